@@ -37,6 +37,7 @@ GetOptions(
   'arch=s',
   'sym=s',
   'config=s',
+  'bench',
 );
 
 foreach my $opt (qw/arch config/) {
@@ -134,6 +135,31 @@ sub process_forward_decls() {
   }
 }
 
+sub kernel_stats {
+  return vpx_config("CONFIG_KERNEL_STATS") eq "yes";
+}
+
+# Returns a prototype's argument list with every parameter named, and the
+# comma separated names to forward them with.
+sub named_args {
+  my $args = shift;
+  return ($args, "") if $args =~ /^\s*(void)?\s*$/;
+  my (@decls, @names);
+  foreach my $arg (split /,/, $args) {
+    $arg =~ s/^\s+|\s+$//g;
+    (my $type = $arg) =~ s/\[.*\]//g;
+    if ($type =~ /[\w\s]*[\s*](\w+)$/) {
+      push @decls, $arg;
+      push @names, $1;
+    } else {
+      my $name = "arg" . scalar(@names);
+      push @decls, "$arg $name";
+      push @names, $name;
+    }
+  }
+  return (join(", ", @decls), join(", ", @names));
+}
+
 sub determine_indirection {
   vpx_config("CONFIG_RUNTIME_CPU_DETECT") eq "yes" or &require(@ALL_ARCHS);
   foreach my $fn (keys %ALL_FUNCS) {
@@ -150,7 +176,7 @@ sub determine_indirection {
       next if $link && $link eq "false";
       $n .= "x";
     }
-    if ($n eq "x") {
+    if ($n eq "x" && !kernel_stats) {
       eval "\$${fn}_indirect = 'false'";
     } else {
       eval "\$${fn}_indirect = 'true'";
@@ -179,7 +205,45 @@ sub declare_function_pointers {
   }
 }
 
+# With --enable-kernel-stats every function pointer is routed through a
+# wrapper that counts the calls and the time spent in the selected
+# implementation, see vpx_util/vpx_kernel_stats.h.
+sub declare_kernel_stats {
+  return if !kernel_stats;
+  my @fns = sort keys %ALL_FUNCS;
+  my $i = 0;
+  print "#ifdef RTCD_C\n";
+  print "#include \"vpx_util/vpx_kernel_stats.h\"\n\n";
+  print "static VpxKernelStat rtcd_kernel_stats[" . scalar(@fns) . "] = {\n";
+  foreach my $fn (@fns) {
+    print "  { \"$fn\", \"\", 0, 0 },\n";
+  }
+  print "};\n\n";
+  foreach my $fn (@fns) {
+    my @val = @{$ALL_FUNCS{$fn}};
+    my $args = pop @val;
+    my $rtyp = "@val";
+    my ($decls, $names) = named_args($args);
+    my $call = "${fn}_impl($names)";
+    print "static $rtyp (*${fn}_impl)($args);\n";
+    print "static $rtyp ${fn}_stats($decls) {\n";
+    print "  const uint64_t rtcd_start = vpx_kernel_stats_ticks();\n";
+    if ($rtyp eq "void") {
+      print "  $call;\n";
+      print "  vpx_kernel_stats_add(&rtcd_kernel_stats[$i], rtcd_start);\n";
+    } else {
+      print "  const $rtyp ret = $call;\n";
+      print "  vpx_kernel_stats_add(&rtcd_kernel_stats[$i], rtcd_start);\n";
+      print "  return ret;\n";
+    }
+    print "}\n\n";
+    ++$i;
+  }
+  print "#endif  // RTCD_C\n\n";
+}
+
 sub set_function_pointers {
+  my $i = 0;
   foreach my $fn (sort keys %ALL_FUNCS) {
     my @val = @{$ALL_FUNCS{$fn}};
     my $args = pop @val;
@@ -187,7 +251,13 @@ sub set_function_pointers {
     my $dfn = eval "\$${fn}_default";
     $dfn = eval "\$${dfn}";
     if (eval "\$${fn}_indirect" eq "true") {
-      print "    $fn = $dfn;\n";
+      my $ptr = $fn;
+      my $impl = "";
+      if (kernel_stats) {
+        $ptr = "${fn}_impl";
+        $impl = " rtcd_kernel_stats[$i].impl = \"$dfn\";";
+      }
+      print "    $ptr = $dfn;$impl\n";
       foreach my $opt (@_) {
         my $ofn = eval "\$${fn}_${opt}";
         next if !$ofn;
@@ -195,10 +265,63 @@ sub set_function_pointers {
         my $link = eval "\$${fn}_${opt}_link";
         next if $link && $link eq "false";
         my $cond = eval "\$have_${opt}";
-        print "    if (${cond}) $fn = $ofn;\n"
+        if (kernel_stats) {
+          print "    if (${cond}) { $ptr = $ofn; " .
+                "rtcd_kernel_stats[$i].impl = \"$ofn\"; }\n";
+        } else {
+          print "    if (${cond}) $fn = $ofn;\n"
+        }
       }
+      print "    $fn = ${fn}_stats;\n" if kernel_stats;
     }
+    ++$i;
   }
+  if (kernel_stats) {
+    print "    vpx_kernel_stats_register(rtcd_kernel_stats, $i);\n";
+  }
+}
+
+# Returns a prototype with the parameter names removed, e.g.
+# "unsigned int(const uint8_t*,int,const uint8_t*,int)".
+sub prototype_key {
+  my ($rtyp, $args) = @_;
+  my @types;
+  foreach my $arg (split /,/, $args) {
+    $arg =~ s/^\s+|\s+$//g;
+    next if $arg eq "" || $arg eq "void";
+    my $dims = join("", $arg =~ /(\[[^\]]*\])/g);
+    $dims =~ s/\[[^\]]*\]/[]/g;
+    (my $type = $arg) =~ s/\[.*\]//g;
+    if ($type =~ /[\w\s]*[\s*](\w+)$/ &&
+        $1 !~ /^(char|short|int|long|unsigned|signed|\w+_t)$/) {
+      $type =~ s/\w+$//;
+    }
+    push @types, $type . $dims;
+  }
+  my $key = "$rtyp(" . join(",", @types) . ")";
+  $key =~ s/\s+/ /g;
+  $key =~ s/\s*([*(),\[\]])\s*/$1/g;
+  return $key;
+}
+
+# With --bench the header instead lists every implementation of every
+# function, keyed by its prototype, for test/vpx_dsp_bench.cc.
+sub bench_table {
+  print "// This file is generated. Do not edit.\n";
+  print "static const RtcdKernel $opts{sym}_kernels[] = {\n";
+  foreach my $fn (sort keys %ALL_FUNCS) {
+    my @val = @{$ALL_FUNCS{$fn}};
+    my $args = pop @val;
+    my $key = prototype_key("@val", $args);
+    foreach my $opt (@_) {
+      my $ofn = eval "\$${fn}_${opt}";
+      next if !$ofn;
+      my $link = eval "\$${fn}_${opt}_link";
+      next if $opt ne "c" && $link && $link eq "false";
+      print "  { \"$fn\", \"$opt\", \"$key\", (RtcdKernelFn)$ofn },\n";
+    }
+  }
+  print "};\n";
 }
 
 sub filter {
@@ -211,6 +334,10 @@ sub filter {
 # Helper functions for generating the arch specific RTCD files
 #
 sub common_top() {
+  if ($opts{bench}) {
+    bench_table("c", @ALL_ARCHS);
+    exit 0;
+  }
   my $include_guard = uc($opts{sym})."_H_";
   my @time = localtime;
   my $year = $time[5] + 1900;
@@ -251,6 +378,7 @@ print <<EOF;
 void $opts{sym}(void);
 
 EOF
+declare_kernel_stats();
 }
 
 sub common_bottom() {
@@ -543,3 +671,4 @@ Options:
   --require-EXT     Require support for EXT extensions
   --sym=SYMBOL      Unique symbol to use for RTCD initialization function
   --config=FILE     File with CONFIG_FOO=yes lines to parse
+  --bench           List every implementation of every function instead
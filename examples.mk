@@ -75,6 +75,7 @@ vpxdec.SRCS                 += args.c args.h
 vpxdec.SRCS                 += ivfdec.c ivfdec.h
 vpxdec.SRCS                 += y4minput.c y4minput.h
 vpxdec.SRCS                 += tools_common.c tools_common.h
+vpxdec.SRCS                 += tool_worker.c tool_worker.h
 vpxdec.SRCS                 += y4menc.c y4menc.h
 ifeq ($(CONFIG_LIBYUV),yes)
   vpxdec.SRCS                 += $(LIBYUV_SRCS)
@@ -97,6 +98,7 @@ vpxenc.SRCS                 += vpx_ports/mem_ops.h
 vpxenc.SRCS                 += vpx_ports/mem_ops_aligned.h
 vpxenc.SRCS                 += vpx_ports/vpx_timer.h
 vpxenc.SRCS                 += vpxstats.c vpxstats.h
+vpxenc.SRCS                 += tool_worker.c tool_worker.h
 ifeq ($(CONFIG_LIBYUV),yes)
   vpxenc.SRCS                 += $(LIBYUV_SRCS)
 endif
@@ -226,6 +228,21 @@ vp9cx_set_ref.DESCRIPTION           = VP9 set encoder reference frame
 endif
 endif
 
+ifeq ($(CONFIG_LIBYUV),yes)
+# tools_common.c reads y4m input and video_writer.c writes ivf, so both
+# still need y4minput.c and ivfenc.c even though the example never calls
+# them directly.
+EXAMPLES-$(CONFIG_VP9_ENCODER)      += vp9_abr_ladder_encoder.c
+vp9_abr_ladder_encoder.SRCS         += ivfenc.h ivfenc.c
+vp9_abr_ladder_encoder.SRCS         += y4minput.c y4minput.h
+vp9_abr_ladder_encoder.SRCS         += tools_common.h tools_common.c
+vp9_abr_ladder_encoder.SRCS         += video_common.h
+vp9_abr_ladder_encoder.SRCS         += video_writer.h video_writer.c
+vp9_abr_ladder_encoder.SRCS         += $(LIBYUV_SRCS)
+vp9_abr_ladder_encoder.GUID          = 5D2B5A3E-8C1F-4E47-9B6A-2F4C7E1D0A93
+vp9_abr_ladder_encoder.DESCRIPTION   = VP9 ABR ladder from one first pass
+endif
+
 ifeq ($(CONFIG_MULTI_RES_ENCODING),yes)
 ifeq ($(CONFIG_LIBYUV),yes)
 EXAMPLES-$(CONFIG_VP8_ENCODER)          += vp8_multi_resolution_encoder.c
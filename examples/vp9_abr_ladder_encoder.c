@@ -0,0 +1,321 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// VP9 ABR Ladder Encoder
+// ======================
+//
+// This is an example of encoding several renditions of one source, the rungs
+// of an adaptive bitrate ladder, from a single first pass. It takes an input
+// file in I420 format and a list of renditions, each with its own frame size,
+// target bitrate and IVF output file. It builds upon the twopass_encoder
+// example.
+//
+// Analysis Pass
+// -------------
+// The first pass only runs once, on the smallest rendition, since the cost of
+// the analysis grows with the frame area while the statistics it produces are
+// normalized per macroblock.
+//
+// Sharing The Statistics
+// ----------------------
+// Every rendition uses the same statistics buffer for its second pass. The
+// renditions whose size differs from the analysed one tell the encoder the
+// size of the first pass with VP9E_SET_FIRST_PASS_FRAME_SIZE, so the motion
+// statistics are rescaled to their own frame size.
+//
+// Encoding The Renditions
+// -----------------------
+// The second passes run in lockstep: each source frame is read once and
+// scaled with libyuv to the size of every rendition.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "third_party/libyuv/include/libyuv/scale.h"
+#include "vpx/vp8cx.h"
+#include "vpx/vpx_encoder.h"
+
+#include "../tools_common.h"
+#include "../video_writer.h"
+
+#define MAX_RENDITIONS 8
+
+typedef struct {
+  int width;
+  int height;
+  int bitrate;
+  const char *outfile;
+  vpx_image_t raw;
+  vpx_codec_ctx_t codec;
+  VpxVideoWriter *writer;
+} Rendition;
+
+static const char *exec_name;
+
+void usage_exit(void) {
+  fprintf(stderr,
+          "Usage: %s <width> <height> <infile> <frame limit> "
+          "<WxH:kbps:outfile>...\n",
+          exec_name);
+  exit(EXIT_FAILURE);
+}
+
+static void parse_rendition(const char *arg, Rendition *rendition) {
+  char *end;
+  rendition->width = (int)strtol(arg, &end, 0);
+  if (*end != 'x') die("Invalid rendition: %s", arg);
+  rendition->height = (int)strtol(end + 1, &end, 0);
+  if (*end != ':') die("Invalid rendition: %s", arg);
+  rendition->bitrate = (int)strtol(end + 1, &end, 0);
+  if (*end != ':' || end[1] == '\0') die("Invalid rendition: %s", arg);
+  rendition->outfile = end + 1;
+
+  if (rendition->width <= 0 || rendition->height <= 0 ||
+      (rendition->width % 2) != 0 || (rendition->height % 2) != 0)
+    die("Invalid frame size: %dx%d", rendition->width, rendition->height);
+  if (rendition->bitrate <= 0) die("Invalid bitrate: %s", arg);
+}
+
+static void scale_frame(const vpx_image_t *src, vpx_image_t *dst) {
+  I420Scale(src->planes[VPX_PLANE_Y], src->stride[VPX_PLANE_Y],
+            src->planes[VPX_PLANE_U], src->stride[VPX_PLANE_U],
+            src->planes[VPX_PLANE_V], src->stride[VPX_PLANE_V], src->d_w,
+            src->d_h, dst->planes[VPX_PLANE_Y], dst->stride[VPX_PLANE_Y],
+            dst->planes[VPX_PLANE_U], dst->stride[VPX_PLANE_U],
+            dst->planes[VPX_PLANE_V], dst->stride[VPX_PLANE_V], dst->d_w,
+            dst->d_h, kFilterBox);
+}
+
+// Returns the source frame at the size of the rendition.
+static const vpx_image_t *rendition_frame(const vpx_image_t *src,
+                                          Rendition *rendition) {
+  if ((int)src->d_w == rendition->width && (int)src->d_h == rendition->height)
+    return src;
+  scale_frame(src, &rendition->raw);
+  return &rendition->raw;
+}
+
+static int get_frame_stats(vpx_codec_ctx_t *ctx, const vpx_image_t *img,
+                           vpx_codec_pts_t pts, vpx_fixed_buf_t *stats) {
+  int got_pkts = 0;
+  vpx_codec_iter_t iter = NULL;
+  const vpx_codec_cx_pkt_t *pkt = NULL;
+  const vpx_codec_err_t res =
+      vpx_codec_encode(ctx, img, pts, 1, 0, VPX_DL_GOOD_QUALITY);
+  if (res != VPX_CODEC_OK) die_codec(ctx, "Failed to get frame stats.");
+
+  while ((pkt = vpx_codec_get_cx_data(ctx, &iter)) != NULL) {
+    got_pkts = 1;
+
+    if (pkt->kind == VPX_CODEC_STATS_PKT) {
+      const uint8_t *const pkt_buf = pkt->data.twopass_stats.buf;
+      const size_t pkt_size = pkt->data.twopass_stats.sz;
+      stats->buf = realloc(stats->buf, stats->sz + pkt_size);
+      if (!stats->buf) die("Failed to reallocate stats buffer.");
+      memcpy((uint8_t *)stats->buf + stats->sz, pkt_buf, pkt_size);
+      stats->sz += pkt_size;
+    }
+  }
+
+  return got_pkts;
+}
+
+static int encode_frame(Rendition *rendition, const vpx_image_t *img,
+                        vpx_codec_pts_t pts) {
+  int got_pkts = 0;
+  vpx_codec_iter_t iter = NULL;
+  const vpx_codec_cx_pkt_t *pkt = NULL;
+  const vpx_codec_err_t res =
+      vpx_codec_encode(&rendition->codec, img, pts, 1, 0, VPX_DL_GOOD_QUALITY);
+  if (res != VPX_CODEC_OK)
+    die_codec(&rendition->codec, "Failed to encode frame.");
+
+  while ((pkt = vpx_codec_get_cx_data(&rendition->codec, &iter)) != NULL) {
+    got_pkts = 1;
+    if (pkt->kind == VPX_CODEC_CX_FRAME_PKT) {
+      if (!vpx_video_writer_write_frame(rendition->writer, pkt->data.frame.buf,
+                                        pkt->data.frame.sz,
+                                        pkt->data.frame.pts))
+        die_codec(&rendition->codec, "Failed to write compressed frame.");
+    }
+  }
+
+  return got_pkts;
+}
+
+static vpx_fixed_buf_t analysis_pass(vpx_image_t *source, FILE *infile,
+                                     const VpxInterface *encoder,
+                                     vpx_codec_enc_cfg_t *cfg,
+                                     Rendition *rendition, int max_frames) {
+  vpx_codec_ctx_t codec;
+  int frame_count = 0;
+  vpx_fixed_buf_t stats = { NULL, 0 };
+
+  cfg->g_w = rendition->width;
+  cfg->g_h = rendition->height;
+  cfg->rc_target_bitrate = rendition->bitrate;
+  cfg->g_pass = VPX_RC_FIRST_PASS;
+  if (vpx_codec_enc_init(&codec, encoder->codec_interface(), cfg, 0))
+    die("Failed to initialize encoder");
+
+  while (vpx_img_read(source, infile)) {
+    ++frame_count;
+    get_frame_stats(&codec, rendition_frame(source, rendition), frame_count,
+                    &stats);
+    if (max_frames > 0 && frame_count >= max_frames) break;
+  }
+
+  // Flush encoder.
+  while (get_frame_stats(&codec, NULL, frame_count, &stats)) {
+  }
+
+  printf("Analysis pass complete at %dx%d. Processed %d frames.\n",
+         rendition->width, rendition->height, frame_count);
+  if (vpx_codec_destroy(&codec)) die_codec(&codec, "Failed to destroy codec.");
+
+  return stats;
+}
+
+static void encode_renditions(vpx_image_t *source, FILE *infile,
+                              const VpxInterface *encoder,
+                              vpx_codec_enc_cfg_t *cfg, Rendition *renditions,
+                              int num_renditions, int analysis_idx,
+                              vpx_fixed_buf_t stats, int max_frames) {
+  vpx_first_pass_frame_size_t first_pass_size;
+  int frame_count = 0;
+  int i;
+
+  first_pass_size.width = renditions[analysis_idx].width;
+  first_pass_size.height = renditions[analysis_idx].height;
+
+  cfg->g_pass = VPX_RC_LAST_PASS;
+  cfg->rc_twopass_stats_in = stats;
+  for (i = 0; i < num_renditions; ++i) {
+    Rendition *const rendition = &renditions[i];
+    VpxVideoInfo info = { encoder->fourcc,
+                          rendition->width,
+                          rendition->height,
+                          { cfg->g_timebase.num, cfg->g_timebase.den } };
+
+    rendition->writer =
+        vpx_video_writer_open(rendition->outfile, kContainerIVF, &info);
+    if (!rendition->writer)
+      die("Failed to open %s for writing", rendition->outfile);
+
+    cfg->g_w = rendition->width;
+    cfg->g_h = rendition->height;
+    cfg->rc_target_bitrate = rendition->bitrate;
+    if (vpx_codec_enc_init(&rendition->codec, encoder->codec_interface(), cfg,
+                           0))
+      die("Failed to initialize encoder");
+
+    if (i != analysis_idx &&
+        vpx_codec_control(&rendition->codec, VP9E_SET_FIRST_PASS_FRAME_SIZE,
+                          &first_pass_size))
+      die_codec(&rendition->codec, "Failed to set first pass frame size");
+  }
+
+  while (vpx_img_read(source, infile)) {
+    ++frame_count;
+    for (i = 0; i < num_renditions; ++i) {
+      encode_frame(&renditions[i], rendition_frame(source, &renditions[i]),
+                   frame_count);
+    }
+    if (max_frames > 0 && frame_count >= max_frames) break;
+  }
+
+  for (i = 0; i < num_renditions; ++i) {
+    Rendition *const rendition = &renditions[i];
+
+    // Flush encoder.
+    while (encode_frame(rendition, NULL, -1)) {
+    }
+
+    if (vpx_codec_destroy(&rendition->codec))
+      die_codec(&rendition->codec, "Failed to destroy codec.");
+    vpx_video_writer_close(rendition->writer);
+    printf("Wrote %dx%d at %d kbps to %s.\n", rendition->width,
+           rendition->height, rendition->bitrate, rendition->outfile);
+  }
+
+  printf("Encode complete. Processed %d frames.\n", frame_count);
+}
+
+int main(int argc, char **argv) {
+  FILE *infile = NULL;
+  int w, h;
+  vpx_codec_enc_cfg_t cfg;
+  vpx_image_t source;
+  vpx_fixed_buf_t stats;
+  Rendition renditions[MAX_RENDITIONS];
+  int num_renditions;
+  int analysis_idx = 0;
+  int max_frames;
+  int i;
+
+  const VpxInterface *encoder = NULL;
+  const int fps = 30;
+  exec_name = argv[0];
+
+  if (argc < 6) die("Invalid number of arguments.");
+  num_renditions = argc - 5;
+  if (num_renditions > MAX_RENDITIONS)
+    die("At most %d renditions are supported.", MAX_RENDITIONS);
+
+  encoder = get_vpx_encoder_by_name("vp9");
+  if (!encoder) die("Unsupported codec.");
+
+  w = (int)strtol(argv[1], NULL, 0);
+  h = (int)strtol(argv[2], NULL, 0);
+  if (w <= 0 || h <= 0 || (w % 2) != 0 || (h % 2) != 0)
+    die("Invalid frame size: %dx%d", w, h);
+  max_frames = (int)strtol(argv[4], NULL, 0);
+
+  memset(renditions, 0, sizeof(renditions));
+  for (i = 0; i < num_renditions; ++i) {
+    Rendition *const rendition = &renditions[i];
+    parse_rendition(argv[5 + i], rendition);
+    if (!vpx_img_alloc(&rendition->raw, VPX_IMG_FMT_I420, rendition->width,
+                       rendition->height, 1))
+      die("Failed to allocate image (%dx%d)", rendition->width,
+          rendition->height);
+    if (rendition->width * rendition->height <
+        renditions[analysis_idx].width * renditions[analysis_idx].height)
+      analysis_idx = i;
+  }
+
+  if (!vpx_img_alloc(&source, VPX_IMG_FMT_I420, w, h, 1))
+    die("Failed to allocate image (%dx%d)", w, h);
+
+  printf("Using %s\n", vpx_codec_iface_name(encoder->codec_interface()));
+
+  if (vpx_codec_enc_config_default(encoder->codec_interface(), &cfg, 0))
+    die("Failed to get default codec config.");
+  cfg.g_timebase.num = 1;
+  cfg.g_timebase.den = fps;
+
+  if (!(infile = fopen(argv[3], "rb")))
+    die("Failed to open %s for reading", argv[3]);
+
+  stats = analysis_pass(&source, infile, encoder, &cfg,
+                        &renditions[analysis_idx], max_frames);
+
+  rewind(infile);
+  encode_renditions(&source, infile, encoder, &cfg, renditions, num_renditions,
+                    analysis_idx, stats, max_frames);
+  free(stats.buf);
+
+  for (i = 0; i < num_renditions; ++i) vpx_img_free(&renditions[i].raw);
+  vpx_img_free(&source);
+  fclose(infile);
+
+  return EXIT_SUCCESS;
+}
@@ -11,6 +11,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 #include "vpx_ports/mem_ops.h"
 
@@ -110,3 +114,86 @@ int ivf_read_frame(FILE *infile, uint8_t **buffer, size_t *bytes_read,
 
   return 1;
 }
+
+int ivf_map_file(struct IvfMappedFile *ivf, FILE *infile) {
+#if !defined(_WIN32)
+  struct stat st;
+  size_t offset = IVF_FILE_HDR_SZ;
+  unsigned int capacity = 0;
+  void *data;
+
+  memset(ivf, 0, sizeof(*ivf));
+  if (fstat(fileno(infile), &st) || !S_ISREG(st.st_mode) ||
+      st.st_size < IVF_FILE_HDR_SZ || (uint64_t)st.st_size > SIZE_MAX) {
+    return 1;
+  }
+  data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE,
+              fileno(infile), 0);
+  if (data == MAP_FAILED) return 1;
+  ivf->data = (uint8_t *)data;
+  ivf->size = (size_t)st.st_size;
+
+  while (ivf->size - offset >= IVF_FRAME_HDR_SZ) {
+    const size_t frame_size = mem_get_le32(ivf->data + offset);
+
+    offset += IVF_FRAME_HDR_SZ;
+    if (frame_size > 256 * 1024 * 1024 || frame_size > ivf->size - offset) {
+      ivf->truncated = 1;
+      break;
+    }
+    if (ivf->frame_count == capacity) {
+      const unsigned int new_capacity = capacity ? 2 * capacity : 256;
+      size_t *const new_offsets = (size_t *)realloc(
+          ivf->frame_offsets, new_capacity * sizeof(*new_offsets));
+
+      if (!new_offsets) {
+        ivf_unmap_file(ivf);
+        return 1;
+      }
+      ivf->frame_offsets = new_offsets;
+      capacity = new_capacity;
+    }
+    ivf->frame_offsets[ivf->frame_count++] = offset;
+    offset += frame_size;
+  }
+  return 0;
+#else
+  (void)ivf;
+  (void)infile;
+  return 1;
+#endif
+}
+
+int ivf_map_read_frame(struct IvfMappedFile *ivf, const uint8_t **buffer,
+                       size_t *bytes_read) {
+  size_t offset;
+
+  if (ivf->next_frame >= ivf->frame_count) {
+    if (ivf->truncated) {
+      warn("Failed to read full frame");
+      ivf->truncated = 0;
+    }
+    return 1;
+  }
+  offset = ivf->frame_offsets[ivf->next_frame++];
+  *buffer = ivf->data + offset;
+  *bytes_read = mem_get_le32(ivf->data + offset - IVF_FRAME_HDR_SZ);
+  return 0;
+}
+
+int ivf_map_seek(struct IvfMappedFile *ivf, unsigned int frame) {
+  if (frame > ivf->frame_count) {
+    ivf->next_frame = ivf->frame_count;
+    return 1;
+  }
+  ivf->next_frame = frame;
+  return 0;
+}
+
+void ivf_unmap_file(struct IvfMappedFile *ivf) {
+#if !defined(_WIN32)
+  if (ivf->data) munmap(ivf->data, ivf->size);
+#endif
+  free(ivf->frame_offsets);
+  memset(ivf, 0, sizeof(*ivf));
+}
@@ -21,6 +21,33 @@ int file_is_ivf(struct VpxInputContext *input);
 int ivf_read_frame(FILE *infile, uint8_t **buffer, size_t *bytes_read,
                    size_t *buffer_size);
 
+// An IVF file mapped read only into memory, with an index of the offset of
+// the data of every complete frame.
+struct IvfMappedFile {
+  uint8_t *data;
+  size_t size;
+  size_t *frame_offsets;
+  unsigned int frame_count;
+  unsigned int next_frame;
+  int truncated;
+};
+
+// Maps |infile|, which must be a regular IVF file, and indexes its frames.
+// Returns 0 on success and nonzero if the file cannot be mapped, in which
+// case ivf_read_frame() should be used instead.
+int ivf_map_file(struct IvfMappedFile *ivf, FILE *infile);
+
+// Returns the next frame in |*buffer| as a pointer into the mapped file.
+// Returns 0 on success and 1 at the end of the file.
+int ivf_map_read_frame(struct IvfMappedFile *ivf, const uint8_t **buffer,
+                       size_t *bytes_read);
+
+// Makes |frame| the next frame returned by ivf_map_read_frame(). Returns 1
+// and positions at the end of the file if there are not that many frames.
+int ivf_map_seek(struct IvfMappedFile *ivf, unsigned int frame);
+
+void ivf_unmap_file(struct IvfMappedFile *ivf);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -29,6 +29,14 @@ $$(BUILD_PFX)$(1).h: $$(SRC_PATH_BARE)/$(2)
           $$(RTCD_OPTIONS) $$^ > $$@
 CLEAN-OBJS += $$(BUILD_PFX)$(1).h
 RTCD += $$(BUILD_PFX)$(1).h
+$$(BUILD_PFX)$(1)_bench.h: $$(SRC_PATH_BARE)/$(2)
+	@echo "    [CREATE] $$@"
+	$$(qexec)$$(SRC_PATH_BARE)/build/make/rtcd.pl --arch=$$(TGT_ISA) \
+          --sym=$(1) --bench \
+          --config=$$(CONFIG_DIR)$$(target)-$$(TOOLCHAIN).mk \
+          $$(RTCD_OPTIONS) $$^ > $$@
+CLEAN-OBJS += $$(BUILD_PFX)$(1)_bench.h
+RTCD_BENCH += $$(BUILD_PFX)$(1)_bench.h
 endef
 
 CODEC_SRCS-yes += CHANGELOG
@@ -171,14 +179,19 @@ endif
 CODEC_EXPORTS-yes += vpx/exports_com
 CODEC_EXPORTS-$(CONFIG_ENCODERS) += vpx/exports_enc
 CODEC_EXPORTS-$(CONFIG_DECODERS) += vpx/exports_dec
+CODEC_EXPORTS-$(CONFIG_THREAD_TRACE) += vpx/exports_trace
+CODEC_EXPORTS-$(CONFIG_KERNEL_STATS) += vpx/exports_kernel_stats
 
 INSTALL-LIBS-yes += include/vpx/vpx_codec.h
 INSTALL-LIBS-yes += include/vpx/vpx_frame_buffer.h
 INSTALL-LIBS-yes += include/vpx/vpx_image.h
 INSTALL-LIBS-yes += include/vpx/vpx_integer.h
+INSTALL-LIBS-yes += include/vpx/vpx_mode_info.h
 INSTALL-LIBS-$(CONFIG_DECODERS) += include/vpx/vpx_decoder.h
 INSTALL-LIBS-$(CONFIG_ENCODERS) += include/vpx/vpx_encoder.h
 INSTALL-LIBS-$(CONFIG_ENCODERS) += include/vpx/vpx_tpl.h
+INSTALL-LIBS-$(CONFIG_THREAD_TRACE) += include/vpx/vpx_trace.h
+INSTALL-LIBS-$(CONFIG_KERNEL_STATS) += include/vpx/vpx_kernel_stats.h
 ifeq ($(CONFIG_EXTERNAL_BUILD),yes)
 ifeq ($(CONFIG_MSVS),yes)
 INSTALL-LIBS-yes                  += $(foreach p,$(VS_PLATFORMS),$(LIBSUBDIR)/$(p)/$(CODEC_LIB).lib)
@@ -506,6 +519,11 @@ TEST_INTRA_PRED_SPEED_SRCS=$(call addprefix_clean,test/,\
                            $(call enabled,TEST_INTRA_PRED_SPEED_SRCS))
 TEST_INTRA_PRED_SPEED_OBJS := $(sort $(call objs,$(TEST_INTRA_PRED_SPEED_SRCS)))
 
+VPX_DSP_BENCH_BIN=./vpx_dsp_bench$(EXE_SFX)
+VPX_DSP_BENCH_SRCS=$(call addprefix_clean,test/,\
+                   $(call enabled,VPX_DSP_BENCH_SRCS))
+VPX_DSP_BENCH_OBJS := $(sort $(call objs,$(VPX_DSP_BENCH_SRCS)))
+
 ifeq ($(CONFIG_ENCODERS),yes)
 RC_INTERFACE_TEST_BIN=./test_rc_interface$(EXE_SFX)
 RC_INTERFACE_TEST_SRCS=$(call addprefix_clean,test/,\
@@ -612,6 +630,25 @@ test_intra_pred_speed.$(VCPROJ_SFX): $(TEST_INTRA_PRED_SPEED_SRCS) vpx.$(VCPROJ_
             -L. -l$(CODEC_LIB) -l$(GTEST_LIB) $^
 endif  # TEST_INTRA_PRED_SPEED
 
+ifneq ($(strip $(VPX_DSP_BENCH_OBJS)),)
+PROJECTS-$(CONFIG_MSVS) += vpx_dsp_bench.$(VCPROJ_SFX)
+# The generated kernel tables are order-only so $^ holds just the sources.
+vpx_dsp_bench.$(VCPROJ_SFX): $(VPX_DSP_BENCH_SRCS) vpx.$(VCPROJ_SFX) \
+	| $(RTCD_BENCH)
+	@echo "    [CREATE] $@"
+	$(qexec)$(GEN_VCPROJ) \
+            --exe \
+            --target=$(TOOLCHAIN) \
+            --name=vpx_dsp_bench \
+            --proj-guid=6F1F8B2E-7B6D-4E1C-9B4A-2D0C5A8E3F71 \
+            --ver=$(CONFIG_VS_VERSION) \
+            --src-path-bare="$(SRC_PATH_BARE)" \
+            --as=$(AS) \
+            $(if $(CONFIG_STATIC_MSVCRT),--static-crt) \
+            --out=$@ $(INTERNAL_CFLAGS) $(CFLAGS) \
+            -I. -L. -l$(CODEC_LIB) $^
+endif  # VPX_DSP_BENCH
+
 ifeq ($(CONFIG_ENCODERS),yes)
 ifneq ($(strip $(RC_INTERFACE_TEST_OBJS)),)
 PROJECTS-$(CONFIG_MSVS) += test_rc_interface.$(VCPROJ_SFX)
@@ -674,6 +711,23 @@ $(eval $(call linkerxx_template,$(TEST_INTRA_PRED_SPEED_BIN), \
               -L. -lvpx -lgtest $(extralibs) -lm))
 endif  # TEST_INTRA_PRED_SPEED
 
+ifneq ($(strip $(VPX_DSP_BENCH_OBJS)),)
+OBJS-yes += $(VPX_DSP_BENCH_OBJS)
+BINS-yes += $(VPX_DSP_BENCH_BIN)
+
+# The kernel tables are generated from the rtcd definitions by rtcd.pl --bench.
+ifeq ($(CONFIG_DEPENDENCY_TRACKING),yes)
+$(VPX_DSP_BENCH_OBJS:.o=.d): $(RTCD_BENCH)
+else
+$(VPX_DSP_BENCH_OBJS): $(RTCD_BENCH)
+endif
+
+$(VPX_DSP_BENCH_BIN): lib$(CODEC_LIB)$(CODEC_LIB_SUF)
+$(eval $(call linkerxx_template,$(VPX_DSP_BENCH_BIN), \
+              $(VPX_DSP_BENCH_OBJS) \
+              -L. -lvpx $(extralibs) -lm))
+endif  # VPX_DSP_BENCH
+
 ifeq ($(CONFIG_ENCODERS),yes)
 ifneq ($(strip $(RC_INTERFACE_TEST_OBJS)),)
 $(RC_INTERFACE_TEST_OBJS) $(RC_INTERFACE_TEST_OBJS:.o=.d): \
@@ -707,6 +761,7 @@ INSTALL-SRCS-$(CONFIG_CODEC_SRCS) += $(patsubst $(SRC_PATH_BARE)/%,%,\
     $(shell find $(SRC_PATH_BARE)/third_party/googletest -type f))
 INSTALL-SRCS-$(CONFIG_CODEC_SRCS) += $(LIBVPX_TEST_SRCS)
 INSTALL-SRCS-$(CONFIG_CODEC_SRCS) += $(TEST_INTRA_PRED_SPEED_SRCS)
+INSTALL-SRCS-$(CONFIG_CODEC_SRCS) += $(VPX_DSP_BENCH_SRCS)
 INSTALL-SRCS-$(CONFIG_CODEC_SRCS) += $(RC_INTERFACE_TEST_SRCS)
 
 define test_shard_template
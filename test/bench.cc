@@ -27,13 +27,22 @@ void AbstractBench::RunNTimes(int n) {
   }
 }
 
-void AbstractBench::PrintMedian(const char *title) {
+int AbstractBench::GetMedian(double *mad) {
   std::sort(times_, times_ + VPX_BENCH_ROBUST_ITER);
   const int med = times_[VPX_BENCH_ROBUST_ITER >> 1];
-  int sad = 0;
-  for (int t = 0; t < VPX_BENCH_ROBUST_ITER; t++) {
-    sad += abs(times_[t] - med);
+  if (mad != nullptr) {
+    int sad = 0;
+    for (int t = 0; t < VPX_BENCH_ROBUST_ITER; t++) {
+      sad += abs(times_[t] - med);
+    }
+    *mad = sad / static_cast<double>(VPX_BENCH_ROBUST_ITER);
   }
+  return med;
+}
+
+void AbstractBench::PrintMedian(const char *title) {
+  double mad;
+  const int med = GetMedian(&mad);
   printf("[%10s] %s %.1f ms ( ±%.1f ms )\n", "BENCH ", title, med / 1000.0,
-         sad / (VPX_BENCH_ROBUST_ITER * 1000.0));
+         mad / 1000.0);
 }
@@ -20,6 +20,10 @@ class AbstractBench {
 
   void RunNTimes(int n);
   void PrintMedian(const char *title);
+  // Returns the median run time in microseconds of the last RunNTimes() call.
+  // If |mad| is not null it receives the mean absolute deviation from the
+  // median, also in microseconds.
+  int GetMedian(double *mad);
 
  protected:
   // Implement this method and put the code to benchmark in it.
@@ -8,10 +8,16 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 
 #include "./vpx_config.h"
 #include "test/ivf_video_source.h"
+#if CONFIG_VP9_ENCODER
+#include "vpx/vp8cx.h"
+#include "vpx/vpx_encoder.h"
+#endif
 #include "vpx/vp8dx.h"
 #include "vpx/vpx_decoder.h"
 
@@ -193,6 +199,206 @@ TEST(DecodeAPI, Vp9PeekStreamInfoTruncated) {
     TestPeekInfo(profile1_data, data_sz, 11);
   }
 }
+
+#if CONFIG_VP9_ENCODER
+// Returns a flat 8-bit I420 image to encode the test streams from.
+vpx_image_t *CreateGrayImage(unsigned int width, unsigned int height) {
+  vpx_image_t *const image =
+      vpx_img_alloc(nullptr, VPX_IMG_FMT_I420, width, height, 1);
+  if (image == nullptr) return image;
+  for (int plane = 0; plane < 3; ++plane) {
+    const unsigned int w = plane ? (width + 1) >> 1 : width;
+    const unsigned int h = plane ? (height + 1) >> 1 : height;
+    for (unsigned int r = 0; r < h; ++r) {
+      memset(image->planes[plane] + r * image->stride[plane], 128, w);
+    }
+  }
+  return image;
+}
+
+// Fills the image with a texture that moves 2 pixels to the right per frame.
+void FillMovingTexture(vpx_image_t *image, int frame) {
+  for (int plane = 0; plane < 3; ++plane) {
+    const int shift = plane ? 1 : 0;
+    const int w = static_cast<int>((image->d_w + shift) >> shift);
+    const int h = static_cast<int>((image->d_h + shift) >> shift);
+    for (int r = 0; r < h; ++r) {
+      uint8_t *const row = image->planes[plane] + r * image->stride[plane];
+      for (int c = 0; c < w; ++c) {
+        const int x = (c << shift) - 2 * frame;
+        const int y = r << shift;
+        row[c] = static_cast<uint8_t>(64 + ((x * 5 + y * 3) & 127));
+      }
+    }
+  }
+}
+
+// Returns whether the columns [x, x + w) of the two images match.
+bool ColumnsMatch(const vpx_image_t *a, const vpx_image_t *b, unsigned int x,
+                  unsigned int w) {
+  for (int plane = 0; plane < 3; ++plane) {
+    const unsigned int shift = plane ? a->x_chroma_shift : 0;
+    const unsigned int h =
+        plane ? (a->d_h + a->y_chroma_shift) >> a->y_chroma_shift : a->d_h;
+    const unsigned int col = (x + shift) >> shift;
+    const unsigned int col_end = (x + w) >> shift;
+    for (unsigned int r = 0; r < h; ++r) {
+      const uint8_t *const row_a = a->planes[plane] + r * a->stride[plane];
+      const uint8_t *const row_b = b->planes[plane] + r * b->stride[plane];
+      if (col < col_end &&
+          memcmp(row_a + col, row_b + col, col_end - col) != 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+TEST(DecodeAPI, DecodeRegionVP9) {
+  constexpr int kNumFrames = 8;
+  vpx_codec_enc_cfg_t cfg;
+  ASSERT_EQ(vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &cfg, 0),
+            VPX_CODEC_OK);
+  // Four tile columns of 256 pixels.
+  cfg.g_w = 1024;
+  cfg.g_h = 64;
+  cfg.g_lag_in_frames = 0;
+  vpx_image_t *image =
+      vpx_img_alloc(nullptr, VPX_IMG_FMT_I420, cfg.g_w, cfg.g_h, 1);
+  ASSERT_NE(image, nullptr);
+  vpx_codec_ctx_t enc;
+  ASSERT_EQ(vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0),
+            VPX_CODEC_OK);
+  ASSERT_EQ(vpx_codec_control(&enc, VP8E_SET_CPUUSED, 8), VPX_CODEC_OK);
+  ASSERT_EQ(vpx_codec_control(&enc, VP9E_SET_TILE_COLUMNS, 2), VPX_CODEC_OK);
+  ASSERT_EQ(vpx_codec_control(&enc, VP9E_SET_FRAME_PARALLEL_DECODING, 1),
+            VPX_CODEC_OK);
+
+  vpx_codec_ctx_t dec;
+  ASSERT_EQ(vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), nullptr, 0),
+            VPX_CODEC_OK);
+  // Decodes the whole frames to compare with.
+  vpx_codec_ctx_t full_dec;
+  ASSERT_EQ(vpx_codec_dec_init(&full_dec, vpx_codec_vp9_dx(), nullptr, 0),
+            VPX_CODEC_OK);
+  vpx_image_rect_t region = { 65537, 0, 16, 0 };
+  EXPECT_EQ(vpx_codec_control(&dec, VP9D_SET_DECODE_REGION, &region),
+            VPX_CODEC_INVALID_PARAM);
+  region.x = 300;
+  region.w = 100;
+  ASSERT_EQ(vpx_codec_control(&dec, VP9D_SET_DECODE_REGION, &region),
+            VPX_CODEC_OK);
+  for (int i = 0; i < kNumFrames; ++i) {
+    if (i == kNumFrames - 1) {
+      // The columns skipped so far stay skipped until the next key frame.
+      region.x = 700;
+      ASSERT_EQ(vpx_codec_control(&dec, VP9D_SET_DECODE_REGION, &region),
+                VPX_CODEC_OK);
+    }
+    FillMovingTexture(image, i);
+    ASSERT_EQ(vpx_codec_encode(&enc, image, i, 1, 0, VPX_DL_REALTIME),
+              VPX_CODEC_OK);
+    vpx_codec_iter_t iter = nullptr;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != nullptr) {
+      ASSERT_EQ(pkt->kind, VPX_CODEC_CX_FRAME_PKT);
+      const uint8_t *const data =
+          static_cast<const uint8_t *>(pkt->data.frame.buf);
+      const unsigned int size = static_cast<unsigned int>(pkt->data.frame.sz);
+      ASSERT_EQ(vpx_codec_decode(&dec, data, size, nullptr, 0), VPX_CODEC_OK);
+      ASSERT_EQ(vpx_codec_decode(&full_dec, data, size, nullptr, 0),
+                VPX_CODEC_OK);
+      vpx_codec_iter_t dec_iter = nullptr;
+      const vpx_image_t *const img = vpx_codec_get_frame(&dec, &dec_iter);
+      ASSERT_NE(img, nullptr);
+      dec_iter = nullptr;
+      const vpx_image_t *const full_img =
+          vpx_codec_get_frame(&full_dec, &dec_iter);
+      ASSERT_NE(full_img, nullptr);
+      vpx_image_rect_t decoded;
+      ASSERT_EQ(vpx_codec_control(&dec, VP9D_GET_DECODED_REGION, &decoded),
+                VPX_CODEC_OK);
+      EXPECT_EQ(decoded.y, 0u);
+      EXPECT_EQ(decoded.h, cfg.g_h);
+      if (i == 0) {
+        // Only the second tile column intersects the region, less the
+        // margin of the loop filter at its edges.
+        EXPECT_EQ(decoded.x, 256u + 16u);
+        EXPECT_EQ(decoded.w, 256u - 32u);
+      } else if (i == kNumFrames - 1) {
+        EXPECT_EQ(decoded.w, 0u);
+      }
+      EXPECT_TRUE(ColumnsMatch(img, full_img, decoded.x, decoded.w))
+          << "frame " << i;
+    }
+  }
+  vpx_img_free(image);
+  ASSERT_EQ(vpx_codec_destroy(&enc), VPX_CODEC_OK);
+  ASSERT_EQ(vpx_codec_destroy(&dec), VPX_CODEC_OK);
+  ASSERT_EQ(vpx_codec_destroy(&full_dec), VPX_CODEC_OK);
+}
+
+TEST(DecodeAPI, FrameDeadlineVP9) {
+  constexpr int kNumFrames = 6;
+  vpx_codec_enc_cfg_t cfg;
+  ASSERT_EQ(vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &cfg, 0),
+            VPX_CODEC_OK);
+  cfg.g_w = 174;
+  cfg.g_h = 142;
+  cfg.g_lag_in_frames = 0;
+  vpx_image_t *image = CreateGrayImage(cfg.g_w, cfg.g_h);
+  ASSERT_NE(image, nullptr);
+  vpx_codec_ctx_t enc;
+  ASSERT_EQ(vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0),
+            VPX_CODEC_OK);
+  ASSERT_EQ(vpx_codec_control(&enc, VP8E_SET_CPUUSED, 8), VPX_CODEC_OK);
+
+  vpx_codec_ctx_t dec;
+  ASSERT_EQ(vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), nullptr, 0),
+            VPX_CODEC_OK);
+  EXPECT_EQ(vpx_codec_control(&dec, VP9D_SET_FRAME_DEADLINE, -1),
+            VPX_CODEC_INVALID_PARAM);
+  // No frame decodes in a microsecond, so the decoder sheds all it can.
+  ASSERT_EQ(vpx_codec_control(&dec, VP9D_SET_FRAME_DEADLINE, 1),
+            VPX_CODEC_OK);
+  for (int i = 0; i < kNumFrames; ++i) {
+    if (i == kNumFrames - 2) {
+      ASSERT_EQ(vpx_codec_control(&dec, VP9D_SET_FRAME_DEADLINE, 0),
+                VPX_CODEC_OK);
+    }
+    // The odd frames are not references.
+    const vpx_enc_frame_flags_t flags =
+        (i & 1) ? VP8_EFLAG_NO_UPD_LAST | VP8_EFLAG_NO_UPD_GF |
+                      VP8_EFLAG_NO_UPD_ARF
+                : 0;
+    ASSERT_EQ(vpx_codec_encode(&enc, image, i, 1, flags, VPX_DL_REALTIME),
+              VPX_CODEC_OK);
+    vpx_codec_iter_t iter = nullptr;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != nullptr) {
+      ASSERT_EQ(pkt->kind, VPX_CODEC_CX_FRAME_PKT);
+      ASSERT_EQ(vpx_codec_decode(
+                    &dec, static_cast<const uint8_t *>(pkt->data.frame.buf),
+                    static_cast<unsigned int>(pkt->data.frame.sz), nullptr, 0),
+                VPX_CODEC_OK);
+      vpx_codec_iter_t dec_iter = nullptr;
+      const vpx_image_t *const img = vpx_codec_get_frame(&dec, &dec_iter);
+      int skipped_work = -1;
+      ASSERT_EQ(vpx_codec_control(&dec, VP9D_GET_SKIPPED_WORK, &skipped_work),
+                VPX_CODEC_OK);
+      const bool dropped = (i & 1) && i < kNumFrames - 2;
+      EXPECT_EQ(img == nullptr, dropped);
+      EXPECT_EQ((skipped_work & VP9D_SKIPPED_FRAME) != 0, dropped);
+      if (i >= kNumFrames - 2) {
+        EXPECT_EQ(skipped_work, 0);
+      }
+    }
+  }
+  vpx_img_free(image);
+  ASSERT_EQ(vpx_codec_destroy(&enc), VPX_CODEC_OK);
+  ASSERT_EQ(vpx_codec_destroy(&dec), VPX_CODEC_OK);
+}
+#endif  // CONFIG_VP9_ENCODER
 #endif  // CONFIG_VP9_DECODER
 
 TEST(DecodeAPI, HighBitDepthCapability) {
@@ -17,6 +17,7 @@
 #include "test/i420_video_source.h"
 #include "test/ivf_video_source.h"
 #include "test/md5_helper.h"
+#include "test/perf_stats.h"
 #include "test/util.h"
 #include "test/webm_video_source.h"
 #include "vpx/vpx_codec.h"
@@ -71,24 +72,31 @@ const DecodePerfParam kVP9DecodePerfVectors[] = {
    power/temp/min max frame decode times/etc
  */
 
-class DecodePerfTest : public ::testing::TestWithParam<DecodePerfParam> {};
-
-TEST_P(DecodePerfTest, PerfTest) {
-  const char *const video_name = GET_PARAM(VIDEO_NAME);
-  const unsigned threads = GET_PARAM(THREADS);
-
+// Decodes |video_name| and prints the throughput, per-frame latency
+// percentiles and peak RSS of the run as JSON. |row_mt| < 0 leaves the decoder
+// default untouched.
+void DecodeAndReport(const char *type, const char *video_name,
+                     unsigned threads, int row_mt) {
   libvpx_test::WebMVideoSource video(video_name);
   video.Init();
 
   vpx_codec_dec_cfg_t cfg = vpx_codec_dec_cfg_t();
   cfg.threads = threads;
   libvpx_test::VP9Decoder decoder(cfg, 0);
+  if (row_mt >= 0) decoder.Control(VP9D_SET_ROW_MT, row_mt);
+
+  libvpx_test::FrameLatencyStats latency;
+  libvpx_test::ResetPeakRss();
 
   vpx_usec_timer t;
   vpx_usec_timer_start(&t);
 
   for (video.Begin(); video.cxdata() != nullptr; video.Next()) {
+    vpx_usec_timer frame_timer;
+    vpx_usec_timer_start(&frame_timer);
     decoder.DecodeFrame(video.cxdata(), video.frame_size());
+    vpx_usec_timer_mark(&frame_timer);
+    latency.Add(vpx_usec_timer_elapsed(&frame_timer));
   }
 
   vpx_usec_timer_mark(&t);
@@ -97,19 +105,56 @@ TEST_P(DecodePerfTest, PerfTest) {
   const double fps = double(frames) / elapsed_secs;
 
   printf("{\n");
-  printf("\t\"type\" : \"decode_perf_test\",\n");
+  printf("\t\"type\" : \"%s\",\n", type);
   printf("\t\"version\" : \"%s\",\n", vpx_codec_version_str());
   printf("\t\"videoName\" : \"%s\",\n", video_name);
   printf("\t\"threadCount\" : %u,\n", threads);
+  if (row_mt >= 0) printf("\t\"rowMt\" : %d,\n", row_mt);
+  libvpx_test::PrintLatencyJson(latency);
   printf("\t\"decodeTimeSecs\" : %f,\n", elapsed_secs);
   printf("\t\"totalFrames\" : %u,\n", frames);
   printf("\t\"framesPerSecond\" : %f\n", fps);
   printf("}\n");
 }
 
+class DecodePerfTest : public ::testing::TestWithParam<DecodePerfParam> {};
+
+TEST_P(DecodePerfTest, PerfTest) {
+  DecodeAndReport("decode_perf_test", GET_PARAM(VIDEO_NAME), GET_PARAM(THREADS),
+                  -1);
+}
+
 INSTANTIATE_TEST_SUITE_P(VP9, DecodePerfTest,
                          ::testing::ValuesIn(kVP9DecodePerfVectors));
 
+/*
+ DecodeScalingPerfTest decodes the same tiled streams with an increasing
+ number of threads, with and without row based multi-threading, to show how
+ the decoder scales on the host.
+ */
+const char *const kVP9DecodeScalingVectors[] = {
+  "vp90-2-bbb_1920x1080_tile_1x1_2581kbps.webm",
+  "vp90-2-bbb_1920x1080_tile_1x4_2586kbps.webm",
+  "vp90-2-sintel_1920x818_tile_1x4_fpm_2279kbps.webm",
+  "vp90-2-tos_1920x800_tile_1x4_fpm_2335kbps.webm",
+};
+
+typedef std::tuple<const char *, unsigned, int> DecodeScalingParam;
+
+class DecodeScalingPerfTest
+    : public ::testing::TestWithParam<DecodeScalingParam> {};
+
+TEST_P(DecodeScalingPerfTest, PerfTest) {
+  DecodeAndReport("decode_scaling_perf_test", GET_PARAM(0), GET_PARAM(1),
+                  GET_PARAM(2));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    VP9, DecodeScalingPerfTest,
+    ::testing::Combine(::testing::ValuesIn(kVP9DecodeScalingVectors),
+                       ::testing::Values(1u, 2u, 4u, 8u),
+                       ::testing::Values(0, 1)));
+
 class VP9NewEncodeDecodePerfTest
     : public ::libvpx_test::EncoderTest,
       public ::libvpx_test::CodecTestWithParam<libvpx_test::TestMode> {
@@ -24,6 +24,10 @@
 
 #include "./vpx_config.h"
 #include "vpx/vp8cx.h"
+#if CONFIG_VP9_DECODER
+#include "vpx/vp8dx.h"
+#include "vpx/vpx_decoder.h"
+#endif
 #include "vpx/vpx_codec.h"
 #include "vpx/vpx_encoder.h"
 #include "vpx/vpx_image.h"
@@ -1922,6 +1926,387 @@ TEST(EncodeAPI, Chromium352414650) {
   ASSERT_EQ(vpx_codec_destroy(&enc), VPX_CODEC_OK);
 }
 
+#if !CONFIG_REALTIME_ONLY
+// Encodes a second pass at twice the size of the first pass, as done for the
+// rungs of an adaptive bitrate ladder sharing one analysis pass.
+TEST(EncodeAPI, FirstPassFrameSizeVP9) {
+  constexpr int kNumFrames = 6;
+  vpx_codec_iface_t *const iface = vpx_codec_vp9_cx();
+  vpx_codec_enc_cfg_t cfg;
+  ASSERT_EQ(vpx_codec_enc_config_default(iface, &cfg, 0), VPX_CODEC_OK);
+  cfg.g_w = 176;
+  cfg.g_h = 144;
+  cfg.g_pass = VPX_RC_FIRST_PASS;
+
+  vpx_first_pass_frame_size_t first_pass_size = { cfg.g_w, cfg.g_h };
+  std::vector<uint8_t> stats;
+  vpx_codec_ctx_t enc;
+  ASSERT_EQ(vpx_codec_enc_init(&enc, iface, &cfg, 0), VPX_CODEC_OK);
+  // Only the second pass accepts the control.
+  EXPECT_EQ(vpx_codec_control(&enc, VP9E_SET_FIRST_PASS_FRAME_SIZE,
+                              &first_pass_size),
+            VPX_CODEC_INVALID_PARAM);
+  vpx_image_t *image =
+      CreateImage(VPX_BITS_8, VPX_IMG_FMT_I420, cfg.g_w, cfg.g_h);
+  ASSERT_NE(image, nullptr);
+  for (int i = 0; i <= kNumFrames; ++i) {
+    ASSERT_EQ(vpx_codec_encode(&enc, i < kNumFrames ? image : nullptr, i, 1, 0,
+                               VPX_DL_GOOD_QUALITY),
+              VPX_CODEC_OK);
+    vpx_codec_iter_t iter = nullptr;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != nullptr) {
+      ASSERT_EQ(pkt->kind, VPX_CODEC_STATS_PKT);
+      const uint8_t *const buf =
+          static_cast<const uint8_t *>(pkt->data.twopass_stats.buf);
+      stats.insert(stats.end(), buf, buf + pkt->data.twopass_stats.sz);
+    }
+  }
+  vpx_img_free(image);
+  ASSERT_EQ(vpx_codec_destroy(&enc), VPX_CODEC_OK);
+
+  cfg.g_w = 2 * first_pass_size.width;
+  cfg.g_h = 2 * first_pass_size.height;
+  cfg.g_pass = VPX_RC_LAST_PASS;
+  cfg.rc_twopass_stats_in.buf = stats.data();
+  cfg.rc_twopass_stats_in.sz = stats.size();
+  ASSERT_EQ(vpx_codec_enc_init(&enc, iface, &cfg, 0), VPX_CODEC_OK);
+  ASSERT_EQ(vpx_codec_control(&enc, VP8E_SET_CPUUSED, 4), VPX_CODEC_OK);
+  EXPECT_EQ(vpx_codec_control(&enc, VP9E_SET_FIRST_PASS_FRAME_SIZE, nullptr),
+            VPX_CODEC_INVALID_PARAM);
+  ASSERT_EQ(vpx_codec_control(&enc, VP9E_SET_FIRST_PASS_FRAME_SIZE,
+                              &first_pass_size),
+            VPX_CODEC_OK);
+  // Setting the size again before encoding replaces the rescaled stats.
+  ASSERT_EQ(vpx_codec_control(&enc, VP9E_SET_FIRST_PASS_FRAME_SIZE,
+                              &first_pass_size),
+            VPX_CODEC_OK);
+  image = CreateImage(VPX_BITS_8, VPX_IMG_FMT_I420, cfg.g_w, cfg.g_h);
+  ASSERT_NE(image, nullptr);
+  int frames_out = 0;
+  for (int i = 0; i <= kNumFrames; ++i) {
+    ASSERT_EQ(vpx_codec_encode(&enc, i < kNumFrames ? image : nullptr, i, 1, 0,
+                               VPX_DL_GOOD_QUALITY),
+              VPX_CODEC_OK);
+    vpx_codec_iter_t iter = nullptr;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != nullptr) {
+      if (pkt->kind == VPX_CODEC_CX_FRAME_PKT) ++frames_out;
+    }
+  }
+  EXPECT_EQ(frames_out, kNumFrames);
+  // The stats can no longer be swapped once frames have been encoded.
+  EXPECT_EQ(vpx_codec_control(&enc, VP9E_SET_FIRST_PASS_FRAME_SIZE,
+                              &first_pass_size),
+            VPX_CODEC_INVALID_PARAM);
+  vpx_img_free(image);
+  ASSERT_EQ(vpx_codec_destroy(&enc), VPX_CODEC_OK);
+}
+
+// Fills the image with a moving gradient, with a moving noise texture added
+// from frame noisy_from on, which makes those frames cost many more bits.
+void FillSegmentTestImage(vpx_image_t *image, int frame, int noisy_from) {
+  for (int plane = 0; plane < 3; ++plane) {
+    const int w = plane ? (image->d_w + 1) / 2 : image->d_w;
+    const int h = plane ? (image->d_h + 1) / 2 : image->d_h;
+    for (int y = 0; y < h; ++y) {
+      uint8_t *const row = image->planes[plane] + y * image->stride[plane];
+      for (int x = 0; x < w; ++x) {
+        const int gradient = (x + 2 * frame + 2 * y) & 0x7f;
+        uint32_t noise = static_cast<uint32_t>(x + 2 * frame) * 73856093u ^
+                         static_cast<uint32_t>(y + 1) * 19349663u;
+        noise = (noise ^ (noise >> 13)) * 0x5bd1e995u;
+        row[x] = static_cast<uint8_t>(
+            frame < noisy_from ? gradient : gradient + (noise >> 29));
+      }
+    }
+  }
+}
+
+// Runs the first pass over num_frames frames of the segment test clip and
+// returns the stats.
+std::vector<uint8_t> SegmentTestFirstPass(vpx_codec_enc_cfg_t cfg,
+                                          int num_frames, int noisy_from) {
+  vpx_codec_iface_t *const iface = vpx_codec_vp9_cx();
+  vpx_image_t *const image =
+      CreateImage(VPX_BITS_8, VPX_IMG_FMT_I420, cfg.g_w, cfg.g_h);
+  EXPECT_NE(image, nullptr);
+  std::vector<uint8_t> stats;
+  if (image == nullptr) return stats;
+  cfg.g_pass = VPX_RC_FIRST_PASS;
+  vpx_codec_ctx_t enc;
+  EXPECT_EQ(vpx_codec_enc_init(&enc, iface, &cfg, 0), VPX_CODEC_OK);
+  // Only the second pass accepts the control.
+  vpx_two_pass_segment_t segment = { 0, 1 };
+  EXPECT_EQ(vpx_codec_control(&enc, VP9E_SET_TWO_PASS_SEGMENT, &segment),
+            VPX_CODEC_INVALID_PARAM);
+  for (int i = 0; i <= num_frames; ++i) {
+    if (i < num_frames) FillSegmentTestImage(image, i, noisy_from);
+    EXPECT_EQ(vpx_codec_encode(&enc, i < num_frames ? image : nullptr, i, 1, 0,
+                               VPX_DL_GOOD_QUALITY),
+              VPX_CODEC_OK);
+    vpx_codec_iter_t iter = nullptr;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != nullptr) {
+      EXPECT_EQ(pkt->kind, VPX_CODEC_STATS_PKT);
+      const uint8_t *const buf =
+          static_cast<const uint8_t *>(pkt->data.twopass_stats.buf);
+      stats.insert(stats.end(), buf, buf + pkt->data.twopass_stats.sz);
+    }
+  }
+  EXPECT_EQ(vpx_codec_destroy(&enc), VPX_CODEC_OK);
+  vpx_img_free(image);
+  return stats;
+}
+
+// Runs the second pass over frames [first, first + num) of the segment test
+// clip of num_frames frames, as a segment when num is less than the whole
+// clip, and returns the size of the stream.
+size_t SegmentTestSecondPass(vpx_codec_enc_cfg_t cfg,
+                             std::vector<uint8_t> *stats, int num_frames,
+                             int noisy_from, int first, int num) {
+  vpx_codec_iface_t *const iface = vpx_codec_vp9_cx();
+  vpx_image_t *const image =
+      CreateImage(VPX_BITS_8, VPX_IMG_FMT_I420, cfg.g_w, cfg.g_h);
+  EXPECT_NE(image, nullptr);
+  if (image == nullptr) return 0;
+  cfg.g_pass = VPX_RC_LAST_PASS;
+  cfg.rc_twopass_stats_in.buf = stats->data();
+  cfg.rc_twopass_stats_in.sz = stats->size();
+  vpx_two_pass_segment_t range = { static_cast<unsigned int>(first),
+                                   static_cast<unsigned int>(num) };
+  size_t bytes = 0;
+  int frames_out = 0;
+  vpx_codec_ctx_t enc;
+  EXPECT_EQ(vpx_codec_enc_init(&enc, iface, &cfg, 0), VPX_CODEC_OK);
+  EXPECT_EQ(vpx_codec_control(&enc, VP8E_SET_CPUUSED, 4), VPX_CODEC_OK);
+  if (num < num_frames) {
+    EXPECT_EQ(vpx_codec_control(&enc, VP9E_SET_TWO_PASS_SEGMENT, &range),
+              VPX_CODEC_OK);
+  }
+  for (int i = 0;; ++i) {
+    // Flush the frames held back in the lookahead at the end.
+    const bool flush = i >= num_frames;
+    if (!flush) {
+      FillSegmentTestImage(image, i, noisy_from);
+      if (i < first || i >= first + num) continue;
+    }
+    EXPECT_EQ(vpx_codec_encode(&enc, flush ? nullptr : image, i - first, 1, 0,
+                               VPX_DL_GOOD_QUALITY),
+              VPX_CODEC_OK);
+    bool got_data = false;
+    vpx_codec_iter_t iter = nullptr;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != nullptr) {
+      if (pkt->kind != VPX_CODEC_CX_FRAME_PKT) continue;
+      // Each segment starts with a key frame.
+      if (frames_out == 0) {
+        EXPECT_NE(pkt->data.frame.flags & VPX_FRAME_IS_KEY, 0u);
+      }
+      ++frames_out;
+      bytes += pkt->data.frame.sz;
+      got_data = true;
+    }
+    if (flush && !got_data) break;
+  }
+  EXPECT_EQ(frames_out, num);
+  // The segment can no longer be changed once frames have been encoded.
+  EXPECT_EQ(vpx_codec_control(&enc, VP9E_SET_TWO_PASS_SEGMENT, &range),
+            VPX_CODEC_INVALID_PARAM);
+  EXPECT_EQ(vpx_codec_destroy(&enc), VPX_CODEC_OK);
+  vpx_img_free(image);
+  return bytes;
+}
+
+// Encodes the second pass of a clip as two segments, as separate encoders
+// would in parallel, and checks that the segments together get about the bits
+// of a single second pass, split by the complexity of their frames.
+TEST(EncodeAPI, TwoPassSegmentVP9) {
+  constexpr int kNumFrames = 16;
+  vpx_codec_iface_t *const iface = vpx_codec_vp9_cx();
+  vpx_codec_enc_cfg_t cfg;
+  ASSERT_EQ(vpx_codec_enc_config_default(iface, &cfg, 0), VPX_CODEC_OK);
+  cfg.g_w = 176;
+  cfg.g_h = 144;
+  cfg.rc_target_bitrate = 1000;
+  std::vector<uint8_t> stats =
+      SegmentTestFirstPass(cfg, kNumFrames, kNumFrames / 2);
+  ASSERT_FALSE(stats.empty());
+
+  const size_t whole = SegmentTestSecondPass(cfg, &stats, kNumFrames,
+                                             kNumFrames / 2, 0, kNumFrames);
+  const size_t simple = SegmentTestSecondPass(
+      cfg, &stats, kNumFrames, kNumFrames / 2, 0, kNumFrames / 2);
+  const size_t complex =
+      SegmentTestSecondPass(cfg, &stats, kNumFrames, kNumFrames / 2,
+                            kNumFrames / 2, kNumFrames / 2);
+  EXPECT_GT(complex, 2 * simple);
+  EXPECT_GT(simple + complex, whole * 3 / 4);
+  EXPECT_LT(simple + complex, whole * 5 / 4);
+
+  vpx_codec_ctx_t enc;
+  vpx_two_pass_segment_t segment = { 0, kNumFrames / 2 };
+  cfg.g_pass = VPX_RC_LAST_PASS;
+  cfg.rc_twopass_stats_in.buf = stats.data();
+  cfg.rc_twopass_stats_in.sz = stats.size();
+  // Segments must lie within the frames of the stats.
+  ASSERT_EQ(vpx_codec_enc_init(&enc, iface, &cfg, 0), VPX_CODEC_OK);
+  EXPECT_EQ(vpx_codec_control(&enc, VP9E_SET_TWO_PASS_SEGMENT, nullptr),
+            VPX_CODEC_INVALID_PARAM);
+  segment.first_frame = kNumFrames / 2 + 1;
+  EXPECT_EQ(vpx_codec_control(&enc, VP9E_SET_TWO_PASS_SEGMENT, &segment),
+            VPX_CODEC_INVALID_PARAM);
+  segment.first_frame = kNumFrames / 2;
+  EXPECT_EQ(vpx_codec_control(&enc, VP9E_SET_TWO_PASS_SEGMENT, &segment),
+            VPX_CODEC_OK);
+  ASSERT_EQ(vpx_codec_destroy(&enc), VPX_CODEC_OK);
+}
+
+// Encodes the first segment of a clip of uniform complexity, which should get
+// the bits of its share of the duration, and checks that the rate control
+// meets that budget within the segment rather than over the rest of the clip.
+TEST(EncodeAPI, TwoPassSegmentBudgetVP9) {
+  constexpr int kNumFrames = 48;
+  constexpr int kSegmentFrames = 24;
+  vpx_codec_iface_t *const iface = vpx_codec_vp9_cx();
+  vpx_codec_enc_cfg_t cfg;
+  ASSERT_EQ(vpx_codec_enc_config_default(iface, &cfg, 0), VPX_CODEC_OK);
+  cfg.g_w = 176;
+  cfg.g_h = 144;
+  cfg.rc_target_bitrate = 200;
+  std::vector<uint8_t> stats = SegmentTestFirstPass(cfg, kNumFrames, 0);
+  ASSERT_FALSE(stats.empty());
+
+  const size_t bytes =
+      SegmentTestSecondPass(cfg, &stats, kNumFrames, 0, 0, kSegmentFrames);
+  const size_t whole =
+      SegmentTestSecondPass(cfg, &stats, kNumFrames, 0, 0, kNumFrames);
+  // The budgets in bytes at 1 / 30 s per frame.
+  const double frame_budget = cfg.rc_target_bitrate * 1000.0 / 8 / 30;
+  const double ratio = bytes / (frame_budget * kSegmentFrames);
+  const double whole_ratio = whole / (frame_budget * kNumFrames);
+  // The segment meets its budget about as well as the whole clip does.
+  EXPECT_GT(ratio, 0.75);
+  EXPECT_LT(ratio, 1.35);
+  EXPECT_NEAR(ratio, whole_ratio, 0.15);
+}
+#endif  // !CONFIG_REALTIME_ONLY
+
+#if CONFIG_VP9_DECODER
+// Transcodes a moving pattern to half the size, seeding each frame of the
+// second encode with the mode info exported by the decoder.
+TEST(EncodeAPI, ModeInfoSeedVP9) {
+  constexpr int kNumFrames = 4;
+  constexpr int kWidth = 176;
+  constexpr int kHeight = 144;
+  constexpr int kMiRows = (kHeight + 7) / 8;
+  constexpr int kMiCols = (kWidth + 7) / 8;
+  vpx_codec_enc_cfg_t cfg;
+  ASSERT_EQ(vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &cfg, 0),
+            VPX_CODEC_OK);
+  cfg.g_w = kWidth;
+  cfg.g_h = kHeight;
+  cfg.g_lag_in_frames = 0;
+  vpx_image_t *image =
+      CreateImage(VPX_BITS_8, VPX_IMG_FMT_I420, cfg.g_w, cfg.g_h);
+  ASSERT_NE(image, nullptr);
+
+  vpx_codec_ctx_t enc;
+  ASSERT_EQ(vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0),
+            VPX_CODEC_OK);
+  ASSERT_EQ(vpx_codec_control(&enc, VP8E_SET_CPUUSED, 4), VPX_CODEC_OK);
+  std::vector<std::vector<uint8_t>> frames;
+  for (int i = 0; i < kNumFrames; ++i) {
+    for (unsigned int r = 0; r < image->d_h; ++r) {
+      uint8_t *const row = image->planes[0] + r * image->stride[0];
+      for (unsigned int c = 0; c < image->d_w; ++c) {
+        row[c] = static_cast<uint8_t>(((r >> 3) * 40 + (c + 3 * i)) * 7);
+      }
+    }
+    ASSERT_EQ(vpx_codec_encode(&enc, image, i, 1, 0, VPX_DL_GOOD_QUALITY),
+              VPX_CODEC_OK);
+    vpx_codec_iter_t iter = nullptr;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != nullptr) {
+      ASSERT_EQ(pkt->kind, VPX_CODEC_CX_FRAME_PKT);
+      const uint8_t *const buf =
+          static_cast<const uint8_t *>(pkt->data.frame.buf);
+      frames.emplace_back(buf, buf + pkt->data.frame.sz);
+    }
+  }
+  ASSERT_EQ(vpx_codec_destroy(&enc), VPX_CODEC_OK);
+  vpx_img_free(image);
+  ASSERT_EQ(frames.size(), static_cast<size_t>(kNumFrames));
+
+  vpx_codec_ctx_t dec;
+  ASSERT_EQ(vpx_codec_dec_init(&dec, vpx_codec_vp9_dx(), nullptr, 0),
+            VPX_CODEC_OK);
+  // A buffer that is too small reports the frame size only.
+  std::vector<VpxBlockModeInfo> blocks(kMiRows * kMiCols - 1);
+  VpxFrameModeInfo mode_info = {};
+  mode_info.blocks = blocks.data();
+  mode_info.num_blocks = static_cast<int>(blocks.size());
+  ASSERT_EQ(vpx_codec_control(&dec, VP9D_SET_MODE_INFO_EXPORT, &mode_info),
+            VPX_CODEC_OK);
+  ASSERT_EQ(vpx_codec_decode(&dec, frames[0].data(),
+                             static_cast<unsigned int>(frames[0].size()),
+                             nullptr, 0),
+            VPX_CODEC_OK);
+  EXPECT_EQ(mode_info.frame_width, kWidth);
+  EXPECT_EQ(mode_info.frame_height, kHeight);
+  EXPECT_EQ(mode_info.mi_rows, 0);
+
+  blocks.resize(kMiRows * kMiCols);
+  mode_info.blocks = blocks.data();
+  mode_info.num_blocks = static_cast<int>(blocks.size());
+
+  cfg.g_w = kWidth / 2;
+  cfg.g_h = kHeight / 2;
+  ASSERT_EQ(vpx_codec_enc_init(&enc, vpx_codec_vp9_cx(), &cfg, 0),
+            VPX_CODEC_OK);
+  ASSERT_EQ(vpx_codec_control(&enc, VP8E_SET_CPUUSED, 4), VPX_CODEC_OK);
+  image = CreateImage(VPX_BITS_8, VPX_IMG_FMT_I420, cfg.g_w, cfg.g_h);
+  ASSERT_NE(image, nullptr);
+  int inter_blocks = 0;
+  int frames_out = 0;
+  for (int i = 1; i < kNumFrames; ++i) {
+    ASSERT_EQ(vpx_codec_decode(&dec, frames[i].data(),
+                               static_cast<unsigned int>(frames[i].size()),
+                               nullptr, 0),
+              VPX_CODEC_OK);
+    ASSERT_EQ(mode_info.mi_rows, kMiRows);
+    ASSERT_EQ(mode_info.mi_cols, kMiCols);
+    ASSERT_EQ(mode_info.stride, kMiCols);
+    for (const VpxBlockModeInfo &block : blocks) {
+      EXPECT_GE(block.block_width, 4);
+      EXPECT_LE(block.block_width, 64);
+      if (block.ref_frame[0] > 0) ++inter_blocks;
+    }
+    ASSERT_EQ(vpx_codec_control(&enc, VP9E_SET_MODE_INFO_SEED, &mode_info),
+              VPX_CODEC_OK);
+    ASSERT_EQ(vpx_codec_encode(&enc, image, i, 1, 0, VPX_DL_GOOD_QUALITY),
+              VPX_CODEC_OK);
+    vpx_codec_iter_t iter = nullptr;
+    const vpx_codec_cx_pkt_t *pkt;
+    while ((pkt = vpx_codec_get_cx_data(&enc, &iter)) != nullptr) {
+      if (pkt->kind == VPX_CODEC_CX_FRAME_PKT) ++frames_out;
+    }
+  }
+  EXPECT_GT(inter_blocks, 0);
+  EXPECT_EQ(frames_out, kNumFrames - 1);
+
+  // Mode info that does not cover its frame is rejected.
+  mode_info.num_blocks = mode_info.mi_rows * mode_info.stride - 1;
+  EXPECT_EQ(vpx_codec_control(&enc, VP9E_SET_MODE_INFO_SEED, &mode_info),
+            VPX_CODEC_INVALID_PARAM);
+  EXPECT_EQ(vpx_codec_control(&enc, VP9E_SET_MODE_INFO_SEED, nullptr),
+            VPX_CODEC_OK);
+  vpx_img_free(image);
+  ASSERT_EQ(vpx_codec_destroy(&enc), VPX_CODEC_OK);
+  ASSERT_EQ(vpx_codec_destroy(&dec), VPX_CODEC_OK);
+}
+#endif  // CONFIG_VP9_DECODER
+
 #endif  // CONFIG_VP9_ENCODER
 
 }  // namespace
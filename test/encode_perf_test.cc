@@ -7,13 +7,19 @@
  *  in the file PATENTS.  All contributing project authors may
  *  be found in the AUTHORS file in the root of the source tree.
  */
+#include <algorithm>
 #include <cstdio>
+#include <cstdlib>
+#include <memory>
 #include <string>
 #include "gtest/gtest.h"
+#include "./vpx_config.h"
 #include "test/codec_factory.h"
 #include "test/encode_test_driver.h"
 #include "test/i420_video_source.h"
+#include "test/perf_stats.h"
 #include "test/util.h"
+#include "test/video_source.h"
 #include "test/y4m_video_source.h"
 #include "vpx/vpx_codec.h"
 #include "vpx_ports/vpx_timer.h"
@@ -185,4 +191,228 @@ TEST_P(VP9EncodePerfTest, PerfTest) {
 
 VP9_INSTANTIATE_TEST_SUITE(VP9EncodePerfTest,
                            ::testing::Values(::libvpx_test::kRealTime));
+
+// Scaling benchmark. Sweeps speed, thread count, tile columns, row-mt and bit
+// depth over a single clip and reports throughput, per-frame latency
+// percentiles, peak RSS, bitrate and PSNR as one JSON object per
+// configuration.
+//
+// The clip is generated in memory unless LIBVPX_PERF_Y4M names a y4m file in
+// LIBVPX_TEST_DATA_PATH, in which case the first kScalingFrames frames of that
+// file are used. A cached y4m clip is only used for the bit depth it was
+// written with; the other bit depths are skipped.
+const unsigned int kScalingWidth = 1280;
+const unsigned int kScalingHeight = 720;
+const unsigned int kScalingFrames = 60;
+const unsigned int kScalingBitrate = 1500;
+
+// Synthetic content with a textured background panning diagonally and a
+// brighter square moving in the opposite direction, so that both motion search
+// and the intra/inter decisions have real work to do.
+class PanningVideoSource : public ::libvpx_test::DummyVideoSource {
+ public:
+  PanningVideoSource(unsigned int width, unsigned int height,
+                     unsigned int limit, int bit_depth)
+      : bit_depth_(bit_depth) {
+    SetImageFormat(bit_depth > 8 ? VPX_IMG_FMT_I42016 : VPX_IMG_FMT_I420);
+    SetSize(width, height);
+    set_limit(limit);
+  }
+
+ protected:
+  void FillFrame() override {
+    if (img_ == nullptr) return;
+    const int shift = bit_depth_ - 8;
+    for (int plane = 0; plane < 3; ++plane) {
+      const int w = plane ? (img_->d_w + 1) >> 1 : img_->d_w;
+      const int h = plane ? (img_->d_h + 1) >> 1 : img_->d_h;
+      const int scale = plane ? 1 : 2;
+      const int pan = static_cast<int>(frame_) * 3 / scale;
+      const int box_x = w / 2 - static_cast<int>(frame_) * 4 / scale;
+      const int box_y = h / 2 - static_cast<int>(frame_) * 2 / scale;
+      const int box_size = w / 8;
+      for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+          const int px = x + pan;
+          const int py = y + pan;
+          int v = ((px ^ py) & 0x3f) + ((px * 7 + py * 3) & 0x7f) + 32;
+          if (plane) v = 128 + ((v - 96) >> 2);
+          if (x >= box_x && x < box_x + box_size && y >= box_y &&
+              y < box_y + box_size) {
+            v = 220 - ((x - box_x) & 15);
+          }
+          SetPixel(plane, x, y, v << shift);
+        }
+      }
+    }
+  }
+
+ private:
+  void SetPixel(int plane, int x, int y, int v) {
+    uint8_t *const row = img_->planes[plane] + y * img_->stride[plane];
+    if (img_->fmt & VPX_IMG_FMT_HIGHBITDEPTH) {
+      reinterpret_cast<uint16_t *>(row)[x] = static_cast<uint16_t>(v);
+    } else {
+      row[x] = static_cast<uint8_t>(v);
+    }
+  }
+
+  const int bit_depth_;
+};
+
+const int kScalingSpeeds[] = { 5, 6, 7, 8, 9 };
+const int kScalingThreads[] = { 1, 2, 4, 8 };
+const int kScalingLog2TileCols[] = { 0, 2 };
+#if CONFIG_VP9_HIGHBITDEPTH
+const int kScalingBitDepths[] = { 8, 10 };
+#else
+const int kScalingBitDepths[] = { 8 };
+#endif
+
+class VP9EncodeScalingPerfTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith5Params<int, int, int, int, int> {
+ protected:
+  VP9EncodeScalingPerfTest()
+      : EncoderTest(GET_PARAM(0)), speed_(GET_PARAM(1)),
+        threads_(GET_PARAM(2)), log2_tile_cols_(GET_PARAM(3)),
+        row_mt_(GET_PARAM(4)), bit_depth_(GET_PARAM(5)), frames_(0),
+        frame_bytes_(0), psnr_sum_(0.0), min_psnr_(kMaxPsnr), psnr_frames_(0) {
+  }
+
+  ~VP9EncodeScalingPerfTest() override = default;
+
+  void SetUp() override {
+    InitializeConfig();
+    SetMode(::libvpx_test::kRealTime);
+
+    cfg_.g_lag_in_frames = 0;
+    cfg_.g_threads = threads_;
+    cfg_.rc_end_usage = VPX_CBR;
+    cfg_.rc_target_bitrate = kScalingBitrate;
+    cfg_.rc_min_quantizer = 2;
+    cfg_.rc_max_quantizer = 56;
+    cfg_.rc_dropframe_thresh = 0;
+    cfg_.rc_resize_allowed = 0;
+    cfg_.rc_buf_sz = 1000;
+    cfg_.rc_buf_initial_sz = 500;
+    cfg_.rc_buf_optimal_sz = 600;
+    init_flags_ = VPX_CODEC_USE_PSNR;
+#if CONFIG_VP9_HIGHBITDEPTH
+    if (bit_depth_ > 8) {
+      cfg_.g_profile = 2;
+      cfg_.g_bit_depth = static_cast<vpx_bit_depth_t>(bit_depth_);
+      cfg_.g_input_bit_depth = bit_depth_;
+      init_flags_ |= VPX_CODEC_USE_HIGHBITDEPTH;
+    }
+#endif
+  }
+
+  void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                          ::libvpx_test::Encoder *encoder) override {
+    if (video->frame() == 0) {
+      encoder->Control(VP8E_SET_CPUUSED, speed_);
+      encoder->Control(VP9E_SET_TILE_COLUMNS, log2_tile_cols_);
+      encoder->Control(VP9E_SET_ROW_MT, row_mt_);
+      encoder->Control(VP9E_SET_FRAME_PARALLEL_DECODING, 1);
+      encoder->Control(VP8E_SET_ENABLEAUTOALTREF, 0);
+    }
+    vpx_usec_timer_start(&frame_timer_);
+  }
+
+  void PostEncodeFrameHook(::libvpx_test::Encoder * /*encoder*/) override {
+    vpx_usec_timer_mark(&frame_timer_);
+    latency_.Add(vpx_usec_timer_elapsed(&frame_timer_));
+  }
+
+  void BeginPassHook(unsigned int /*pass*/) override {
+    latency_.Reset();
+    frames_ = 0;
+    frame_bytes_ = 0;
+    psnr_sum_ = 0.0;
+    min_psnr_ = kMaxPsnr;
+    psnr_frames_ = 0;
+  }
+
+  void FramePktHook(const vpx_codec_cx_pkt_t *pkt) override {
+    ++frames_;
+    frame_bytes_ += pkt->data.frame.sz;
+  }
+
+  void PSNRPktHook(const vpx_codec_cx_pkt_t *pkt) override {
+    psnr_sum_ += pkt->data.psnr.psnr[0];
+    min_psnr_ = std::min(min_psnr_, pkt->data.psnr.psnr[0]);
+    ++psnr_frames_;
+  }
+
+  // for performance reasons don't decode
+  bool DoDecode() const override { return false; }
+
+  const int speed_;
+  const int threads_;
+  const int log2_tile_cols_;
+  const int row_mt_;
+  const int bit_depth_;
+  vpx_usec_timer frame_timer_;
+  ::libvpx_test::FrameLatencyStats latency_;
+  unsigned int frames_;
+  size_t frame_bytes_;
+  double psnr_sum_;
+  double min_psnr_;
+  int psnr_frames_;
+};
+
+TEST_P(VP9EncodeScalingPerfTest, PerfTest) {
+  const char *const clip = getenv("LIBVPX_PERF_Y4M");
+  std::unique_ptr<::libvpx_test::VideoSource> video;
+  std::string video_name;
+  if (clip != nullptr && clip[0] != '\0') {
+    if (bit_depth_ > 8) GTEST_SKIP() << "cached clip is 8-bit";
+    video.reset(new ::libvpx_test::Y4mVideoSource(clip, 0, kScalingFrames));
+    video_name = clip;
+  } else {
+    video.reset(new PanningVideoSource(kScalingWidth, kScalingHeight,
+                                       kScalingFrames, bit_depth_));
+    video_name = "synthetic_panning";
+  }
+
+  ::libvpx_test::ResetPeakRss();
+  vpx_usec_timer t;
+  vpx_usec_timer_start(&t);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(video.get()));
+  vpx_usec_timer_mark(&t);
+
+  const double elapsed_secs = vpx_usec_timer_elapsed(&t) / kUsecsInSec;
+  const unsigned int frames = frames_;
+  const vpx_rational_t timebase = video->timebase();
+  const double duration_secs =
+      static_cast<double>(frames) * timebase.num / timebase.den;
+
+  printf("{\n");
+  printf("\t\"type\" : \"encode_scaling_perf_test\",\n");
+  printf("\t\"version\" : \"%s\",\n", vpx_codec_version_str());
+  printf("\t\"videoName\" : \"%s\",\n", video_name.c_str());
+  printf("\t\"speed\" : %d,\n", speed_);
+  printf("\t\"threads\" : %d,\n", threads_);
+  printf("\t\"log2TileCols\" : %d,\n", log2_tile_cols_);
+  printf("\t\"rowMt\" : %d,\n", row_mt_);
+  printf("\t\"bitDepth\" : %d,\n", bit_depth_);
+  printf("\t\"encodeTimeSecs\" : %f,\n", elapsed_secs);
+  printf("\t\"totalFrames\" : %u,\n", frames);
+  printf("\t\"framesPerSecond\" : %f,\n", frames / elapsed_secs);
+  ::libvpx_test::PrintLatencyJson(latency_);
+  printf("\t\"bitrateKbps\" : %f,\n",
+         duration_secs > 0 ? frame_bytes_ * 8 / duration_secs / 1000 : 0.0);
+  printf("\t\"avgPsnr\" : %f,\n",
+         psnr_frames_ ? psnr_sum_ / psnr_frames_ : 0.0);
+  printf("\t\"minPsnr\" : %f\n", min_psnr_);
+  printf("}\n");
+}
+
+VP9_INSTANTIATE_TEST_SUITE(VP9EncodeScalingPerfTest,
+                           ::testing::ValuesIn(kScalingSpeeds),
+                           ::testing::ValuesIn(kScalingThreads),
+                           ::testing::ValuesIn(kScalingLog2TileCols),
+                           ::testing::Values(0, 1),
+                           ::testing::ValuesIn(kScalingBitDepths));
 }  // namespace
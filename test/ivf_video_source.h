@@ -13,6 +13,11 @@
 #include <cstdlib>
 #include <new>
 #include <string>
+#include <vector>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #include "test/video_source.h"
 
 namespace libvpx_test {
@@ -25,25 +30,26 @@ static unsigned int MemGetLe32(const uint8_t *mem) {
 }
 
 // This class extends VideoSource to allow parsing of ivf files,
-// so that we can do actual file decodes.
+// so that we can do actual file decodes. Files are mapped when possible and
+// the frames are then returned in place.
 class IVFVideoSource : public CompressedVideoSource {
  public:
   explicit IVFVideoSource(const std::string &file_name)
       : file_name_(file_name), input_file_(nullptr),
-        compressed_frame_buf_(nullptr), frame_sz_(0), frame_(0),
+        compressed_frame_buf_(nullptr), mapped_data_(nullptr),
+        mapped_size_(0), frame_data_(nullptr), frame_sz_(0), frame_(0),
         end_of_file_(false) {}
 
   ~IVFVideoSource() override {
     delete[] compressed_frame_buf_;
+#if !defined(_WIN32)
+    if (mapped_data_) munmap(const_cast<uint8_t *>(mapped_data_), mapped_size_);
+#endif
 
     if (input_file_) fclose(input_file_);
   }
 
-  void Init() override {
-    // Allocate a buffer for read in the compressed video frame.
-    compressed_frame_buf_ = new uint8_t[libvpx_test::kCodeBufferSize];
-    ASSERT_NE(compressed_frame_buf_, nullptr) << "Allocate frame buffer failed";
-  }
+  void Init() override {}
 
   void Begin() override {
     input_file_ = OpenTestDataFile(file_name_);
@@ -59,6 +65,13 @@ class IVFVideoSource : public CompressedVideoSource {
                 file_hdr[2] == 'I' && file_hdr[3] == 'F')
         << "Input is not an IVF file.";
 
+    if (!MapFile()) {
+      // Allocate a buffer for read in the compressed video frame.
+      compressed_frame_buf_ = new uint8_t[libvpx_test::kCodeBufferSize];
+      ASSERT_NE(compressed_frame_buf_, nullptr)
+          << "Allocate frame buffer failed";
+    }
+
     FillFrame();
   }
 
@@ -69,6 +82,11 @@ class IVFVideoSource : public CompressedVideoSource {
 
   void FillFrame() {
     ASSERT_NE(input_file_, nullptr);
+    if (mapped_data_) {
+      FillMappedFrame();
+      return;
+    }
+    frame_data_ = compressed_frame_buf_;
     uint8_t frame_hdr[kIvfFrameHdrSize];
     // Check frame header and read a frame from input_file.
     if (fread(frame_hdr, 1, kIvfFrameHdrSize, input_file_) !=
@@ -87,15 +105,59 @@ class IVFVideoSource : public CompressedVideoSource {
   }
 
   const uint8_t *cxdata() const override {
-    return end_of_file_ ? nullptr : compressed_frame_buf_;
+    return end_of_file_ ? nullptr : frame_data_;
   }
   size_t frame_size() const override { return frame_sz_; }
   unsigned int frame_number() const override { return frame_; }
 
  protected:
+  // Maps the input file and records the offset of each frame header.
+  bool MapFile() {
+#if !defined(_WIN32)
+    struct stat st;
+    if (fstat(fileno(input_file_), &st) || !S_ISREG(st.st_mode)) return false;
+    void *const data = mmap(nullptr, static_cast<size_t>(st.st_size),
+                            PROT_READ, MAP_PRIVATE, fileno(input_file_), 0);
+    if (data == MAP_FAILED) return false;
+    mapped_data_ = static_cast<const uint8_t *>(data);
+    mapped_size_ = static_cast<size_t>(st.st_size);
+
+    size_t offset = kIvfFileHdrSize;
+    while (mapped_size_ - offset >= kIvfFrameHdrSize) {
+      frame_offsets_.push_back(offset);
+      const size_t frame_sz = MemGetLe32(mapped_data_ + offset);
+      if (frame_sz > mapped_size_ - offset - kIvfFrameHdrSize) break;
+      offset += kIvfFrameHdrSize + frame_sz;
+    }
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  void FillMappedFrame() {
+    if (frame_ >= frame_offsets_.size()) {
+      end_of_file_ = true;
+      return;
+    }
+    end_of_file_ = false;
+
+    const size_t offset = frame_offsets_[frame_];
+    frame_sz_ = MemGetLe32(mapped_data_ + offset);
+    ASSERT_LE(frame_sz_, kCodeBufferSize)
+        << "Frame is too big for allocated code buffer";
+    ASSERT_LE(frame_sz_, mapped_size_ - offset - kIvfFrameHdrSize)
+        << "Failed to read complete frame";
+    frame_data_ = mapped_data_ + offset + kIvfFrameHdrSize;
+  }
+
   std::string file_name_;
   FILE *input_file_;
   uint8_t *compressed_frame_buf_;
+  const uint8_t *mapped_data_;
+  size_t mapped_size_;
+  std::vector<size_t> frame_offsets_;
+  const uint8_t *frame_data_;
   size_t frame_sz_;
   unsigned int frame_;
   bool end_of_file_;
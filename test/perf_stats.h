@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#ifndef VPX_TEST_PERF_STATS_H_
+#define VPX_TEST_PERF_STATS_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "vpx/vpx_integer.h"
+
+namespace libvpx_test {
+
+// Collects per-frame latencies (in microseconds) of an encode or decode run.
+class FrameLatencyStats {
+ public:
+  void Reset() { usecs_.clear(); }
+
+  void Add(int64_t usecs) { usecs_.push_back(usecs); }
+
+  // Returns the |pct| percentile (0 - 100) using the nearest-rank method.
+  int64_t Percentile(double pct) const {
+    if (usecs_.empty()) return 0;
+    std::vector<int64_t> sorted(usecs_);
+    std::sort(sorted.begin(), sorted.end());
+    size_t rank = static_cast<size_t>(pct / 100.0 * sorted.size() + 0.5);
+    if (rank > 0) --rank;
+    return sorted[std::min(rank, sorted.size() - 1)];
+  }
+
+  int64_t Max() const {
+    return usecs_.empty() ? 0 : *std::max_element(usecs_.begin(), usecs_.end());
+  }
+
+  size_t count() const { return usecs_.size(); }
+
+ private:
+  std::vector<int64_t> usecs_;
+};
+
+// Resets the peak resident set size of the process so that PeakRssKb() covers
+// only what follows. This is only possible on Linux; elsewhere the peak is the
+// high-water mark since the process started.
+inline void ResetPeakRss() {
+#if defined(__linux__)
+  FILE *const f = fopen("/proc/self/clear_refs", "w");
+  if (f != nullptr) {
+    fputs("5", f);
+    fclose(f);
+  }
+#endif
+}
+
+// Returns the peak resident set size of the process in kilobytes, or 0 if it
+// is not available on this platform.
+inline int64_t PeakRssKb() {
+#if defined(__linux__)
+  FILE *const f = fopen("/proc/self/status", "r");
+  if (f != nullptr) {
+    char line[256];
+    int64_t kb = 0;
+    while (fgets(line, sizeof(line), f) != nullptr) {
+      if (!strncmp(line, "VmHWM:", 6)) {
+        kb = strtoll(line + 6, nullptr, 10);
+        break;
+      }
+    }
+    fclose(f);
+    if (kb > 0) return kb;
+  }
+#endif
+#if defined(__linux__) || defined(__APPLE__)
+  struct rusage usage;
+  if (!getrusage(RUSAGE_SELF, &usage)) {
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;  // bytes
+#else
+    return usage.ru_maxrss;  // kilobytes
+#endif
+  }
+#endif
+  return 0;
+}
+
+// Prints the latency percentiles and peak RSS fields shared by the encode and
+// decode perf tests. The caller is responsible for the surrounding braces.
+inline void PrintLatencyJson(const FrameLatencyStats &latency) {
+  printf("\t\"frameLatencyP50Us\" : %" PRId64 ",\n", latency.Percentile(50));
+  printf("\t\"frameLatencyP90Us\" : %" PRId64 ",\n", latency.Percentile(90));
+  printf("\t\"frameLatencyP99Us\" : %" PRId64 ",\n", latency.Percentile(99));
+  printf("\t\"frameLatencyMaxUs\" : %" PRId64 ",\n", latency.Max());
+  printf("\t\"peakRssKb\" : %" PRId64 ",\n", PeakRssKb());
+}
+
+}  // namespace libvpx_test
+
+#endif  // VPX_TEST_PERF_STATS_H_
@@ -0,0 +1,160 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+#include "test/video_source.h"
+#include "vpx/vp8cx.h"
+#include "vpx_config.h"
+
+namespace {
+
+const int kFrames = 20;
+
+const libvpx_test::TestMode kEncodingModes[] = {
+#if !CONFIG_REALTIME_ONLY
+  ::libvpx_test::kOnePassGood,
+#endif
+  ::libvpx_test::kRealTime
+};
+
+class EncodeTimeBudgetTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith2Params<libvpx_test::TestMode, int> {
+ protected:
+  EncodeTimeBudgetTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)),
+        cpu_used_(GET_PARAM(2)), budget_us_(0), row_mt_(0),
+        toggle_speed_(false) {}
+
+  ~EncodeTimeBudgetTest() override = default;
+
+  void SetUp() override {
+    InitializeConfig();
+    SetMode(encoding_mode_);
+    cfg_.rc_target_bitrate = 300;
+    if (encoding_mode_ == ::libvpx_test::kRealTime) {
+      cfg_.g_lag_in_frames = 0;
+      cfg_.rc_end_usage = VPX_CBR;
+    } else {
+      cfg_.g_lag_in_frames = 5;
+      cfg_.rc_end_usage = VPX_VBR;
+    }
+  }
+
+  void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                          ::libvpx_test::Encoder *encoder) override {
+    if (video->frame() == 0) {
+      encoder->Control(VP8E_SET_CPUUSED, cpu_used_);
+      encoder->Control(VP9E_SET_ROW_MT, row_mt_);
+      encoder->Control(VP9E_SET_FRAME_TIME_BUDGET, budget_us_);
+    }
+    // Setting a budget of 1us encodes the frame at cpu_used and the next one
+    // a speed above, as the budget is exceeded.
+    if (toggle_speed_ && video->frame() % 2 == 0) {
+      encoder->Control(VP9E_SET_FRAME_TIME_BUDGET, 1);
+    }
+  }
+
+  void FramePktHook(const vpx_codec_cx_pkt_t *pkt) override {
+    md5_.Add(static_cast<const uint8_t *>(pkt->data.frame.buf),
+             pkt->data.frame.sz);
+    frame_sizes_.push_back(pkt->data.frame.sz);
+    frame_flags_.push_back(pkt->data.frame.flags &
+                           (VPX_FRAME_IS_KEY | VPX_FRAME_IS_INVISIBLE));
+  }
+
+  // Encodes the test clip with the given budget and returns the MD5 of the
+  // compressed frames. Encoder/decoder mismatches fail the test.
+  std::string EncodeWithBudget(unsigned int budget_us) {
+    ::libvpx_test::RandomVideoSource video;
+    video.SetSize(176, 144);
+    video.set_limit(kFrames);
+    budget_us_ = budget_us;
+    md5_ = libvpx_test::MD5();
+    frame_sizes_.clear();
+    frame_flags_.clear();
+    EXPECT_NO_FATAL_FAILURE(RunLoop(&video));
+    return md5_.Get();
+  }
+
+  ::libvpx_test::TestMode encoding_mode_;
+  int cpu_used_;
+  unsigned int budget_us_;
+  int row_mt_;
+  bool toggle_speed_;
+  libvpx_test::MD5 md5_;
+  std::vector<size_t> frame_sizes_;
+  std::vector<vpx_codec_frame_flags_t> frame_flags_;
+};
+
+// A budget that is never reached must leave the encoding unchanged.
+TEST_P(EncodeTimeBudgetTest, LargeBudgetIsBitExact) {
+  const std::string reference = EncodeWithBudget(0);
+  EXPECT_EQ(reference, EncodeWithBudget(100000000));
+}
+
+// A budget that is always exceeded raises the speed, which changes the
+// bitstream. Switching speeds between frames must not cause mismatches.
+TEST_P(EncodeTimeBudgetTest, SmallBudgetRaisesSpeed) {
+  if (encoding_mode_ != ::libvpx_test::kRealTime && cpu_used_ >= 5) {
+    GTEST_SKIP() << "No faster good quality speed than 5";
+  }
+  const std::string reference = EncodeWithBudget(0);
+  EXPECT_NE(reference, EncodeWithBudget(1));
+}
+
+// The speeds the budget moves through differ in their use of row based
+// multi-threading, which must follow the speed of each frame.
+TEST_P(EncodeTimeBudgetTest, SmallBudgetWithRowMt) {
+  if (encoding_mode_ != ::libvpx_test::kRealTime && cpu_used_ >= 5) {
+    GTEST_SKIP() << "No faster good quality speed than 5";
+  }
+  cfg_.g_threads = 2;
+  row_mt_ = 1;
+  const std::string reference = EncodeWithBudget(0);
+  EXPECT_NE(reference, EncodeWithBudget(1));
+}
+
+// Toggling the speed between frames must leave the rate control state alone:
+// the key frames and the alt-ref frames stay where an encode at cpu_used puts
+// them, and the rate stays close to it.
+TEST_P(EncodeTimeBudgetTest, SpeedToggleKeepsRateControl) {
+  if (encoding_mode_ != ::libvpx_test::kRealTime && cpu_used_ >= 5) {
+    GTEST_SKIP() << "No faster good quality speed than 5";
+  }
+  const std::string reference = EncodeWithBudget(0);
+  const std::vector<size_t> reference_sizes = frame_sizes_;
+  const std::vector<vpx_codec_frame_flags_t> reference_flags = frame_flags_;
+  toggle_speed_ = true;
+  EXPECT_NE(reference, EncodeWithBudget(0));
+  ASSERT_EQ(frame_flags_.size(), reference_flags.size());
+  size_t reference_bytes = 0;
+  size_t bytes = 0;
+  for (size_t i = 0; i < frame_flags_.size(); ++i) {
+    EXPECT_EQ(frame_flags_[i], reference_flags[i]) << "frame " << i;
+    reference_bytes += reference_sizes[i];
+    bytes += frame_sizes_[i];
+  }
+  EXPECT_NEAR(static_cast<double>(bytes), static_cast<double>(reference_bytes),
+              0.1 * reference_bytes);
+}
+
+VP9_INSTANTIATE_TEST_SUITE(EncodeTimeBudgetTest,
+                           ::testing::ValuesIn(kEncodingModes),
+                           ::testing::Values(1, 6));
+}  // namespace
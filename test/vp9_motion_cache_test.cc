@@ -0,0 +1,152 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "test/acm_random.h"
+#include "./vpx_config.h"
+#include "vp9/encoder/vp9_motion_cache.h"
+#include "vpx_scale/yv12config.h"
+
+namespace {
+
+using libvpx_test::ACMRandom;
+
+const int kWidth = 160;
+const int kHeight = 128;
+const int kBorder = 32;
+// Motion of the current frame in the reference frame.
+const int kMotionRow = 6;
+const int kMotionCol = -10;
+
+class MotionCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    memset(&cache_, 0, sizeof(cache_));
+    memset(&cur_, 0, sizeof(cur_));
+    memset(&ref_, 0, sizeof(ref_));
+    ASSERT_EQ(AllocFrame(&cur_.img), 0);
+    ASSERT_EQ(AllocFrame(&ref_.img), 0);
+    cur_.show_idx = 3;
+    ref_.show_idx = 4;
+
+    // A smooth texture, so that it survives the downsampling, which the
+    // current frame sees displaced by (kMotionRow, kMotionCol).
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    const int tex_width = kWidth + 2 * kBorder;
+    const int tex_height = kHeight + 2 * kBorder;
+    std::vector<int> noise(tex_width * tex_height);
+    for (size_t i = 0; i < noise.size(); ++i) noise[i] = rnd.Rand8();
+    texture_.resize(tex_width * tex_height);
+    for (int r = 0; r < tex_height; ++r) {
+      for (int c = 0; c < tex_width; ++c) {
+        int sum = 0, count = 0;
+        for (int dr = -3; dr <= 3; ++dr) {
+          for (int dc = -3; dc <= 3; ++dc) {
+            const int rr = r + dr, cc = c + dc;
+            if (rr < 0 || cc < 0 || rr >= tex_height || cc >= tex_width)
+              continue;
+            sum += noise[rr * tex_width + cc];
+            ++count;
+          }
+        }
+        texture_[r * tex_width + c] = static_cast<uint8_t>(sum / count);
+      }
+    }
+    for (int r = 0; r < kHeight; ++r) {
+      for (int c = 0; c < kWidth; ++c) {
+        ref_.img.y_buffer[r * ref_.img.y_stride + c] =
+            texture_[(r + kBorder) * tex_width + c + kBorder];
+        cur_.img.y_buffer[r * cur_.img.y_stride + c] =
+            texture_[(r + kBorder + kMotionRow) * tex_width + c + kBorder +
+                     kMotionCol];
+      }
+    }
+  }
+
+  void TearDown() override {
+    vp9_motion_cache_free(&cache_);
+    vpx_free_frame_buffer(&cur_.img);
+    vpx_free_frame_buffer(&ref_.img);
+  }
+
+  static int AllocFrame(YV12_BUFFER_CONFIG *img) {
+    return vpx_alloc_frame_buffer(img, kWidth, kHeight, 1, 1,
+#if CONFIG_VP9_HIGHBITDEPTH
+                                  0,
+#endif
+                                  kBorder, 0);
+  }
+
+  MotionCache cache_;
+  struct lookahead_entry cur_;
+  struct lookahead_entry ref_;
+  std::vector<uint8_t> texture_;
+};
+
+TEST_F(MotionCacheTest, BuildFieldFindsMotion) {
+  ASSERT_TRUE(vp9_motion_cache_build_field(&cache_, &cur_, &ref_));
+  EXPECT_TRUE(
+      vp9_motion_cache_has_motion(&cache_, cur_.show_idx, ref_.show_idx));
+  EXPECT_TRUE(
+      vp9_motion_cache_has_motion(&cache_, ref_.show_idx, cur_.show_idx));
+
+  // Away from the frame edges every 16x16 block must find the motion.
+  for (int mi_row = 2; mi_row < kHeight / 8 - 2; mi_row += 2) {
+    for (int mi_col = 2; mi_col < kWidth / 8 - 2; mi_col += 2) {
+      MV mvs[4];
+      ASSERT_EQ(vp9_motion_cache_get_mvs(&cache_, cur_.show_idx, ref_.show_idx,
+                                         mi_row, mi_col, BLOCK_16X16, mvs),
+                1);
+      EXPECT_EQ(mvs[0].row, kMotionRow) << mi_row << "," << mi_col;
+      EXPECT_EQ(mvs[0].col, kMotionCol) << mi_row << "," << mi_col;
+
+      // The motion in the opposite direction is derived from it.
+      ASSERT_EQ(vp9_motion_cache_get_mvs(&cache_, ref_.show_idx, cur_.show_idx,
+                                         mi_row, mi_col, BLOCK_16X16, mvs),
+                1);
+      EXPECT_EQ(mvs[0].row, -kMotionRow);
+      EXPECT_EQ(mvs[0].col, -kMotionCol);
+    }
+  }
+}
+
+TEST_F(MotionCacheTest, IncompleteFieldIsNotUsed) {
+  MotionCacheField *const field = vp9_motion_cache_get_field(
+      &cache_, cur_.show_idx, ref_.show_idx, kWidth, kHeight);
+  ASSERT_NE(field, nullptr);
+  const MV mv = { 2, -3 };
+  vp9_motion_cache_set_mvs(field, 0, 0, BLOCK_32X32, &mv);
+
+  MV mvs[4];
+  EXPECT_EQ(vp9_motion_cache_get_mvs(&cache_, cur_.show_idx, ref_.show_idx, 0,
+                                     0, BLOCK_32X32, mvs),
+            0);
+  field->complete = 1;
+  ASSERT_EQ(vp9_motion_cache_get_mvs(&cache_, cur_.show_idx, ref_.show_idx, 0,
+                                     0, BLOCK_32X32, mvs),
+            1);
+  EXPECT_EQ(mvs[0].row, 2);
+  EXPECT_EQ(mvs[0].col, -3);
+
+  // A frame taking over the slot of another one drops its fields.
+  EXPECT_EQ(vp9_motion_cache_get_field(&cache_,
+                                       cur_.show_idx + MOTION_CACHE_FRAMES,
+                                       ref_.show_idx, kWidth, kHeight),
+            field);
+  EXPECT_FALSE(
+      vp9_motion_cache_has_motion(&cache_, cur_.show_idx, ref_.show_idx));
+}
+
+}  // namespace
@@ -0,0 +1,455 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+#include "test/acm_random.h"
+#include "./vpx_config.h"
+#include "vpx_mem/vpx_mem.h"
+#include "vp9/common/vp9_blockd.h"
+#include "vp9/common/vp9_entropy.h"
+#include "vp9/common/vp9_onyxc_int.h"
+#include "vp9/common/vp9_scan.h"
+#include "vp9/encoder/vp9_block.h"
+#include "vp9/encoder/vp9_cost.h"
+#include "vp9/encoder/vp9_encodemb.h"
+#include "vp9/encoder/vp9_rd.h"
+#include "vp9/encoder/vp9_tokenize.h"
+
+namespace {
+
+using libvpx_test::ACMRandom;
+
+const int kNumTrials = 400;
+
+const int kPlaneRdMult[REF_TYPES][PLANE_TYPES] = {
+  { 10, 6 },
+  { 8, 5 },
+};
+
+#define RIGHT_SHIFT_POSSIBLY_NEGATIVE(num, shift) \
+  (((num) >= 0) ? (num) >> (shift) : -((-(num)) >> (shift)))
+
+// The trellis as it was before it reused the contexts of the search and
+// computed token_cache[] on the fly, which vp9_optimize_b() must match.
+int ReferenceOptimizeB(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
+                       int ctx) {
+  MACROBLOCKD *const xd = &mb->e_mbd;
+  struct macroblock_plane *const p = &mb->plane[plane];
+  struct macroblockd_plane *const pd = &xd->plane[plane];
+  const int ref = is_inter_block(xd->mi[0]);
+  uint8_t token_cache[1024];
+  const tran_low_t *const coeff = BLOCK_OFFSET(p->coeff, block);
+  tran_low_t *const qcoeff = BLOCK_OFFSET(p->qcoeff, block);
+  tran_low_t *const dqcoeff = BLOCK_OFFSET(pd->dqcoeff, block);
+  const int eob = p->eobs[block];
+  const PLANE_TYPE plane_type = get_plane_type(plane);
+  const int default_eob = 16 << (tx_size << 1);
+  const int shift = (tx_size == TX_32X32);
+  const int16_t *const dequant_ptr = pd->dequant;
+  const uint8_t *const band_translate = get_band_translate(tx_size);
+  const ScanOrder *const so = get_scan(xd, tx_size, plane_type, block);
+  const int16_t *const scan = so->scan;
+  const int16_t *const nb = so->neighbors;
+  const MODE_INFO *mbmi = xd->mi[0];
+  const int sharpness = mb->sharpness;
+  const int64_t rdadj = (int64_t)mb->rdmult * kPlaneRdMult[ref][plane_type];
+  const int64_t rdmult =
+      (sharpness == 0 ? rdadj >> 1
+                      : (rdadj * (8 - sharpness + mbmi->segment_id)) >> 4);
+
+  const int64_t rddiv = mb->rddiv;
+  int64_t rd_cost0, rd_cost1;
+  int64_t rate0, rate1;
+  int16_t t0, t1;
+  int i, final_eob;
+  int count_high_values_after_eob = 0;
+#if CONFIG_VP9_HIGHBITDEPTH
+  const uint16_t *cat6_high_cost = vp9_get_high_cost_table(xd->bd);
+#else
+  const uint16_t *cat6_high_cost = vp9_get_high_cost_table(8);
+#endif
+  uint16_t(*const token_costs)[2][COEFF_CONTEXTS][ENTROPY_TOKENS] =
+      mb->token_costs[tx_size][plane_type][ref];
+  uint16_t(*token_costs_cur)[2][COEFF_CONTEXTS][ENTROPY_TOKENS];
+  int64_t eob_cost0, eob_cost1;
+  const int ctx0 = ctx;
+  int64_t accu_rate = 0;
+  // Initialized to the worst possible error for the largest transform size.
+  // This ensures that it never goes negative.
+  int64_t accu_error = ((int64_t)1) << 50;
+  int64_t best_block_rd_cost = INT64_MAX;
+  int x_prev = 1;
+  tran_low_t before_best_eob_qc = 0;
+  tran_low_t before_best_eob_dqc = 0;
+
+  assert((!plane_type && !plane) || (plane_type && plane));
+  assert(eob <= default_eob);
+
+  for (i = 0; i < eob; i++) {
+    const int rc = scan[i];
+    token_cache[rc] = vp9_pt_energy_class[vp9_get_token(qcoeff[rc])];
+  }
+  final_eob = 0;
+
+  // Initial RD cost.
+  token_costs_cur = token_costs + band_translate[0];
+  rate0 = (*token_costs_cur)[0][ctx0][EOB_TOKEN];
+  best_block_rd_cost = RDCOST(rdmult, rddiv, rate0, accu_error);
+
+  // For each token, pick one of two choices greedily:
+  // (i) First candidate: Keep current quantized value, OR
+  // (ii) Second candidate: Reduce quantized value by 1.
+  for (i = 0; i < eob; i++) {
+    const int rc = scan[i];
+    const int x = qcoeff[rc];
+    const int band_cur = band_translate[i];
+    const int ctx_cur = (i == 0) ? ctx : get_coef_context(nb, token_cache, i);
+    const int token_tree_sel_cur = (x_prev == 0);
+    token_costs_cur = token_costs + band_cur;
+    if (x == 0) {  // No need to search
+      const int token = vp9_get_token(x);
+      rate0 = (*token_costs_cur)[token_tree_sel_cur][ctx_cur][token];
+      accu_rate += rate0;
+      x_prev = 0;
+      // Note: accu_error does not change.
+    } else {
+      const int dqv = dequant_ptr[rc != 0];
+      // Compute the distortion for quantizing to 0.
+      const int diff_for_zero_raw = (0 - coeff[rc]) * (1 << shift);
+      const int diff_for_zero =
+#if CONFIG_VP9_HIGHBITDEPTH
+          (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH)
+              ? RIGHT_SHIFT_POSSIBLY_NEGATIVE(diff_for_zero_raw, xd->bd - 8)
+              :
+#endif
+              diff_for_zero_raw;
+      const int64_t distortion_for_zero =
+          (int64_t)diff_for_zero * diff_for_zero;
+
+      // Compute the distortion for the first candidate
+      const int diff0_raw = (dqcoeff[rc] - coeff[rc]) * (1 << shift);
+      const int diff0 =
+#if CONFIG_VP9_HIGHBITDEPTH
+          (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH)
+              ? RIGHT_SHIFT_POSSIBLY_NEGATIVE(diff0_raw, xd->bd - 8)
+              :
+#endif  // CONFIG_VP9_HIGHBITDEPTH
+              diff0_raw;
+      const int64_t distortion0 = (int64_t)diff0 * diff0;
+
+      // Compute the distortion for the second candidate
+      const int sign = -(x < 0);        // -1 if x is negative and 0 otherwise.
+      const int x1 = x - 2 * sign - 1;  // abs(x1) = abs(x) - 1.
+      int64_t distortion1;
+      if (x1 != 0) {
+        const int dqv_step =
+#if CONFIG_VP9_HIGHBITDEPTH
+            (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) ? dqv >> (xd->bd - 8)
+                                                          :
+#endif  // CONFIG_VP9_HIGHBITDEPTH
+                                                          dqv;
+        const int diff_step = (dqv_step + sign) ^ sign;
+        const int diff1 = diff0 - diff_step;
+        assert(dqv > 0);  // We aren't right shifting a negative number above.
+        distortion1 = (int64_t)diff1 * diff1;
+      } else {
+        distortion1 = distortion_for_zero;
+      }
+      {
+        // Calculate RDCost for current coeff for the two candidates.
+        const int64_t base_bits0 = vp9_get_token_cost(x, &t0, cat6_high_cost);
+        const int64_t base_bits1 = vp9_get_token_cost(x1, &t1, cat6_high_cost);
+        rate0 =
+            base_bits0 + (*token_costs_cur)[token_tree_sel_cur][ctx_cur][t0];
+        rate1 =
+            base_bits1 + (*token_costs_cur)[token_tree_sel_cur][ctx_cur][t1];
+      }
+      {
+        int rdcost_better_for_x1, eob_rdcost_better_for_x1;
+        int dqc0, dqc1;
+        int64_t best_eob_cost_cur;
+        int use_x1;
+
+        // Calculate RD Cost effect on the next coeff for the two candidates.
+        int64_t next_bits0 = 0;
+        int64_t next_bits1 = 0;
+        int64_t next_eob_bits0 = 0;
+        int64_t next_eob_bits1 = 0;
+        if (i < default_eob - 1) {
+          int ctx_next, token_tree_sel_next;
+          const int band_next = band_translate[i + 1];
+          const int token_next =
+              (i + 1 != eob) ? vp9_get_token(qcoeff[scan[i + 1]]) : EOB_TOKEN;
+          uint16_t(*const token_costs_next)[2][COEFF_CONTEXTS]
+                                           [ENTROPY_TOKENS] =
+                                               token_costs + band_next;
+          token_cache[rc] = vp9_pt_energy_class[t0];
+          ctx_next = get_coef_context(nb, token_cache, i + 1);
+          token_tree_sel_next = (x == 0);
+          next_bits0 =
+              (*token_costs_next)[token_tree_sel_next][ctx_next][token_next];
+          next_eob_bits0 =
+              (*token_costs_next)[token_tree_sel_next][ctx_next][EOB_TOKEN];
+          token_cache[rc] = vp9_pt_energy_class[t1];
+          ctx_next = get_coef_context(nb, token_cache, i + 1);
+          token_tree_sel_next = (x1 == 0);
+          next_bits1 =
+              (*token_costs_next)[token_tree_sel_next][ctx_next][token_next];
+          if (x1 != 0) {
+            next_eob_bits1 =
+                (*token_costs_next)[token_tree_sel_next][ctx_next][EOB_TOKEN];
+          }
+        }
+
+        // Compare the total RD costs for two candidates.
+        rd_cost0 = RDCOST(rdmult, rddiv, (rate0 + next_bits0), distortion0);
+        rd_cost1 = RDCOST(rdmult, rddiv, (rate1 + next_bits1), distortion1);
+        rdcost_better_for_x1 = (rd_cost1 < rd_cost0);
+        eob_cost0 = RDCOST(rdmult, rddiv, (accu_rate + rate0 + next_eob_bits0),
+                           (accu_error + distortion0 - distortion_for_zero));
+        eob_cost1 = eob_cost0;
+        if (x1 != 0) {
+          eob_cost1 =
+              RDCOST(rdmult, rddiv, (accu_rate + rate1 + next_eob_bits1),
+                     (accu_error + distortion1 - distortion_for_zero));
+          eob_rdcost_better_for_x1 = (eob_cost1 < eob_cost0);
+        } else {
+          eob_rdcost_better_for_x1 = 0;
+        }
+
+        // Calculate the two candidate de-quantized values.
+        dqc0 = dqcoeff[rc];
+        dqc1 = 0;
+        if (rdcost_better_for_x1 + eob_rdcost_better_for_x1) {
+          if (x1 != 0) {
+            dqc1 = RIGHT_SHIFT_POSSIBLY_NEGATIVE(x1 * dqv, shift);
+          } else {
+            dqc1 = 0;
+          }
+        }
+
+        // Pick and record the better quantized and de-quantized values.
+        if (rdcost_better_for_x1) {
+          qcoeff[rc] = x1;
+          dqcoeff[rc] = dqc1;
+          accu_rate += rate1;
+          accu_error += distortion1 - distortion_for_zero;
+          assert(distortion1 <= distortion_for_zero);
+          token_cache[rc] = vp9_pt_energy_class[t1];
+        } else {
+          accu_rate += rate0;
+          accu_error += distortion0 - distortion_for_zero;
+          assert(distortion0 <= distortion_for_zero);
+          token_cache[rc] = vp9_pt_energy_class[t0];
+        }
+        if (sharpness > 0 && abs(qcoeff[rc]) > 1) count_high_values_after_eob++;
+        assert(accu_error >= 0);
+        x_prev = qcoeff[rc];  // Update based on selected quantized value.
+
+        use_x1 = (x1 != 0) && eob_rdcost_better_for_x1;
+        best_eob_cost_cur = use_x1 ? eob_cost1 : eob_cost0;
+
+        // Determine whether to move the eob position to i+1
+        if (best_eob_cost_cur < best_block_rd_cost) {
+          best_block_rd_cost = best_eob_cost_cur;
+          final_eob = i + 1;
+          count_high_values_after_eob = 0;
+          if (use_x1) {
+            before_best_eob_qc = x1;
+            before_best_eob_dqc = dqc1;
+          } else {
+            before_best_eob_qc = x;
+            before_best_eob_dqc = dqc0;
+          }
+        }
+      }
+    }
+  }
+  if (count_high_values_after_eob > 0) {
+    final_eob = eob - 1;
+    for (; final_eob >= 0; final_eob--) {
+      const int rc = scan[final_eob];
+      const int x = qcoeff[rc];
+      if (x) {
+        break;
+      }
+    }
+    final_eob++;
+  } else {
+    assert(final_eob <= eob);
+    if (final_eob > 0) {
+      int rc;
+      assert(before_best_eob_qc != 0);
+      i = final_eob - 1;
+      rc = scan[i];
+      qcoeff[rc] = before_best_eob_qc;
+      dqcoeff[rc] = before_best_eob_dqc;
+    }
+    for (i = final_eob; i < eob; i++) {
+      int rc = scan[i];
+      qcoeff[rc] = 0;
+      dqcoeff[rc] = 0;
+    }
+  }
+  mb->plane[plane].eobs[block] = final_eob;
+  return final_eob;
+}
+
+#undef RIGHT_SHIFT_POSSIBLY_NEGATIVE
+
+class OptimizeBTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mb_ = static_cast<MACROBLOCK *>(vpx_calloc(1, sizeof(*mb_)));
+    ASSERT_NE(mb_, nullptr);
+    memset(&mi_, 0, sizeof(mi_));
+    memset(&cur_buf_, 0, sizeof(cur_buf_));
+    mi_ptr_ = &mi_;
+    mi_.sb_type = BLOCK_64X64;
+    mb_->e_mbd.mi = &mi_ptr_;
+    mb_->e_mbd.cur_buf = &cur_buf_;
+#if CONFIG_VP9_HIGHBITDEPTH
+    mb_->e_mbd.bd = 8;
+#endif
+    for (int plane = 0; plane < 2; ++plane) {
+      mb_->plane[plane].coeff = coeff_;
+      mb_->plane[plane].qcoeff = qcoeff_;
+      mb_->plane[plane].eobs = &eob_;
+      mb_->e_mbd.plane[plane].dqcoeff = dqcoeff_;
+      mb_->e_mbd.plane[plane].dequant = dequant_;
+    }
+  }
+
+  void TearDown() override { vpx_free(mb_); }
+
+  // Fills the token costs from random model probabilities, the same way
+  // vp9_initialize_rd_consts() does from the frame probabilities.
+  void FillTokenCosts(ACMRandom *rnd) {
+    for (int t = TX_4X4; t <= TX_32X32; ++t) {
+      for (int i = 0; i < PLANE_TYPES; ++i) {
+        for (int j = 0; j < REF_TYPES; ++j) {
+          for (int k = 0; k < COEF_BANDS; ++k) {
+            for (int l = 0; l < BAND_COEFF_CONTEXTS(k); ++l) {
+              vpx_prob model[UNCONSTRAINED_NODES];
+              vpx_prob probs[ENTROPY_NODES];
+              int costs[2][ENTROPY_TOKENS];
+              for (int m = 0; m < UNCONSTRAINED_NODES; ++m) {
+                model[m] = static_cast<vpx_prob>(1 + rnd->Rand8() % 255);
+              }
+              vp9_model_to_full_probs(model, probs);
+              vp9_cost_tokens(costs[0], probs, vp9_coef_tree);
+              vp9_cost_tokens_skip(costs[1], probs, vp9_coef_tree);
+              for (int m = 0; m < ENTROPY_TOKENS; ++m) {
+                mb_->token_costs[t][i][j][k][0][l][m] =
+                    static_cast<uint16_t>(costs[0][m]);
+                mb_->token_costs[t][i][j][k][1][l][m] =
+                    static_cast<uint16_t>(costs[1][m]);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // Generates residual coefficients whose magnitude decays along the scan,
+  // and quantizes them with rounding to the nearest level.
+  void FillBlock(ACMRandom *rnd, TX_SIZE tx_size, const int16_t *scan) {
+    const int num_coeffs = 16 << (tx_size << 1);
+    const int shift = tx_size == TX_32X32;
+    const int max_amp = 64 + rnd->Rand16() % 4000;
+    const int zero_prob = rnd->Rand8();
+    dequant_[0] = static_cast<int16_t>(8 + rnd->Rand16() % 1000);
+    dequant_[1] = static_cast<int16_t>(8 + rnd->Rand16() % 1000);
+    memset(coeff_, 0, sizeof(coeff_));
+    memset(qcoeff_, 0, sizeof(qcoeff_));
+    memset(dqcoeff_, 0, sizeof(dqcoeff_));
+    eob_ = 0;
+    for (int i = 0; i < num_coeffs; ++i) {
+      const int rc = scan[i];
+      const int dqv = dequant_[rc != 0];
+      const int amp = max_amp * 4 / (4 + i);
+      int level, value;
+      if (rnd->Rand8() < zero_prob) continue;
+      value = rnd->Rand16() % (amp + 1);
+      level = ((value << shift) + (dqv >> 1)) / dqv;
+      if (rnd->Rand8() & 1) {
+        coeff_[rc] = -value;
+        qcoeff_[rc] = -level;
+        dqcoeff_[rc] = -((level * dqv) >> shift);
+      } else {
+        coeff_[rc] = value;
+        qcoeff_[rc] = level;
+        dqcoeff_[rc] = (level * dqv) >> shift;
+      }
+      if (level) eob_ = i + 1;
+    }
+  }
+
+  MACROBLOCK *mb_;
+  MODE_INFO mi_;
+  MODE_INFO *mi_ptr_;
+  YV12_BUFFER_CONFIG cur_buf_;
+  DECLARE_ALIGNED(16, tran_low_t, coeff_[32 * 32]);
+  DECLARE_ALIGNED(16, tran_low_t, qcoeff_[32 * 32]);
+  DECLARE_ALIGNED(16, tran_low_t, dqcoeff_[32 * 32]);
+  int16_t dequant_[2];
+  uint16_t eob_;
+};
+
+TEST_F(OptimizeBTest, MatchesReference) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  FillTokenCosts(&rnd);
+  for (int trial = 0; trial < kNumTrials; ++trial) {
+    for (int tx_size = TX_4X4; tx_size <= TX_32X32; ++tx_size) {
+      const int plane = rnd.Rand8() & 1;
+      const int ctx = rnd.Rand8() % 3;
+      tran_low_t qcoeff[32 * 32], dqcoeff[32 * 32];
+      tran_low_t ref_qcoeff[32 * 32], ref_dqcoeff[32 * 32];
+      uint16_t eob;
+      mi_.ref_frame[0] = (rnd.Rand8() & 1) ? LAST_FRAME : INTRA_FRAME;
+      mi_.mode = static_cast<PREDICTION_MODE>(rnd.Rand8() % INTRA_MODES);
+      mi_.segment_id = rnd.Rand8() % MAX_SEGMENTS;
+      mb_->rdmult = 1 + rnd.Rand16() * 4;
+      mb_->rddiv = RDDIV_BITS;
+      mb_->sharpness = (rnd.Rand8() & 3) ? 0 : rnd.Rand8() % 8;
+      const ScanOrder *const so = get_scan(
+          &mb_->e_mbd, static_cast<TX_SIZE>(tx_size), get_plane_type(plane), 0);
+      FillBlock(&rnd, static_cast<TX_SIZE>(tx_size), so->scan);
+
+      memcpy(qcoeff, qcoeff_, sizeof(qcoeff));
+      memcpy(dqcoeff, dqcoeff_, sizeof(dqcoeff));
+      eob = eob_;
+      const int ref_ret = ReferenceOptimizeB(
+          mb_, plane, 0, static_cast<TX_SIZE>(tx_size), ctx);
+      memcpy(ref_qcoeff, qcoeff_, sizeof(ref_qcoeff));
+      memcpy(ref_dqcoeff, dqcoeff_, sizeof(ref_dqcoeff));
+      const uint16_t ref_eob = eob_;
+
+      memcpy(qcoeff_, qcoeff, sizeof(qcoeff));
+      memcpy(dqcoeff_, dqcoeff, sizeof(dqcoeff));
+      eob_ = eob;
+      const int ret =
+          vp9_optimize_b(mb_, plane, 0, static_cast<TX_SIZE>(tx_size), ctx);
+      ASSERT_EQ(ref_ret, ret) << "trial " << trial << " tx_size " << tx_size;
+      ASSERT_EQ(ref_eob, eob_) << "trial " << trial << " tx_size " << tx_size;
+      ASSERT_EQ(0, memcmp(ref_qcoeff, qcoeff_, sizeof(ref_qcoeff)))
+          << "trial " << trial << " tx_size " << tx_size;
+      ASSERT_EQ(0, memcmp(ref_dqcoeff, dqcoeff_, sizeof(ref_dqcoeff)))
+          << "trial " << trial << " tx_size " << tx_size;
+    }
+  }
+}
+
+}  // namespace
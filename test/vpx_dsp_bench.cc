@@ -0,0 +1,1382 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Kernel-level micro-benchmark for the RTCD functions in
+// vpx_dsp_rtcd_defs.pl, vp9_rtcd_defs.pl, vp8/common/rtcd_defs.pl and
+// vpx_scale_rtcd.pl.
+//
+// Every implementation of every RTCD function that was compiled in and is
+// supported by the running CPU is timed. The median of VPX_BENCH_ROBUST_ITER
+// samples is reported as JSON, one result object per line. Kernels whose
+// prototype has no benchmark below are listed under "unsupported".
+//
+//   vpx_dsp_bench [--output=out.json] [--filter=substr] [--isa=name]
+//                 [--scale=n] [--compare=baseline.json] [--threshold=pct]
+//
+// With --compare the results are matched by (kernel, isa, width, height)
+// against a previous run and any kernel whose time per call grew by more than
+// --threshold percent (default 5) is reported as a regression. The exit status
+// is non-zero when a regression was found.
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "./vpx_config.h"
+#include "./vpx_dsp_rtcd.h"
+#include "./vpx_scale_rtcd.h"
+#if CONFIG_VP8
+#include "./vp8_rtcd.h"
+#endif
+#if CONFIG_VP9
+#include "./vp9_rtcd.h"
+#include "vp9/common/vp9_filter.h"
+#include "vp9/common/vp9_scan.h"
+#endif
+#if CONFIG_VP9_ENCODER
+#include "vp9/encoder/vp9_block.h"
+#endif
+#include "test/bench.h"
+#include "vpx/vpx_integer.h"
+#include "vpx_dsp/vpx_dsp_common.h"
+#include "vpx_ports/mem.h"
+#include "vpx_ports/vpx_timer.h"
+#if VPX_ARCH_X86 || VPX_ARCH_X86_64
+#include "vpx_ports/x86.h"
+#endif
+#if VPX_ARCH_ARM || VPX_ARCH_AARCH64
+#include "vpx_ports/arm.h"
+#endif
+#if VPX_ARCH_MIPS
+#include "vpx_ports/mips.h"
+#endif
+#if VPX_ARCH_PPC
+#include "vpx_ports/ppc.h"
+#endif
+#if VPX_ARCH_LOONGARCH
+#include "vpx_ports/loongarch.h"
+#endif
+
+namespace {
+
+// Stride of all the pixel and coefficient buffers. Large enough for a 64x64
+// block plus the border read by the 8-tap filters and the loop filters.
+const int kStride = 96;
+const int kBorder = 16;
+const int kBufSize = kStride * kStride;
+// Offset of the top-left pixel of the block, leaving room for the border.
+const int kOffset = kBorder * kStride + kBorder;
+
+// Minimum duration of each timing sample, before --scale. Samples shorter than
+// this are dominated by the resolution of vpx_usec_timer.
+const int64_t kMinSampleUs = 1000;
+
+uint32_t g_seed = 0x9e3779b9;
+int Rand8() {
+  g_seed = g_seed * 1664525 + 1013904223;
+  return (g_seed >> 24) & 0xff;
+}
+
+int IsaSupported(const char *isa) {
+  if (!strcmp(isa, "c")) return 1;
+#if VPX_ARCH_X86 || VPX_ARCH_X86_64
+  {
+    const int caps = x86_simd_caps();
+    if (!strcmp(isa, "mmx")) return !!(caps & HAS_MMX);
+    if (!strcmp(isa, "sse")) return !!(caps & HAS_SSE);
+    if (!strcmp(isa, "sse2")) return !!(caps & HAS_SSE2);
+    if (!strcmp(isa, "sse3")) return !!(caps & HAS_SSE3);
+    if (!strcmp(isa, "ssse3")) return !!(caps & HAS_SSSE3);
+    if (!strcmp(isa, "sse4_1")) return !!(caps & HAS_SSE4_1);
+    if (!strcmp(isa, "avx")) return !!(caps & HAS_AVX);
+    if (!strcmp(isa, "avx2")) return !!(caps & HAS_AVX2);
+    if (!strcmp(isa, "avx512")) return !!(caps & HAS_AVX512);
+  }
+#endif
+#if VPX_ARCH_ARM || VPX_ARCH_AARCH64
+  {
+    const int caps = arm_cpu_caps();
+    if (!strcmp(isa, "neon")) return !!(caps & HAS_NEON);
+    if (!strcmp(isa, "neon_asm")) return !!(caps & HAS_NEON);
+    if (!strcmp(isa, "neon_dotprod")) return !!(caps & HAS_NEON_DOTPROD);
+    if (!strcmp(isa, "neon_i8mm")) return !!(caps & HAS_NEON_I8MM);
+    if (!strcmp(isa, "sve")) return !!(caps & HAS_SVE);
+    if (!strcmp(isa, "sve2")) return !!(caps & HAS_SVE2);
+  }
+#endif
+#if VPX_ARCH_MIPS
+  {
+    const int caps = mips_cpu_caps();
+    if (!strcmp(isa, "mmi")) return !!(caps & HAS_MMI);
+    if (!strcmp(isa, "msa")) return !!(caps & HAS_MSA);
+    if (!strcmp(isa, "dspr2")) return HAVE_DSPR2;
+  }
+#endif
+#if VPX_ARCH_PPC
+  if (!strcmp(isa, "vsx")) return !!(ppc_simd_caps() & HAS_VSX);
+#endif
+#if VPX_ARCH_LOONGARCH
+  {
+    const int caps = loongarch_cpu_caps();
+    if (!strcmp(isa, "lsx")) return !!(caps & HAS_LSX);
+    if (!strcmp(isa, "lasx")) return !!(caps & HAS_LASX);
+  }
+#endif
+  return 0;
+}
+
+// Input and output buffers shared by all the kernels. They are refilled with
+// the same pseudo-random content before each kernel is timed.
+struct BenchBuffers {
+  void Init() {
+    g_seed = 0x9e3779b9;
+    for (int i = 0; i < kBufSize; ++i) {
+      src[i] = Rand8();
+      ref[i] = Rand8();
+      dst[i] = Rand8();
+      diff[i] = src[i] - ref[i];
+      // Sparse coefficients with a decaying magnitude, roughly matching what
+      // the quantizers and inverse transforms see in practice.
+      coeff[i] = (i % 7 == 0) ? (Rand8() - 128) * 8 / (1 + (i & 63)) : 0;
+    }
+    for (int i = 0; i < 2 * kStride; ++i) edge[i] = Rand8();
+    // The high bitdepth kernels see the same 8-bit content.
+    for (int i = 0; i < kBufSize; ++i) {
+      src16[i] = src[i];
+      ref16[i] = ref[i];
+      dst16[i] = dst[i];
+    }
+    for (int i = 0; i < 2 * kStride; ++i) edge16[i] = edge[i];
+    memset(blimit, 60, sizeof(blimit));
+    memset(limit, 10, sizeof(limit));
+    memset(thresh, 8, sizeof(thresh));
+  }
+
+  DECLARE_ALIGNED(32, uint8_t, src[kBufSize]);
+  DECLARE_ALIGNED(32, uint8_t, ref[kBufSize]);
+  DECLARE_ALIGNED(32, uint8_t, dst[kBufSize]);
+  DECLARE_ALIGNED(32, int16_t, diff[kBufSize]);
+  DECLARE_ALIGNED(32, tran_low_t, coeff[kBufSize]);
+  DECLARE_ALIGNED(32, tran_low_t, out[kBufSize]);
+  DECLARE_ALIGNED(32, tran_low_t, out2[kBufSize]);
+  DECLARE_ALIGNED(32, uint8_t, edge[2 * kStride]);
+  DECLARE_ALIGNED(32, uint16_t, src16[kBufSize]);
+  DECLARE_ALIGNED(32, uint16_t, ref16[kBufSize]);
+  DECLARE_ALIGNED(32, uint16_t, dst16[kBufSize]);
+  DECLARE_ALIGNED(32, uint16_t, edge16[2 * kStride]);
+  DECLARE_ALIGNED(16, uint8_t, blimit[16]);
+  DECLARE_ALIGNED(16, uint8_t, limit[16]);
+  DECLARE_ALIGNED(16, uint8_t, thresh[16]);
+};
+
+BenchBuffers g_buffers;
+BenchBuffers *const g_buf = &g_buffers;
+
+// The kernel tables generated from the rtcd definitions by rtcd.pl --bench.
+// Every implementation of every RTCD function is listed with its prototype,
+// e.g. "unsigned int(const uint8_t*,int,const uint8_t*,int)", which selects
+// the benchmark below that knows how to call it.
+typedef void (*RtcdKernelFn)(void);
+struct RtcdKernel {
+  const char *name;
+  const char *isa;
+  const char *prototype;
+  RtcdKernelFn fn;
+};
+
+#include "./vpx_dsp_rtcd_bench.h"
+#include "./vpx_scale_rtcd_bench.h"
+#if CONFIG_VP8
+#include "./vp8_rtcd_bench.h"
+#endif
+#if CONFIG_VP9
+#include "./vp9_rtcd_bench.h"
+#endif
+
+struct KernelTable {
+  const RtcdKernel *kernels;
+  size_t count;
+};
+
+#define KERNEL_TABLE(t) \
+  { t, sizeof(t) / sizeof(t[0]) }
+
+const KernelTable kKernelTables[] = {
+  KERNEL_TABLE(vpx_dsp_rtcd_kernels),
+  KERNEL_TABLE(vpx_scale_rtcd_kernels),
+#if CONFIG_VP8
+  KERNEL_TABLE(vp8_rtcd_kernels),
+#endif
+#if CONFIG_VP9
+  KERNEL_TABLE(vp9_rtcd_kernels),
+#endif
+};
+
+class KernelBench : public AbstractBench {
+ public:
+  KernelBench(const RtcdKernel &kernel, int width, int height)
+      : kernel_(kernel), width_(width), height_(height), sink_(0) {
+    highbd_ = strstr(kernel.name, "_highbd_") != nullptr;
+    bit_depth_ = strstr(kernel.name, "_highbd_12_")  ? 12
+                 : strstr(kernel.name, "_highbd_8_") ? 8
+                                                     : 10;
+  }
+
+  // Returns the number of calls needed for one sample to last at least
+  // |min_us| microseconds.
+  int Calibrate(int64_t min_us) {
+    int runs = 1;
+    while (runs < (1 << 24)) {
+      vpx_usec_timer timer;
+      vpx_usec_timer_start(&timer);
+      for (int i = 0; i < runs; ++i) Run();
+      vpx_usec_timer_mark(&timer);
+      if (vpx_usec_timer_elapsed(&timer) >= min_us) break;
+      runs <<= 1;
+    }
+    return runs;
+  }
+
+  const char *kernel() const { return kernel_.name; }
+  const char *isa() const { return kernel_.isa; }
+  int width() const { return width_; }
+  int height() const { return height_; }
+
+ protected:
+  // The uint8_t pointers passed to the high bitdepth kernels that take them
+  // wrap the uint16_t buffers, see CONVERT_TO_BYTEPTR().
+  uint8_t *Pixels(uint8_t *buf8, uint16_t *buf16) const {
+#if CONFIG_VP9_HIGHBITDEPTH
+    if (highbd_) return CONVERT_TO_BYTEPTR(buf16);
+#else
+    (void)buf16;
+#endif
+    return buf8;
+  }
+  uint8_t *Src() const { return Pixels(g_buf->src, g_buf->src16) + kOffset; }
+  uint8_t *Ref() const { return Pixels(g_buf->ref, g_buf->ref16) + kOffset; }
+  uint8_t *Dst() const { return Pixels(g_buf->dst, g_buf->dst16) + kOffset; }
+  // The second predictor of the compound kernels is contiguous.
+  uint8_t *Pred() const { return Pixels(g_buf->dst, g_buf->dst16); }
+
+  const RtcdKernel &kernel_;
+  const int width_;
+  const int height_;
+  bool highbd_;
+  int bit_depth_;
+  // Accumulates return values so that the calls can not be optimized away.
+  int64_t sink_;
+};
+
+template <typename Func>
+class FuncBench : public KernelBench {
+ public:
+  FuncBench(const RtcdKernel &kernel, int width, int height)
+      : KernelBench(kernel, width, height),
+        fn_(reinterpret_cast<Func>(kernel.fn)) {}
+
+ protected:
+  const Func fn_;
+};
+
+typedef unsigned int (*SadFunc)(const uint8_t *src_ptr, int src_stride,
+                                const uint8_t *ref_ptr, int ref_stride);
+class SadBench : public FuncBench<SadFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { sink_ += fn_(Src(), kStride, Ref(), kStride); }
+};
+
+typedef unsigned int (*SadAvgFunc)(const uint8_t *src_ptr, int src_stride,
+                                   const uint8_t *ref_ptr, int ref_stride,
+                                   const uint8_t *second_pred);
+class SadAvgBench : public FuncBench<SadAvgFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { sink_ += fn_(Src(), kStride, Ref(), kStride, Pred()); }
+};
+
+typedef void (*Sad4dFunc)(const uint8_t *src_ptr, int src_stride,
+                          const uint8_t *const ref_array[4], int ref_stride,
+                          uint32_t sad_array[4]);
+class Sad4dBench : public FuncBench<Sad4dFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    const uint8_t *const refs[4] = { Ref(), Ref() + 1, Ref() + kStride,
+                                     Ref() + kStride + 1 };
+    uint32_t sads[4];
+    fn_(Src(), kStride, refs, kStride, sads);
+    sink_ += sads[0] + sads[1] + sads[2] + sads[3];
+  }
+};
+
+typedef unsigned int (*VarianceFunc)(const uint8_t *src_ptr, int src_stride,
+                                     const uint8_t *ref_ptr, int ref_stride,
+                                     unsigned int *sse);
+class VarianceBench : public FuncBench<VarianceFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    unsigned int sse;
+    sink_ += fn_(Src(), kStride, Ref(), kStride, &sse);
+    sink_ += sse;
+  }
+};
+
+typedef uint32_t (*SubpelVarianceFunc)(const uint8_t *src_ptr, int src_stride,
+                                       int x_offset, int y_offset,
+                                       const uint8_t *ref_ptr, int ref_stride,
+                                       uint32_t *sse);
+class SubpelVarianceBench : public FuncBench<SubpelVarianceFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    uint32_t sse;
+    sink_ += fn_(Src(), kStride, 3, 5, Ref(), kStride, &sse);
+    sink_ += sse;
+  }
+};
+
+typedef uint32_t (*SubpelAvgVarianceFunc)(
+    const uint8_t *src_ptr, int src_stride, int x_offset, int y_offset,
+    const uint8_t *ref_ptr, int ref_stride, uint32_t *sse,
+    const uint8_t *second_pred);
+class SubpelAvgVarianceBench : public FuncBench<SubpelAvgVarianceFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    uint32_t sse;
+    sink_ += fn_(Src(), kStride, 3, 5, Ref(), kStride, &sse, Pred());
+    sink_ += sse;
+  }
+};
+
+typedef void (*GetVarFunc)(const uint8_t *src_ptr, int src_stride,
+                           const uint8_t *ref_ptr, int ref_stride,
+                           unsigned int *sse, int *sum);
+class GetVarBench : public FuncBench<GetVarFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    unsigned int sse;
+    int sum;
+    fn_(Src(), kStride, Ref(), kStride, &sse, &sum);
+    sink_ += sse + sum;
+  }
+};
+
+typedef void (*MinMaxFunc)(const uint8_t *s, int p, const uint8_t *d, int dp,
+                           int *min, int *max);
+class MinMaxBench : public FuncBench<MinMaxFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    int min, max;
+    fn_(Src(), kStride, Ref(), kStride, &min, &max);
+    sink_ += min + max;
+  }
+};
+
+typedef int64_t (*SseFunc)(const uint8_t *a, int a_stride, const uint8_t *b,
+                           int b_stride, int width, int height);
+class SseBench : public FuncBench<SseFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    sink_ += fn_(Src(), kStride, Ref(), kStride, width_, height_);
+  }
+};
+
+typedef unsigned int (*AvgFunc)(const uint8_t *, int p);
+class AvgBench : public FuncBench<AvgFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { sink_ += fn_(Src(), kStride); }
+};
+
+typedef unsigned int (*MbSsFunc)(const int16_t *);
+class MbSsBench : public FuncBench<MbSsFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { sink_ += fn_(g_buf->diff); }
+};
+
+typedef void (*IntProRowFunc)(int16_t hbuf[16], const uint8_t *ref,
+                              const int ref_stride, const int height);
+class IntProRowBench : public FuncBench<IntProRowFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    fn_(hbuf_, Ref(), kStride, height_);
+    sink_ += hbuf_[0];
+  }
+  DECLARE_ALIGNED(16, int16_t, hbuf_[16]);
+};
+
+typedef int16_t (*IntProColFunc)(const uint8_t *ref, const int width);
+class IntProColBench : public FuncBench<IntProColFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { sink_ += fn_(Ref(), width_); }
+};
+
+typedef int (*VectorVarFunc)(const int16_t *ref, const int16_t *src,
+                             const int bwl);
+class VectorVarBench : public FuncBench<VectorVarFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    const int bwl = (width_ == 16) ? 2 : (width_ == 32) ? 3 : 4;
+    sink_ += fn_(g_buf->diff, g_buf->diff + kStride, bwl);
+  }
+};
+
+typedef void (*CompAvgFunc)(uint8_t *comp_pred, const uint8_t *pred,
+                            int width, int height, const uint8_t *ref,
+                            int ref_stride);
+class CompAvgBench : public FuncBench<CompAvgFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    fn_(g_buf->dst, g_buf->src, width_, height_, Ref(), kStride);
+  }
+};
+
+typedef void (*IntraPredFunc)(uint8_t *dst, ptrdiff_t stride,
+                              const uint8_t *above, const uint8_t *left);
+class IntraPredBench : public FuncBench<IntraPredFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    fn_(Dst(), kStride, g_buf->edge + 16, g_buf->edge + kStride);
+  }
+};
+
+typedef void (*SubtractFunc)(int rows, int cols, int16_t *diff_ptr,
+                             ptrdiff_t diff_stride, const uint8_t *src_ptr,
+                             ptrdiff_t src_stride, const uint8_t *pred_ptr,
+                             ptrdiff_t pred_stride);
+class SubtractBench : public FuncBench<SubtractFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    fn_(height_, width_, g_buf->diff, kStride, Src(), kStride, Ref(),
+        kStride);
+  }
+};
+
+typedef uint64_t (*SumSquaresFunc)(const int16_t *src, int stride, int size);
+class SumSquaresBench : public FuncBench<SumSquaresFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    sink_ += static_cast<int64_t>(fn_(g_buf->diff, kStride, width_));
+  }
+};
+
+typedef void (*LoopFilterFunc)(uint8_t *s, int pitch, const uint8_t *blimit,
+                               const uint8_t *limit, const uint8_t *thresh);
+class LoopFilterBench : public FuncBench<LoopFilterFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    fn_(Dst(), kStride, g_buf->blimit, g_buf->limit, g_buf->thresh);
+  }
+};
+
+typedef void (*LoopFilterDualFunc)(uint8_t *s, int pitch,
+                                   const uint8_t *blimit0,
+                                   const uint8_t *limit0,
+                                   const uint8_t *thresh0,
+                                   const uint8_t *blimit1,
+                                   const uint8_t *limit1,
+                                   const uint8_t *thresh1);
+class LoopFilterDualBench : public FuncBench<LoopFilterDualFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    fn_(Dst(), kStride, g_buf->blimit, g_buf->limit, g_buf->thresh,
+        g_buf->blimit, g_buf->limit, g_buf->thresh);
+  }
+};
+
+typedef void (*InvTxfmFunc)(const tran_low_t *input, uint8_t *dest,
+                            int stride);
+class InvTxfmBench : public FuncBench<InvTxfmFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { fn_(g_buf->coeff, Dst(), kStride); }
+};
+
+#if CONFIG_VP9
+typedef void (*InvHtFunc)(const tran_low_t *input, uint8_t *dest, int stride,
+                          int tx_type);
+class InvHtBench : public FuncBench<InvHtFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { fn_(g_buf->coeff, Dst(), kStride, ADST_ADST); }
+};
+
+typedef void (*ConvolveFunc)(const uint8_t *src, ptrdiff_t src_stride,
+                             uint8_t *dst, ptrdiff_t dst_stride,
+                             const InterpKernel *filter, int x0_q4,
+                             int x_step_q4, int y0_q4, int y_step_q4, int w,
+                             int h);
+class ConvolveBench : public FuncBench<ConvolveFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    // Use a non-zero sub-pixel phase in both directions so that the
+    // SIMD versions take their filtering path.
+    fn_(Src(), kStride, Dst(), kStride, vp9_filter_kernels[EIGHTTAP], 5, 16,
+        11, 16, width_, height_);
+  }
+};
+#endif  // CONFIG_VP9
+
+#if CONFIG_VP9_ENCODER
+typedef void (*FwdTxfmFunc)(const int16_t *input, tran_low_t *output,
+                            int stride);
+class FwdTxfmBench : public FuncBench<FwdTxfmFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { fn_(g_buf->diff, g_buf->out, kStride); }
+};
+
+typedef void (*FwdHtFunc)(const int16_t *input, tran_low_t *output,
+                          int stride, int tx_type);
+class FwdHtBench : public FuncBench<FwdHtFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { fn_(g_buf->diff, g_buf->out, kStride, ADST_ADST); }
+};
+
+typedef void (*HadamardFunc)(const int16_t *src_diff, ptrdiff_t src_stride,
+                             tran_low_t *coeff);
+class HadamardBench : public FuncBench<HadamardFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { fn_(g_buf->diff, kStride, g_buf->out); }
+};
+
+typedef int (*SatdFunc)(const tran_low_t *coeff, int length);
+class SatdBench : public FuncBench<SatdFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { sink_ += fn_(g_buf->coeff, width_ * height_); }
+};
+
+// Quantizer values for a mid-range qindex at 8-bit.
+class QuantizeParams {
+ public:
+  QuantizeParams() {
+    for (int i = 0; i < 8; ++i) {
+      const int q = (i == 0) ? 38 : 44;
+      zbin_[i] = (q * 84 + 64) >> 7;
+      round_[i] = (q * 48) >> 7;
+      quant_[i] = (1 << 16) / q;
+      quant_shift_[i] = 1 << 14;
+      dequant_[i] = q;
+    }
+    memset(&plane_, 0, sizeof(plane_));
+    plane_.zbin = zbin_;
+    plane_.round = plane_.round_fp = round_;
+    plane_.quant = plane_.quant_fp = quant_;
+    plane_.quant_shift = quant_shift_;
+  }
+
+  static const ScanOrder *Scan(int width) {
+    const TX_SIZE tx_size = (width == 4)    ? TX_4X4
+                            : (width == 8)  ? TX_8X8
+                            : (width == 16) ? TX_16X16
+                                            : TX_32X32;
+    return &vp9_default_scan_orders[tx_size];
+  }
+
+  struct macroblock_plane plane_;
+  DECLARE_ALIGNED(16, int16_t, zbin_[8]);
+  DECLARE_ALIGNED(16, int16_t, round_[8]);
+  DECLARE_ALIGNED(16, int16_t, quant_[8]);
+  DECLARE_ALIGNED(16, int16_t, quant_shift_[8]);
+  DECLARE_ALIGNED(16, int16_t, dequant_[8]);
+};
+
+typedef void (*QuantizeFunc)(const tran_low_t *coeff_ptr, intptr_t n_coeffs,
+                             const struct macroblock_plane *const mb_plane,
+                             tran_low_t *qcoeff_ptr, tran_low_t *dqcoeff_ptr,
+                             const int16_t *dequant_ptr, uint16_t *eob_ptr,
+                             const struct ScanOrder *const scan_order);
+class QuantizeBench : public FuncBench<QuantizeFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    uint16_t eob;
+    fn_(g_buf->coeff, width_ * height_, &q_.plane_, g_buf->out, g_buf->out2,
+        q_.dequant_, &eob, QuantizeParams::Scan(width_));
+    sink_ += eob;
+  }
+  QuantizeParams q_;
+};
+
+typedef void (*Quantize32x32Func)(
+    const tran_low_t *coeff_ptr, const struct macroblock_plane *const mb_plane,
+    tran_low_t *qcoeff_ptr, tran_low_t *dqcoeff_ptr,
+    const int16_t *dequant_ptr, uint16_t *eob_ptr,
+    const struct ScanOrder *const scan_order);
+class Quantize32x32Bench : public FuncBench<Quantize32x32Func> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    uint16_t eob;
+    fn_(g_buf->coeff, &q_.plane_, g_buf->out, g_buf->out2, q_.dequant_, &eob,
+        QuantizeParams::Scan(width_));
+    sink_ += eob;
+  }
+  QuantizeParams q_;
+};
+
+typedef int64_t (*BlockErrorFunc)(const tran_low_t *coeff,
+                                  const tran_low_t *dqcoeff,
+                                  intptr_t block_size, int64_t *ssz);
+class BlockErrorBench : public FuncBench<BlockErrorFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    int64_t ssz;
+    sink_ += fn_(g_buf->coeff, g_buf->out, width_ * height_, &ssz) + ssz;
+  }
+};
+
+typedef int64_t (*BlockErrorFpFunc)(const tran_low_t *coeff,
+                                    const tran_low_t *dqcoeff,
+                                    int block_size);
+class BlockErrorFpBench : public FuncBench<BlockErrorFpFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    sink_ += fn_(g_buf->coeff, g_buf->out, width_ * height_);
+  }
+};
+#endif  // CONFIG_VP9_ENCODER
+
+#if CONFIG_VP9_HIGHBITDEPTH
+typedef void (*HighbdCompAvgFunc)(uint16_t *comp_pred, const uint16_t *pred,
+                                  int width, int height, const uint16_t *ref,
+                                  int ref_stride);
+class HighbdCompAvgBench : public FuncBench<HighbdCompAvgFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    fn_(g_buf->dst16, g_buf->src16, width_, height_, g_buf->ref16 + kOffset,
+        kStride);
+  }
+};
+
+typedef void (*HighbdIntraPredFunc)(uint16_t *dst, ptrdiff_t stride,
+                                    const uint16_t *above,
+                                    const uint16_t *left, int bd);
+class HighbdIntraPredBench : public FuncBench<HighbdIntraPredFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    fn_(g_buf->dst16 + kOffset, kStride, g_buf->edge16 + 16,
+        g_buf->edge16 + kStride, bit_depth_);
+  }
+};
+
+typedef void (*HighbdSubtractFunc)(int rows, int cols, int16_t *diff_ptr,
+                                   ptrdiff_t diff_stride,
+                                   const uint8_t *src_ptr,
+                                   ptrdiff_t src_stride,
+                                   const uint8_t *pred_ptr,
+                                   ptrdiff_t pred_stride, int bd);
+class HighbdSubtractBench : public FuncBench<HighbdSubtractFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    fn_(height_, width_, g_buf->diff, kStride, Src(), kStride, Ref(), kStride,
+        bit_depth_);
+  }
+};
+
+typedef void (*HighbdLoopFilterFunc)(uint16_t *s, int pitch,
+                                     const uint8_t *blimit,
+                                     const uint8_t *limit,
+                                     const uint8_t *thresh, int bd);
+class HighbdLoopFilterBench : public FuncBench<HighbdLoopFilterFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    fn_(g_buf->dst16 + kOffset, kStride, g_buf->blimit, g_buf->limit,
+        g_buf->thresh, bit_depth_);
+  }
+};
+
+typedef void (*HighbdLoopFilterDualFunc)(
+    uint16_t *s, int pitch, const uint8_t *blimit0, const uint8_t *limit0,
+    const uint8_t *thresh0, const uint8_t *blimit1, const uint8_t *limit1,
+    const uint8_t *thresh1, int bd);
+class HighbdLoopFilterDualBench : public FuncBench<HighbdLoopFilterDualFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    fn_(g_buf->dst16 + kOffset, kStride, g_buf->blimit, g_buf->limit,
+        g_buf->thresh, g_buf->blimit, g_buf->limit, g_buf->thresh,
+        bit_depth_);
+  }
+};
+
+typedef void (*HighbdInvTxfmFunc)(const tran_low_t *input, uint16_t *dest,
+                                  int stride, int bd);
+class HighbdInvTxfmBench : public FuncBench<HighbdInvTxfmFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    fn_(g_buf->coeff, g_buf->dst16 + kOffset, kStride, bit_depth_);
+  }
+};
+
+#if CONFIG_VP9
+typedef void (*HighbdInvHtFunc)(const tran_low_t *input, uint16_t *dest,
+                                int stride, int tx_type, int bd);
+class HighbdInvHtBench : public FuncBench<HighbdInvHtFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    fn_(g_buf->coeff, g_buf->dst16 + kOffset, kStride, ADST_ADST, bit_depth_);
+  }
+};
+
+typedef void (*HighbdConvolveFunc)(const uint16_t *src, ptrdiff_t src_stride,
+                                   uint16_t *dst, ptrdiff_t dst_stride,
+                                   const InterpKernel *filter, int x0_q4,
+                                   int x_step_q4, int y0_q4, int y_step_q4,
+                                   int w, int h, int bd);
+class HighbdConvolveBench : public FuncBench<HighbdConvolveFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    fn_(g_buf->src16 + kOffset, kStride, g_buf->dst16 + kOffset, kStride,
+        vp9_filter_kernels[EIGHTTAP], 5, 16, 11, 16, width_, height_,
+        bit_depth_);
+  }
+};
+#endif  // CONFIG_VP9
+
+#if CONFIG_VP9_ENCODER
+typedef int64_t (*HighbdBlockErrorFunc)(const tran_low_t *coeff,
+                                        const tran_low_t *dqcoeff,
+                                        intptr_t block_size, int64_t *ssz,
+                                        int bd);
+class HighbdBlockErrorBench : public FuncBench<HighbdBlockErrorFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    int64_t ssz;
+    sink_ += fn_(g_buf->coeff, g_buf->out, width_ * height_, &ssz,
+                 bit_depth_) +
+             ssz;
+  }
+};
+#endif  // CONFIG_VP9_ENCODER
+#endif  // CONFIG_VP9_HIGHBITDEPTH
+
+#if CONFIG_VP8
+typedef void (*Vp8PredictFunc)(unsigned char *src_ptr, int src_pixels_per_line,
+                               int xoffset, int yoffset,
+                               unsigned char *dst_ptr, int dst_pitch);
+class Vp8PredictBench : public FuncBench<Vp8PredictFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { fn_(Src(), kStride, 3, 5, Dst(), kStride); }
+};
+
+typedef void (*Vp8IdctFunc)(short *input, unsigned char *pred_ptr,
+                            int pred_stride, unsigned char *dst_ptr,
+                            int dst_stride);
+class Vp8IdctBench : public FuncBench<Vp8IdctFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { fn_(g_buf->diff, Ref(), kStride, Dst(), kStride); }
+};
+
+typedef void (*Vp8CopyFunc)(unsigned char *src, int src_stride,
+                            unsigned char *dst, int dst_stride);
+class Vp8CopyBench : public FuncBench<Vp8CopyFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { fn_(Src(), kStride, Dst(), kStride); }
+};
+
+typedef void (*Vp8LoopFilterSimpleFunc)(unsigned char *y_ptr, int y_stride,
+                                        const unsigned char *blimit);
+class Vp8LoopFilterSimpleBench : public FuncBench<Vp8LoopFilterSimpleFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { fn_(Dst(), kStride, g_buf->blimit); }
+};
+
+// The VP8 forward transforms take the pitch of their input in bytes.
+typedef void (*Vp8FdctFunc)(short *input, short *output, int pitch);
+class Vp8FdctBench : public FuncBench<Vp8FdctFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    fn_(g_buf->diff, output_, kStride * static_cast<int>(sizeof(short)));
+  }
+  DECLARE_ALIGNED(16, short, output_[32]);
+};
+
+typedef void (*Vp8InvWalshFunc)(short *input, short *mb_dqcoeff);
+class Vp8InvWalshBench : public FuncBench<Vp8InvWalshFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { fn_(g_buf->diff, mb_dqcoeff_); }
+  DECLARE_ALIGNED(16, short, mb_dqcoeff_[256]);
+};
+
+typedef int (*Vp8BlockErrorFunc)(short *coeff, short *dqcoeff);
+class Vp8BlockErrorBench : public FuncBench<Vp8BlockErrorFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { sink_ += fn_(g_buf->diff, g_buf->diff + kStride); }
+};
+
+typedef void (*Vp8CopyNFunc)(const unsigned char *src_ptr, int src_stride,
+                             unsigned char *dst_ptr, int dst_stride,
+                             int height);
+class Vp8CopyNBench : public FuncBench<Vp8CopyNFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { fn_(Src(), kStride, Dst(), kStride, height_); }
+};
+
+typedef void (*Vp8DcOnlyIdctFunc)(short input_dc, unsigned char *pred_ptr,
+                                  int pred_stride, unsigned char *dst_ptr,
+                                  int dst_stride);
+class Vp8DcOnlyIdctBench : public FuncBench<Vp8DcOnlyIdctFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override { fn_(g_buf->diff[0], Ref(), kStride, Dst(), kStride); }
+};
+
+// vp8_dequant_idct_add() clears its input, so all but the first call of a
+// sample run on zero coefficients.
+typedef void (*Vp8DequantIdctFunc)(short *input, short *dq,
+                                   unsigned char *dest, int stride);
+class Vp8DequantIdctBench : public FuncBench<Vp8DequantIdctFunc> {
+ public:
+  using FuncBench::FuncBench;
+
+ protected:
+  void Run() override {
+    fn_(g_buf->diff, g_buf->diff + kStride, Dst(), kStride);
+  }
+};
+#endif  // CONFIG_VP8
+
+typedef KernelBench *(*BenchFactory)(const RtcdKernel &kernel, int width,
+                                     int height);
+
+template <typename Bench>
+KernelBench *CreateBench(const RtcdKernel &kernel, int width, int height) {
+  return new Bench(kernel, width, height);
+}
+
+// Maps a prototype from the kernel tables to the benchmark that calls it.
+// Kernels without the block size in their name, e.g. vpx_subtract_block, are
+// run at each of the square |sizes|.
+struct BenchFamily {
+  const char *prototype;
+  BenchFactory create;
+  int sizes[4];
+};
+
+const BenchFamily kBenchFamilies[] = {
+  { "unsigned int(const uint8_t*,int,const uint8_t*,int)",
+    CreateBench<SadBench>, { 16 } },
+  { "unsigned int(const unsigned char*,int,const unsigned char*,int)",
+    CreateBench<SadBench>, { 4 } },
+  { "unsigned int(const uint8_t*,int,const uint8_t*,int,const uint8_t*)",
+    CreateBench<SadAvgBench>, { 16 } },
+  { "void(const uint8_t*,int,const uint8_t*const[],int,uint32_t[])",
+    CreateBench<Sad4dBench>, { 16 } },
+  { "unsigned int(const uint8_t*,int,const uint8_t*,int,unsigned int*)",
+    CreateBench<VarianceBench>, { 16 } },
+  { "uint32_t(const uint8_t*,int,int,int,const uint8_t*,int,uint32_t*)",
+    CreateBench<SubpelVarianceBench>, { 16 } },
+  { "uint32_t(const uint8_t*,int,int,int,const uint8_t*,int,uint32_t*,"
+    "const uint8_t*)",
+    CreateBench<SubpelAvgVarianceBench>, { 16 } },
+  { "void(const uint8_t*,int,const uint8_t*,int,unsigned int*,int*)",
+    CreateBench<GetVarBench>, { 16 } },
+  { "void(const uint8_t*,int,const uint8_t*,int,int*,int*)",
+    CreateBench<MinMaxBench>, { 8 } },
+  { "int64_t(const uint8_t*,int,const uint8_t*,int,int,int)",
+    CreateBench<SseBench>, { 16, 64 } },
+  { "unsigned int(const uint8_t*,int)", CreateBench<AvgBench>, { 8 } },
+  { "unsigned int(const int16_t*)", CreateBench<MbSsBench>, { 16 } },
+  { "void(int16_t[],const uint8_t*,const int,const int)",
+    CreateBench<IntProRowBench>, { 16, 32, 64 } },
+  { "int16_t(const uint8_t*,const int)", CreateBench<IntProColBench>,
+    { 16, 32, 64 } },
+  { "int(const int16_t*,const int16_t*,const int)",
+    CreateBench<VectorVarBench>, { 16, 32, 64 } },
+  { "void(uint8_t*,const uint8_t*,int,int,const uint8_t*,int)",
+    CreateBench<CompAvgBench>, { 16, 64 } },
+  { "void(uint8_t*,ptrdiff_t,const uint8_t*,const uint8_t*)",
+    CreateBench<IntraPredBench>, { 4 } },
+  { "void(int,int,int16_t*,ptrdiff_t,const uint8_t*,ptrdiff_t,const uint8_t*,"
+    "ptrdiff_t)",
+    CreateBench<SubtractBench>, { 4, 16, 64 } },
+  { "uint64_t(const int16_t*,int,int)", CreateBench<SumSquaresBench>,
+    { 8, 64 } },
+  { "void(uint8_t*,int,const uint8_t*,const uint8_t*,const uint8_t*)",
+    CreateBench<LoopFilterBench>, { 8 } },
+  { "void(uint8_t*,int,const uint8_t*,const uint8_t*,const uint8_t*,"
+    "const uint8_t*,const uint8_t*,const uint8_t*)",
+    CreateBench<LoopFilterDualBench>, { 8 } },
+  { "void(const tran_low_t*,uint8_t*,int)", CreateBench<InvTxfmBench>,
+    { 4 } },
+#if CONFIG_VP9
+  { "void(const tran_low_t*,uint8_t*,int,int)", CreateBench<InvHtBench>,
+    { 4 } },
+  { "void(const uint8_t*,ptrdiff_t,uint8_t*,ptrdiff_t,const InterpKernel*,"
+    "int,int,int,int,int,int)",
+    CreateBench<ConvolveBench>, { 8, 16, 64 } },
+#endif
+#if CONFIG_VP9_ENCODER
+  { "void(const int16_t*,tran_low_t*,int)", CreateBench<FwdTxfmBench>,
+    { 4 } },
+  { "void(const int16_t*,tran_low_t*,int,int)", CreateBench<FwdHtBench>,
+    { 4 } },
+  { "void(const int16_t*,ptrdiff_t,tran_low_t*)", CreateBench<HadamardBench>,
+    { 8 } },
+  { "int(const tran_low_t*,int)", CreateBench<SatdBench>, { 16, 32 } },
+  { "void(const tran_low_t*,intptr_t,const struct macroblock_plane*const,"
+    "tran_low_t*,tran_low_t*,const int16_t*,uint16_t*,"
+    "const struct ScanOrder*const)",
+    CreateBench<QuantizeBench>, { 16 } },
+  { "void(const tran_low_t*,const struct macroblock_plane*const,tran_low_t*,"
+    "tran_low_t*,const int16_t*,uint16_t*,const struct ScanOrder*const)",
+    CreateBench<Quantize32x32Bench>, { 32 } },
+  { "int64_t(const tran_low_t*,const tran_low_t*,intptr_t,int64_t*)",
+    CreateBench<BlockErrorBench>, { 16, 32 } },
+  { "int64_t(const tran_low_t*,const tran_low_t*,int)",
+    CreateBench<BlockErrorFpBench>, { 16, 32 } },
+#endif
+#if CONFIG_VP9_HIGHBITDEPTH
+  { "void(uint16_t*,const uint16_t*,int,int,const uint16_t*,int)",
+    CreateBench<HighbdCompAvgBench>, { 16, 64 } },
+  { "void(uint16_t*,ptrdiff_t,const uint16_t*,const uint16_t*,int)",
+    CreateBench<HighbdIntraPredBench>, { 4 } },
+  { "void(int,int,int16_t*,ptrdiff_t,const uint8_t*,ptrdiff_t,const uint8_t*,"
+    "ptrdiff_t,int)",
+    CreateBench<HighbdSubtractBench>, { 4, 16, 64 } },
+  { "void(uint16_t*,int,const uint8_t*,const uint8_t*,const uint8_t*,int)",
+    CreateBench<HighbdLoopFilterBench>, { 8 } },
+  { "void(uint16_t*,int,const uint8_t*,const uint8_t*,const uint8_t*,"
+    "const uint8_t*,const uint8_t*,const uint8_t*,int)",
+    CreateBench<HighbdLoopFilterDualBench>, { 8 } },
+  { "void(const tran_low_t*,uint16_t*,int,int)",
+    CreateBench<HighbdInvTxfmBench>, { 4 } },
+#if CONFIG_VP9
+  { "void(const tran_low_t*,uint16_t*,int,int,int)",
+    CreateBench<HighbdInvHtBench>, { 4 } },
+  { "void(const uint16_t*,ptrdiff_t,uint16_t*,ptrdiff_t,const InterpKernel*,"
+    "int,int,int,int,int,int,int)",
+    CreateBench<HighbdConvolveBench>, { 8, 16, 64 } },
+#endif
+#if CONFIG_VP9_ENCODER
+  { "int64_t(const tran_low_t*,const tran_low_t*,intptr_t,int64_t*,int)",
+    CreateBench<HighbdBlockErrorBench>, { 16, 32 } },
+#endif
+#endif  // CONFIG_VP9_HIGHBITDEPTH
+#if CONFIG_VP8
+  { "void(unsigned char*,int,int,int,unsigned char*,int)",
+    CreateBench<Vp8PredictBench>, { 16 } },
+  { "void(short*,unsigned char*,int,unsigned char*,int)",
+    CreateBench<Vp8IdctBench>, { 4 } },
+  { "void(unsigned char*,int,unsigned char*,int)", CreateBench<Vp8CopyBench>,
+    { 16 } },
+  { "void(unsigned char*,int,const unsigned char*)",
+    CreateBench<Vp8LoopFilterSimpleBench>, { 16 } },
+  { "void(short*,short*,int)", CreateBench<Vp8FdctBench>, { 4 } },
+  { "void(short*,short*)", CreateBench<Vp8InvWalshBench>, { 4 } },
+  { "int(short*,short*)", CreateBench<Vp8BlockErrorBench>, { 4 } },
+  { "void(const unsigned char*,int,unsigned char*,int,int)",
+    CreateBench<Vp8CopyNBench>, { 32 } },
+  { "void(short,unsigned char*,int,unsigned char*,int)",
+    CreateBench<Vp8DcOnlyIdctBench>, { 4 } },
+  { "void(short*,short*,unsigned char*,int)",
+    CreateBench<Vp8DequantIdctBench>, { 4 } },
+#endif
+};
+
+const BenchFamily *FindBenchFamily(const char *prototype) {
+  for (const BenchFamily &family : kBenchFamilies) {
+    if (!strcmp(family.prototype, prototype)) return &family;
+  }
+  return nullptr;
+}
+
+// Finds the first "<width>x<height>" in a kernel name, e.g. 16x8 in
+// vpx_highbd_10_sub_pixel_variance16x8.
+bool ParseBlockSize(const char *name, int *width, int *height) {
+  for (const char *p = name; *p != '\0'; ++p) {
+    if (!isdigit(static_cast<unsigned char>(*p))) continue;
+    if (p > name && isdigit(static_cast<unsigned char>(p[-1]))) continue;
+    char *end;
+    const long w = strtol(p, &end, 10);
+    if (*end != 'x' || !isdigit(static_cast<unsigned char>(end[1]))) continue;
+    *width = static_cast<int>(w);
+    *height = static_cast<int>(strtol(end + 1, nullptr, 10));
+    return true;
+  }
+  return false;
+}
+
+typedef std::vector<std::unique_ptr<KernelBench> > BenchList;
+
+// Creates the benchmarks of every kernel in the tables. The kernels whose
+// prototype has no benchmark are returned in |unsupported|.
+void RegisterKernels(BenchList *list,
+                     std::vector<const RtcdKernel *> *unsupported) {
+  for (const KernelTable &table : kKernelTables) {
+    for (size_t i = 0; i < table.count; ++i) {
+      const RtcdKernel &kernel = table.kernels[i];
+      const BenchFamily *const family = FindBenchFamily(kernel.prototype);
+      if (family == nullptr) {
+        unsupported->push_back(&kernel);
+        continue;
+      }
+      int width, height;
+      if (ParseBlockSize(kernel.name, &width, &height)) {
+        list->emplace_back(family->create(kernel, width, height));
+        continue;
+      }
+      for (int j = 0; j < 4 && family->sizes[j] != 0; ++j) {
+        const int size = family->sizes[j];
+        list->emplace_back(family->create(kernel, size, size));
+      }
+    }
+  }
+}
+
+struct BaselineEntry {
+  std::string kernel;
+  std::string isa;
+  int width;
+  int height;
+  double ns_per_call;
+};
+
+// Extracts the value of |key| from a single line of our own JSON output.
+bool FindJsonString(const std::string &line, const char *key,
+                    std::string *value) {
+  const std::string needle = std::string("\"") + key + "\": \"";
+  const size_t start = line.find(needle);
+  if (start == std::string::npos) return false;
+  const size_t begin = start + needle.size();
+  const size_t end = line.find('"', begin);
+  if (end == std::string::npos) return false;
+  *value = line.substr(begin, end - begin);
+  return true;
+}
+
+bool FindJsonNumber(const std::string &line, const char *key, double *value) {
+  const std::string needle = std::string("\"") + key + "\": ";
+  const size_t start = line.find(needle);
+  if (start == std::string::npos) return false;
+  *value = strtod(line.c_str() + start + needle.size(), nullptr);
+  return true;
+}
+
+bool ReadBaseline(const char *path, std::vector<BaselineEntry> *entries) {
+  FILE *const f = fopen(path, "r");
+  if (f == nullptr) return false;
+  char buf[1024];
+  while (fgets(buf, sizeof(buf), f) != nullptr) {
+    const std::string line(buf);
+    BaselineEntry e;
+    double w, h;
+    if (FindJsonString(line, "kernel", &e.kernel) &&
+        FindJsonString(line, "isa", &e.isa) &&
+        FindJsonNumber(line, "width", &w) &&
+        FindJsonNumber(line, "height", &h) &&
+        FindJsonNumber(line, "ns_per_call", &e.ns_per_call)) {
+      e.width = static_cast<int>(w);
+      e.height = static_cast<int>(h);
+      entries->push_back(e);
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+const BaselineEntry *FindBaseline(const std::vector<BaselineEntry> &entries,
+                                  const KernelBench &bench) {
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const BaselineEntry &e = entries[i];
+    if (e.kernel == bench.kernel() && e.isa == bench.isa() &&
+        e.width == bench.width() && e.height == bench.height()) {
+      return &e;
+    }
+  }
+  return nullptr;
+}
+
+void Usage(const char *exe) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --output=FILE     write JSON results to FILE (default stdout)\n"
+          "  --filter=STR      only run kernels whose name contains STR\n"
+          "  --isa=NAME        only run the NAME instruction set (e.g. c)\n"
+          "  --scale=N         multiply the duration of each sample by N\n"
+          "  --compare=FILE    compare against a previous JSON result\n"
+          "  --threshold=PCT   regression threshold in percent (default 5)\n",
+          exe);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  const char *output = nullptr;
+  const char *filter = nullptr;
+  const char *isa_filter = nullptr;
+  const char *compare = nullptr;
+  int scale = 1;
+  double threshold = 5.0;
+
+  for (int i = 1; i < argc; ++i) {
+    const char *const arg = argv[i];
+    if (!strncmp(arg, "--output=", 9)) {
+      output = arg + 9;
+    } else if (!strncmp(arg, "--filter=", 9)) {
+      filter = arg + 9;
+    } else if (!strncmp(arg, "--isa=", 6)) {
+      isa_filter = arg + 6;
+    } else if (!strncmp(arg, "--scale=", 8)) {
+      scale = VPXMAX(1, atoi(arg + 8));
+    } else if (!strncmp(arg, "--compare=", 10)) {
+      compare = arg + 10;
+    } else if (!strncmp(arg, "--threshold=", 12)) {
+      threshold = atof(arg + 12);
+    } else {
+      Usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<BaselineEntry> baseline;
+  if (compare != nullptr && !ReadBaseline(compare, &baseline)) {
+    fprintf(stderr, "Failed to open baseline %s\n", compare);
+    return EXIT_FAILURE;
+  }
+
+  FILE *out = stdout;
+  if (output != nullptr) {
+    out = fopen(output, "w");
+    if (out == nullptr) {
+      fprintf(stderr, "Failed to open %s for writing\n", output);
+      return EXIT_FAILURE;
+    }
+  }
+
+  vpx_dsp_rtcd();
+  vpx_scale_rtcd();
+#if CONFIG_VP8
+  vp8_rtcd();
+#endif
+#if CONFIG_VP9
+  vp9_rtcd();
+#endif
+
+  BenchList list;
+  std::vector<const RtcdKernel *> unsupported;
+  RegisterKernels(&list, &unsupported);
+
+  int regressions = 0;
+  int first = 1;
+  fprintf(out, "{\n  \"version\": 1,\n  \"results\": [\n");
+  for (size_t i = 0; i < list.size(); ++i) {
+    KernelBench &bench = *list[i];
+    if (filter != nullptr && strstr(bench.kernel(), filter) == nullptr) {
+      continue;
+    }
+    if (isa_filter != nullptr && strcmp(bench.isa(), isa_filter)) continue;
+    if (!IsaSupported(bench.isa())) continue;
+
+    g_buf->Init();
+    const int runs = bench.Calibrate(kMinSampleUs * scale);
+    bench.RunNTimes(runs);
+    double mad_us;
+    const int median_us = bench.GetMedian(&mad_us);
+    const double ns_per_call = median_us * 1000.0 / runs;
+
+    fprintf(out,
+            "%s    {\"kernel\": \"%s\", \"isa\": \"%s\", \"width\": %d, "
+            "\"height\": %d, \"runs\": %d, \"median_us\": %d, "
+            "\"mad_us\": %.1f, \"ns_per_call\": %.3f",
+            first ? "" : ",\n", bench.kernel(), bench.isa(), bench.width(),
+            bench.height(), runs, median_us, mad_us, ns_per_call);
+    first = 0;
+
+    const BaselineEntry *const base = FindBaseline(baseline, bench);
+    if (base != nullptr && base->ns_per_call > 0) {
+      const double change =
+          100.0 * (ns_per_call - base->ns_per_call) / base->ns_per_call;
+      const int regressed = change > threshold;
+      fprintf(out,
+              ", \"baseline_ns_per_call\": %.3f, \"change_pct\": %.1f, "
+              "\"regression\": %s",
+              base->ns_per_call, change, regressed ? "true" : "false");
+      if (regressed) {
+        fprintf(stderr,
+                "REGRESSION %s %s %dx%d: %.3f ns -> %.3f ns (%+.1f%%)\n",
+                bench.kernel(), bench.isa(), bench.width(), bench.height(),
+                base->ns_per_call, ns_per_call, change);
+        ++regressions;
+      }
+    }
+    fprintf(out, "}");
+  }
+  fprintf(out, "\n  ],\n  \"unsupported\": [\n");
+
+  // List the kernels that could not be timed rather than dropping them.
+  int num_unsupported = 0;
+  for (size_t i = 0; i < unsupported.size(); ++i) {
+    const RtcdKernel &kernel = *unsupported[i];
+    if (filter != nullptr && strstr(kernel.name, filter) == nullptr) continue;
+    if (isa_filter != nullptr && strcmp(kernel.isa, isa_filter)) continue;
+    fprintf(out,
+            "%s    {\"kernel\": \"%s\", \"isa\": \"%s\", "
+            "\"prototype\": \"%s\"}",
+            num_unsupported ? ",\n" : "", kernel.name, kernel.isa,
+            kernel.prototype);
+    ++num_unsupported;
+  }
+  fprintf(out, "\n  ]\n}\n");
+  if (out != stdout) fclose(out);
+
+  if (num_unsupported > 0) {
+    fprintf(stderr, "%d kernel(s) without a benchmark for their prototype\n",
+            num_unsupported);
+  }
+  if (compare != nullptr) {
+    fprintf(stderr, "%d regression(s) above %.1f%% against %s\n", regressions,
+            threshold, compare);
+  }
+  return regressions ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -9,11 +9,13 @@
  */
 
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 
 #include "./vpx_config.h"
 #include "./y4menc.h"
+#include "test/acm_random.h"
 #include "test/md5_helper.h"
 #include "test/util.h"
 #include "test/y4m_video_source.h"
@@ -241,4 +243,112 @@ TEST(Y4MHeaderTest, LongHeader) {
   y4m_input_close(&y4m);
 }
 
+// Filters used by the chroma conversions, applied to every step'th pixel with
+// the first tap offset pixels before it.
+static const int kDecimateTaps[6] = { 3, -17, 78, 78, -17, 3 };
+static const int kRightTaps[6] = { 4, -17, 114, 35, -9, 1 };
+static const int kUpTaps[6] = { 1, -9, 35, 114, -17, 4 };
+
+// Straightforward implementation of the conversion filters, replicating the
+// pixels at the edges of the w by h plane.
+static std::vector<uint8_t> FilterPlane(const std::vector<uint8_t> &src, int w,
+                                        int h, const int taps[6], int offset,
+                                        int step, bool horizontal, int *out_w,
+                                        int *out_h) {
+  *out_w = horizontal ? (w + step - 1) / step : w;
+  *out_h = horizontal ? h : (h + step - 1) / step;
+  std::vector<uint8_t> dst(*out_w * *out_h);
+  for (int y = 0; y < *out_h; ++y) {
+    for (int x = 0; x < *out_w; ++x) {
+      int sum = 64;
+      for (int k = 0; k < 6; ++k) {
+        int sx = horizontal ? x * step + k - offset : x;
+        int sy = horizontal ? y : y * step + k - offset;
+        sx = sx < 0 ? 0 : sx > w - 1 ? w - 1 : sx;
+        sy = sy < 0 ? 0 : sy > h - 1 ? h - 1 : sy;
+        sum += taps[k] * src[sy * w + sx];
+      }
+      sum >>= 7;
+      dst[y * *out_w + x] = sum < 0 ? 0 : sum > 255 ? 255 : sum;
+    }
+  }
+  return dst;
+}
+
+// Converts one chroma plane of the given type to 420jpeg.
+static std::vector<uint8_t> ConvertPlane(const std::string &chroma_type,
+                                         int plane, std::vector<uint8_t> src,
+                                         int w, int h) {
+  if (chroma_type == "444") {
+    src = FilterPlane(src, w, h, kDecimateTaps, 2, 2, true, &w, &h);
+  } else if (chroma_type != "422jpeg") {
+    src = FilterPlane(src, w, h, kRightTaps, 2, 1, true, &w, &h);
+  }
+  if (chroma_type == "420paldv") {
+    return plane == 1 ? FilterPlane(src, w, h, kUpTaps, 3, 1, false, &w, &h)
+                      : FilterPlane(src, w, h, kRightTaps, 2, 1, false, &w, &h);
+  }
+  return FilterPlane(src, w, h, kDecimateTaps, 2, 2, false, &w, &h);
+}
+
+// Checks the conversions of 8-bit input to 420jpeg against the reference
+// filters above, for sizes covering both the vectorized and the edge paths.
+TEST(Y4MConversionTest, MatchesReference) {
+  libvpx_test::ACMRandom rnd(libvpx_test::ACMRandom::DeterministicSeed());
+  const char *const kChromaTypes[] = { "422jpeg", "422", "444", "420paldv" };
+  const int kSizes[][2] = { { 1, 1 },  { 2, 3 },  { 5, 4 },   { 7, 9 },
+                            { 16, 6 }, { 33, 5 }, { 37, 17 }, { 64, 8 },
+                            { 77, 11 } };
+  for (const char *chroma_type : kChromaTypes) {
+    const std::string type = chroma_type;
+    for (const auto &size : kSizes) {
+      const int w = size[0];
+      const int h = size[1];
+      const int c_w = type == "444" ? w : (w + 1) / 2;
+      const int c_h = type == "420paldv" ? (h + 1) / 2 : h;
+      std::vector<uint8_t> planes[3];
+      planes[0].resize(w * h);
+      planes[1].resize(c_w * c_h);
+      planes[2].resize(c_w * c_h);
+      libvpx_test::TempOutFile f;
+      ASSERT_NE(f.file(), nullptr);
+      fprintf(f.file(), "YUV4MPEG2 W%d H%d F30:1 Ip A1:1 C%s\nFRAME\n", w, h,
+              chroma_type);
+      for (auto &plane : planes) {
+        // Mix in extreme values to exercise the clamping.
+        for (auto &pixel : plane) {
+          pixel = rnd(4) == 0 ? rnd.Rand8Extremes() : rnd.Rand8();
+        }
+        fwrite(plane.data(), 1, plane.size(), f.file());
+      }
+      fflush(f.file());
+      EXPECT_EQ(fseek(f.file(), 0, 0), 0);
+
+      y4m_input y4m;
+      ASSERT_EQ(y4m_input_open(&y4m, f.file(), /*skip_buffer=*/nullptr,
+                               /*num_skip=*/0, /*only_420=*/1),
+                0);
+      vpx_image_t img;
+      memset(&img, 0, sizeof(img));
+      ASSERT_EQ(y4m_input_fetch_frame(&y4m, f.file(), &img), 1);
+      for (int plane = 1; plane < 3; ++plane) {
+        const std::vector<uint8_t> expected =
+            ConvertPlane(type, plane, planes[plane], c_w, c_h);
+        const int dst_w = (w + 1) / 2;
+        const int dst_h = (h + 1) / 2;
+        ASSERT_EQ(expected.size(), static_cast<size_t>(dst_w * dst_h));
+        for (int y = 0; y < dst_h; ++y) {
+          for (int x = 0; x < dst_w; ++x) {
+            ASSERT_EQ(img.planes[plane][y * img.stride[plane] + x],
+                      expected[y * dst_w + x])
+                << type << " " << w << "x" << h << " plane " << plane
+                << " at (" << x << ", " << y << ")";
+          }
+        }
+      }
+      y4m_input_close(&y4m);
+    }
+  }
+}
+
 }  // namespace
@@ -0,0 +1,106 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "./tool_worker.h"
+
+#include <string.h>
+
+#if CONFIG_MULTITHREAD
+static THREADFN tool_worker_loop(void *arg) {
+  ToolWorker *const worker = (ToolWorker *)arg;
+
+  pthread_mutex_lock(&worker->mutex);
+  for (;;) {
+    while (!worker->busy && !worker->quit)
+      pthread_cond_wait(&worker->cond, &worker->mutex);
+    if (!worker->busy) break;
+    pthread_mutex_unlock(&worker->mutex);
+    tool_worker_execute(worker);
+    pthread_mutex_lock(&worker->mutex);
+    worker->busy = 0;
+    pthread_cond_signal(&worker->cond);
+  }
+  pthread_mutex_unlock(&worker->mutex);
+  return THREAD_EXIT_SUCCESS;
+}
+#endif  // CONFIG_MULTITHREAD
+
+void tool_worker_init(ToolWorker *worker) {
+  memset(worker, 0, sizeof(*worker));
+}
+
+int tool_worker_start(ToolWorker *worker) {
+#if CONFIG_MULTITHREAD
+  if (worker->started) return 1;
+  if (pthread_mutex_init(&worker->mutex, NULL)) return 0;
+  if (pthread_cond_init(&worker->cond, NULL)) {
+    pthread_mutex_destroy(&worker->mutex);
+    return 0;
+  }
+  worker->busy = 0;
+  worker->quit = 0;
+  if (pthread_create(&worker->thread, NULL, tool_worker_loop, worker)) {
+    pthread_cond_destroy(&worker->cond);
+    pthread_mutex_destroy(&worker->mutex);
+    return 0;
+  }
+  worker->started = 1;
+  return 1;
+#else
+  (void)worker;
+  return 1;
+#endif
+}
+
+void tool_worker_launch(ToolWorker *worker) {
+#if CONFIG_MULTITHREAD
+  if (worker->started) {
+    pthread_mutex_lock(&worker->mutex);
+    worker->busy = 1;
+    pthread_cond_signal(&worker->cond);
+    pthread_mutex_unlock(&worker->mutex);
+    return;
+  }
+#endif
+  tool_worker_execute(worker);
+}
+
+void tool_worker_execute(ToolWorker *worker) {
+  if (worker->hook != NULL && !worker->hook(worker->data1, worker->data2))
+    worker->had_error = 1;
+}
+
+int tool_worker_sync(ToolWorker *worker) {
+#if CONFIG_MULTITHREAD
+  if (worker->started) {
+    pthread_mutex_lock(&worker->mutex);
+    while (worker->busy) pthread_cond_wait(&worker->cond, &worker->mutex);
+    pthread_mutex_unlock(&worker->mutex);
+  }
+#endif
+  return !worker->had_error;
+}
+
+void tool_worker_end(ToolWorker *worker) {
+#if CONFIG_MULTITHREAD
+  if (!worker->started) return;
+  pthread_mutex_lock(&worker->mutex);
+  while (worker->busy) pthread_cond_wait(&worker->cond, &worker->mutex);
+  worker->quit = 1;
+  pthread_cond_signal(&worker->cond);
+  pthread_mutex_unlock(&worker->mutex);
+  pthread_join(worker->thread, NULL);
+  pthread_cond_destroy(&worker->cond);
+  pthread_mutex_destroy(&worker->mutex);
+  worker->started = 0;
+#else
+  (void)worker;
+#endif
+}
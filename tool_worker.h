@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VPX_TOOL_WORKER_H_
+#define VPX_TOOL_WORKER_H_
+
+#include "./vpx_config.h"
+#include "vpx_util/vpx_pthread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Runs one job at a time on a thread of its own, so that a tool can overlap
+ * its file I/O with the codec calls. This is a local copy of the launch/sync
+ * model of vpx_util/vpx_thread.h: the libvpx worker is internal to the
+ * library and is not exported from shared builds. Without CONFIG_MULTITHREAD
+ * the jobs run inline.
+ */
+typedef int (*ToolWorkerHook)(void *data1, void *data2);
+
+typedef struct ToolWorker {
+  ToolWorkerHook hook;
+  void *data1;
+  void *data2;
+  int had_error;  // set when a call to |hook| returned 0
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  pthread_t thread;
+  int started;
+  int busy;
+  int quit;
+#endif
+} ToolWorker;
+
+void tool_worker_init(ToolWorker *worker);
+
+/* Starts the thread. Returns 0 if it could not be created. */
+int tool_worker_start(ToolWorker *worker);
+
+/* Runs |hook| with |data1| and |data2| on the thread. These must not change
+ * until the next tool_worker_sync().
+ */
+void tool_worker_launch(ToolWorker *worker);
+
+/* Runs |hook| on the calling thread. */
+void tool_worker_execute(ToolWorker *worker);
+
+/* Waits for the job to finish. Returns 0 if any job has failed. */
+int tool_worker_sync(ToolWorker *worker);
+
+/* Waits for the job to finish and stops the thread. */
+void tool_worker_end(ToolWorker *worker);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VPX_TOOL_WORKER_H_
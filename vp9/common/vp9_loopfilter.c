@@ -849,9 +849,9 @@ void vp9_adjust_mask(VP9_COMMON *const cm, const int mi_row, const int mi_col,
       lfm->left_uv[TX_16X16] &= ~(lfm->left_uv[TX_16X16] & 0xcccc);
     }
   }
-  // We don't apply a loop filter on the first column in the image, mask that
-  // out.
-  if (mi_col == 0) {
+  // We don't apply a loop filter on the first column in the image, or of the
+  // decoded columns, mask that out.
+  if (mi_col == 0 || mi_col == cm->lf.mi_col_start) {
     for (i = 0; i < TX_32X32; i++) {
       lfm->left_y[i] &= 0xfefefefefefefefeULL;
       lfm->left_uv[i] &= 0xeeee;
@@ -1178,7 +1178,7 @@ void vp9_filter_block_plane_non420(VP9_COMMON *cm,
     }
 
     // Disable filtering on the leftmost column
-    border_mask = ~(mi_col == 0 ? 1u : 0u);
+    border_mask = ~(mi_col == 0 || mi_col == cm->lf.mi_col_start ? 1u : 0u);
 #if CONFIG_VP9_HIGHBITDEPTH
     if (cm->use_highbitdepth) {
       highbd_filter_selectively_vert(
@@ -1423,6 +1423,8 @@ static void loop_filter_rows(YV12_BUFFER_CONFIG *frame_buffer, VP9_COMMON *cm,
                              struct macroblockd_plane planes[MAX_MB_PLANE],
                              int start, int stop, int y_only) {
   const int num_planes = y_only ? 1 : MAX_MB_PLANE;
+  const int col_start = cm->lf.mi_col_end ? cm->lf.mi_col_start : 0;
+  const int col_end = cm->lf.mi_col_end ? cm->lf.mi_col_end : cm->mi_cols;
   enum lf_path path;
   int mi_row, mi_col;
 
@@ -1437,9 +1439,9 @@ static void loop_filter_rows(YV12_BUFFER_CONFIG *frame_buffer, VP9_COMMON *cm,
 
   for (mi_row = start; mi_row < stop; mi_row += MI_BLOCK_SIZE) {
     MODE_INFO **mi = cm->mi_grid_visible + mi_row * cm->mi_stride;
-    LOOP_FILTER_MASK *lfm = get_lfm(&cm->lf, mi_row, 0);
+    LOOP_FILTER_MASK *lfm = get_lfm(&cm->lf, mi_row, col_start);
 
-    for (mi_col = 0; mi_col < cm->mi_cols; mi_col += MI_BLOCK_SIZE, ++lfm) {
+    for (mi_col = col_start; mi_col < col_end; mi_col += MI_BLOCK_SIZE, ++lfm) {
       int plane;
 
       vp9_setup_dst_planes(planes, frame_buffer, mi_row, mi_col);
@@ -87,6 +87,12 @@ struct loopfilter {
 
   LOOP_FILTER_MASK *lfm;
   int lfm_stride;
+
+  // When mi_col_end is non-zero only the columns [mi_col_start, mi_col_end)
+  // are filtered, and not across their left edge. Set by the decoder when it
+  // reconstructs only part of the frame.
+  int mi_col_start;
+  int mi_col_end;
 };
 
 /* assorted loopfilter functions which get used elsewhere */
@@ -14,6 +14,7 @@
 #include "vpx_dsp/vpx_dsp_common.h"
 #include "vpx_mem/vpx_mem.h"
 #include "vpx_util/vpx_pthread.h"
+#include "vpx_util/vpx_trace.h"
 #include "vp9/common/vp9_entropymode.h"
 #include "vp9/common/vp9_thread_common.h"
 #include "vp9/common/vp9_reconinter.h"
@@ -44,8 +45,12 @@ static INLINE void sync_read(VP9LfSync *const lf_sync, int r, int c) {
     pthread_mutex_t *const mutex = &lf_sync->mutex[r - 1];
     mutex_lock(mutex);
 
-    while (c > lf_sync->cur_sb_col[r - 1] - nsync) {
-      pthread_cond_wait(&lf_sync->cond[r - 1], mutex);
+    if (c > lf_sync->cur_sb_col[r - 1] - nsync) {
+      VPX_TRACE_BEGIN("lf_row_sync_wait", r);
+      while (c > lf_sync->cur_sb_col[r - 1] - nsync) {
+        pthread_cond_wait(&lf_sync->cond[r - 1], mutex);
+      }
+      VPX_TRACE_END("lf_row_sync_wait");
     }
     pthread_mutex_unlock(mutex);
   }
@@ -95,6 +100,8 @@ static INLINE void thread_loop_filter_rows(
   const int num_planes = y_only ? 1 : MAX_MB_PLANE;
   const int sb_cols = mi_cols_aligned_to_sb(cm->mi_cols) >> MI_BLOCK_SIZE_LOG2;
   const int num_active_workers = lf_sync->num_active_workers;
+  const int col_start = cm->lf.mi_col_end ? cm->lf.mi_col_start : 0;
+  const int col_end = cm->lf.mi_col_end ? cm->lf.mi_col_end : cm->mi_cols;
   int mi_row, mi_col;
   enum lf_path path;
   if (y_only)
@@ -113,6 +120,7 @@ static INLINE void thread_loop_filter_rows(
     MODE_INFO **const mi = cm->mi_grid_visible + mi_row * cm->mi_stride;
     LOOP_FILTER_MASK *lfm = get_lfm(&cm->lf, mi_row, 0);
 
+    VPX_TRACE_BEGIN("loop_filter_sb_row", mi_row);
     for (mi_col = 0; mi_col < cm->mi_cols; mi_col += MI_BLOCK_SIZE, ++lfm) {
       const int r = mi_row >> MI_BLOCK_SIZE_LOG2;
       const int c = mi_col >> MI_BLOCK_SIZE_LOG2;
@@ -120,6 +128,12 @@ static INLINE void thread_loop_filter_rows(
 
       sync_read(lf_sync, r, c);
 
+      // Columns outside the filtered range still signal their progress.
+      if (mi_col < col_start || mi_col >= col_end) {
+        sync_write(lf_sync, r, c, sb_cols);
+        continue;
+      }
+
       vp9_setup_dst_planes(planes, frame_buffer, mi_row, mi_col);
 
       vp9_adjust_mask(cm, mi_row, mi_col, lfm);
@@ -142,6 +156,7 @@ static INLINE void thread_loop_filter_rows(
 
       sync_write(lf_sync, r, c, sb_cols);
     }
+    VPX_TRACE_END("loop_filter_sb_row");
   }
 }
 
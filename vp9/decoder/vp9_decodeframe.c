@@ -24,6 +24,7 @@
 #include "vpx_scale/vpx_scale.h"
 #include "vpx_util/vpx_pthread.h"
 #include "vpx_util/vpx_thread.h"
+#include "vpx_util/vpx_trace.h"
 #if CONFIG_BITSTREAM_DEBUG || CONFIG_MISMATCH_DEBUG
 #include "vpx_util/vpx_debug_util.h"
 #endif  // CONFIG_BITSTREAM_DEBUG || CONFIG_MISMATCH_DEBUG
@@ -753,14 +754,25 @@ static void dec_build_inter_predictors_sb(TileWorkerData *twd,
         const int n4w_x4 = 4 * num_4x4_w;
         const int n4h_x4 = 4 * num_4x4_h;
         struct buf_2d *const pre_buf = &pd->pre[ref];
-        int i = 0, x, y;
-        for (y = 0; y < num_4x4_h; ++y) {
-          for (x = 0; x < num_4x4_w; ++x) {
-            const MV mv = average_split_mvs(pd, mi, ref, i++);
-            dec_build_inter_predictors(twd, xd, plane, n4w_x4, n4h_x4, 4 * x,
-                                       4 * y, 4, 4, mi_x, mi_y, kernel, sf,
-                                       pre_buf, dst_buf, &mv, ref_frame_buf,
-                                       is_scaled, ref);
+        MV mvs[4];
+        int i, x, y, merge_x, merge_y;
+        for (i = 0; i < num_4x4_w * num_4x4_h; ++i)
+          mvs[i] = average_split_mvs(pd, mi, ref, i);
+        // Predict the 4x4 blocks that share a motion vector with one
+        // convolve. A scaled reference maps each 4x4 block separately, so
+        // only unscaled predictions are merged.
+        merge_x = !is_scaled && num_4x4_w == 2 &&
+                  is_equal_mv(&mvs[0], &mvs[1]) &&
+                  (num_4x4_h == 1 || is_equal_mv(&mvs[2], &mvs[3]));
+        merge_y = !is_scaled && num_4x4_h == 2 &&
+                  is_equal_mv(&mvs[0], &mvs[num_4x4_w]) &&
+                  (num_4x4_w == 1 || is_equal_mv(&mvs[1], &mvs[3]));
+        for (y = 0; y < num_4x4_h; y += 1 + merge_y) {
+          for (x = 0; x < num_4x4_w; x += 1 + merge_x) {
+            dec_build_inter_predictors(
+                twd, xd, plane, n4w_x4, n4h_x4, 4 * x, 4 * y, 4 << merge_x,
+                4 << merge_y, mi_x, mi_y, kernel, sf, pre_buf, dst_buf,
+                &mvs[y * num_4x4_w + x], ref_frame_buf, is_scaled, ref);
           }
         }
       }
@@ -1954,8 +1966,10 @@ static int row_decode_worker_hook(void *arg1, void *arg2) {
       tile_data_recon->error_info.setjmp = 1;
       tile_data_recon->xd.error_info = &tile_data_recon->error_info;
 
+      VPX_TRACE_BEGIN("recon_tile_row", mi_row);
       recon_tile_row(tile_data_recon, pbi, mi_row, is_last_row, lf_sync,
                      job.tile_col);
+      VPX_TRACE_END("recon_tile_row");
 
       if (corrupted)
         vpx_internal_error(&tile_data_recon->error_info,
@@ -1981,7 +1995,9 @@ static int row_decode_worker_hook(void *arg1, void *arg2) {
 
       tile_data->error_info.setjmp = 1;
 
+      VPX_TRACE_BEGIN("parse_tile_row", mi_row);
       parse_tile_row(tile_data, pbi, mi_row, job.tile_col, data_end);
+      VPX_TRACE_END("parse_tile_row");
 
       corrupted |= tile_data->xd.corrupted;
       if (corrupted)
@@ -2014,6 +2030,197 @@ static int row_decode_worker_hook(void *arg1, void *arg2) {
   return !corrupted;
 }
 
+// Returns 1 if the tile column lies outside the columns decoded in this frame.
+static INLINE int tile_col_skipped(const VP9Decoder *pbi,
+                                   const TileInfo *tile) {
+  return tile->mi_col_start >= pbi->decode_mi_col_end ||
+         tile->mi_col_end <= pbi->decode_mi_col_start;
+}
+
+// Picks the tile columns to decode for the region set by the application.
+// Skipped columns leave the entropy counts, the motion vectors and the
+// segment map of the frame stale, so they are not decoded again until a frame
+// that resets that state, and frames whose counts adapt the probabilities of
+// later frames are always decoded in full.
+static void setup_decode_region(VP9Decoder *pbi) {
+  VP9_COMMON *const cm = &pbi->common;
+  const int reset = frame_is_intra_only(cm) || cm->error_resilient_mode;
+  const int adapts = cm->refresh_frame_context && !cm->error_resilient_mode &&
+                     !cm->frame_parallel_decoding_mode;
+  int start = 0, end = cm->mi_cols;
+
+  if (pbi->region_w > 0 && !adapts) {
+    const int region_start = (int)(pbi->region_x >> MI_SIZE_LOG2);
+    const int region_end =
+        (int)((pbi->region_x + pbi->region_w + MI_SIZE - 1) >> MI_SIZE_LOG2);
+    const int tile_cols = 1 << cm->log2_tile_cols;
+    int tile_col;
+
+    start = cm->mi_cols;
+    end = 0;
+    for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
+      TileInfo tile;
+      vp9_tile_set_col(&tile, cm, tile_col);
+      if (tile.mi_col_start >= tile.mi_col_end ||
+          tile.mi_col_start >= region_end || tile.mi_col_end <= region_start)
+        continue;
+      if (!reset && (tile.mi_col_start < pbi->valid_mi_col_start ||
+                     tile.mi_col_end > pbi->valid_mi_col_end))
+        continue;
+      start = VPXMIN(start, tile.mi_col_start);
+      end = VPXMAX(end, tile.mi_col_end);
+    }
+    if (start >= end) start = end = 0;
+  }
+
+  pbi->decode_mi_col_start = start;
+  pbi->decode_mi_col_end = end;
+  // Filter only the decoded columns, the loop filter would otherwise read the
+  // stale pixels of the skipped ones.
+  if (start == 0 && end == cm->mi_cols) {
+    cm->lf.mi_col_start = cm->lf.mi_col_end = 0;
+  } else {
+    cm->lf.mi_col_start = start;
+    cm->lf.mi_col_end = end;
+  }
+  if (reset) {
+    pbi->valid_mi_col_start = start;
+    pbi->valid_mi_col_end = end;
+  } else {
+    pbi->valid_mi_col_start = VPXMAX(pbi->valid_mi_col_start, start);
+    pbi->valid_mi_col_end = VPXMIN(pbi->valid_mi_col_end, end);
+    if (pbi->valid_mi_col_start >= pbi->valid_mi_col_end)
+      pbi->valid_mi_col_start = pbi->valid_mi_col_end = 0;
+  }
+}
+
+// The loop filter changes up to 7 pixels on each side of an edge, 14 luma
+// columns for subsampled chroma, so it spreads the pixels that differ from a
+// full decode by as much.
+#define DECODE_REGION_LF_MARGIN 16
+
+// Narrows the columns [*start, *end) of the new frame whose prediction matches
+// a full decode. Inter blocks that read columns of a reference that do not
+// match it, and intra blocks next to those, are left out.
+static void clip_decoded_region_to_refs(const VP9Decoder *pbi, int *start,
+                                        int *end) {
+  const VP9_COMMON *const cm = &pbi->common;
+  const int col_start = pbi->decode_mi_col_start;
+  const int col_end = pbi->decode_mi_col_end;
+  int changed = 1;
+
+  // Intra blocks may take their edge from blocks left out later in the scan,
+  // so repeat until no more blocks are left out.
+  while (changed && *start < *end) {
+    int mi_row, mi_col;
+    changed = 0;
+    for (mi_row = 0; mi_row < cm->mi_rows; ++mi_row) {
+      MODE_INFO **const mi = cm->mi_grid_visible + mi_row * cm->mi_stride;
+      for (mi_col = col_start; mi_col < col_end; ++mi_col) {
+        const MODE_INFO *const m = mi[mi_col];
+        const int x = mi_col * MI_SIZE;
+        const int x_end = x + num_8x8_blocks_wide_lookup[m->sb_type] * MI_SIZE;
+        int bad_left = 0, bad_right = 0;
+
+        // Visit each block once, from its top left mi.
+        if ((mi_col > col_start && mi[mi_col - 1] == m) ||
+            (mi_row > 0 && mi[mi_col - cm->mi_stride] == m))
+          continue;
+        if (x_end <= *start || x >= *end) continue;
+
+        if (is_inter_block(m)) {
+          int ref;
+          for (ref = 0; ref < 1 + has_second_ref(m); ++ref) {
+            const int idx = cm->frame_refs[m->ref_frame[ref] - LAST_FRAME].idx;
+            int mv_min, mv_max, i;
+            if (m->sb_type < BLOCK_8X8) {
+              mv_min = mv_max = m->bmi[0].as_mv[ref].as_mv.col;
+              for (i = 1; i < 4; ++i) {
+                mv_min = VPXMIN(mv_min, m->bmi[i].as_mv[ref].as_mv.col);
+                mv_max = VPXMAX(mv_max, m->bmi[i].as_mv[ref].as_mv.col);
+              }
+            } else {
+              mv_min = mv_max = m->mv[ref].as_mv.col;
+            }
+            // The motion vectors are in 1/8 pel and the subpel filters read
+            // 4 more pixels, 8 luma columns for subsampled chroma.
+            if (x + (mv_min >> 3) - (VP9_INTERP_EXTEND << 1) <
+                pbi->region_x_start[idx])
+              bad_left = 1;
+            if (x_end + ((mv_max + 7) >> 3) + (VP9_INTERP_EXTEND << 1) >
+                pbi->region_x_end[idx])
+              bad_right = 1;
+          }
+        } else {
+          // The edge is the column to the left and the row above, which does
+          // not extend to the right of the block.
+          if (x > col_start * MI_SIZE && x - 1 < *start) bad_left = 1;
+          if (x_end > *end) bad_right = 1;
+        }
+
+        if (bad_left && *start < x_end) {
+          *start = x_end;
+          changed = 1;
+        }
+        if (bad_right && *end > x) {
+          *end = x;
+          changed = 1;
+        }
+      }
+    }
+  }
+}
+
+// Records the pixel columns of the new frame that match a full decode. They
+// exclude the columns near the edges of the decoded ones, which are not loop
+// filtered, and the blocks whose prediction reads the columns of the
+// references that do not match.
+static void update_decoded_region(VP9Decoder *pbi) {
+  VP9_COMMON *const cm = &pbi->common;
+  const int width = cm->width;
+  int start = pbi->decode_mi_col_start * MI_SIZE;
+  int end = VPXMIN(pbi->decode_mi_col_end * MI_SIZE, width);
+  int i;
+
+  if (!frame_is_intra_only(cm)) {
+    int partial = 0, scaled = 0;
+    for (i = 0; i < REFS_PER_FRAME; ++i) {
+      const RefBuffer *const ref = &cm->frame_refs[i];
+      if (pbi->region_x_start[ref->idx] > 0 ||
+          pbi->region_x_end[ref->idx] < ref->buf->y_crop_width) {
+        partial = 1;
+        scaled |= vp9_is_scaled(&ref->sf);
+      }
+    }
+    if (scaled)
+      start = end = 0;
+    else if (partial)
+      clip_decoded_region_to_refs(pbi, &start, &end);
+  }
+
+  if (start > 0) start += DECODE_REGION_LF_MARGIN;
+  if (end < width) end -= DECODE_REGION_LF_MARGIN;
+  if (start >= end) start = end = 0;
+
+  pbi->region_x_start[cm->new_fb_idx] = start;
+  pbi->region_x_end[cm->new_fb_idx] = end;
+}
+
+// Parses a superblock without reconstructing it. The coefficients are read
+// into a scratch buffer and dropped.
+static void parse_superblock(TileWorkerData *twd, VP9Decoder *const pbi,
+                             int mi_row, int mi_col) {
+  int plane;
+  for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
+    twd->xd.plane[plane].eob = pbi->parse_eob + (plane << EOBS_PER_SB_LOG2);
+    twd->xd.plane[plane].dqcoeff =
+        pbi->parse_dqcoeff + (plane << DQCOEFFS_PER_SB_LOG2);
+  }
+  twd->xd.partition = pbi->parse_partition;
+  process_partition(twd, pbi, mi_row, mi_col, BLOCK_64X64, 4, PARSE,
+                    parse_block);
+}
+
 static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
                                    const uint8_t *data_end) {
   VP9_COMMON *const cm = &pbi->common;
@@ -2025,9 +2232,10 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
   int tile_row, tile_col;
   int mi_row, mi_col;
   TileWorkerData *tile_data = NULL;
+  const int do_loop_filter =
+      cm->lf.filter_level && !cm->skip_loop_filter && !pbi->parse_only;
 
-  if (cm->lf.filter_level && !cm->skip_loop_filter &&
-      pbi->lf_worker.data1 == NULL) {
+  if (do_loop_filter && pbi->lf_worker.data1 == NULL) {
     CHECK_MEM_ERROR(&cm->error, pbi->lf_worker.data1,
                     vpx_memalign(32, sizeof(LFWorkerData)));
     pbi->lf_worker.hook = vp9_loop_filter_worker;
@@ -2037,7 +2245,7 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
     }
   }
 
-  if (cm->lf.filter_level && !cm->skip_loop_filter) {
+  if (do_loop_filter) {
     LFWorkerData *const lf_data = (LFWorkerData *)pbi->lf_worker.data1;
     // Be sure to sync as we might be resuming after a failed frame decode.
     winterface->sync(&pbi->lf_worker);
@@ -2088,11 +2296,14 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
             pbi->inv_tile_order ? tile_cols - tile_col - 1 : tile_col;
         tile_data = pbi->tile_worker_data + tile_cols * tile_row + col;
         vp9_tile_set_col(&tile, cm, col);
+        if (tile_col_skipped(pbi, &tile)) continue;
         vp9_zero(tile_data->xd.left_context);
         vp9_zero(tile_data->xd.left_seg_context);
         for (mi_col = tile.mi_col_start; mi_col < tile.mi_col_end;
              mi_col += MI_BLOCK_SIZE) {
-          if (pbi->row_mt == 1) {
+          if (pbi->parse_only) {
+            parse_superblock(tile_data, pbi, mi_row, mi_col);
+          } else if (pbi->row_mt == 1) {
             int plane;
             RowMTWorkerData *const row_mt_worker_data = pbi->row_mt_worker_data;
             for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
@@ -2122,7 +2333,7 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
                              "Failed to decode tile data");
       }
       // Loopfilter one row.
-      if (cm->lf.filter_level && !cm->skip_loop_filter) {
+      if (do_loop_filter) {
         const int lf_start = mi_row - MI_BLOCK_SIZE;
         LFWorkerData *const lf_data = (LFWorkerData *)pbi->lf_worker.data1;
 
@@ -2145,7 +2356,7 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
   }
 
   // Loopfilter remaining rows in the frame.
-  if (cm->lf.filter_level && !cm->skip_loop_filter) {
+  if (do_loop_filter) {
     LFWorkerData *const lf_data = (LFWorkerData *)pbi->lf_worker.data1;
     winterface->sync(&pbi->lf_worker);
     lf_data->start = lf_data->stop;
@@ -2156,6 +2367,8 @@ static const uint8_t *decode_tiles(VP9Decoder *pbi, const uint8_t *data,
   // Get last tile data.
   tile_data = pbi->tile_worker_data + tile_cols * tile_rows - 1;
 
+  // The last tile extends to the end of the frame data.
+  if (tile_col_skipped(pbi, &tile_data->xd.tile)) return data_end;
   return vpx_reader_find_end(&tile_data->bit_reader);
 }
 
@@ -2233,10 +2446,12 @@ static int tile_worker_hook(void *arg1, void *arg2) {
          mi_row += MI_BLOCK_SIZE) {
       vp9_zero(tile_data->xd.left_context);
       vp9_zero(tile_data->xd.left_seg_context);
+      VPX_TRACE_BEGIN("decode_tile_row", mi_row);
       for (mi_col = tile->mi_col_start; mi_col < tile->mi_col_end;
            mi_col += MI_BLOCK_SIZE) {
         decode_partition(tile_data, pbi, mi_row, mi_col, BLOCK_64X64, 4);
       }
+      VPX_TRACE_END("decode_tile_row");
       if (pbi->lpf_mt_opt && cm->lf.filter_level && !cm->skip_loop_filter) {
         const int aligned_rows = mi_cols_aligned_to_sb(cm->mi_rows);
         const int sb_rows = (aligned_rows >> MI_BLOCK_SIZE_LOG2);
@@ -2451,7 +2666,8 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi, const uint8_t *data,
   YV12_BUFFER_CONFIG *const new_fb = get_frame_new_buffer(cm);
   const int tile_cols = 1 << cm->log2_tile_cols;
   const int tile_rows = 1 << cm->log2_tile_rows;
-  const int num_workers = VPXMIN(pbi->max_threads, tile_cols);
+  int num_bufs = tile_cols;
+  int num_workers;
   int n;
 
   assert(tile_cols <= (1 << 6));
@@ -2460,6 +2676,34 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi, const uint8_t *data,
 
   init_mt(pbi);
 
+  // Load tile data into tile_buffers
+  get_tile_buffers(pbi, data, data_end, tile_cols, tile_rows,
+                   &pbi->tile_buffers);
+
+  // Drop the tile columns outside the decoded region. Their rows count as
+  // done for the loop filter, which has nothing to filter there.
+  if (pbi->decode_mi_col_start > 0 || pbi->decode_mi_col_end < cm->mi_cols) {
+    const int sb_rows =
+        mi_cols_aligned_to_sb(cm->mi_rows) >> MI_BLOCK_SIZE_LOG2;
+    num_bufs = 0;
+    for (n = 0; n < tile_cols; ++n) {
+      TileInfo tile;
+      vp9_tile_set_col(&tile, cm, pbi->tile_buffers[n].col);
+      if (!tile_col_skipped(pbi, &tile)) {
+        pbi->tile_buffers[num_bufs++] = pbi->tile_buffers[n];
+      } else if (pbi->lpf_mt_opt && cm->lf.filter_level &&
+                 !cm->skip_loop_filter) {
+        int sb_row;
+        for (sb_row = 0; sb_row < sb_rows; ++sb_row)
+          vp9_set_row(lf_row_sync, tile_cols, sb_row, sb_row == sb_rows - 1,
+                      0);
+      }
+    }
+    // The last tile extends to the end of the frame data.
+    if (num_bufs == 0) return data_end;
+  }
+  num_workers = VPXMIN(pbi->max_threads, num_bufs);
+
   // Reset tile decoding hook
   for (n = 0; n < num_workers; ++n) {
     VPxWorker *const worker = &pbi->tile_workers[n];
@@ -2482,25 +2726,21 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi, const uint8_t *data,
     worker->data2 = pbi;
   }
 
-  // Load tile data into tile_buffers
-  get_tile_buffers(pbi, data, data_end, tile_cols, tile_rows,
-                   &pbi->tile_buffers);
-
   // Sort the buffers based on size in descending order.
-  qsort(pbi->tile_buffers, tile_cols, sizeof(pbi->tile_buffers[0]),
+  qsort(pbi->tile_buffers, num_bufs, sizeof(pbi->tile_buffers[0]),
         compare_tile_buffers);
 
-  if (num_workers == tile_cols) {
+  if (num_workers == num_bufs) {
     // Rearrange the tile buffers such that the largest, and
     // presumably the most difficult, tile will be decoded in the main thread.
     // This should help minimize the number of instances where the main thread
     // is waiting for a worker to complete.
     const TileBuffer largest = pbi->tile_buffers[0];
     memmove(pbi->tile_buffers, pbi->tile_buffers + 1,
-            (tile_cols - 1) * sizeof(pbi->tile_buffers[0]));
-    pbi->tile_buffers[tile_cols - 1] = largest;
+            (num_bufs - 1) * sizeof(pbi->tile_buffers[0]));
+    pbi->tile_buffers[num_bufs - 1] = largest;
   } else {
-    int start = 0, end = tile_cols - 2;
+    int start = 0, end = num_bufs - 2;
     TileBuffer tmp;
 
     // Interleave the tiles to distribute the load between threads, assuming a
@@ -2524,8 +2764,8 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi, const uint8_t *data,
   }
 
   {
-    const int base = tile_cols / num_workers;
-    const int remain = tile_cols % num_workers;
+    const int base = num_bufs / num_workers;
+    const int remain = num_bufs % num_workers;
     int buf_start = 0;
 
     for (n = 0; n < num_workers; ++n) {
@@ -2540,7 +2780,7 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi, const uint8_t *data,
 
       worker->had_error = 0;
       if (n == num_workers - 1) {
-        assert(tile_data->buf_end == tile_cols - 1);
+        assert(tile_data->buf_end == num_bufs - 1);
         winterface->execute(worker);
       } else {
         winterface->launch(worker);
@@ -2559,6 +2799,9 @@ static const uint8_t *decode_tiles_mt(VP9Decoder *pbi, const uint8_t *data,
     }
   }
 
+  // The last tile extends to the end of the frame data when it was skipped.
+  if (!bit_reader_end && !pbi->mb.corrupted) bit_reader_end = data_end;
+
   // Accumulate thread frame counts.
   if (!cm->frame_parallel_decoding_mode) {
     for (n = 0; n < num_workers; ++n) {
@@ -2952,6 +3195,28 @@ BITSTREAM_PROFILE vp9_read_profile(struct vpx_read_bit_buffer *rb) {
   return (BITSTREAM_PROFILE)profile;
 }
 
+static void setup_mode_info_export(VP9Decoder *pbi) {
+  const VP9_COMMON *const cm = &pbi->common;
+  VpxFrameModeInfo *const info = pbi->mode_info_export;
+
+  pbi->mode_info_blocks = NULL;
+  if (info == NULL) return;
+
+  info->frame_width = cm->width;
+  info->frame_height = cm->height;
+  if (info->blocks != NULL && info->num_blocks >= cm->mi_rows * cm->mi_cols) {
+    info->mi_rows = cm->mi_rows;
+    info->mi_cols = cm->mi_cols;
+    info->stride = cm->mi_cols;
+    pbi->mode_info_blocks = info->blocks;
+    pbi->mode_info_stride = cm->mi_cols;
+  } else {
+    info->mi_rows = 0;
+    info->mi_cols = 0;
+    info->stride = 0;
+  }
+}
+
 void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
                       const uint8_t *data_end, const uint8_t **p_data_end) {
   VP9_COMMON *const cm = &pbi->common;
@@ -2972,6 +3237,12 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
 #endif
   xd->cur_buf = new_fb;
 
+  // Frames that are not references are only parsed when shedding load. The
+  // parse keeps the motion vectors, segment map and entropy counts that the
+  // following frames depend on.
+  pbi->parse_only = first_partition_size && pbi->load_shed_level >= 1 &&
+                    pbi->refresh_frame_flags == 0;
+
   if (!first_partition_size) {
     // showing a frame directly
     *p_data_end = data + (cm->profile <= PROFILE_2 ? 1 : 2);
@@ -2995,6 +3266,8 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
     vpx_internal_error(&cm->error, VPX_CODEC_CORRUPT_FRAME,
                        "Uninitialized entropy context.");
 
+  setup_mode_info_export(pbi);
+
   xd->corrupted = 0;
   new_fb->corrupted = read_compressed_header(pbi, data, first_partition_size);
   if (new_fb->corrupted)
@@ -3019,9 +3292,25 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
     pbi->total_tiles = tile_rows * tile_cols;
   }
 
+  setup_decode_region(pbi);
+
+  if (pbi->parse_only && pbi->parse_dqcoeff == NULL) {
+    CHECK_MEM_ERROR(&cm->error, pbi->parse_dqcoeff,
+                    vpx_memalign(32, (MAX_MB_PLANE << DQCOEFFS_PER_SB_LOG2) *
+                                         sizeof(*pbi->parse_dqcoeff)));
+    CHECK_MEM_ERROR(&cm->error, pbi->parse_eob,
+                    vpx_malloc((MAX_MB_PLANE << EOBS_PER_SB_LOG2) *
+                               sizeof(*pbi->parse_eob)));
+    CHECK_MEM_ERROR(&cm->error, pbi->parse_partition,
+                    vpx_malloc(PARTITIONS_PER_SB *
+                               sizeof(*pbi->parse_partition)));
+  }
+
   if (pbi->max_threads > 1 && tile_rows == 1 &&
-      (tile_cols > 1 || pbi->row_mt == 1)) {
-    if (pbi->row_mt == 1) {
+      (tile_cols > 1 || pbi->row_mt == 1) && !pbi->parse_only) {
+    // The row based decoder does not skip tile columns.
+    if (pbi->row_mt == 1 && pbi->decode_mi_col_start == 0 &&
+        pbi->decode_mi_col_end == cm->mi_cols) {
       *p_data_end =
           decode_tiles_row_wise_mt(pbi, data + first_partition_size, data_end);
     } else {
@@ -3060,6 +3349,8 @@ void vp9_decode_frame(VP9Decoder *pbi, const uint8_t *data,
                        "Decode failed. Frame data is corrupted.");
   }
 
+  update_decoded_region(pbi);
+
   // Non frame parallel update frame context here.
   if (cm->refresh_frame_context && !context_updated)
     cm->frame_contexts[cm->frame_context_idx] = *cm->fc;
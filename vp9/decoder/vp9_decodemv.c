@@ -810,6 +810,29 @@ static INLINE void copy_ref_frame_pair(MV_REFERENCE_FRAME *dst,
   memcpy(dst, src, sizeof(*dst) * 2);
 }
 
+static void export_mode_info(const VP9Decoder *const pbi, const MODE_INFO *mi,
+                             int mi_row, int mi_col, int x_mis, int y_mis) {
+  VpxBlockModeInfo *blocks =
+      pbi->mode_info_blocks + mi_row * pbi->mode_info_stride + mi_col;
+  VpxBlockModeInfo info;
+  int w, h, i;
+
+  info.block_width = 4 << b_width_log2_lookup[mi->sb_type];
+  info.block_height = 4 << b_height_log2_lookup[mi->sb_type];
+  info.skip = mi->skip;
+  for (i = 0; i < 2; ++i) {
+    const int has_mv = is_inter_block(mi) && mi->ref_frame[i] > INTRA_FRAME;
+    info.ref_frame[i] = mi->ref_frame[i];
+    info.mv_row[i] = has_mv ? mi->mv[i].as_mv.row : 0;
+    info.mv_col[i] = has_mv ? mi->mv[i].as_mv.col : 0;
+  }
+
+  for (h = 0; h < y_mis; ++h) {
+    for (w = 0; w < x_mis; ++w) blocks[w] = info;
+    blocks += pbi->mode_info_stride;
+  }
+}
+
 void vp9_read_mode_info(TileWorkerData *twd, VP9Decoder *const pbi, int mi_row,
                         int mi_col, int x_mis, int y_mis) {
   vpx_reader *r = &twd->bit_reader;
@@ -841,6 +864,9 @@ void vp9_read_mode_info(TileWorkerData *twd, VP9Decoder *const pbi, int mi_row,
       frame_mvs += cm->mi_cols;
     }
   }
+
+  if (pbi->mode_info_blocks != NULL)
+    export_mode_info(pbi, mi, mi_row, mi_col, x_mis, y_mis);
 #if 0   // CONFIG_BETTER_HW_COMPATIBILITY && CONFIG_VP9_HIGHBITDEPTH
   if ((xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) &&
       (xd->above_mi == NULL || xd->left_mi == NULL) &&
@@ -248,6 +248,9 @@ void vp9_decoder_remove(VP9Decoder *pbi) {
     vpx_free(pbi->row_mt_worker_data);
   }
 
+  vpx_free(pbi->parse_dqcoeff);
+  vpx_free(pbi->parse_eob);
+  vpx_free(pbi->parse_partition);
   vp9_remove_common(&pbi->common);
   vpx_free(pbi);
 }
@@ -507,7 +510,7 @@ int vp9_get_raw_frame(VP9Decoder *pbi, YV12_BUFFER_CONFIG *sd,
   pbi->ready_for_new_data = 1;
 
   /* no raw frame to show!!! */
-  if (!cm->show_frame) return ret;
+  if (!cm->show_frame || pbi->parse_only) return ret;
 
   pbi->ready_for_new_data = 1;
 
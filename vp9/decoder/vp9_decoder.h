@@ -14,6 +14,7 @@
 #include "./vpx_config.h"
 
 #include "vpx/vpx_codec.h"
+#include "vpx/vpx_mode_info.h"
 #include "vpx_dsp/bitreader.h"
 #include "vpx_scale/yv12config.h"
 #include "vpx_util/vpx_pthread.h"
@@ -125,6 +126,38 @@ typedef struct VP9Decoder {
   int row_mt;
   int lpf_mt_opt;
   RowMTWorkerData *row_mt_worker_data;
+
+  // Application buffer receiving the mode info of each decoded frame.
+  // mode_info_blocks is NULL when the blocks do not fit the current frame.
+  VpxFrameModeInfo *mode_info_export;
+  VpxBlockModeInfo *mode_info_blocks;
+  int mode_info_stride;
+
+  // Pixel columns [region_x, region_x + region_w) to decode, region_w is 0
+  // to decode the whole frame.
+  unsigned int region_x;
+  unsigned int region_w;
+  // Mi columns decoded in the current frame, and those decoded in every frame
+  // since the last frame that reset the decoder state.
+  int decode_mi_col_start;
+  int decode_mi_col_end;
+  int valid_mi_col_start;
+  int valid_mi_col_end;
+  // Pixel columns [region_x_start, region_x_end) of each frame buffer that
+  // match a full decode.
+  int region_x_start[FRAME_BUFFERS];
+  int region_x_end[FRAME_BUFFERS];
+
+  // How much work to shed to catch up with the frame deadline: 1 parses the
+  // frames that are not references without reconstructing them, 2 also skips
+  // the loop filter and 3 also skips the postprocessing.
+  int load_shed_level;
+  // Set when the current frame is only parsed, it is not output.
+  int parse_only;
+  // Coefficients, eobs and partitions of the superblock being parsed.
+  tran_low_t *parse_dqcoeff;
+  int *parse_eob;
+  PARTITION_TYPE *parse_partition;
 } VP9Decoder;
 
 int vp9_receive_compressed_data(struct VP9Decoder *pbi, size_t size,
@@ -44,9 +44,11 @@ struct macroblock_plane {
 };
 
 /* The [2] dimension is for whether we skip the EOB node (i.e. if previous
- * coefficient in this block was zero) or not. */
-typedef unsigned int vp9_coeff_cost[PLANE_TYPES][REF_TYPES][COEF_BANDS][2]
-                                   [COEFF_CONTEXTS][ENTROPY_TOKENS];
+ * coefficient in this block was zero) or not. A token costs at most
+ * ENTROPY_NODES times vp9_prob_cost[0], which fits in 16 bits, and the
+ * narrower type keeps the costs of a whole frame in the L1 cache. */
+typedef uint16_t vp9_coeff_cost[PLANE_TYPES][REF_TYPES][COEF_BANDS][2]
+                               [COEFF_CONTEXTS][ENTROPY_TOKENS];
 
 typedef struct {
   int_mv ref_mvs[MAX_REF_FRAMES][MAX_MV_REF_CANDIDATES];
@@ -212,6 +214,10 @@ struct macroblock {
                               int stride, int eob, int bd);
 #endif
   DECLARE_ALIGNED(16, uint8_t, est_pred[64 * 64]);
+  // sse and sum of the differences between the source and est_pred of each
+  // 16x16 block of the superblock, in raster order.
+  unsigned int est_pred_sse[16];
+  int est_pred_sum[16];
 
   struct scale_factors *me_sf;
 };
@@ -54,6 +54,7 @@
 #include "vp9/encoder/vp9_multi_thread.h"
 #include "vp9/encoder/vp9_partition_models.h"
 #include "vp9/encoder/vp9_pickmode.h"
+#include "vp9/encoder/vp9_pyramid_me.h"
 #include "vp9/encoder/vp9_rd.h"
 #include "vp9/encoder/vp9_rdopt.h"
 #include "vp9/encoder/vp9_segmentation.h"
@@ -3044,6 +3045,46 @@ static void rd_auto_partition_range(VP9_COMP *cpi, const TileInfo *const tile,
   *max_block_size = max_size;
 }
 
+// Set the min and max partition size of the SB64 around the block sizes of
+// the mode info seed.
+static void seed_partition_range(VP9_COMP *cpi, const TileInfo *const tile,
+                                 int mi_row, int mi_col,
+                                 BLOCK_SIZE *min_block_size,
+                                 BLOCK_SIZE *max_block_size) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const MiSeed *seed = &cpi->mi_seed.seeds[mi_row * cm->mi_cols + mi_col];
+  const int rows = VPXMIN(MI_BLOCK_SIZE, cm->mi_rows - mi_row);
+  const int cols = VPXMIN(MI_BLOCK_SIZE, cm->mi_cols - mi_col);
+  BLOCK_SIZE min_size = BLOCK_64X64;
+  BLOCK_SIZE max_size = BLOCK_4X4;
+  int bh, bw, r, c;
+
+  for (r = 0; r < rows; ++r) {
+    for (c = 0; c < cols; ++c) {
+      min_size = VPXMIN(min_size, (BLOCK_SIZE)seed[c].bsize);
+      max_size = VPXMAX(max_size, (BLOCK_SIZE)seed[c].bsize);
+    }
+    seed += cm->mi_cols;
+  }
+  min_size = min_partition_size[min_size];
+  max_size = max_partition_size[max_size];
+
+  max_size = find_partition_size(max_size, tile->mi_row_end - mi_row,
+                                 tile->mi_col_end - mi_col, &bh, &bw);
+  if (vp9_active_edge_sb(cpi, mi_row, mi_col))
+    min_size = BLOCK_4X4;
+  else
+    min_size = VPXMIN(min_size, max_size);
+
+  if (cpi->sf.use_square_partition_only &&
+      next_square_size[max_size] < min_size) {
+    min_size = next_square_size[max_size];
+  }
+
+  *min_block_size = min_size;
+  *max_block_size = max_size;
+}
+
 // TODO(jingning) refactor functions setting partition search range
 static void set_partition_range(VP9_COMMON *cm, MACROBLOCKD *xd, int mi_row,
                                 int mi_col, BLOCK_SIZE bsize,
@@ -3105,6 +3146,7 @@ static INLINE void load_pred_mv(MACROBLOCK *x, PICK_MODE_CONTEXT *ctx) {
   memcpy(x->pred_mv, ctx->pred_mv, sizeof(x->pred_mv));
 }
 
+#if !CONFIG_REALTIME_ONLY
 // Calculate prediction based on the given input features and neural net config.
 // Assume there are no more than NN_MAX_NODES_PER_LAYER nodes in each hidden
 // layer.
@@ -3152,7 +3194,6 @@ static void nn_predict(const float *features, const NN_CONFIG *nn_config,
   }
 }
 
-#if !CONFIG_REALTIME_ONLY
 #define FEATURES 7
 // Machine-learning based partition search early termination.
 // Return 1 to skip split and rect partitions.
@@ -4581,9 +4622,16 @@ static void encode_rd_sb_row(VP9_COMP *cpi, ThreadData *td,
 
       // If required set upper and lower partition size limits
       if (sf->auto_min_max_partition_size) {
-        set_offsets(cpi, tile_info, x, mi_row, mi_col, BLOCK_64X64);
-        rd_auto_partition_range(cpi, tile_info, xd, mi_row, mi_col,
-                                &x->min_partition_size, &x->max_partition_size);
+        if (vp9_mi_seed_active(cpi)) {
+          seed_partition_range(cpi, tile_info, mi_row, mi_col,
+                               &x->min_partition_size,
+                               &x->max_partition_size);
+        } else {
+          set_offsets(cpi, tile_info, x, mi_row, mi_col, BLOCK_64X64);
+          rd_auto_partition_range(cpi, tile_info, xd, mi_row, mi_col,
+                                  &x->min_partition_size,
+                                  &x->max_partition_size);
+        }
       }
       td->pc_root->none.rdcost = 0;
 
@@ -4850,68 +4898,203 @@ static void pred_pixel_ready_reset(PC_TREE *pc_tree, BLOCK_SIZE bsize) {
   }
 }
 
+// Fixed point copies of vp9_var_part_nnconfig_{64,32,16}.
+static NN_CONFIG_FIXED var_part_nnconfig_fixed[3];
+
+static void quantize_nn_config(const NN_CONFIG *nn_config,
+                               NN_CONFIG_FIXED *fixed) {
+  int num_input_nodes = nn_config->num_inputs;
+  int layer, i;
+  assert(nn_config->num_hidden_layers <= NN_FIXED_MAX_HIDDEN_LAYERS);
+  assert(nn_config->num_inputs <= NN_FIXED_MAX_NODES);
+  assert(nn_config->num_outputs <= NN_FIXED_MAX_NODES);
+  fixed->num_inputs = nn_config->num_inputs;
+  fixed->num_outputs = nn_config->num_outputs;
+  fixed->num_hidden_layers = nn_config->num_hidden_layers;
+  for (layer = 0; layer <= nn_config->num_hidden_layers; ++layer) {
+    const int num_output_nodes = layer < nn_config->num_hidden_layers
+                                     ? nn_config->num_hidden_nodes[layer]
+                                     : nn_config->num_outputs;
+    assert(num_output_nodes <= NN_FIXED_MAX_NODES);
+    if (layer < nn_config->num_hidden_layers)
+      fixed->num_hidden_nodes[layer] = num_output_nodes;
+    for (i = 0; i < num_input_nodes * num_output_nodes; ++i) {
+      const float w = nn_config->weights[layer][i] * (1 << NN_FIXED_BITS);
+      assert(fabsf(w) < INT16_MAX);
+      fixed->weights[layer][i] = (int16_t)floorf(w + 0.5f);
+    }
+    for (i = 0; i < num_output_nodes; ++i) {
+      fixed->bias[layer][i] = (int32_t)floor(
+          nn_config->bias[layer][i] * (1 << (2 * NN_FIXED_BITS)) + 0.5);
+    }
+    num_input_nodes = num_output_nodes;
+  }
+}
+
+void vp9_init_ml_var_partition(void) {
+  quantize_nn_config(&vp9_var_part_nnconfig_64, &var_part_nnconfig_fixed[0]);
+  quantize_nn_config(&vp9_var_part_nnconfig_32, &var_part_nnconfig_fixed[1]);
+  quantize_nn_config(&vp9_var_part_nnconfig_16, &var_part_nnconfig_fixed[2]);
+}
+
+// Fixed point version of nn_predict(), with Q10 features and outputs.
+static void nn_predict_fixed(const int32_t *features,
+                             const NN_CONFIG_FIXED *nn_config,
+                             int32_t *output) {
+  int num_input_nodes = nn_config->num_inputs;
+  int32_t buf[2][NN_FIXED_MAX_NODES];
+  const int32_t *input_nodes = features;
+  int buf_index = 0;
+  int layer, node, i;
+
+  for (layer = 0; layer <= nn_config->num_hidden_layers; ++layer) {
+    const int is_output = layer == nn_config->num_hidden_layers;
+    const int num_output_nodes = is_output
+                                     ? nn_config->num_outputs
+                                     : nn_config->num_hidden_nodes[layer];
+    const int16_t *weights = nn_config->weights[layer];
+    int32_t *const output_nodes = is_output ? output : buf[buf_index];
+    for (node = 0; node < num_output_nodes; ++node) {
+      int64_t val = nn_config->bias[layer][node];
+      for (i = 0; i < num_input_nodes; ++i)
+        val += (int64_t)weights[i] * input_nodes[i];
+      // ReLU as activation function of the hidden layers.
+      if (!is_output) val = VPXMAX(val, 0);
+      output_nodes[node] =
+          (int32_t)((val + (1 << (NN_FIXED_BITS - 1))) >> NN_FIXED_BITS);
+      weights += num_input_nodes;
+    }
+    num_input_nodes = num_output_nodes;
+    input_nodes = output_nodes;
+    buf_index = 1 - buf_index;
+  }
+}
+
+// Natural logarithm of |v| in Q10, v > 0.
+static int32_t log_fixed(uint32_t v) {
+  // log(1 + i / 32) in Q10.
+  static const int16_t log_table[33] = {
+    0,   32,  62,  92,  121, 149, 176, 203, 228, 254, 278,
+    303, 326, 349, 372, 394, 415, 436, 457, 477, 497, 517,
+    536, 555, 573, 591, 609, 626, 644, 661, 677, 694, 710,
+  };
+  // log(2) in Q16.
+  const int64_t log2_q16 = 45426;
+  const int msb = get_msb(v);
+  // The mantissa, in [1, 2), as a Q16 fraction.
+  const uint32_t frac = (uint32_t)(((uint64_t)v << 16) >> msb) & 0xffff;
+  const int idx = frac >> 11;
+  const int rem = frac & 2047;
+  return (int32_t)((msb * log2_q16 + 32) >> 6) + log_table[idx] +
+         (((log_table[idx + 1] - log_table[idx]) * rem + 1024) >> 11);
+}
+
+// Sets the sse and sum of the 16x16 blocks of the superblock at
+// (mi_row, mi_col) against x->est_pred, which the 64x64 and 32x32 blocks of
+// ml_predict_var_partitioning() derive their variances from in one pass.
+static void set_est_pred_stats(VP9_COMP *cpi, MACROBLOCK *x, int mi_row,
+                               int mi_col) {
+  const uint8_t *src;
+  int src_stride, r, c;
+  vp9_setup_src_planes(x, cpi->Source, mi_row, mi_col);
+  src = x->plane[0].src.buf;
+  src_stride = x->plane[0].src.stride;
+  for (r = 0; r < 4; ++r) {
+    for (c = 0; c < 4; ++c) {
+      vpx_get16x16var(src + 16 * (r * src_stride + c), src_stride,
+                      x->est_pred + 16 * (r * 64 + c), 64,
+                      &x->est_pred_sse[r * 4 + c], &x->est_pred_sum[r * 4 + c]);
+    }
+  }
+}
+
+// Variance of the block of (1 << log2_size) x (1 << log2_size) 16x16 blocks
+// at (row, col) of the 16x16 grid of the superblock, as vpx_variance*()
+// gives it.
+static unsigned int est_pred_variance(const MACROBLOCK *x, int row, int col,
+                                      int log2_size) {
+  const int size = 1 << log2_size;
+  uint32_t sse = 0;
+  int sum = 0;
+  int r, c;
+  for (r = row; r < row + size; ++r) {
+    for (c = col; c < col + size; ++c) {
+      sse += x->est_pred_sse[r * 4 + c];
+      sum += x->est_pred_sum[r * 4 + c];
+    }
+  }
+  return sse - (uint32_t)(((int64_t)sum * sum) >> (8 + 2 * log2_size));
+}
+
 #define FEATURES 6
 #define LABELS 2
 static int ml_predict_var_partitioning(VP9_COMP *cpi, MACROBLOCK *x,
                                        BLOCK_SIZE bsize, int mi_row,
                                        int mi_col) {
   VP9_COMMON *const cm = &cpi->common;
-  const NN_CONFIG *nn_config = NULL;
+  const NN_CONFIG_FIXED *nn_config = NULL;
 
   switch (bsize) {
-    case BLOCK_64X64: nn_config = &vp9_var_part_nnconfig_64; break;
-    case BLOCK_32X32: nn_config = &vp9_var_part_nnconfig_32; break;
-    case BLOCK_16X16: nn_config = &vp9_var_part_nnconfig_16; break;
+    case BLOCK_64X64: nn_config = &var_part_nnconfig_fixed[0]; break;
+    case BLOCK_32X32: nn_config = &var_part_nnconfig_fixed[1]; break;
+    case BLOCK_16X16: nn_config = &var_part_nnconfig_fixed[2]; break;
     case BLOCK_8X8: break;
     default: assert(0 && "Unexpected block size."); return -1;
   }
 
   if (!nn_config) return -1;
 
-  vpx_clear_system_state();
-
   {
-    const float thresh = cpi->oxcf.speed <= 5 ? 1.25f : 0.0f;
-    float features[FEATURES] = { 0.0f };
+    const int32_t thresh =
+        cpi->oxcf.speed <= 5 ? (5 << NN_FIXED_BITS) / 4 : 0;
+    int32_t features[FEATURES] = { 0 };
     const int dc_q = vp9_dc_quant(cm->base_qindex, 0, cm->bit_depth);
+    const int row = (mi_row & 7) >> 1;
+    const int col = (mi_col & 7) >> 1;
+    const int log2_size = b_width_log2_lookup[bsize] - 2;
+    unsigned int var;
+    unsigned int sub_vars[4];
     int feature_idx = 0;
-    float score[LABELS];
+    int32_t score[LABELS];
+    int i;
 
-    features[feature_idx++] = logf((float)(dc_q * dc_q) / 256.0f + 1.0f);
-    vp9_setup_src_planes(x, cpi->Source, mi_row, mi_col);
-    {
-      const int bs = 4 * num_4x4_blocks_wide_lookup[bsize];
-      const BLOCK_SIZE subsize = get_subsize(bsize, PARTITION_SPLIT);
-      const int sb_offset_row = 8 * (mi_row & 7);
-      const int sb_offset_col = 8 * (mi_col & 7);
-      const uint8_t *pred = x->est_pred + sb_offset_row * 64 + sb_offset_col;
-      const uint8_t *src = x->plane[0].src.buf;
-      const int src_stride = x->plane[0].src.stride;
-      const int pred_stride = 64;
+    if (bsize == BLOCK_16X16) {
+      const uint8_t *src;
+      const uint8_t *pred = x->est_pred + 16 * (row * 64 + col);
+      int src_stride, sum;
       unsigned int sse;
-      int i;
-      // Variance of whole block.
-      const unsigned int var =
-          cpi->fn_ptr[bsize].vf(src, src_stride, pred, pred_stride, &sse);
-      const float factor = (var == 0) ? 1.0f : (1.0f / (float)var);
-
-      features[feature_idx++] = logf((float)var + 1.0f);
+      vp9_setup_src_planes(x, cpi->Source, mi_row, mi_col);
+      src = x->plane[0].src.buf;
+      src_stride = x->plane[0].src.stride;
+      var = est_pred_variance(x, row, col, 0);
       for (i = 0; i < 4; ++i) {
-        const int x_idx = (i & 1) * bs / 2;
-        const int y_idx = (i >> 1) * bs / 2;
-        const int src_offset = y_idx * src_stride + x_idx;
-        const int pred_offset = y_idx * pred_stride + x_idx;
-        // Variance of quarter block.
-        const unsigned int sub_var =
-            cpi->fn_ptr[subsize].vf(src + src_offset, src_stride,
-                                    pred + pred_offset, pred_stride, &sse);
-        const float var_ratio = (var == 0) ? 1.0f : factor * (float)sub_var;
-        features[feature_idx++] = var_ratio;
+        vpx_get8x8var(src + 8 * ((i >> 1) * src_stride + (i & 1)), src_stride,
+                      pred + 8 * ((i >> 1) * 64 + (i & 1)), 64, &sse, &sum);
+        sub_vars[i] = sse - (uint32_t)(((int64_t)sum * sum) >> 6);
+      }
+    } else {
+      const int half = 1 << (log2_size - 1);
+      var = est_pred_variance(x, row, col, log2_size);
+      for (i = 0; i < 4; ++i) {
+        sub_vars[i] = est_pred_variance(x, row + (i >> 1) * half,
+                                        col + (i & 1) * half, log2_size - 1);
       }
     }
 
+    // log(dc_q * dc_q / 256 + 1), with log(256) in Q10 being 5678.
+    features[feature_idx++] = log_fixed(dc_q * dc_q + 256) - 5678;
+    // Variance of whole block.
+    features[feature_idx++] = log_fixed(var + 1);
+    for (i = 0; i < 4; ++i) {
+      // Variance of quarter block.
+      const unsigned int sub_var = sub_vars[i];
+      features[feature_idx++] =
+          var == 0 ? 1 << NN_FIXED_BITS
+                   : (int32_t)(((uint64_t)sub_var << NN_FIXED_BITS) / var);
+    }
+
     assert(feature_idx == FEATURES);
-    nn_predict(features, nn_config, score);
+    nn_predict_fixed(features, nn_config, score);
     if (score[0] > thresh) return PARTITION_SPLIT;
     if (score[0] < -thresh) return PARTITION_NONE;
     return -1;
@@ -5637,6 +5820,7 @@ static void encode_nonrd_sb_row(VP9_COMP *cpi, ThreadData *td,
         break;
       case ML_BASED_PARTITION:
         get_estimated_pred(cpi, tile_info, x, mi_row, mi_col);
+        set_est_pred_stats(cpi, x, mi_row, mi_col);
         x->max_partition_size = BLOCK_64X64;
         x->min_partition_size = BLOCK_8X8;
         x->sb_pickmode_part = 1;
@@ -6172,6 +6356,16 @@ static void encode_frame_internal(VP9_COMP *cpi) {
     }
   }
 
+  if (sf->mv.use_pyramid_search && !frame_is_intra_only(cm))
+    vp9_pyramid_me_setup(cpi);
+  if (sf->mv.use_hash_search && !frame_is_intra_only(cm) &&
+      cpi->Last_Source != NULL &&
+      cpi->Last_Source->y_crop_width == cpi->Source->y_crop_width &&
+      cpi->Last_Source->y_crop_height == cpi->Source->y_crop_height)
+    vp9_hash_me_update(&cpi->hash_me, cpi->Last_Source);
+  else
+    cpi->hash_me.ready = 0;
+
   // Frame segmentation
   if (cpi->oxcf.aq_mode == PERCEPTUAL_AQ) build_kmeans_segmentation(cpi);
 
@@ -93,6 +93,7 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
   int64_t rd_cost0, rd_cost1;
   int64_t rate0, rate1;
   int16_t t0, t1;
+  uint8_t class0, class1;
   int i, final_eob;
   int count_high_values_after_eob = 0;
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -100,11 +101,13 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
 #else
   const uint16_t *cat6_high_cost = vp9_get_high_cost_table(8);
 #endif
-  unsigned int(*const token_costs)[2][COEFF_CONTEXTS][ENTROPY_TOKENS] =
+  uint16_t(*const token_costs)[2][COEFF_CONTEXTS][ENTROPY_TOKENS] =
       mb->token_costs[tx_size][plane_type][ref];
-  unsigned int(*token_costs_cur)[2][COEFF_CONTEXTS][ENTROPY_TOKENS];
+  uint16_t(*token_costs_cur)[2][COEFF_CONTEXTS][ENTROPY_TOKENS];
   int64_t eob_cost0, eob_cost1;
   const int ctx0 = ctx;
+  // Context of the current coefficient, or -1 if it is not known yet.
+  int ctx_cur = ctx;
   int64_t accu_rate = 0;
   // Initialized to the worst possible error for the largest transform size.
   // This ensures that it never goes negative.
@@ -117,10 +120,8 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
   assert((!plane_type && !plane) || (plane_type && plane));
   assert(eob <= default_eob);
 
-  for (i = 0; i < eob; i++) {
-    const int rc = scan[i];
-    token_cache[rc] = vp9_pt_energy_class[vp9_get_token(qcoeff[rc])];
-  }
+  // The neighbors of a coefficient precede it in the scan order, so
+  // token_cache[] is filled in as the coefficients are visited.
   final_eob = 0;
 
   // Initial RD cost.
@@ -135,13 +136,15 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
     const int rc = scan[i];
     const int x = qcoeff[rc];
     const int band_cur = band_translate[i];
-    const int ctx_cur = (i == 0) ? ctx : get_coef_context(nb, token_cache, i);
     const int token_tree_sel_cur = (x_prev == 0);
+    // Context of the next coefficient, if the search of this one finds it.
+    int ctx_next = -1;
+    if (ctx_cur < 0) ctx_cur = get_coef_context(nb, token_cache, i);
     token_costs_cur = token_costs + band_cur;
     if (x == 0) {  // No need to search
-      const int token = vp9_get_token(x);
-      rate0 = (*token_costs_cur)[token_tree_sel_cur][ctx_cur][token];
+      rate0 = (*token_costs_cur)[token_tree_sel_cur][ctx_cur][ZERO_TOKEN];
       accu_rate += rate0;
+      token_cache[rc] = vp9_pt_energy_class[ZERO_TOKEN];
       x_prev = 0;
       // Note: accu_error does not change.
     } else {
@@ -189,8 +192,10 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
       }
       {
         // Calculate RDCost for current coeff for the two candidates.
-        const int64_t base_bits0 = vp9_get_token_cost(x, &t0, cat6_high_cost);
-        const int64_t base_bits1 = vp9_get_token_cost(x1, &t1, cat6_high_cost);
+        const int64_t base_bits0 =
+            vp9_get_token_cost_class(x, &t0, &class0, cat6_high_cost);
+        const int64_t base_bits1 =
+            vp9_get_token_cost_class(x1, &t1, &class1, cat6_high_cost);
         rate0 =
             base_bits0 + (*token_costs_cur)[token_tree_sel_cur][ctx_cur][t0];
         rate1 =
@@ -207,29 +212,35 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
         int64_t next_bits1 = 0;
         int64_t next_eob_bits0 = 0;
         int64_t next_eob_bits1 = 0;
+        int ctx_next0 = -1;
+        int ctx_next1 = -1;
         if (i < default_eob - 1) {
-          int ctx_next, token_tree_sel_next;
+          int token_tree_sel_next;
           const int band_next = band_translate[i + 1];
           const int token_next =
               (i + 1 != eob) ? vp9_get_token(qcoeff[scan[i + 1]]) : EOB_TOKEN;
-          unsigned int(*const token_costs_next)[2][COEFF_CONTEXTS]
-                                               [ENTROPY_TOKENS] =
-                                                   token_costs + band_next;
-          token_cache[rc] = vp9_pt_energy_class[t0];
-          ctx_next = get_coef_context(nb, token_cache, i + 1);
+          uint16_t(*const token_costs_next)[2][COEFF_CONTEXTS]
+                                           [ENTROPY_TOKENS] =
+                                               token_costs + band_next;
+          token_cache[rc] = class0;
+          ctx_next0 = get_coef_context(nb, token_cache, i + 1);
           token_tree_sel_next = (x == 0);
           next_bits0 =
-              (*token_costs_next)[token_tree_sel_next][ctx_next][token_next];
+              (*token_costs_next)[token_tree_sel_next][ctx_next0][token_next];
           next_eob_bits0 =
-              (*token_costs_next)[token_tree_sel_next][ctx_next][EOB_TOKEN];
-          token_cache[rc] = vp9_pt_energy_class[t1];
-          ctx_next = get_coef_context(nb, token_cache, i + 1);
+              (*token_costs_next)[token_tree_sel_next][ctx_next0][EOB_TOKEN];
+          if (class1 == class0) {
+            ctx_next1 = ctx_next0;
+          } else {
+            token_cache[rc] = class1;
+            ctx_next1 = get_coef_context(nb, token_cache, i + 1);
+          }
           token_tree_sel_next = (x1 == 0);
           next_bits1 =
-              (*token_costs_next)[token_tree_sel_next][ctx_next][token_next];
+              (*token_costs_next)[token_tree_sel_next][ctx_next1][token_next];
           if (x1 != 0) {
             next_eob_bits1 =
-                (*token_costs_next)[token_tree_sel_next][ctx_next][EOB_TOKEN];
+                (*token_costs_next)[token_tree_sel_next][ctx_next1][EOB_TOKEN];
           }
         }
 
@@ -267,12 +278,14 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
           accu_rate += rate1;
           accu_error += distortion1 - distortion_for_zero;
           assert(distortion1 <= distortion_for_zero);
-          token_cache[rc] = vp9_pt_energy_class[t1];
+          token_cache[rc] = class1;
+          ctx_next = ctx_next1;
         } else {
           accu_rate += rate0;
           accu_error += distortion0 - distortion_for_zero;
           assert(distortion0 <= distortion_for_zero);
-          token_cache[rc] = vp9_pt_energy_class[t0];
+          token_cache[rc] = class0;
+          ctx_next = ctx_next0;
         }
         if (sharpness > 0 && abs(qcoeff[rc]) > 1) count_high_values_after_eob++;
         assert(accu_error >= 0);
@@ -296,6 +309,7 @@ int vp9_optimize_b(MACROBLOCK *mb, int plane, int block, TX_SIZE tx_size,
         }
       }
     }
+    ctx_cur = ctx_next;
   }
   if (count_high_values_after_eob > 0) {
     final_eob = eob - 1;
@@ -798,6 +798,74 @@ int vp9_get_active_map(VP9_COMP *cpi, unsigned char *new_map_16x16, int rows,
   }
 }
 
+static uint8_t seed_square_size(int pixels) {
+  if (pixels >= 48) return BLOCK_64X64;
+  if (pixels >= 24) return BLOCK_32X32;
+  if (pixels >= 12) return BLOCK_16X16;
+  if (pixels >= 6) return BLOCK_8X8;
+  return BLOCK_4X4;
+}
+
+int vp9_set_mode_info_seed(VP9_COMP *cpi, const VpxFrameModeInfo *info) {
+  const VP9_COMMON *const cm = &cpi->common;
+  ModeInfoSeed *const mi_seed = &cpi->mi_seed;
+  int r, c, i;
+
+  if (info == NULL) {
+    mi_seed->enabled = 0;
+    return 0;
+  }
+  if (info->blocks == NULL || info->mi_rows <= 0 || info->mi_cols <= 0 ||
+      info->stride < info->mi_cols ||
+      info->num_blocks < (info->mi_rows - 1) * info->stride + info->mi_cols ||
+      info->frame_width <= 0 || info->frame_height <= 0)
+    return -1;
+
+  if (mi_seed->seeds == NULL || mi_seed->mi_rows != cm->mi_rows ||
+      mi_seed->mi_cols != cm->mi_cols) {
+    vpx_free(mi_seed->seeds);
+    mi_seed->enabled = 0;
+    mi_seed->seeds = (MiSeed *)vpx_malloc(cm->mi_rows * cm->mi_cols *
+                                          sizeof(*mi_seed->seeds));
+    if (mi_seed->seeds == NULL) return -1;
+    mi_seed->mi_rows = cm->mi_rows;
+    mi_seed->mi_cols = cm->mi_cols;
+  }
+
+  // Pick the seed at the center of each 8x8 area, scaling the sizes and the
+  // motion vectors when the seeds come from another resolution.
+  for (r = 0; r < cm->mi_rows; ++r) {
+    const int src_row = (int)VPXMIN((int64_t)(r * MI_SIZE + MI_SIZE / 2) *
+                                        info->frame_height / cm->height /
+                                        MI_SIZE,
+                                    info->mi_rows - 1);
+    for (c = 0; c < cm->mi_cols; ++c) {
+      const int src_col = (int)VPXMIN((int64_t)(c * MI_SIZE + MI_SIZE / 2) *
+                                          info->frame_width / cm->width /
+                                          MI_SIZE,
+                                      info->mi_cols - 1);
+      const VpxBlockModeInfo *const src =
+          &info->blocks[src_row * info->stride + src_col];
+      MiSeed *const seed = &mi_seed->seeds[r * cm->mi_cols + c];
+      const int w = src->block_width * cm->width / info->frame_width;
+      const int h = src->block_height * cm->height / info->frame_height;
+
+      seed->bsize = seed_square_size(VPXMAX(w, h));
+      for (i = 0; i < 2; ++i) {
+        seed->ref_frame[i] = src->ref_frame[i];
+        seed->mv[i].row = (int16_t)clamp(
+            src->mv_row[i] * cm->height / info->frame_height, MV_LOW + 1,
+            MV_UPP - 1);
+        seed->mv[i].col = (int16_t)clamp(
+            src->mv_col[i] * cm->width / info->frame_width, MV_LOW + 1,
+            MV_UPP - 1);
+      }
+    }
+  }
+  mi_seed->enabled = 1;
+  return 0;
+}
+
 void vp9_set_high_precision_mv(VP9_COMP *cpi, int allow_high_precision_mv) {
   MACROBLOCK *const mb = &cpi->td.mb;
   cpi->common.allow_high_precision_mv = allow_high_precision_mv;
@@ -938,6 +1006,7 @@ static void initialize_enc(void) {
   vp9_init_me_luts();
   vp9_rc_init_minq_luts();
   vp9_entropy_mv_init();
+  vp9_init_ml_var_partition();
 #if !CONFIG_REALTIME_ONLY
   vp9_temporal_filter_init();
 #endif
@@ -1012,6 +1081,9 @@ static void dealloc_compressor_data(VP9_COMP *cpi) {
   vpx_free(cpi->active_map.map);
   cpi->active_map.map = NULL;
 
+  vpx_free(cpi->mi_seed.seeds);
+  cpi->mi_seed.seeds = NULL;
+
   vpx_free(cpi->roi.roi_map);
   cpi->roi.roi_map = NULL;
 
@@ -1049,6 +1121,9 @@ static void dealloc_compressor_data(VP9_COMP *cpi) {
 #endif
 
   vp9_lookahead_destroy(cpi->lookahead);
+  vp9_motion_cache_free(&cpi->motion_cache);
+  vp9_pyramid_me_free(&cpi->pyramid_me);
+  vp9_hash_me_free(&cpi->hash_me);
 
   vpx_free(cpi->tile_tok[0][0]);
   cpi->tile_tok[0][0] = 0;
@@ -1065,6 +1140,9 @@ static void dealloc_compressor_data(VP9_COMP *cpi) {
     lc->rc_twopass_stats_in.sz = 0;
   }
 
+  vpx_free(cpi->twopass.scaled_stats);
+  cpi->twopass.scaled_stats = NULL;
+
   if (cpi->source_diff_var != NULL) {
     vpx_free(cpi->source_diff_var);
     cpi->source_diff_var = NULL;
@@ -1485,6 +1563,7 @@ static void init_config(struct VP9_COMP *cpi, const VP9EncoderConfig *oxcf) {
   VP9_COMMON *const cm = &cpi->common;
 
   cpi->oxcf = *oxcf;
+  cpi->time_budget.base_speed = oxcf->speed;
   cpi->framerate = oxcf->init_framerate;
   cm->profile = oxcf->profile;
   cm->bit_depth = oxcf->bit_depth;
@@ -2088,6 +2167,8 @@ void vp9_change_config(struct VP9_COMP *cpi, const VP9EncoderConfig *oxcf) {
     assert(cm->bit_depth > VPX_BITS_8);
 
   cpi->oxcf = *oxcf;
+  cpi->time_budget.base_speed = oxcf->speed;
+  cpi->oxcf.speed = vp9_get_time_budget_speed(cpi);
 #if CONFIG_VP9_HIGHBITDEPTH
   cpi->td.mb.e_mbd.bd = (int)cm->bit_depth;
 #endif  // CONFIG_VP9_HIGHBITDEPTH
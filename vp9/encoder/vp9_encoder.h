@@ -44,11 +44,14 @@
 #include "vp9/encoder/vp9_ethread.h"
 #include "vp9/encoder/vp9_ext_ratectrl.h"
 #include "vp9/encoder/vp9_firstpass.h"
+#include "vp9/encoder/vp9_hash_me.h"
 #include "vp9/encoder/vp9_job_queue.h"
 #include "vp9/encoder/vp9_lookahead.h"
 #include "vp9/encoder/vp9_mbgraph.h"
 #include "vp9/encoder/vp9_mcomp.h"
+#include "vp9/encoder/vp9_motion_cache.h"
 #include "vp9/encoder/vp9_noise_estimate.h"
+#include "vp9/encoder/vp9_pyramid_me.h"
 #include "vp9/encoder/vp9_quantize.h"
 #include "vp9/encoder/vp9_ratectrl.h"
 #include "vp9/encoder/vp9_rd.h"
@@ -265,6 +268,10 @@ typedef struct VP9EncoderConfig {
 
   int enable_keyframe_filtering;
 
+  int enable_pyramid_search;
+
+  int enable_hash_search;
+
   int max_threads;
 
   unsigned int target_level;
@@ -402,6 +409,21 @@ typedef struct ActiveMap {
   unsigned char *map;
 } ActiveMap;
 
+// Mode info of one 8x8 area taken from another encode of the source,
+// rescaled to the coded frame size.
+typedef struct MiSeed {
+  MV mv[2];
+  int8_t ref_frame[2];
+  uint8_t bsize;  // Square block size closest to the seeded block.
+} MiSeed;
+
+typedef struct ModeInfoSeed {
+  int enabled;
+  int mi_rows;
+  int mi_cols;
+  MiSeed *seeds;
+} ModeInfoSeed;
+
 typedef enum { Y, U, V, ALL } STAT_TYPE;
 
 typedef struct IMAGE_STAT {
@@ -506,6 +528,10 @@ typedef struct ARNRFilterData {
   int alt_ref_index;
   struct scale_factors sf;
   YV12_BUFFER_CONFIG *dst;
+  // Lookahead show_idx of each frame, -1 if it does not use the motion cache.
+  int show_idx[MAX_LAG_BUFFERS];
+  // Where the motion of the ARF in each frame is stored, may be NULL.
+  MotionCacheField *motion_fields[MAX_LAG_BUFFERS];
 } ARNRFilterData;
 
 typedef struct EncFrameBuf {
@@ -835,9 +861,17 @@ typedef struct VP9_COMP {
   MBGRAPH_FRAME_STATS mbgraph_stats[MAX_LAG_BUFFERS];
   int mbgraph_n_frames;  // number of frames filled in the above
   int static_mb_pct;     // % forced skip mbs by segmentation
+
+  // Motion shared by the analysis stages searching the lookahead frames.
+  MotionCache motion_cache;
+  // Downsampled source and references of the frame being encoded.
+  PyramidMe pyramid_me;
+  // Block hashes of the source the LAST reference was coded from.
+  HashMe hash_me;
   int ref_frame_flags;
 
   SPEED_FEATURES sf;
+  ENCODE_TIME_BUDGET time_budget;
 
   uint32_t max_mv_magnitude;
   int mv_step_param;
@@ -860,6 +894,7 @@ typedef struct VP9_COMP {
 
   CYCLIC_REFRESH *cyclic_refresh;
   ActiveMap active_map;
+  ModeInfoSeed mi_seed;
 
   fractional_mv_step_fp *find_fractional_mv_step;
   struct scale_factors me_sf;
@@ -1251,6 +1286,8 @@ int vp9_set_active_map(VP9_COMP *cpi, unsigned char *new_map_16x16, int rows,
 int vp9_get_active_map(VP9_COMP *cpi, unsigned char *new_map_16x16, int rows,
                        int cols);
 
+int vp9_set_mode_info_seed(VP9_COMP *cpi, const VpxFrameModeInfo *info);
+
 int vp9_set_internal_size(VP9_COMP *cpi, VPX_SCALING_MODE horiz_mode,
                           VPX_SCALING_MODE vert_mode);
 
@@ -1546,6 +1583,36 @@ static INLINE uint32_t get_start_mv_sad(const MACROBLOCK *x, const MV *mvp_full,
   return start_mv_sad;
 }
 
+static INLINE int vp9_mi_seed_active(const VP9_COMP *cpi) {
+  const ModeInfoSeed *const mi_seed = &cpi->mi_seed;
+  return mi_seed->enabled && mi_seed->mi_rows == cpi->common.mi_rows &&
+         mi_seed->mi_cols == cpi->common.mi_cols;
+}
+
+// Returns 1 and the seeded motion vector, in 1/8 pel, when the seed at the
+// center of the block has one for ref_frame.
+static INLINE int vp9_get_seed_mv(const VP9_COMP *cpi, int mi_row, int mi_col,
+                                  BLOCK_SIZE bsize,
+                                  MV_REFERENCE_FRAME ref_frame, MV *mv) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const int row = VPXMIN(mi_row + (num_8x8_blocks_high_lookup[bsize] >> 1),
+                         cm->mi_rows - 1);
+  const int col = VPXMIN(mi_col + (num_8x8_blocks_wide_lookup[bsize] >> 1),
+                         cm->mi_cols - 1);
+  const MiSeed *seed;
+  int i;
+
+  if (!vp9_mi_seed_active(cpi)) return 0;
+  seed = &cpi->mi_seed.seeds[row * cm->mi_cols + col];
+  for (i = 0; i < 2; ++i) {
+    if (seed->ref_frame[i] == ref_frame) {
+      *mv = seed->mv[i];
+      return 1;
+    }
+  }
+  return 0;
+}
+
 static INLINE int num_4x4_to_edge(int plane_4x4_dim, int mb_to_edge_dim,
                                   int subsampling_dim, int blk_dim) {
   return plane_4x4_dim + (mb_to_edge_dim >> (5 + subsampling_dim)) - blk_dim;
@@ -18,6 +18,7 @@
 #include "vp9/encoder/vp9_temporal_filter.h"
 #include "vpx_dsp/vpx_dsp_common.h"
 #include "vpx_util/vpx_pthread.h"
+#include "vpx_util/vpx_trace.h"
 
 static void accumulate_rd_opt(ThreadData *td, ThreadData *td_t) {
   int i, j, k, l, m, n;
@@ -53,7 +54,9 @@ static int enc_worker_hook(void *arg1, void *unused) {
     int tile_row = t / tile_cols;
     int tile_col = t % tile_cols;
 
+    VPX_TRACE_BEGIN("encode_tile", t);
     vp9_encode_tile(cpi, thread_data->td, tile_row, tile_col);
+    VPX_TRACE_END("encode_tile");
   }
 
   return 1;
@@ -356,8 +359,12 @@ void vp9_row_mt_sync_read(VP9RowMTSync *const row_mt_sync, int r, int c) {
     pthread_mutex_t *const mutex = &row_mt_sync->mutex[r - 1];
     pthread_mutex_lock(mutex);
 
-    while (c > row_mt_sync->cur_col[r - 1] - nsync + 1) {
-      pthread_cond_wait(&row_mt_sync->cond[r - 1], mutex);
+    if (c > row_mt_sync->cur_col[r - 1] - nsync + 1) {
+      VPX_TRACE_BEGIN("enc_row_sync_wait", r);
+      while (c > row_mt_sync->cur_col[r - 1] - nsync + 1) {
+        pthread_cond_wait(&row_mt_sync->cond[r - 1], mutex);
+      }
+      VPX_TRACE_END("enc_row_sync_wait");
     }
     pthread_mutex_unlock(mutex);
   }
@@ -453,8 +460,10 @@ static int first_pass_worker_hook(void *arg1, void *arg2) {
       best_ref_mv = zero_mv;
       vp9_zero(fp_acc_data);
       fp_acc_data.image_data_start_row = INVALID_ROW;
+      VPX_TRACE_BEGIN("first_pass_mb_row", mb_row);
       vp9_first_pass_encode_tile_mb_row(cpi, thread_data->td, &fp_acc_data,
                                         this_tile, &best_ref_mv, mb_row);
+      VPX_TRACE_END("first_pass_mb_row");
     }
   }
   return 1;
@@ -540,8 +549,10 @@ static int temporal_filter_worker_hook(void *arg1, void *arg2) {
       mb_col_end = (this_tile->tile_info.mi_col_end + TF_ROUND) >> TF_SHIFT;
       mb_row = proc_job->vert_unit_row_num;
 
+      VPX_TRACE_BEGIN("temporal_filter_mb_row", mb_row);
       vp9_temporal_filter_iterate_row_c(cpi, thread_data->td, mb_row,
                                         mb_col_start, mb_col_end);
+      VPX_TRACE_END("temporal_filter_mb_row");
     }
   }
   return 1;
@@ -614,7 +625,9 @@ static int enc_row_mt_worker_hook(void *arg1, void *arg2) {
       tile_row = proc_job->tile_row_id;
       mi_row = proc_job->vert_unit_row_num * MI_BLOCK_SIZE;
 
+      VPX_TRACE_BEGIN("encode_sb_row", mi_row);
       vp9_encode_sb_row(cpi, thread_data->td, tile_row, tile_col, mi_row);
+      VPX_TRACE_END("encode_sb_row");
     }
   }
   return 1;
@@ -1747,6 +1747,36 @@ void vp9_init_second_pass(VP9_COMP *cpi) {
   twopass->bits_left =
       (int64_t)(stats->duration * oxcf->target_bandwidth / 10000000.0);
 
+  if (twopass->segment_num_frames > 0) {
+    // Only a segment of the frames is encoded. The scores above are
+    // normalized over all of the frames, so the segment gets the share of
+    // the bits its frames would get in a single pass over all of them. The
+    // total stats are kept for the whole clip.
+    const FIRSTPASS_STATS *const start =
+        twopass->stats_in_start + twopass->segment_first_frame;
+    const FIRSTPASS_STATS *const end = start + twopass->segment_num_frames;
+    const double av_err = get_distribution_av_err(cpi, twopass);
+    double segment_score = 0.0;
+    const FIRSTPASS_STATS *s;
+
+    zero_stats(&twopass->total_left_stats);
+    for (s = start; s < end; ++s) {
+      segment_score +=
+          calculate_norm_frame_score(cpi, twopass, oxcf, s, av_err);
+      accumulate_stats(&twopass->total_left_stats, s);
+    }
+    twopass->bits_left = (int64_t)(
+        twopass->bits_left *
+        (segment_score / DOUBLE_DIVIDE_CHECK(twopass->normalized_score_left)));
+    twopass->normalized_score_left = segment_score;
+
+    twopass->stats_in_start = start;
+    twopass->stats_in = start;
+    twopass->stats_in_end = end;
+    fps_init_first_pass_info(&twopass->first_pass_info, start,
+                             twopass->segment_num_frames);
+  }
+
   // This variable monitors how far behind the second ref update is lagging.
   twopass->sr_update_lag = 1;
 
@@ -1774,6 +1804,90 @@ void vp9_init_second_pass(VP9_COMP *cpi) {
   twopass->arnr_strength_adjustment = 0;
 }
 
+int vp9_set_first_pass_frame_size(VP9_COMP *cpi, int width, int height) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const VP9EncoderConfig *const oxcf = &cpi->oxcf;
+  TWO_PASS *const twopass = &cpi->twopass;
+  const int packets =
+      (int)(oxcf->two_pass_stats_in.sz / sizeof(FIRSTPASS_STATS));
+  const FIRSTPASS_STATS *const src = oxcf->two_pass_stats_in.buf;
+  int mi_rows, mi_cols, mi_stride, mb_rows, mb_cols, mb_num;
+  double row_scale, col_scale, mb_row_scale;
+  int i;
+
+  // The stats can only be swapped before the second pass has consumed any of
+  // them. Corpus VBR rescales the target bandwidth on every initialization.
+  if (oxcf->pass != 2 || cpi->use_svc || oxcf->vbr_corpus_complexity ||
+      packets < 1 || twopass->stats_in != twopass->stats_in_start ||
+      cm->current_video_frame != 0 || width <= 0 || height <= 0)
+    return -1;
+
+  vp9_set_mi_size(&mi_rows, &mi_cols, &mi_stride, width, height);
+  vp9_set_mb_size(&mb_rows, &mb_cols, &mb_num, mi_rows, mi_cols);
+  row_scale = (double)cm->height / height;
+  col_scale = (double)cm->width / width;
+  mb_row_scale = (double)cm->mb_rows / mb_rows;
+
+  if (twopass->scaled_stats == NULL) {
+    twopass->scaled_stats =
+        (FIRSTPASS_STATS *)vpx_malloc(oxcf->two_pass_stats_in.sz);
+    if (twopass->scaled_stats == NULL) return -1;
+  }
+
+  // The last packet holds the sums of the others, which scale the same way.
+  for (i = 0; i < packets; ++i) {
+    FIRSTPASS_STATS *const dst = &twopass->scaled_stats[i];
+    *dst = src[i];
+    dst->inactive_zone_rows *= mb_row_scale;
+    dst->inactive_zone_cols *= (double)cm->mb_cols / mb_cols;
+    dst->MVr *= row_scale;
+    dst->mvr_abs *= row_scale;
+    dst->MVrv *= row_scale * row_scale;
+    dst->MVc *= col_scale;
+    dst->mvc_abs *= col_scale;
+    dst->MVcv *= col_scale * col_scale;
+  }
+
+  twopass->stats_in_start = twopass->scaled_stats;
+  twopass->stats_in = twopass->stats_in_start;
+  twopass->stats_in_end = &twopass->stats_in[packets - 1];
+  fps_init_first_pass_info(&twopass->first_pass_info, twopass->stats_in_start,
+                           packets - 1);
+  vp9_init_second_pass(cpi);
+  return 0;
+}
+
+int vp9_set_two_pass_segment(VP9_COMP *cpi, int first_frame, int num_frames) {
+  const VP9_COMMON *const cm = &cpi->common;
+  const VP9EncoderConfig *const oxcf = &cpi->oxcf;
+  TWO_PASS *const twopass = &cpi->twopass;
+  const int packets =
+      (int)(oxcf->two_pass_stats_in.sz / sizeof(FIRSTPASS_STATS));
+
+  // As with vp9_set_first_pass_frame_size(), the second pass can only be
+  // initialized again before it has consumed any stats. The last packet holds
+  // the sums of the others and is not a frame.
+  if (oxcf->pass != 2 || cpi->use_svc || oxcf->vbr_corpus_complexity ||
+      packets < 1 || twopass->stats_in != twopass->stats_in_start ||
+      cm->current_video_frame != 0 || first_frame < 0 || num_frames < 0 ||
+      first_frame > packets - 1 - num_frames)
+    return -1;
+
+  twopass->segment_first_frame = num_frames > 0 ? first_frame : 0;
+  twopass->segment_num_frames = num_frames;
+
+  // Start over from all of the stats, rescaled if they were.
+  twopass->stats_in_start = twopass->scaled_stats != NULL
+                                ? twopass->scaled_stats
+                                : oxcf->two_pass_stats_in.buf;
+  twopass->stats_in = twopass->stats_in_start;
+  twopass->stats_in_end = &twopass->stats_in[packets - 1];
+  fps_init_first_pass_info(&twopass->first_pass_info, twopass->stats_in_start,
+                           packets - 1);
+  vp9_init_second_pass(cpi);
+  return 0;
+}
+
 /* This function considers how the quality of prediction may be deteriorating
  * with distance. It compares the coded error for the last frame and the
  * second reference frame (usually two frames old) and also applies a factor
@@ -3732,8 +3846,7 @@ void vp9_rc_get_second_pass_params(VP9_COMP *cpi) {
   if (cpi->oxcf.rc_mode == VPX_Q) {
     twopass->active_worst_quality = cpi->oxcf.cq_level;
   } else if (cm->current_video_frame == 0) {
-    const int frames_left =
-        (int)(twopass->total_stats.count - cm->current_video_frame);
+    const int frames_left = (int)twopass->total_left_stats.count;
     // Special case code for first frame.
     int64_t section_target_bandwidth = twopass->bits_left / frames_left;
     section_target_bandwidth = VPXMIN(section_target_bandwidth, INT_MAX);
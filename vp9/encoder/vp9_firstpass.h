@@ -143,6 +143,12 @@ typedef struct {
   const FIRSTPASS_STATS *stats_in;
   const FIRSTPASS_STATS *stats_in_start;
   const FIRSTPASS_STATS *stats_in_end;
+  // Copy of the stats rescaled by vp9_set_first_pass_frame_size().
+  FIRSTPASS_STATS *scaled_stats;
+  // Range of the frames of the stats encoded, set by
+  // vp9_set_two_pass_segment(). All of them when segment_num_frames is 0.
+  int segment_first_frame;
+  int segment_num_frames;
   FIRST_PASS_INFO first_pass_info;
   FIRSTPASS_STATS total_left_stats;
   int first_pass_done;
@@ -214,6 +220,20 @@ void vp9_first_pass_encode_tile_mb_row(struct VP9_COMP *cpi,
                                        MV *best_ref_mv, int mb_row);
 
 void vp9_init_second_pass(struct VP9_COMP *cpi);
+// Sets the size of the frames the two pass stats were collected on, when the
+// second pass encodes at another size. The stats are normalized per
+// macroblock, as with internal resizing, except for the motion vectors and
+// the inactive rows, which are rescaled to the size of the second pass.
+// Must be called before the first frame is encoded. Returns 0 on success.
+int vp9_set_first_pass_frame_size(struct VP9_COMP *cpi, int width, int height);
+// Restricts the second pass to num_frames frames of the stats starting at
+// first_frame, with the bits those frames would get in a single second pass
+// over all of the stats. Lets several encoders work on the segments of a
+// clip, split at key frames, in parallel. A num_frames of 0 encodes all of
+// the frames again. Must be called before the first frame is encoded.
+// Returns 0 on success.
+int vp9_set_two_pass_segment(struct VP9_COMP *cpi, int first_frame,
+                             int num_frames);
 void vp9_rc_get_second_pass_params(struct VP9_COMP *cpi);
 void vp9_init_vizier_params(TWO_PASS *const twopass, int screen_area);
 
@@ -0,0 +1,340 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <limits.h>
+#include <string.h>
+
+#include "vpx_dsp/vpx_dsp_common.h"
+#include "vpx_mem/vpx_mem.h"
+#include "vp9/common/vp9_common_data.h"
+#include "vp9/encoder/vp9_hash_me.h"
+
+#define ROW_MULT 0x9E3779B1u
+#define COL_MULT 0x85EBCA77u
+#define MIN_TABLE_BITS 10
+#define MAX_TABLE_BITS 20
+// The index is built again from scratch when more than 1/REBUILD_RATIO of
+// the row segments changed. Hashing a changed position on its own costs a
+// full block, while a build slides the hashes at a constant cost per
+// position.
+#define REBUILD_RATIO 16
+
+static uint32_t power(uint32_t base, int exponent) {
+  uint32_t result = 1;
+  while (exponent-- > 0) result *= base;
+  return result;
+}
+
+// Returns the hash of the block at |src|, which is the same as the one the
+// incremental hashing of build_index() gives, and sets |flat| if all its
+// rows are flat.
+static uint32_t block_hash(const uint8_t *src, int stride, int *flat) {
+  uint32_t hash = 0;
+  int r, c;
+  *flat = 1;
+  for (r = 0; r < HASH_ME_BLOCK_SIZE; ++r) {
+    uint32_t row_hash = 0;
+    for (c = 0; c < HASH_ME_BLOCK_SIZE; ++c) {
+      row_hash = row_hash * ROW_MULT + src[c];
+      if (src[c] != src[0]) *flat = 0;
+    }
+    hash = hash * COL_MULT + row_hash;
+    src += stride;
+  }
+  return hash;
+}
+
+// Hashes the |n| pixels of a row segment.
+static uint32_t segment_hash(const uint8_t *src, int n) {
+  uint32_t hash = 0;
+  int c;
+  for (c = 0; c < n; ++c) hash = hash * ROW_MULT + src[c];
+  return hash;
+}
+
+// Hashes the row segments of row |y| of |img| into |hashes|.
+static void hash_row_segments(const HashMe *hash_me,
+                              const YV12_BUFFER_CONFIG *img, int y,
+                              uint32_t *hashes) {
+  const uint8_t *const src = img->y_buffer + y * img->y_stride;
+  int s;
+  for (s = 0; s < hash_me->num_segments; ++s) {
+    const int x = s * HASH_ME_BLOCK_SIZE;
+    hashes[s] =
+        segment_hash(src + x, VPXMIN(HASH_ME_BLOCK_SIZE, hash_me->width - x));
+  }
+}
+
+static void link_entry(HashMe *hash_me, int pos, uint32_t hash) {
+  HashMeEntry *const entry = &hash_me->entries[pos];
+  int *const bucket =
+      &hash_me->buckets[hash & ((1u << hash_me->table_bits) - 1)];
+  entry->hash = hash;
+  entry->next = *bucket;
+  entry->prev = -1;
+  if (*bucket >= 0) hash_me->entries[*bucket].prev = pos;
+  *bucket = pos;
+}
+
+static void unlink_entry(HashMe *hash_me, int pos) {
+  HashMeEntry *const entry = &hash_me->entries[pos];
+  if (entry->prev == HASH_ME_NOT_LINKED) return;
+  if (entry->prev >= 0) {
+    hash_me->entries[entry->prev].next = entry->next;
+  } else {
+    hash_me->buckets[entry->hash & ((1u << hash_me->table_bits) - 1)] =
+        entry->next;
+  }
+  if (entry->next >= 0) hash_me->entries[entry->next].prev = entry->prev;
+  entry->prev = HASH_ME_NOT_LINKED;
+}
+
+void vp9_hash_me_free(HashMe *hash_me) {
+  vpx_free(hash_me->buckets);
+  vpx_free(hash_me->entries);
+  vpx_free(hash_me->segment_hashes);
+  vpx_free(hash_me->changed);
+  vpx_free(hash_me->row_hashes);
+  vpx_free(hash_me->block_hashes);
+  vpx_free(hash_me->flat_rows);
+  vpx_free(hash_me->runs);
+  memset(hash_me, 0, sizeof(*hash_me));
+}
+
+static int alloc_index(HashMe *hash_me, int width, int height) {
+  const int cols = width - HASH_ME_BLOCK_SIZE + 1;
+  const int rows = height - HASH_ME_BLOCK_SIZE + 1;
+  const int num_segments =
+      (width + HASH_ME_BLOCK_SIZE - 1) / HASH_ME_BLOCK_SIZE;
+  int table_bits = MIN_TABLE_BITS;
+
+  vp9_hash_me_free(hash_me);
+  while (table_bits < MAX_TABLE_BITS && (1 << table_bits) < cols * rows)
+    ++table_bits;
+  hash_me->buckets =
+      (int *)vpx_malloc(sizeof(*hash_me->buckets) << table_bits);
+  hash_me->entries = (HashMeEntry *)vpx_malloc(sizeof(*hash_me->entries) *
+                                               (size_t)cols * rows);
+  hash_me->segment_hashes = (uint32_t *)vpx_malloc(
+      sizeof(*hash_me->segment_hashes) * num_segments * height);
+  hash_me->changed = (uint8_t *)vpx_malloc(num_segments * height);
+  hash_me->row_hashes = (uint32_t *)vpx_malloc(
+      sizeof(*hash_me->row_hashes) * HASH_ME_BLOCK_SIZE * cols);
+  hash_me->block_hashes =
+      (uint32_t *)vpx_malloc(sizeof(*hash_me->block_hashes) * cols);
+  hash_me->flat_rows = (uint8_t *)vpx_malloc(cols);
+  hash_me->runs = (uint8_t *)vpx_malloc(width);
+  if (hash_me->buckets == NULL || hash_me->entries == NULL ||
+      hash_me->segment_hashes == NULL || hash_me->changed == NULL ||
+      hash_me->row_hashes == NULL || hash_me->block_hashes == NULL ||
+      hash_me->flat_rows == NULL || hash_me->runs == NULL) {
+    vp9_hash_me_free(hash_me);
+    return 0;
+  }
+  hash_me->width = width;
+  hash_me->height = height;
+  hash_me->cols = cols;
+  hash_me->table_bits = table_bits;
+  hash_me->num_segments = num_segments;
+  return 1;
+}
+
+// Indexes every position of |img| from scratch.
+static void build_index(HashMe *hash_me, const YV12_BUFFER_CONFIG *img) {
+  const int width = hash_me->width;
+  const int height = hash_me->height;
+  const int cols = hash_me->cols;
+  // Weights of the pixel leaving a row hash and of the row hash leaving a
+  // block hash.
+  const uint32_t row_weight = power(ROW_MULT, HASH_ME_BLOCK_SIZE - 1);
+  const uint32_t col_weight = power(COL_MULT, HASH_ME_BLOCK_SIZE);
+  int x, y;
+
+  memset(hash_me->buckets, 0xff, sizeof(*hash_me->buckets)
+                                     << hash_me->table_bits);
+  memset(hash_me->block_hashes, 0, sizeof(*hash_me->block_hashes) * cols);
+  memset(hash_me->flat_rows, 0, cols);
+
+  for (y = 0; y < height; ++y) {
+    const uint8_t *const src = img->y_buffer + y * img->y_stride;
+    // The ring of row hashes holds row y - HASH_ME_BLOCK_SIZE in this slot.
+    uint32_t *const row_hashes =
+        hash_me->row_hashes + (y % HASH_ME_BLOCK_SIZE) * cols;
+    uint32_t row_hash = 0;
+
+    hash_row_segments(hash_me, img, y,
+                      hash_me->segment_hashes + y * hash_me->num_segments);
+    hash_me->runs[width - 1] = 1;
+    for (x = width - 2; x >= 0; --x) {
+      hash_me->runs[x] =
+          src[x] == src[x + 1]
+              ? VPXMIN(hash_me->runs[x + 1] + 1, HASH_ME_BLOCK_SIZE)
+              : 1;
+    }
+    for (x = 0; x < HASH_ME_BLOCK_SIZE; ++x)
+      row_hash = row_hash * ROW_MULT + src[x];
+
+    for (x = 0; x < cols; ++x) {
+      const uint32_t leaving = y >= HASH_ME_BLOCK_SIZE ? row_hashes[x] : 0;
+      const uint32_t hash =
+          hash_me->block_hashes[x] * COL_MULT + row_hash - leaving * col_weight;
+      hash_me->block_hashes[x] = hash;
+      row_hashes[x] = row_hash;
+      hash_me->flat_rows[x] =
+          hash_me->runs[x] >= HASH_ME_BLOCK_SIZE
+              ? VPXMIN(hash_me->flat_rows[x] + 1, HASH_ME_BLOCK_SIZE)
+              : 0;
+      if (y >= HASH_ME_BLOCK_SIZE - 1) {
+        const int pos = (y - HASH_ME_BLOCK_SIZE + 1) * cols + x;
+        if (hash_me->flat_rows[x] < HASH_ME_BLOCK_SIZE)
+          link_entry(hash_me, pos, hash);
+        else
+          hash_me->entries[pos].prev = HASH_ME_NOT_LINKED;
+      }
+      if (x + HASH_ME_BLOCK_SIZE < width) {
+        row_hash = (row_hash - src[x] * row_weight) * ROW_MULT +
+                   src[x + HASH_ME_BLOCK_SIZE];
+      }
+    }
+  }
+  hash_me->valid = 1;
+}
+
+// Flags the row segments of |img| that differ from the indexed frame, stores
+// their new hashes and returns how many there are.
+static int find_changed_segments(HashMe *hash_me,
+                                 const YV12_BUFFER_CONFIG *img) {
+  const int num_segments = hash_me->num_segments;
+  int num_changed = 0;
+  int y, s;
+  for (y = 0; y < hash_me->height; ++y) {
+    const uint8_t *const src = img->y_buffer + y * img->y_stride;
+    uint32_t *const hashes = hash_me->segment_hashes + y * num_segments;
+    uint8_t *const changed = hash_me->changed + y * num_segments;
+    for (s = 0; s < num_segments; ++s) {
+      const int x = s * HASH_ME_BLOCK_SIZE;
+      const uint32_t hash =
+          segment_hash(src + x, VPXMIN(HASH_ME_BLOCK_SIZE, hash_me->width - x));
+      changed[s] = hash != hashes[s];
+      num_changed += changed[s];
+      hashes[s] = hash;
+    }
+  }
+  return num_changed;
+}
+
+// Hashes again the positions whose block covers a changed row segment.
+static void rehash_changed(HashMe *hash_me, const YV12_BUFFER_CONFIG *img) {
+  const int rows = hash_me->height - HASH_ME_BLOCK_SIZE + 1;
+  const int cols = hash_me->cols;
+  const int num_segments = hash_me->num_segments;
+  // Number of changed segments in each column of segments over the rows of
+  // the blocks at the current row of positions. This reuses the flat row
+  // counts of build_index(), which has at least as many columns.
+  uint8_t *const window = hash_me->flat_rows;
+  int x, y, s;
+
+  memset(window, 0, num_segments);
+  for (y = 0; y < HASH_ME_BLOCK_SIZE - 1; ++y) {
+    for (s = 0; s < num_segments; ++s)
+      window[s] += hash_me->changed[y * num_segments + s];
+  }
+  for (y = 0; y < rows; ++y) {
+    const uint8_t *const entering =
+        hash_me->changed + (y + HASH_ME_BLOCK_SIZE - 1) * num_segments;
+    const uint8_t *const leaving = hash_me->changed + y * num_segments;
+    int next_x = 0;
+    for (s = 0; s < num_segments; ++s) window[s] += entering[s];
+    for (s = 0; s < num_segments; ++s) {
+      // The blocks at x in [x_start, x_end) cover segment s.
+      const int x_start = (s - 1) * HASH_ME_BLOCK_SIZE + 1;
+      const int x_end = VPXMIN((s + 1) * HASH_ME_BLOCK_SIZE, cols);
+      if (!window[s]) continue;
+      for (x = VPXMAX(x_start, next_x); x < x_end; ++x) {
+        const int pos = y * cols + x;
+        int flat;
+        const uint32_t hash = block_hash(img->y_buffer + y * img->y_stride + x,
+                                         img->y_stride, &flat);
+        unlink_entry(hash_me, pos);
+        if (!flat) link_entry(hash_me, pos, hash);
+      }
+      next_x = VPXMAX(next_x, x_end);
+    }
+    for (s = 0; s < num_segments; ++s) window[s] -= leaving[s];
+  }
+}
+
+void vp9_hash_me_update(HashMe *hash_me, const YV12_BUFFER_CONFIG *img) {
+  const int width = img->y_crop_width;
+  const int height = img->y_crop_height;
+
+  hash_me->ready = 0;
+  if (img->flags & YV12_FLAG_HIGHBITDEPTH) return;
+  if (width < HASH_ME_BLOCK_SIZE || height < HASH_ME_BLOCK_SIZE ||
+      width > INT16_MAX || height > INT16_MAX)
+    return;
+  if (hash_me->buckets == NULL || hash_me->width != width ||
+      hash_me->height != height) {
+    if (!alloc_index(hash_me, width, height)) return;
+  }
+
+  if (!hash_me->valid) {
+    build_index(hash_me, img);
+  } else {
+    const int num_changed = find_changed_segments(hash_me, img);
+    if (num_changed * REBUILD_RATIO > hash_me->num_segments * height)
+      build_index(hash_me, img);
+    else if (num_changed > 0)
+      rehash_changed(hash_me, img);
+  }
+  hash_me->ready = 1;
+}
+
+int vp9_hash_me_search(const HashMe *hash_me, const MACROBLOCK *x,
+                       const vp9_variance_fn_ptr_t *fn_ptr, int mi_row,
+                       int mi_col, MV *mv, unsigned int *sad) {
+  const struct buf_2d *const src = &x->plane[0].src;
+  const struct buf_2d *const pre = &x->e_mbd.plane[0].pre[0];
+  const MvLimits *const limits = &x->mv_limits;
+  const int row = mi_row * MI_SIZE;
+  const int col = mi_col * MI_SIZE;
+  int num_candidates = 0;
+  int flat, idx;
+  uint32_t hash;
+
+  *sad = UINT_MAX;
+  if (!hash_me->ready) return 0;
+  hash = block_hash(src->buf, src->stride, &flat);
+  if (flat) return 0;
+
+  for (idx = hash_me->buckets[hash & ((1u << hash_me->table_bits) - 1)];
+       idx >= 0 && num_candidates < HASH_ME_MAX_CANDIDATES;
+       idx = hash_me->entries[idx].next) {
+    const HashMeEntry *const entry = &hash_me->entries[idx];
+    MV this_mv;
+    unsigned int this_sad;
+    if (entry->hash != hash) continue;
+    ++num_candidates;
+    this_mv.row = idx / hash_me->cols - row;
+    this_mv.col = idx % hash_me->cols - col;
+    if ((this_mv.row == 0 && this_mv.col == 0) ||
+        this_mv.row < limits->row_min || this_mv.row > limits->row_max ||
+        this_mv.col < limits->col_min || this_mv.col > limits->col_max)
+      continue;
+    this_sad = fn_ptr->sdf(src->buf, src->stride,
+                           pre->buf + this_mv.row * pre->stride + this_mv.col,
+                           pre->stride);
+    if (this_sad < *sad) {
+      *sad = this_sad;
+      *mv = this_mv;
+    }
+  }
+  return *sad != UINT_MAX;
+}
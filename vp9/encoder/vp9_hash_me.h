@@ -0,0 +1,97 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VPX_VP9_ENCODER_VP9_HASH_ME_H_
+#define VPX_VP9_ENCODER_VP9_HASH_ME_H_
+
+#include "vpx/vpx_integer.h"
+#include "vpx_dsp/variance.h"
+#include "vpx_scale/yv12config.h"
+#include "vp9/common/vp9_mv.h"
+#include "vp9/encoder/vp9_block.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Exact match motion search for screen content. The index holds a hash of
+// the 16x16 luma block at every pixel position of the source the LAST
+// reference was coded from, so that scrolled or moved content is found
+// whatever the displacement. The hashes are polynomial hashes of the rows
+// combined over the columns, which are updated incrementally as the block
+// slides, at a constant cost per position.
+//
+// Screen content mostly stays the same from frame to frame, so the index is
+// kept across frames. A hash of each 16 pixel row segment of the indexed
+// frame finds the segments that changed in the next one, and only the
+// positions whose block covers a changed segment are hashed again.
+
+#define HASH_ME_BLOCK_SIZE 16
+// Number of matching positions whose SAD is evaluated per lookup.
+#define HASH_ME_MAX_CANDIDATES 8
+#define HASH_ME_NOT_LINKED -2
+
+// Entry of the block at one position, linked into the bucket of its hash.
+typedef struct HashMeEntry {
+  uint32_t hash;
+  // Neighbors in the bucket, -1 at the ends. prev is HASH_ME_NOT_LINKED for
+  // the flat blocks that are not indexed.
+  int next;
+  int prev;
+} HashMeEntry;
+
+typedef struct HashMe {
+  // Whether the index may be searched in the current frame.
+  int ready;
+  // Whether the index and the segment hashes match the last indexed frame.
+  int valid;
+  int width;
+  int height;
+  // Number of block positions per row.
+  int cols;
+  int table_bits;
+  // Index of the first entry of each bucket, -1 for empty buckets.
+  int *buckets;
+  // One entry per block position, in raster order.
+  HashMeEntry *entries;
+  // Hashes of the row segments of the indexed frame, and the flags of the
+  // segments that changed in the frame being indexed.
+  int num_segments;
+  uint32_t *segment_hashes;
+  uint8_t *changed;
+  // Scratch buffers of the incremental hashing.
+  uint32_t *row_hashes;
+  uint32_t *block_hashes;
+  uint8_t *flat_rows;
+  uint8_t *runs;
+} HashMe;
+
+// Indexes the luma plane of |img|, updating the positions that changed since
+// the last indexed frame. Blocks whose rows are all flat are left out, as the
+// zero and the neighboring motion vectors predict them already. Leaves the
+// index not ready for high bitdepth frames or if memory allocation fails.
+void vp9_hash_me_update(HashMe *hash_me, const YV12_BUFFER_CONFIG *img);
+
+void vp9_hash_me_free(HashMe *hash_me);
+
+// Looks up the 16x16 block at the top left of the |bsize| block at
+// (mi_row, mi_col) of x->plane[0].src in the index. Sets |mv| (full pixel)
+// and |sad| to the non-zero candidate within x->mv_limits with the lowest
+// SAD of the whole block against x->e_mbd.plane[0].pre[0] and returns 1, or
+// returns 0 if there is no candidate. |bsize| must be 16x16 or larger.
+int vp9_hash_me_search(const HashMe *hash_me, const MACROBLOCK *x,
+                       const vp9_variance_fn_ptr_t *fn_ptr, int mi_row,
+                       int mi_col, MV *mv, unsigned int *sad);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VPX_VP9_ENCODER_VP9_HASH_ME_H_
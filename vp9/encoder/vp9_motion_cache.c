@@ -0,0 +1,361 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+
+#include "./vpx_dsp_rtcd.h"
+#include "vpx_dsp/vpx_dsp_common.h"
+#include "vpx_mem/vpx_mem.h"
+#include "vp9/common/vp9_common_data.h"
+#include "vp9/encoder/vp9_motion_cache.h"
+
+// Search range of the coarse motion search on the 1/4 resolution level of the
+// pyramid, i.e. 16 pixels at full resolution.
+#define COARSE_SEARCH_RANGE 4
+
+static const MotionCacheFrame *find_frame(const MotionCache *cache,
+                                          int show_idx) {
+  const MotionCacheFrame *frame;
+  if (show_idx < 0) return NULL;
+  frame = &cache->frames[show_idx % MOTION_CACHE_FRAMES];
+  if (!frame->in_use || frame->show_idx != show_idx) return NULL;
+  return frame;
+}
+
+static const MotionCacheField *find_field(const MotionCache *cache,
+                                          int cur_show_idx, int ref_show_idx) {
+  const MotionCacheFrame *const frame = find_frame(cache, cur_show_idx);
+  int i;
+  if (frame == NULL) return NULL;
+  for (i = 0; i < MOTION_CACHE_FIELDS; ++i) {
+    const MotionCacheField *const field = &frame->fields[i];
+    if (field->in_use && field->complete &&
+        field->ref_show_idx == ref_show_idx)
+      return field;
+  }
+  return NULL;
+}
+
+// Returns the entry of |show_idx|, recycling its slot if it holds another
+// frame.
+static MotionCacheFrame *claim_frame(MotionCache *cache, int show_idx,
+                                     int width, int height) {
+  MotionCacheFrame *const frame =
+      &cache->frames[show_idx % MOTION_CACHE_FRAMES];
+  int i;
+
+  if (frame->width != width || frame->height != height) {
+    for (i = 0; i < MOTION_CACHE_FIELDS; ++i) {
+      vpx_free(frame->fields[i].mvs);
+      frame->fields[i].mvs = NULL;
+    }
+    vp9_luma_pyramid_free(&frame->pyramid);
+    frame->in_use = 0;
+    frame->width = width;
+    frame->height = height;
+    frame->mb_rows = (height + 15) >> 4;
+    frame->mb_cols = (width + 15) >> 4;
+  }
+
+  if (!frame->in_use || frame->show_idx != show_idx) {
+    frame->in_use = 1;
+    frame->show_idx = show_idx;
+    frame->pyramid.ready = 0;
+    frame->next_field = 0;
+    for (i = 0; i < MOTION_CACHE_FIELDS; ++i) frame->fields[i].in_use = 0;
+  }
+  return frame;
+}
+
+void vp9_motion_cache_free(MotionCache *cache) {
+  int i, j;
+  for (i = 0; i < MOTION_CACHE_FRAMES; ++i) {
+    MotionCacheFrame *const frame = &cache->frames[i];
+    for (j = 0; j < MOTION_CACHE_FIELDS; ++j) vpx_free(frame->fields[j].mvs);
+    vp9_luma_pyramid_free(&frame->pyramid);
+  }
+  memset(cache, 0, sizeof(*cache));
+}
+
+MotionCacheField *vp9_motion_cache_get_field(MotionCache *cache,
+                                             int cur_show_idx,
+                                             int ref_show_idx, int width,
+                                             int height) {
+  MotionCacheFrame *frame;
+  MotionCacheField *field = NULL;
+  int i;
+
+  if (cur_show_idx < 0 || ref_show_idx < 0) return NULL;
+  frame = claim_frame(cache, cur_show_idx, width, height);
+
+  for (i = 0; i < MOTION_CACHE_FIELDS; ++i) {
+    if (frame->fields[i].in_use &&
+        frame->fields[i].ref_show_idx == ref_show_idx)
+      return &frame->fields[i];
+  }
+  for (i = 0; i < MOTION_CACHE_FIELDS; ++i) {
+    if (!frame->fields[i].in_use) {
+      field = &frame->fields[i];
+      break;
+    }
+  }
+  if (field == NULL) {
+    // Replace the oldest field.
+    field = &frame->fields[frame->next_field];
+    frame->next_field = (frame->next_field + 1) % MOTION_CACHE_FIELDS;
+  }
+
+  if (field->mvs == NULL) {
+    field->mvs = (MV *)vpx_calloc(frame->mb_rows * frame->mb_cols,
+                                  sizeof(*field->mvs));
+    if (field->mvs == NULL) return NULL;
+  }
+  field->in_use = 1;
+  field->complete = 0;
+  field->ref_show_idx = ref_show_idx;
+  field->mb_rows = frame->mb_rows;
+  field->mb_cols = frame->mb_cols;
+  return field;
+}
+
+int vp9_motion_cache_has_motion(const MotionCache *cache, int cur_show_idx,
+                                int ref_show_idx) {
+  return find_field(cache, cur_show_idx, ref_show_idx) != NULL ||
+         find_field(cache, ref_show_idx, cur_show_idx) != NULL;
+}
+
+void vp9_motion_cache_set_mvs(MotionCacheField *field, int mi_row, int mi_col,
+                              BLOCK_SIZE bsize, const MV *mv) {
+  const int mb_row_end = VPXMIN(
+      (mi_row + num_8x8_blocks_high_lookup[bsize] + 1) >> 1, field->mb_rows);
+  const int mb_col_end = VPXMIN(
+      (mi_col + num_8x8_blocks_wide_lookup[bsize] + 1) >> 1, field->mb_cols);
+  int mb_row, mb_col;
+  for (mb_row = mi_row >> 1; mb_row < mb_row_end; ++mb_row) {
+    for (mb_col = mi_col >> 1; mb_col < mb_col_end; ++mb_col)
+      field->mvs[mb_row * field->mb_cols + mb_col] = *mv;
+  }
+}
+
+int vp9_motion_cache_get_mvs(const MotionCache *cache, int cur_show_idx,
+                             int ref_show_idx, int mi_row, int mi_col,
+                             BLOCK_SIZE bsize, MV *mvs) {
+  const MotionCacheField *field = find_field(cache, cur_show_idx, ref_show_idx);
+  int sign = 1;
+  int num_mvs = 0;
+  int mb_row, mb_col, mb_row_end, mb_col_end;
+
+  if (field == NULL) {
+    // The blocks of the reference that are co-located with this block give
+    // a reasonable guess of the motion in the opposite direction.
+    field = find_field(cache, ref_show_idx, cur_show_idx);
+    sign = -1;
+  }
+  if (field == NULL) return 0;
+
+  mb_row_end = VPXMIN((mi_row + num_8x8_blocks_high_lookup[bsize] + 1) >> 1,
+                      field->mb_rows);
+  mb_col_end = VPXMIN((mi_col + num_8x8_blocks_wide_lookup[bsize] + 1) >> 1,
+                      field->mb_cols);
+  for (mb_row = mi_row >> 1; mb_row < mb_row_end; ++mb_row) {
+    for (mb_col = mi_col >> 1; mb_col < mb_col_end; ++mb_col) {
+      const MV *const cached = &field->mvs[mb_row * field->mb_cols + mb_col];
+      MV mv;
+      int i;
+      mv.row = sign * cached->row;
+      mv.col = sign * cached->col;
+      for (i = 0; i < num_mvs; ++i) {
+        if (is_equal_mv(&mvs[i], &mv)) break;
+      }
+      if (i == num_mvs && num_mvs < 4) mvs[num_mvs++] = mv;
+    }
+  }
+  return num_mvs;
+}
+
+void vp9_motion_cache_pick_start_mv(const MACROBLOCK *x,
+                                    const vp9_variance_fn_ptr_t *fn_ptr,
+                                    const MV *mvs, int num_mvs, MV *start_mv) {
+  const struct buf_2d *const src = &x->plane[0].src;
+  const struct buf_2d *const pre = &x->e_mbd.plane[0].pre[0];
+  unsigned int best_sad =
+      fn_ptr->sdf(src->buf, src->stride, pre->buf, pre->stride);
+  int i;
+
+  start_mv->row = 0;
+  start_mv->col = 0;
+  for (i = 0; i < num_mvs; ++i) {
+    MV mv = mvs[i];
+    unsigned int sad;
+    clamp_mv(&mv, x->mv_limits.col_min, x->mv_limits.col_max,
+             x->mv_limits.row_min, x->mv_limits.row_max);
+    if (mv.row == 0 && mv.col == 0) continue;
+    sad = fn_ptr->sdf(src->buf, src->stride,
+                      pre->buf + mv.row * pre->stride + mv.col, pre->stride);
+    if (sad < best_sad) {
+      best_sad = sad;
+      *start_mv = mv;
+    }
+  }
+}
+
+const uint8_t *vp9_motion_cache_get_pyramid(MotionCache *cache,
+                                            const struct lookahead_entry *entry,
+                                            int level, int *stride) {
+  const YV12_BUFFER_CONFIG *const img = &entry->img;
+  MotionCacheFrame *frame;
+
+  assert(level >= 0 && level < PYRAMID_LEVELS);
+  frame = claim_frame(cache, entry->show_idx, img->y_crop_width,
+                      img->y_crop_height);
+
+  if (!frame->pyramid.ready &&
+      !vp9_luma_pyramid_build(&frame->pyramid, img))
+    return NULL;
+
+  *stride = frame->pyramid.stride[level];
+  return frame->pyramid.level[level];
+}
+
+// Returns the SAD of the |size|x|size| window at (row, col) of |src| and the
+// window displaced by |mv| in |ref|, or UINT_MAX if the displaced window does
+// not fit in the border of |ref|.
+static unsigned int window_sad(const uint8_t *src, const uint8_t *ref,
+                               int stride, int width, int height, int row,
+                               int col, const MV *mv, int size) {
+  const int ref_row = row + mv->row;
+  const int ref_col = col + mv->col;
+  const uint8_t *const src_ptr = src + row * stride + col;
+  const uint8_t *const ref_ptr = ref + ref_row * stride + ref_col;
+  if (ref_row < -PYRAMID_BORDER || ref_col < -PYRAMID_BORDER ||
+      ref_row + size > height + PYRAMID_BORDER ||
+      ref_col + size > width + PYRAMID_BORDER)
+    return UINT_MAX;
+  return size == 8 ? vpx_sad8x8(src_ptr, stride, ref_ptr, stride)
+                   : vpx_sad16x16(src_ptr, stride, ref_ptr, stride);
+}
+
+// Searches the +/-1 neighborhood of |center| and updates |best_mv| and
+// |best_sad|.
+static void refine_window(const uint8_t *src, const uint8_t *ref, int stride,
+                          int width, int height, int row, int col, int size,
+                          const MV *center, MV *best_mv,
+                          unsigned int *best_sad) {
+  int dr, dc;
+  for (dr = -1; dr <= 1; ++dr) {
+    for (dc = -1; dc <= 1; ++dc) {
+      MV mv;
+      unsigned int sad;
+      mv.row = center->row + dr;
+      mv.col = center->col + dc;
+      sad = window_sad(src, ref, stride, width, height, row, col, &mv, size);
+      if (sad < *best_sad) {
+        *best_sad = sad;
+        *best_mv = mv;
+      }
+    }
+  }
+}
+
+int vp9_motion_cache_build_field(MotionCache *cache,
+                                 const struct lookahead_entry *cur,
+                                 const struct lookahead_entry *ref) {
+  const uint8_t *cur_levels[PYRAMID_LEVELS];
+  const uint8_t *ref_levels[PYRAMID_LEVELS];
+  const MotionCacheFrame *frame;
+  MotionCacheField *field;
+  int strides[PYRAMID_LEVELS];
+  int ref_stride;
+  int level, mb_row, mb_col;
+
+  if (cur->img.y_crop_width != ref->img.y_crop_width ||
+      cur->img.y_crop_height != ref->img.y_crop_height)
+    return 0;
+  for (level = 0; level < PYRAMID_LEVELS; ++level) {
+    cur_levels[level] =
+        vp9_motion_cache_get_pyramid(cache, cur, level, &strides[level]);
+    ref_levels[level] =
+        vp9_motion_cache_get_pyramid(cache, ref, level, &ref_stride);
+    if (cur_levels[level] == NULL || ref_levels[level] == NULL) return 0;
+    assert(ref_stride == strides[level]);
+  }
+  field = vp9_motion_cache_get_field(cache, cur->show_idx, ref->show_idx,
+                                     cur->img.y_crop_width,
+                                     cur->img.y_crop_height);
+  if (field == NULL) return 0;
+  frame = find_frame(cache, cur->show_idx);
+
+  // Each 16x16 block is matched by the 8x8 window centered on it at 1/4
+  // resolution, with a full search seeded by the motion of the left and
+  // above blocks, then by the 16x16 window centered on it at 1/2 resolution.
+  for (mb_row = 0; mb_row < field->mb_rows; ++mb_row) {
+    for (mb_col = 0; mb_col < field->mb_cols; ++mb_col) {
+      const int q_width = frame->pyramid.width[1];
+      const int q_height = frame->pyramid.height[1];
+      const int q_row = 4 * mb_row - 2;
+      const int q_col = 4 * mb_col - 2;
+      const int h_row = 8 * mb_row - 4;
+      const int h_col = 8 * mb_col - 4;
+      MV best_mv = { 0, 0 };
+      MV center;
+      unsigned int best_sad;
+      int dr, dc;
+
+      best_sad = window_sad(cur_levels[1], ref_levels[1], strides[1], q_width,
+                            q_height, q_row, q_col, &best_mv, 8);
+      for (dr = -COARSE_SEARCH_RANGE; dr <= COARSE_SEARCH_RANGE; ++dr) {
+        for (dc = -COARSE_SEARCH_RANGE; dc <= COARSE_SEARCH_RANGE; ++dc) {
+          MV mv;
+          unsigned int sad;
+          mv.row = dr;
+          mv.col = dc;
+          sad = window_sad(cur_levels[1], ref_levels[1], strides[1], q_width,
+                           q_height, q_row, q_col, &mv, 8);
+          if (sad < best_sad) {
+            best_sad = sad;
+            best_mv = mv;
+          }
+        }
+      }
+      if (mb_col > 0) {
+        const MV *const left = &field->mvs[mb_row * field->mb_cols + mb_col - 1];
+        center.row = left->row / 4;
+        center.col = left->col / 4;
+        refine_window(cur_levels[1], ref_levels[1], strides[1], q_width,
+                      q_height, q_row, q_col, 8, &center, &best_mv, &best_sad);
+      }
+      if (mb_row > 0) {
+        const MV *const above =
+            &field->mvs[(mb_row - 1) * field->mb_cols + mb_col];
+        center.row = above->row / 4;
+        center.col = above->col / 4;
+        refine_window(cur_levels[1], ref_levels[1], strides[1], q_width,
+                      q_height, q_row, q_col, 8, &center, &best_mv, &best_sad);
+      }
+
+      center.row = best_mv.row * 2;
+      center.col = best_mv.col * 2;
+      best_mv = center;
+      best_sad = window_sad(cur_levels[0], ref_levels[0], strides[0],
+                            frame->pyramid.width[0], frame->pyramid.height[0],
+                            h_row, h_col, &best_mv, 16);
+      refine_window(cur_levels[0], ref_levels[0], strides[0],
+                    frame->pyramid.width[0], frame->pyramid.height[0], h_row,
+                    h_col, 16, &center, &best_mv, &best_sad);
+
+      field->mvs[mb_row * field->mb_cols + mb_col].row = best_mv.row * 2;
+      field->mvs[mb_row * field->mb_cols + mb_col].col = best_mv.col * 2;
+    }
+  }
+  field->complete = 1;
+  return 1;
+}
@@ -0,0 +1,130 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VPX_VP9_ENCODER_VP9_MOTION_CACHE_H_
+#define VPX_VP9_ENCODER_VP9_MOTION_CACHE_H_
+
+#include "vpx/vpx_integer.h"
+#include "vpx_dsp/variance.h"
+#include "vpx_scale/yv12config.h"
+#include "vp9/common/vp9_enums.h"
+#include "vp9/common/vp9_mv.h"
+#include "vp9/encoder/vp9_block.h"
+#include "vp9/encoder/vp9_lookahead.h"
+#include "vp9/encoder/vp9_pyramid_me.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The temporal filter and the TPL model both run a full pixel motion search
+// between pairs of lookahead source frames, often between the same pairs.
+// The motion cache keeps, per lookahead frame, the motion fields found by the
+// earlier stages so that the later ones can start their searches from them,
+// and a downsampled luma pyramid from which a coarse motion field can be
+// built when no stage has searched a pair yet.
+//
+// Frames are identified by their lookahead show_idx, which stays unique for
+// the lifetime of the encoder, so entries never need to be invalidated. An
+// entry is recycled once its slot is claimed by a frame with another show_idx.
+
+#define MOTION_CACHE_FRAMES (MAX_LAG_BUFFERS + MAX_PRE_FRAMES)
+// Enough for the temporal filter to keep the motion of an ARF in all the frames
+// it blends.
+#define MOTION_CACHE_FIELDS 16
+// Increase of the step_param of the diamond searches that start from cached
+// motion.
+#define MOTION_CACHE_STEP_PARAM_OFFSET 3
+
+typedef struct MotionCacheField {
+  int in_use;
+  // Set once the motion of every block of the frame has been stored.
+  int complete;
+  int ref_show_idx;
+  int mb_rows;
+  int mb_cols;
+  // Full pixel motion vectors, one per 16x16 block.
+  MV *mvs;
+} MotionCacheField;
+
+typedef struct MotionCacheFrame {
+  int in_use;
+  int show_idx;
+  int width;
+  int height;
+  int mb_rows;
+  int mb_cols;
+  LumaPyramid pyramid;
+  int next_field;
+  MotionCacheField fields[MOTION_CACHE_FIELDS];
+} MotionCacheFrame;
+
+typedef struct MotionCache {
+  MotionCacheFrame frames[MOTION_CACHE_FRAMES];
+} MotionCache;
+
+void vp9_motion_cache_free(MotionCache *cache);
+
+// Returns the field storing the motion of frame |cur_show_idx| searched in
+// frame |ref_show_idx|, creating an incomplete one if the pair has none yet.
+// The caller fills it in with vp9_motion_cache_set_mvs() and marks it
+// complete. Must not be called while other threads access the cache. Returns
+// NULL if memory allocation fails.
+MotionCacheField *vp9_motion_cache_get_field(MotionCache *cache,
+                                             int cur_show_idx,
+                                             int ref_show_idx, int width,
+                                             int height);
+
+// Returns 1 if the motion of |cur_show_idx| in |ref_show_idx|, or of
+// |ref_show_idx| in |cur_show_idx|, is available.
+int vp9_motion_cache_has_motion(const MotionCache *cache, int cur_show_idx,
+                                int ref_show_idx);
+
+// Stores |mv| (full pixel) for the 16x16 blocks covered by the |bsize| block
+// at (mi_row, mi_col).
+void vp9_motion_cache_set_mvs(MotionCacheField *field, int mi_row, int mi_col,
+                              BLOCK_SIZE bsize, const MV *mv);
+
+// Collects the distinct cached full pixel motion vectors of the 16x16 blocks
+// covered by the |bsize| block at (mi_row, mi_col) of |cur_show_idx| in
+// |ref_show_idx|. Motion found in the opposite direction is used negated when
+// the pair has only been searched that way. Returns the number of vectors
+// written to |mvs|, which must have room for 4. Safe to call from several
+// threads as long as no field is being created.
+int vp9_motion_cache_get_mvs(const MotionCache *cache, int cur_show_idx,
+                             int ref_show_idx, int mi_row, int mi_col,
+                             BLOCK_SIZE bsize, MV *mvs);
+
+// Sets |start_mv| to the vector of |mvs| or the zero vector with the lowest
+// SAD between x->plane[0].src and x->e_mbd.plane[0].pre[0], after clamping
+// them to x->mv_limits.
+void vp9_motion_cache_pick_start_mv(const MACROBLOCK *x,
+                                    const vp9_variance_fn_ptr_t *fn_ptr,
+                                    const MV *mvs, int num_mvs, MV *start_mv);
+
+// Returns level |level| of the pyramid of |entry|, building it if needed, and
+// its stride. Returns NULL for high bitdepth frames or on allocation failure.
+// Must not be called while other threads access the cache.
+const uint8_t *vp9_motion_cache_get_pyramid(MotionCache *cache,
+                                            const struct lookahead_entry *entry,
+                                            int level, int *stride);
+
+// Builds a coarse motion field of |cur| in |ref| with a search on the
+// pyramids of the two frames. Returns 0 if the field could not be built. Must
+// not be called while other threads access the cache.
+int vp9_motion_cache_build_field(MotionCache *cache,
+                                 const struct lookahead_entry *cur,
+                                 const struct lookahead_entry *ref);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VPX_VP9_ENCODER_VP9_MOTION_CACHE_H_
@@ -11,6 +11,8 @@
 #ifndef VPX_VP9_ENCODER_VP9_PARTITION_MODELS_H_
 #define VPX_VP9_ENCODER_VP9_PARTITION_MODELS_H_
 
+#include "vpx/vpx_integer.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -33,6 +35,24 @@ typedef struct {
   const float *bias[NN_MAX_HIDDEN_LAYERS + 1];
 } NN_CONFIG;
 
+#define NN_FIXED_MAX_HIDDEN_LAYERS 2
+#define NN_FIXED_MAX_NODES 16
+// Fractional bits of the features, weights and outputs of NN_CONFIG_FIXED.
+#define NN_FIXED_BITS 10
+
+// Fixed point copy of a small NN_CONFIG, for the real-time partition search.
+// Weights are Q10 and biases Q20, so that the products of Q10 features and
+// weights add up with the biases in 64 bits without any rescaling.
+typedef struct {
+  int num_inputs;
+  int num_outputs;
+  int num_hidden_layers;
+  int num_hidden_nodes[NN_FIXED_MAX_HIDDEN_LAYERS];
+  int16_t weights[NN_FIXED_MAX_HIDDEN_LAYERS + 1]
+                 [NN_FIXED_MAX_NODES * NN_FIXED_MAX_NODES];
+  int32_t bias[NN_FIXED_MAX_HIDDEN_LAYERS + 1][NN_FIXED_MAX_NODES];
+} NN_CONFIG_FIXED;
+
 // Partition search breakout model.
 #define FEATURES 4
 #define Q_CTX 3
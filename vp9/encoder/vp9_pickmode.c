@@ -158,9 +158,10 @@ static int combined_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
   MACROBLOCKD *xd = &x->e_mbd;
   MODE_INFO *mi = xd->mi[0];
   struct buf_2d backup_yv12[MAX_MB_PLANE] = { { 0, 0 } };
-  const int step_param = cpi->sf.mv.fullpel_search_step_param;
+  int step_param = cpi->sf.mv.fullpel_search_step_param;
   const int sadpb = x->sadperbit16;
   MV mvp_full;
+  MV seed_mv;
   const int ref = mi->ref_frame[0];
   const MV ref_mv = x->mbmi_ext->ref_mvs[ref][0].as_mv;
   MV center_mv;
@@ -196,6 +197,12 @@ static int combined_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
   else
     mvp_full = x->pred_mv[ref];
 
+  if (vp9_get_seed_mv(cpi, mi_row, mi_col, bsize, ref, &seed_mv)) {
+    // Start from the seeded motion and search a smaller area around it.
+    mvp_full = seed_mv;
+    step_param = VPXMIN(step_param + 2, MAX_MVSEARCH_STEPS - 2);
+  }
+
   mvp_full.col >>= 3;
   mvp_full.row >>= 3;
 
@@ -208,9 +215,29 @@ static int combined_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
     tmp_mv->as_mv.row = x->sb_mvrow_part >> 3;
     tmp_mv->as_mv.col = x->sb_mvcol_part >> 3;
   } else {
-    vp9_full_pixel_search(
-        cpi, x, bsize, &mvp_full, step_param, cpi->sf.mv.search_method, sadpb,
-        cond_cost_list(cpi, cost_list), &center_mv, &tmp_mv->as_mv, INT_MAX, 0);
+    MV hash_mv;
+    unsigned int hash_sad = UINT_MAX;
+    const vp9_variance_fn_ptr_t *const fn_ptr = &cpi->fn_ptr[bsize];
+    if (cpi->sf.mv.use_hash_search && ref == LAST_FRAME &&
+        bsize >= BLOCK_16X16 && scaled_ref_frame == NULL)
+      vp9_hash_me_search(&cpi->hash_me, x, fn_ptr, mi_row, mi_col, &hash_mv,
+                         &hash_sad);
+    if (hash_sad == 0) {
+      // An exact match leaves nothing for the regular search to improve.
+      tmp_mv->as_mv = hash_mv;
+      search_subpel = 0;
+    } else {
+      vp9_full_pixel_search(cpi, x, bsize, &mvp_full, step_param,
+                            cpi->sf.mv.search_method, sadpb,
+                            cond_cost_list(cpi, cost_list), &center_mv,
+                            &tmp_mv->as_mv, INT_MAX, 0);
+      if (hash_sad != UINT_MAX &&
+          hash_sad < fn_ptr->sdf(x->plane[0].src.buf, x->plane[0].src.stride,
+                                 get_buf_from_mv(&xd->plane[0].pre[0],
+                                                 &tmp_mv->as_mv),
+                                 xd->plane[0].pre[0].stride))
+        tmp_mv->as_mv = hash_mv;
+    }
   }
 
   x->mv_limits = tmp_mv_limits;
@@ -232,6 +259,8 @@ static int combined_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
     if (mvp_full.row == 0 && mvp_full.col == 0) search_subpel = 0;
   }
 
+  if (!search_subpel) tmp_mv->as_mv = mvp_full;
+
   if (rv && search_subpel) {
     SUBPEL_FORCE_STOP subpel_force_stop = cpi->sf.mv.subpel_force_stop;
     if (use_base_mv && cpi->sf.base_mv_aggressive) subpel_force_stop = HALF_PEL;
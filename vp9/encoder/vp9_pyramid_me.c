@@ -0,0 +1,272 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+
+#include "vpx_dsp/vpx_dsp_common.h"
+#include "vpx_mem/vpx_mem.h"
+#include "vp9/common/vp9_common_data.h"
+#include "vp9/encoder/vp9_encoder.h"
+#include "vp9/encoder/vp9_pyramid_me.h"
+#include "vp9/encoder/vp9_rd.h"
+
+// Halves |src| with a 2x2 box filter. The last row and column are repeated
+// when the source dimensions are odd.
+static void downsample_plane(const uint8_t *src, int src_stride, int src_width,
+                             int src_height, uint8_t *dst, int dst_stride,
+                             int dst_width, int dst_height) {
+  int r, c;
+  for (r = 0; r < dst_height; ++r) {
+    const uint8_t *const src0 = src + 2 * r * src_stride;
+    const uint8_t *const src1 =
+        src + VPXMIN(2 * r + 1, src_height - 1) * src_stride;
+    for (c = 0; c < dst_width; ++c) {
+      const int c0 = 2 * c;
+      const int c1 = VPXMIN(2 * c + 1, src_width - 1);
+      dst[c] = (src0[c0] + src0[c1] + src1[c0] + src1[c1] + 2) >> 2;
+    }
+    dst += dst_stride;
+  }
+}
+
+static void extend_plane(uint8_t *buf, int stride, int width, int height,
+                         int border) {
+  uint8_t *row = buf;
+  int r;
+  for (r = 0; r < height; ++r) {
+    memset(row - border, row[0], border);
+    memset(row + width, row[width - 1], border);
+    row += stride;
+  }
+  for (r = 1; r <= border; ++r) {
+    memcpy(buf - border - r * stride, buf - border, stride);
+    memcpy(buf - border + (height - 1 + r) * stride,
+           buf - border + (height - 1) * stride, stride);
+  }
+}
+
+void vp9_luma_pyramid_free(LumaPyramid *pyramid) {
+  int i;
+  for (i = 0; i < PYRAMID_LEVELS; ++i) vpx_free(pyramid->alloc[i]);
+  memset(pyramid, 0, sizeof(*pyramid));
+}
+
+int vp9_luma_pyramid_build(LumaPyramid *pyramid,
+                           const YV12_BUFFER_CONFIG *img) {
+  const uint8_t *src = img->y_buffer;
+  int src_stride = img->y_stride;
+  int src_width = img->y_crop_width;
+  int src_height = img->y_crop_height;
+  int i;
+
+  pyramid->ready = 0;
+  if (img->flags & YV12_FLAG_HIGHBITDEPTH) return 0;
+
+  for (i = 0; i < PYRAMID_LEVELS; ++i) {
+    const int width = (src_width + 1) >> 1;
+    const int height = (src_height + 1) >> 1;
+    if (pyramid->alloc[i] == NULL || pyramid->width[i] != width ||
+        pyramid->height[i] != height) {
+      const int stride = (width + 2 * PYRAMID_BORDER + 31) & ~31;
+      vpx_free(pyramid->alloc[i]);
+      pyramid->alloc[i] = (uint8_t *)vpx_memalign(
+          32, (size_t)stride * (height + 2 * PYRAMID_BORDER));
+      if (pyramid->alloc[i] == NULL) {
+        vp9_luma_pyramid_free(pyramid);
+        return 0;
+      }
+      pyramid->width[i] = width;
+      pyramid->height[i] = height;
+      pyramid->stride[i] = stride;
+      pyramid->level[i] =
+          pyramid->alloc[i] + PYRAMID_BORDER * stride + PYRAMID_BORDER;
+    }
+    downsample_plane(src, src_stride, src_width, src_height, pyramid->level[i],
+                     pyramid->stride[i], width, height);
+    extend_plane(pyramid->level[i], pyramid->stride[i], width, height,
+                 PYRAMID_BORDER);
+    src = pyramid->level[i];
+    src_stride = pyramid->stride[i];
+    src_width = width;
+    src_height = height;
+  }
+  pyramid->ready = 1;
+  return 1;
+}
+
+void vp9_pyramid_me_setup(VP9_COMP *cpi) {
+  PyramidMe *const pyramid_me = &cpi->pyramid_me;
+  MV_REFERENCE_FRAME ref_frame;
+
+  for (ref_frame = LAST_FRAME; ref_frame <= ALTREF_FRAME; ++ref_frame)
+    pyramid_me->refs[ref_frame].ready = 0;
+  if (!vp9_luma_pyramid_build(&pyramid_me->source, cpi->Source)) return;
+
+  for (ref_frame = LAST_FRAME; ref_frame <= ALTREF_FRAME; ++ref_frame) {
+    const YV12_BUFFER_CONFIG *ref_buf;
+    if (!(cpi->ref_frame_flags & ref_frame_to_flag(ref_frame))) continue;
+    ref_buf = vp9_get_scaled_ref_frame(cpi, ref_frame);
+    if (ref_buf == NULL) ref_buf = get_ref_frame_buffer(cpi, ref_frame);
+    if (ref_buf == NULL) continue;
+    vp9_luma_pyramid_build(&pyramid_me->refs[ref_frame], ref_buf);
+  }
+}
+
+void vp9_pyramid_me_free(PyramidMe *pyramid_me) {
+  MV_REFERENCE_FRAME ref_frame;
+  vp9_luma_pyramid_free(&pyramid_me->source);
+  for (ref_frame = 0; ref_frame < MAX_REF_FRAMES; ++ref_frame)
+    vp9_luma_pyramid_free(&pyramid_me->refs[ref_frame]);
+}
+
+// The range of full pixel vectors, on the pyramid level downscaled by
+// 1 << |shift|, that stay within |limits| and within the border of the level
+// for a |size| pixel wide block at |pos|.
+static void level_range(int min_limit, int max_limit, int shift, int pos,
+                        int size, int dim, int *min_mv, int *max_mv) {
+  *min_mv = VPXMAX(-((-min_limit) >> shift), -pos - PYRAMID_BORDER);
+  *max_mv = VPXMIN(max_limit >> shift, dim + PYRAMID_BORDER - size - pos);
+}
+
+int vp9_pyramid_me_search(const VP9_COMP *cpi, const MACROBLOCK *x,
+                          BLOCK_SIZE bsize, MV_REFERENCE_FRAME ref, int mi_row,
+                          int mi_col, const MV *center, MV *mv) {
+  const LumaPyramid *const src = &cpi->pyramid_me.source;
+  const LumaPyramid *const pre = &cpi->pyramid_me.refs[ref];
+  const MvLimits *const limits = &x->mv_limits;
+  const BLOCK_SIZE half_bsize = ss_size_lookup[bsize][1][1];
+  const BLOCK_SIZE quarter_bsize = ss_size_lookup[half_bsize][1][1];
+  const vp9_variance_fn_ptr_t *const fn_ptr = &cpi->fn_ptr[bsize];
+  const struct buf_2d *const src_buf = &x->plane[0].src;
+  const struct buf_2d *const pre_buf = &x->e_mbd.plane[0].pre[0];
+  MV start = *center;
+  MV best_mv;
+  unsigned int best_sad;
+  int row_min, row_max, col_min, col_max, r, c;
+
+  assert(bsize >= BLOCK_16X16);
+  if (x->pred_mv_sad[ref] < (PYRAMID_ME_MIN_PRED_SAD_PER_PIXEL
+                             << num_pels_log2_lookup[bsize]))
+    return 0;
+  if (!src->ready || !pre->ready || src->width[0] != pre->width[0] ||
+      src->height[0] != pre->height[0])
+    return 0;
+
+  // Full search on the 1/4 resolution level, four candidates at a time.
+  {
+    const int stride = src->stride[1];
+    const int row = mi_row * 2;
+    const int col = mi_col * 2;
+    const int bh = 4 * num_4x4_blocks_high_lookup[quarter_bsize];
+    const int bw = 4 * num_4x4_blocks_wide_lookup[quarter_bsize];
+    const uint8_t *const src_ptr = src->level[1] + row * stride + col;
+    const uint8_t *const ref_ptr = pre->level[1] + row * stride + col;
+    const vp9_variance_fn_ptr_t *const level_fn_ptr =
+        &cpi->fn_ptr[quarter_bsize];
+    MV level_center;
+
+    assert(pre->stride[1] == stride);
+    level_range(limits->row_min, limits->row_max, 2, row, bh, src->height[1],
+                &row_min, &row_max);
+    level_range(limits->col_min, limits->col_max, 2, col, bw, src->width[1],
+                &col_min, &col_max);
+    if (row_min > row_max || col_min > col_max) return 0;
+    level_center.row = clamp(center->row >> 2, row_min, row_max);
+    level_center.col = clamp(center->col >> 2, col_min, col_max);
+    best_mv = level_center;
+    best_sad = level_fn_ptr->sdf(
+        src_ptr, stride,
+        ref_ptr + best_mv.row * stride + best_mv.col, stride);
+    row_min = VPXMAX(row_min, level_center.row - PYRAMID_ME_SEARCH_RANGE);
+    row_max = VPXMIN(row_max, level_center.row + PYRAMID_ME_SEARCH_RANGE);
+    col_min = VPXMAX(col_min, level_center.col - PYRAMID_ME_SEARCH_RANGE);
+    col_max = VPXMIN(col_max, level_center.col + PYRAMID_ME_SEARCH_RANGE);
+
+    for (r = row_min; r <= row_max; ++r) {
+      const uint8_t *const ref_row = ref_ptr + r * stride;
+      for (c = col_min; c + 3 <= col_max; c += 4) {
+        const uint8_t *const refs[4] = { ref_row + c, ref_row + c + 1,
+                                         ref_row + c + 2, ref_row + c + 3 };
+        uint32_t sads[4];
+        int i;
+        level_fn_ptr->sdx4df(src_ptr, stride, refs, stride, sads);
+        for (i = 0; i < 4; ++i) {
+          if (sads[i] < best_sad) {
+            best_sad = sads[i];
+            best_mv.row = r;
+            best_mv.col = c + i;
+          }
+        }
+      }
+      for (; c <= col_max; ++c) {
+        const unsigned int sad =
+            level_fn_ptr->sdf(src_ptr, stride, ref_row + c, stride);
+        if (sad < best_sad) {
+          best_sad = sad;
+          best_mv.row = r;
+          best_mv.col = c;
+        }
+      }
+    }
+  }
+
+  // Refinement of the +/-1 neighborhood on the 1/2 resolution level.
+  {
+    const int stride = src->stride[0];
+    const int row = mi_row * 4;
+    const int col = mi_col * 4;
+    const int bh = 4 * num_4x4_blocks_high_lookup[half_bsize];
+    const int bw = 4 * num_4x4_blocks_wide_lookup[half_bsize];
+    const uint8_t *const src_ptr = src->level[0] + row * stride + col;
+    const uint8_t *const ref_ptr = pre->level[0] + row * stride + col;
+    const vp9_variance_fn_ptr_t *const level_fn_ptr = &cpi->fn_ptr[half_bsize];
+    MV level_center;
+
+    level_range(limits->row_min, limits->row_max, 1, row, bh, src->height[0],
+                &row_min, &row_max);
+    level_range(limits->col_min, limits->col_max, 1, col, bw, src->width[0],
+                &col_min, &col_max);
+    if (row_min > row_max || col_min > col_max) return 0;
+    level_center.row = clamp(2 * best_mv.row, row_min, row_max);
+    level_center.col = clamp(2 * best_mv.col, col_min, col_max);
+    best_mv = level_center;
+    best_sad = UINT_MAX;
+    for (r = VPXMAX(level_center.row - 1, row_min);
+         r <= VPXMIN(level_center.row + 1, row_max); ++r) {
+      for (c = VPXMAX(level_center.col - 1, col_min);
+           c <= VPXMIN(level_center.col + 1, col_max); ++c) {
+        const unsigned int sad = level_fn_ptr->sdf(
+            src_ptr, stride, ref_ptr + r * stride + c, stride);
+        if (sad < best_sad) {
+          best_sad = sad;
+          best_mv.row = r;
+          best_mv.col = c;
+        }
+      }
+    }
+  }
+
+  // Keep the result only if it beats the starting point at full resolution.
+  mv->row = 2 * best_mv.row;
+  mv->col = 2 * best_mv.col;
+  clamp_mv(mv, limits->col_min, limits->col_max, limits->row_min,
+           limits->row_max);
+  clamp_mv(&start, limits->col_min, limits->col_max, limits->row_min,
+           limits->row_max);
+  if (mv->row == start.row && mv->col == start.col) return 0;
+  best_sad = fn_ptr->sdf(src_buf->buf, src_buf->stride,
+                         pre_buf->buf + start.row * pre_buf->stride + start.col,
+                         pre_buf->stride);
+  return fn_ptr->sdf(src_buf->buf, src_buf->stride,
+                     pre_buf->buf + mv->row * pre_buf->stride + mv->col,
+                     pre_buf->stride) < best_sad;
+}
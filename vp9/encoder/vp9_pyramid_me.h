@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VPX_VP9_ENCODER_VP9_PYRAMID_ME_H_
+#define VPX_VP9_ENCODER_VP9_PYRAMID_ME_H_
+
+#include "vpx/vpx_integer.h"
+#include "vpx_scale/yv12config.h"
+#include "vp9/common/vp9_enums.h"
+#include "vp9/common/vp9_mv.h"
+#include "vp9/encoder/vp9_block.h"
+#include "vp9/encoder/vp9_mcomp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Levels of a luma pyramid: the luma plane downsampled by 2 and by 4 in each
+// dimension.
+#define PYRAMID_LEVELS 2
+#define PYRAMID_BORDER 32
+
+// Search range of the coarse search on the 1/4 resolution level, i.e. 64
+// pixels at full resolution.
+#define PYRAMID_ME_SEARCH_RANGE 16
+// The pyramid is only searched when the best predicted motion vector leaves
+// an average absolute difference of at least this much per pixel.
+#define PYRAMID_ME_MIN_PRED_SAD_PER_PIXEL 8
+// step_param of the full resolution diamond search that refines the motion
+// found on the pyramid.
+#define PYRAMID_ME_STEP_PARAM (MAX_MVSEARCH_STEPS - 3)
+
+typedef struct LumaPyramid {
+  int ready;
+  int width[PYRAMID_LEVELS];
+  int height[PYRAMID_LEVELS];
+  int stride[PYRAMID_LEVELS];
+  uint8_t *alloc[PYRAMID_LEVELS];
+  // Top left pixel of each level, inside a border of PYRAMID_BORDER.
+  uint8_t *level[PYRAMID_LEVELS];
+} LumaPyramid;
+
+// Pyramids of the source and of the references of the frame being encoded,
+// built by vp9_pyramid_me_setup() before the frame is encoded and read only
+// afterwards.
+typedef struct PyramidMe {
+  LumaPyramid source;
+  LumaPyramid refs[MAX_REF_FRAMES];
+} PyramidMe;
+
+// Builds the pyramid of the luma plane of |img| with 2x2 box filters.
+// Returns 0 for high bitdepth frames or on allocation failure, in which case
+// the pyramid is left not ready.
+int vp9_luma_pyramid_build(LumaPyramid *pyramid,
+                           const YV12_BUFFER_CONFIG *img);
+
+void vp9_luma_pyramid_free(LumaPyramid *pyramid);
+
+struct VP9_COMP;
+
+// Builds the pyramids of the source and of the active references, scaled
+// references included, of the current frame.
+void vp9_pyramid_me_setup(struct VP9_COMP *cpi);
+
+void vp9_pyramid_me_free(PyramidMe *pyramid_me);
+
+// Searches the motion of the |bsize| block at (mi_row, mi_col) in reference
+// |ref| with a full search around |center| on the 1/4 resolution pyramid
+// level, refined on the 1/2 resolution level, unless x->pred_mv_sad shows
+// that the predicted motion is good already. The search is clamped to
+// x->mv_limits. Returns 1 and sets |mv| (full pixel) if the result has a
+// lower full resolution SAD between x->plane[0].src and
+// x->e_mbd.plane[0].pre[0] than |center|. |bsize| must be 16x16 or larger.
+int vp9_pyramid_me_search(const struct VP9_COMP *cpi, const MACROBLOCK *x,
+                          BLOCK_SIZE bsize, MV_REFERENCE_FRAME ref, int mi_row,
+                          int mi_col, const MV *center, MV *mv);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VPX_VP9_ENCODER_VP9_PYRAMID_ME_H_
@@ -2668,8 +2668,12 @@ static void vbr_rate_correction(VP9_COMP *cpi, int *this_frame_target) {
   RATE_CONTROL *const rc = &cpi->rc;
   int64_t vbr_bits_off_target = rc->vbr_bits_off_target;
   int64_t frame_target = *this_frame_target;
+  // A segment of the two pass stats corrects within the segment.
+  const double frames_to_code = cpi->twopass.segment_num_frames > 0
+                                    ? cpi->twopass.segment_num_frames
+                                    : cpi->twopass.total_stats.count;
   int frame_window = (int)VPXMIN(
-      16, cpi->twopass.total_stats.count - cpi->common.current_video_frame);
+      16, frames_to_code - cpi->common.current_video_frame);
 
   // Calcluate the adjustment to rate for this frame.
   if (frame_window > 0) {
@@ -142,12 +142,17 @@ static void fill_token_costs(vp9_coeff_cost *c,
         for (k = 0; k < COEF_BANDS; ++k)
           for (l = 0; l < BAND_COEFF_CONTEXTS(k); ++l) {
             vpx_prob probs[ENTROPY_NODES];
+            int costs[2][ENTROPY_TOKENS];
+            int m;
             vp9_model_to_full_probs(p[t][i][j][k][l], probs);
-            vp9_cost_tokens((int *)c[t][i][j][k][0][l], probs, vp9_coef_tree);
-            vp9_cost_tokens_skip((int *)c[t][i][j][k][1][l], probs,
-                                 vp9_coef_tree);
-            assert(c[t][i][j][k][0][l][EOB_TOKEN] ==
-                   c[t][i][j][k][1][l][EOB_TOKEN]);
+            vp9_cost_tokens(costs[0], probs, vp9_coef_tree);
+            vp9_cost_tokens_skip(costs[1], probs, vp9_coef_tree);
+            assert(costs[0][EOB_TOKEN] == costs[1][EOB_TOKEN]);
+            for (m = 0; m < ENTROPY_TOKENS; ++m) {
+              assert(costs[0][m] <= UINT16_MAX && costs[1][m] <= UINT16_MAX);
+              c[t][i][j][k][0][l][m] = (uint16_t)costs[0][m];
+              c[t][i][j][k][1][l][m] = (uint16_t)costs[1][m];
+            }
           }
 }
 
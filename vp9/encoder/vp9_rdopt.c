@@ -39,6 +39,7 @@
 #include "vp9/encoder/vp9_encodemv.h"
 #include "vp9/encoder/vp9_encoder.h"
 #include "vp9/encoder/vp9_mcomp.h"
+#include "vp9/encoder/vp9_pyramid_me.h"
 #include "vp9/encoder/vp9_quantize.h"
 #include "vp9/encoder/vp9_ratectrl.h"
 #include "vp9/encoder/vp9_rd.h"
@@ -344,17 +345,6 @@ int64_t vp9_block_error_fp_c(const tran_low_t *coeff, const tran_low_t *dqcoeff,
   return error;
 }
 
-/* The trailing '0' is a terminator which is used inside cost_coeffs() to
- * decide whether to include cost of a trailing EOB node or not (i.e. we
- * can skip this if the last coefficient in this transform block, e.g. the
- * 16th coefficient in a 4x4 block or the 64th coefficient in a 8x8 block,
- * were non-zero). */
-static const int16_t band_counts[TX_SIZES][8] = {
-  { 1, 2, 3, 4, 3, 16 - 13, 0 },
-  { 1, 2, 3, 4, 11, 64 - 21, 0 },
-  { 1, 2, 3, 4, 11, 256 - 21, 0 },
-  { 1, 2, 3, 4, 11, 1024 - 21, 0 },
-};
 static int cost_coeffs(MACROBLOCK *x, int plane, int block, TX_SIZE tx_size,
                        int pt, const int16_t *scan, const int16_t *nb,
                        int use_fast_coef_costing) {
@@ -362,10 +352,10 @@ static int cost_coeffs(MACROBLOCK *x, int plane, int block, TX_SIZE tx_size,
   MODE_INFO *mi = xd->mi[0];
   const struct macroblock_plane *p = &x->plane[plane];
   const PLANE_TYPE type = get_plane_type(plane);
-  const int16_t *band_count = &band_counts[tx_size][1];
+  const uint8_t *const band_translate = get_band_translate(tx_size);
   const int eob = p->eobs[block];
   const tran_low_t *const qcoeff = BLOCK_OFFSET(p->qcoeff, block);
-  unsigned int(*token_costs)[2][COEFF_CONTEXTS][ENTROPY_TOKENS] =
+  uint16_t(*token_costs)[2][COEFF_CONTEXTS][ENTROPY_TOKENS] =
       x->token_costs[tx_size][type][is_inter_block(mi)];
   uint8_t token_cache[32 * 32];
   int cost;
@@ -384,75 +374,38 @@ static int cost_coeffs(MACROBLOCK *x, int plane, int block, TX_SIZE tx_size,
     // single eob token
     cost = token_costs[0][0][pt][EOB_TOKEN];
   } else {
-    if (use_fast_coef_costing) {
-      int band_left = *band_count++;
-      int c;
+    int c;
+    int16_t tok;
 
-      // dc token
-      int v = qcoeff[0];
-      int16_t prev_t;
-      cost = vp9_get_token_cost(v, &prev_t, cat6_high_cost);
-      cost += (*token_costs)[0][pt][prev_t];
+    // dc token
+    cost = vp9_get_token_cost_class(qcoeff[0], &tok, &token_cache[0],
+                                    cat6_high_cost);
+    cost += token_costs[0][0][pt][tok];
 
-      token_cache[0] = vp9_pt_energy_class[prev_t];
-      ++token_costs;
-
-      // ac tokens
+    if (use_fast_coef_costing) {
+      // ac tokens, with the context taken from the previous token only
       for (c = 1; c < eob; c++) {
-        const int rc = scan[c];
-        int16_t t;
-
-        v = qcoeff[rc];
-        cost += vp9_get_token_cost(v, &t, cat6_high_cost);
-        cost += (*token_costs)[!prev_t][!prev_t][t];
-        prev_t = t;
-        if (!--band_left) {
-          band_left = *band_count++;
-          ++token_costs;
-        }
+        const int prev_zero = tok == ZERO_TOKEN;
+        cost += vp9_get_token_cost(qcoeff[scan[c]], &tok, cat6_high_cost);
+        cost += token_costs[band_translate[c]][prev_zero][prev_zero][tok];
       }
-
-      // eob token
-      if (band_left) cost += (*token_costs)[0][!prev_t][EOB_TOKEN];
-
-    } else {  // !use_fast_coef_costing
-      int band_left = *band_count++;
-      int c;
-
-      // dc token
-      int v = qcoeff[0];
-      int16_t tok;
-      unsigned int(*tok_cost_ptr)[COEFF_CONTEXTS][ENTROPY_TOKENS];
-      cost = vp9_get_token_cost(v, &tok, cat6_high_cost);
-      cost += (*token_costs)[0][pt][tok];
-
-      token_cache[0] = vp9_pt_energy_class[tok];
-      ++token_costs;
-
-      tok_cost_ptr = &((*token_costs)[!tok]);
-
+      pt = tok == ZERO_TOKEN;
+    } else {
       // ac tokens
       for (c = 1; c < eob; c++) {
         const int rc = scan[c];
-
-        v = qcoeff[rc];
-        cost += vp9_get_token_cost(v, &tok, cat6_high_cost);
+        const int prev_zero = tok == ZERO_TOKEN;
         pt = get_coef_context(nb, token_cache, c);
-        cost += (*tok_cost_ptr)[pt][tok];
-        token_cache[rc] = vp9_pt_energy_class[tok];
-        if (!--band_left) {
-          band_left = *band_count++;
-          ++token_costs;
-        }
-        tok_cost_ptr = &((*token_costs)[!tok]);
-      }
-
-      // eob token
-      if (band_left) {
-        pt = get_coef_context(nb, token_cache, c);
-        cost += (*token_costs)[0][pt][EOB_TOKEN];
+        cost += vp9_get_token_cost_class(qcoeff[rc], &tok, &token_cache[rc],
+                                         cat6_high_cost);
+        cost += token_costs[band_translate[c]][prev_zero][pt][tok];
       }
+      pt = get_coef_context(nb, token_cache, c);
     }
+
+    // eob token, unless the last coefficient of the block is nonzero
+    if (eob < (16 << (tx_size << 1)))
+      cost += token_costs[band_translate[eob]][0][pt][EOB_TOKEN];
   }
 
   return cost;
@@ -1359,6 +1312,89 @@ static int64_t rd_pick_intra_sub_8x8_y_mode(VP9_COMP *cpi, MACROBLOCK *mb,
   return RDCOST(mb->rdmult, mb->rddiv, cost, total_distortion);
 }
 
+// Returns the sum of the 8x8 Hadamard SATDs of the luma residual of intra
+// |mode| over the visible part of the block, predicting each |tx_size| block
+// from the source as an approximation of the reconstructed neighbors.
+static unsigned int intra_mode_satd(MACROBLOCK *x, BLOCK_SIZE bsize,
+                                    TX_SIZE tx_size, PREDICTION_MODE mode) {
+  MACROBLOCKD *const xd = &x->e_mbd;
+  const struct buf_2d *const src = &x->plane[0].src;
+  const int bwl = b_width_log2_lookup[bsize];
+  const int step = 1 << tx_size;
+  const int tx_pels = 4 << tx_size;
+  int max_blocks_wide = num_4x4_blocks_wide_lookup[bsize];
+  int max_blocks_high = num_4x4_blocks_high_lookup[bsize];
+  DECLARE_ALIGNED(16, uint8_t, pred[32 * 32]);
+  DECLARE_ALIGNED(16, int16_t, diff[32 * 32]);
+  DECLARE_ALIGNED(16, tran_low_t, coeff[64]);
+  unsigned int satd = 0;
+  int row, col, r, c;
+
+  if (xd->mb_to_right_edge < 0) max_blocks_wide += xd->mb_to_right_edge >> 5;
+  if (xd->mb_to_bottom_edge < 0) max_blocks_high += xd->mb_to_bottom_edge >> 5;
+
+  for (row = 0; row < max_blocks_high; row += step) {
+    for (col = 0; col < max_blocks_wide; col += step) {
+      const uint8_t *const src_ptr =
+          &src->buf[4 * (row * (int64_t)src->stride + col)];
+      vp9_predict_intra_block(xd, bwl, tx_size, mode, src_ptr, src->stride,
+                              pred, tx_pels, col, row, 0);
+      vpx_subtract_block(tx_pels, tx_pels, diff, tx_pels, src_ptr, src->stride,
+                         pred, tx_pels);
+      for (r = 0; r < tx_pels; r += 8) {
+        for (c = 0; c < tx_pels; c += 8) {
+          vpx_hadamard_8x8(diff + r * tx_pels + c, tx_pels, coeff);
+          satd += vpx_satd(coeff, 64);
+        }
+      }
+    }
+  }
+  return satd;
+}
+
+// Returns the mask of the |k| intra modes of |mode_mask| with the lowest
+// estimated rd cost, which is the SATD of their residual, standing in for
+// both the distortion and the coefficient rate as the SAD does in the motion
+// search, plus their mode cost weighted by x->sadperbit16. Returns
+// |mode_mask| when the estimate is not available.
+static uint16_t intra_mode_satd_top_k(const VP9_COMP *cpi, MACROBLOCK *x,
+                                      BLOCK_SIZE bsize, const int *mode_costs,
+                                      uint16_t mode_mask, int k) {
+  const TX_SIZE tx_size = VPXMIN(
+      TX_8X8, tx_mode_to_biggest_tx_size[cpi->common.tx_mode]);
+  unsigned int cost[INTRA_MODES];
+  uint16_t top_k = 0;
+  PREDICTION_MODE mode;
+  int i;
+
+  if (bsize < BLOCK_8X8 || tx_size == TX_4X4) return mode_mask;
+#if CONFIG_VP9_HIGHBITDEPTH
+  if (x->e_mbd.cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) return mode_mask;
+#endif
+
+  for (mode = DC_PRED; mode <= TM_PRED; ++mode) {
+    if (!(mode_mask & (1 << mode))) continue;
+    cost[mode] = intra_mode_satd(x, bsize, tx_size, mode) +
+                 ROUND_POWER_OF_TWO(mode_costs[mode] * x->sadperbit16,
+                                    VP9_PROB_COST_SHIFT);
+  }
+
+  for (i = 0; i < k; ++i) {
+    PREDICTION_MODE best_mode = DC_PRED;
+    unsigned int best_cost = UINT_MAX;
+    for (mode = DC_PRED; mode <= TM_PRED; ++mode) {
+      if (!(mode_mask & (1 << mode)) || (top_k & (1 << mode))) continue;
+      if (cost[mode] < best_cost) {
+        best_cost = cost[mode];
+        best_mode = mode;
+      }
+    }
+    if (best_cost == UINT_MAX) break;
+    top_k |= 1 << best_mode;
+  }
+  return top_k;
+}
+
 // This function is used only for intra_only frames
 static int64_t rd_pick_intra_sby_mode(VP9_COMP *cpi, MACROBLOCK *x, int *rate,
                                       int *rate_tokenonly, int64_t *distortion,
@@ -1376,11 +1412,18 @@ static int64_t rd_pick_intra_sby_mode(VP9_COMP *cpi, MACROBLOCK *x, int *rate,
   const MODE_INFO *left_mi = xd->left_mi;
   const PREDICTION_MODE A = vp9_above_block_mode(mic, above_mi, 0);
   const PREDICTION_MODE L = vp9_left_block_mode(mic, left_mi, 0);
+  uint16_t mode_mask = (1 << INTRA_MODES) - 1;
   bmode_costs = cpi->y_mode_costs[A][L];
 
+  if (cpi->sf.intra_satd_top_k) {
+    mode_mask = intra_mode_satd_top_k(cpi, x, bsize, bmode_costs, mode_mask,
+                                      cpi->sf.intra_satd_top_k);
+  }
+
   memset(x->skip_txfm, SKIP_TXFM_NONE, sizeof(x->skip_txfm));
   /* Y Search for intra prediction mode */
   for (mode = DC_PRED; mode <= TM_PRED; mode++) {
+    if (!(mode_mask & (1 << mode))) continue;
     if (cpi->sf.use_nonrd_pick_mode) {
       // These speed features are turned on in hybrid non-RD and RD mode
       // for key frame coding in the context of real-time setting.
@@ -2581,6 +2624,8 @@ static void single_motion_search(VP9_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize,
   const int ph = num_4x4_blocks_high_lookup[bsize] << 2;
   MV pred_mv[3];
 
+  MV seed_mv;
+
   int bestsme = INT_MAX;
 #if CONFIG_NON_GREEDY_MV
   int gf_group_idx = cpi->twopass.gf_group.index;
@@ -2663,6 +2708,11 @@ static void single_motion_search(VP9_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize,
   vp9_set_mv_search_range(&x->mv_limits, &ref_mv);
 
   mvp_full = pred_mv[best_predmv_idx];
+  if (vp9_get_seed_mv(cpi, mi_row, mi_col, bsize, ref, &seed_mv)) {
+    // Start from the seeded motion and search a smaller area around it.
+    mvp_full = seed_mv;
+    step_param = VPXMIN(step_param + 2, MAX_MVSEARCH_STEPS - 2);
+  }
   mvp_full.col >>= 3;
   mvp_full.row >>= 3;
 
@@ -2722,6 +2772,31 @@ static void single_motion_search(VP9_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize,
     }
   }
 
+  if (cpi->sf.mv.use_pyramid_search && bsize >= BLOCK_32X32 &&
+      bestsme < INT_MAX) {
+    // Look for motion beyond the reach of the searches from the predicted
+    // vectors on the pyramid, and refine it locally.
+    MV this_mv;
+    if (vp9_pyramid_me_search(cpi, x, bsize, ref, mi_row, mi_col,
+                              &tmp_mv->as_mv, &mvp_full)) {
+      int this_me;
+#if CONFIG_NON_GREEDY_MV
+      this_me = vp9_full_pixel_diamond_new(
+          cpi, x, bsize, &mvp_full, PYRAMID_ME_STEP_PARAM, lambda, 1,
+          nb_full_mvs, nb_full_mv_num, &this_mv);
+#else   // CONFIG_NON_GREEDY_MV
+      this_me = vp9_full_pixel_search(
+          cpi, x, bsize, &mvp_full, PYRAMID_ME_STEP_PARAM,
+          cpi->sf.mv.search_method, sadpb, cond_cost_list(cpi, cost_list),
+          &ref_mv, &this_mv, INT_MAX, 1);
+#endif  // CONFIG_NON_GREEDY_MV
+      if (this_me < bestsme) {
+        tmp_mv->as_mv = this_mv;
+        bestsme = this_me;
+      }
+    }
+  }
+
   x->mv_limits = tmp_mv_limits;
 
   if (bestsme < INT_MAX) {
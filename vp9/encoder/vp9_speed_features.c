@@ -341,6 +341,7 @@ static void set_good_speed_feature_framesize_independent(VP9_COMP *cpi,
     sf->rd_ml_partition.prune_rect_thresh[2] = -1;
     sf->rd_ml_partition.prune_rect_thresh[3] = -1;
     sf->mv.subpel_search_level = 0;
+    sf->intra_satd_top_k = 4;
 
     if (cpi->twopass.fr_content_type == FC_GRAPHICS_ANIMATION) {
       for (i = 0; i < MAX_MESH_STEP; ++i) {
@@ -353,6 +354,7 @@ static void set_good_speed_feature_framesize_independent(VP9_COMP *cpi,
     }
 
     sf->use_accurate_subpel_search = USE_2_TAPS;
+    sf->use_motion_cache = 1;
   }
 
   if (speed >= 3) {
@@ -365,11 +367,13 @@ static void set_good_speed_feature_framesize_independent(VP9_COMP *cpi,
     sf->cb_partition_search = !boosted;
     sf->cb_pred_filter_search = 2;
     sf->alt_ref_search_fp = 1;
+    sf->use_motion_cache = 2;
     sf->recode_loop = ALLOW_RECODE_KFMAXBW;
     sf->adaptive_rd_thresh = 3;
     sf->mode_skip_start = 6;
     sf->intra_y_mode_mask[TX_32X32] = INTRA_DC;
     sf->intra_uv_mode_mask[TX_32X32] = INTRA_DC;
+    sf->intra_satd_top_k = 3;
 
     if (cpi->twopass.fr_content_type == FC_GRAPHICS_ANIMATION) {
       for (i = 0; i < MAX_MESH_STEP; ++i) {
@@ -631,9 +635,9 @@ static void set_rt_speed_feature_framesize_independent(
             sf->intra_y_mode_bsize_mask[i] = INTRA_DC_H_V;
       }
     }
-    if (content == VP9E_CONTENT_SCREEN) {
-      sf->short_circuit_flat_blocks = 1;
-    }
+    if (content == VP9E_CONTENT_SCREEN) sf->short_circuit_flat_blocks = 1;
+    // With layers the LAST reference is not always the previous source.
+    if (!cpi->use_svc) sf->mv.use_hash_search = cpi->oxcf.enable_hash_search;
     if (cpi->oxcf.rc_mode == VPX_CBR &&
         cpi->oxcf.content != VP9E_CONTENT_SCREEN) {
       sf->limit_newmv_early_exit = 1;
@@ -882,6 +886,8 @@ void vp9_set_speed_features_framesize_dependent(VP9_COMP *cpi, int speed) {
   sf->partition_search_breakout_thr.rate = 80;
   sf->rd_ml_partition.search_early_termination = 0;
   sf->rd_ml_partition.search_breakout = 0;
+  sf->mv.use_pyramid_search =
+      oxcf->mode == GOOD && oxcf->enable_pyramid_search;
 
   if (oxcf->mode == REALTIME)
     set_rt_speed_feature_framesize_dependent(cpi, sf, speed);
@@ -938,6 +944,7 @@ void vp9_set_speed_features_framesize_independent(VP9_COMP *cpi, int speed) {
   sf->mv.auto_mv_step_size = 0;
   sf->mv.fullpel_search_step_param = 6;
   sf->mv.use_downsampled_sad = 0;
+  sf->mv.use_hash_search = 0;
   sf->comp_inter_joint_search_iter_level = 0;
   sf->tx_size_search_method = USE_FULL_RD;
   sf->use_lp32x32fdct = 0;
@@ -979,12 +986,14 @@ void vp9_set_speed_features_framesize_independent(VP9_COMP *cpi, int speed) {
   sf->enable_tpl_model = oxcf->enable_tpl_model;
   sf->prune_ref_frame_for_rect_partitions = 0;
   sf->temporal_filter_search_method = MESH;
+  sf->use_motion_cache = 0;
   sf->allow_skip_txfm_ac_dc = 0;
 
   for (i = 0; i < TX_SIZES; i++) {
     sf->intra_y_mode_mask[i] = INTRA_ALL;
     sf->intra_uv_mode_mask[i] = INTRA_ALL;
   }
+  sf->intra_satd_top_k = 0;
   sf->use_rd_breakout = 0;
   sf->skip_encode_sb = 0;
   sf->use_uv_intra_rd_estimate = 0;
@@ -1095,3 +1104,66 @@ void vp9_set_speed_features_framesize_independent(VP9_COMP *cpi, int speed) {
       oxcf->max_threads > 1)
     sf->adaptive_rd_thresh = 0;
 }
+
+// The controller aims for the average encode time to use 90% of the budget,
+// leaving some headroom for frames that are more expensive than the average.
+#define TIME_BUDGET_TARGET_Q8 230
+
+static int get_max_time_budget_speed(const VP9_COMP *cpi) {
+  const int base_speed = cpi->time_budget.base_speed;
+  if (cpi->oxcf.mode == REALTIME) return base_speed >= 5 ? 9 : 4;
+  return VPXMAX(base_speed, 5);
+}
+
+// Switches to the speed chosen by the controller between two frames. The speed
+// features follow on the next frame, only the setup that vp9_change_config()
+// derives from the speed is redone here: it would also reset the rate control
+// and the GF/ARF state in the middle of a group.
+static void apply_time_budget_speed(VP9_COMP *cpi) {
+  const int speed = vp9_get_time_budget_speed(cpi);
+  if (speed == cpi->oxcf.speed) return;
+  cpi->oxcf.speed = speed;
+  vp9_set_row_mt(cpi);
+}
+
+void vp9_set_encode_time_budget(VP9_COMP *cpi, int64_t budget_us) {
+  ENCODE_TIME_BUDGET *const tb = &cpi->time_budget;
+  tb->budget_us = budget_us;
+  tb->avg_time_us = 0;
+  tb->speed_offset_q8 = 0;
+  apply_time_budget_speed(cpi);
+}
+
+int vp9_get_time_budget_speed(const VP9_COMP *cpi) {
+  const ENCODE_TIME_BUDGET *const tb = &cpi->time_budget;
+  const int max_speed = get_max_time_budget_speed(cpi);
+  if (tb->budget_us <= 0 || tb->base_speed >= max_speed)
+    return tb->base_speed;
+  return VPXMIN(tb->base_speed + ((tb->speed_offset_q8 + 128) >> 8),
+                max_speed);
+}
+
+void vp9_update_encode_time_budget(VP9_COMP *cpi, int64_t frame_time_us) {
+  ENCODE_TIME_BUDGET *const tb = &cpi->time_budget;
+  const int max_speed = get_max_time_budget_speed(cpi);
+  int64_t ratio_q8;
+  int delta_q8;
+
+  if (tb->budget_us <= 0 || tb->base_speed >= max_speed) return;
+
+  if (tb->avg_time_us == 0)
+    tb->avg_time_us = frame_time_us;
+  else
+    tb->avg_time_us += (frame_time_us - tb->avg_time_us) / 4;
+
+  // Integral control on the ratio of the average encode time to the budget.
+  // Being 50% over the target moves the speed up by about half a level per
+  // frame. Rounding the accumulated offset to the nearest speed dithers
+  // between two adjacent speeds when the budget lies between them.
+  ratio_q8 = tb->avg_time_us * 256 / tb->budget_us;
+  delta_q8 = (int)VPXMIN(ratio_q8 - TIME_BUDGET_TARGET_Q8, 256);
+  delta_q8 = VPXMAX(delta_q8, -256);
+  tb->speed_offset_q8 = clamp(tb->speed_offset_q8 + delta_q8, 0,
+                              (max_speed - tb->base_speed) * 256);
+  apply_time_budget_speed(cpi);
+}
@@ -214,6 +214,18 @@ typedef struct MV_SPEED_FEATURES {
   // Whether to downsample the rows in sad calculation during motion search.
   // This is only active when there are at least 8 rows.
   int use_downsampled_sad;
+
+  // Whether the rd motion search of blocks of 32x32 and larger first
+  // searches a wide range on a 1/4 resolution pyramid of the source and the
+  // references, and starts the full resolution search from the result when
+  // it beats the predicted motion. Set with VP9E_SET_PYRAMID_MOTION_SEARCH.
+  int use_pyramid_search;
+
+  // Whether the non-rd motion search of blocks of 16x16 and larger on the
+  // LAST reference first looks up exact matches of the block in a hash index
+  // of the previous source, which finds scrolled content at any distance.
+  // Set with VP9E_SET_HASH_MOTION_SEARCH.
+  int use_hash_search;
 } MV_SPEED_FEATURES;
 
 typedef struct PARTITION_SEARCH_BREAKOUT_THR {
@@ -475,6 +487,11 @@ typedef struct SPEED_FEATURES {
   int intra_y_mode_mask[TX_SIZES];
   int intra_uv_mode_mask[TX_SIZES];
 
+  // When non-zero, the luma intra mode search of intra only frames ranks the
+  // modes with the Hadamard SATD of their residual and their mode cost first,
+  // and only runs the transform rd search of this many best ranked ones.
+  int intra_satd_top_k;
+
   // These bit masks allow you to enable or disable intra modes for each
   // prediction block size separately.
   int intra_y_mode_bsize_mask[BLOCK_SIZES];
@@ -640,6 +657,14 @@ typedef struct SPEED_FEATURES {
   // Search method used by temporal filtering in full_pixel_motion_search.
   SEARCH_METHODS temporal_filter_search_method;
 
+  // Share the motion found between the lookahead frames by the temporal
+  // filter and the TPL model through cpi->motion_cache.
+  // 0: disabled.
+  // 1: start the searches from the motion cached by the earlier stages.
+  // 2: as 1, and build a coarse motion field from the downsampled frames when
+  //    the temporal filter finds nothing cached.
+  int use_motion_cache;
+
   // Use machine learning based partition search.
   int nonrd_use_ml_partition;
 
@@ -660,6 +685,20 @@ typedef struct SPEED_FEATURES {
   int allow_skip_txfm_ac_dc;
 } SPEED_FEATURES;
 
+// State of the controller which adapts the speed to the per frame encode time
+// budget set with VP9E_SET_FRAME_TIME_BUDGET.
+typedef struct ENCODE_TIME_BUDGET {
+  // Encode time budget per input frame in microseconds. 0 disables the
+  // controller.
+  int64_t budget_us;
+  // Running average of the encode time per input frame in microseconds.
+  int64_t avg_time_us;
+  // Speed set by the application through VP8E_SET_CPUUSED.
+  int base_speed;
+  // Speed increase over base_speed, in Q8.
+  int speed_offset_q8;
+} ENCODE_TIME_BUDGET;
+
 struct VP9_COMP;
 
 void vp9_set_speed_features_framesize_independent(struct VP9_COMP *cpi,
@@ -667,6 +706,16 @@ void vp9_set_speed_features_framesize_independent(struct VP9_COMP *cpi,
 void vp9_set_speed_features_framesize_dependent(struct VP9_COMP *cpi,
                                                 int speed);
 
+void vp9_set_encode_time_budget(struct VP9_COMP *cpi, int64_t budget_us);
+
+// Returns the speed to encode the next frame with: base_speed plus the offset
+// chosen by the time budget controller.
+int vp9_get_time_budget_speed(const struct VP9_COMP *cpi);
+
+// Feeds the time taken to encode the last input frame to the controller, which
+// sets the speed of the next frame.
+void vp9_update_encode_time_budget(struct VP9_COMP *cpi, int64_t frame_time_us);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -22,6 +22,7 @@
 #include "vp9/encoder/vp9_extend.h"
 #include "vp9/encoder/vp9_firstpass.h"
 #include "vp9/encoder/vp9_mcomp.h"
+#include "vp9/encoder/vp9_motion_cache.h"
 #include "vp9/encoder/vp9_encoder.h"
 #include "vp9/encoder/vp9_quantize.h"
 #include "vp9/encoder/vp9_ratectrl.h"
@@ -753,12 +754,12 @@ void vp9_highbd_apply_temporal_filter_c(
 
 static uint32_t temporal_filter_find_matching_mb_c(
     VP9_COMP *cpi, ThreadData *td, uint8_t *arf_frame_buf,
-    uint8_t *frame_ptr_buf, int stride, MV *ref_mv, MV *blk_mvs,
-    int *blk_bestsme) {
+    uint8_t *frame_ptr_buf, int stride, const MV *cached_mvs,
+    int num_cached_mvs, MV *ref_mv, MV *blk_mvs, int *blk_bestsme) {
   MACROBLOCK *const x = &td->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   MV_SPEED_FEATURES *const mv_sf = &cpi->sf.mv;
-  const SEARCH_METHODS search_method = MESH;
+  SEARCH_METHODS search_method = MESH;
   const SEARCH_METHODS search_method_16 = cpi->sf.temporal_filter_search_method;
   int step_param;
   int sadpb = x->sadperbit16;
@@ -790,6 +791,16 @@ static uint32_t temporal_filter_find_matching_mb_c(
 
   vp9_set_mv_search_range(&x->mv_limits, &best_ref_mv1);
 
+  if (num_cached_mvs > 0) {
+    // Starting from the cached motion, a shorter diamond search is enough and
+    // the exhaustive mesh search can be skipped.
+    vp9_motion_cache_pick_start_mv(x, &cpi->fn_ptr[TF_BLOCK], cached_mvs,
+                                   num_cached_mvs, &best_ref_mv1_full);
+    search_method = NSTEP;
+    step_param = VPXMIN(step_param + MOTION_CACHE_STEP_PARAM_OFFSET,
+                        MAX_MVSEARCH_STEPS - 2);
+  }
+
   vp9_full_pixel_search(cpi, x, TF_BLOCK, &best_ref_mv1_full, step_param,
                         search_method, sadpb, cond_cost_list(cpi, cost_list),
                         &best_ref_mv1, ref_mv, 0, 0);
@@ -957,13 +968,26 @@ void vp9_temporal_filter_iterate_row_c(VP9_COMP *cpi, ThreadData *td,
       } else {
         const int thresh_low = 10000;
         const int thresh_high = 20000;
+        const int mi_row = mb_row << (BH_LOG2 - MI_SIZE_LOG2);
+        const int mi_col = mb_col << (BW_LOG2 - MI_SIZE_LOG2);
+        MotionCacheField *const motion_field =
+            arnr_filter_data->motion_fields[frame];
         int blk_bestsme[4] = { INT_MAX, INT_MAX, INT_MAX, INT_MAX };
+        MV cached_mvs[4];
+        const int num_cached_mvs =
+            arnr_filter_data->show_idx[frame] >= 0
+                ? vp9_motion_cache_get_mvs(
+                      &cpi->motion_cache,
+                      arnr_filter_data->show_idx[alt_ref_index],
+                      arnr_filter_data->show_idx[frame], mi_row, mi_col,
+                      TF_BLOCK, cached_mvs)
+                : 0;
 
         // Find best match in this frame by MC
         int err = temporal_filter_find_matching_mb_c(
             cpi, td, frames[alt_ref_index]->y_buffer + mb_y_offset,
             frames[frame]->y_buffer + mb_y_offset, frames[frame]->y_stride,
-            &ref_mv, blk_mvs, blk_bestsme);
+            cached_mvs, num_cached_mvs, &ref_mv, blk_mvs, blk_bestsme);
 
         int err16 =
             blk_bestsme[0] + blk_bestsme[1] + blk_bestsme[2] + blk_bestsme[3];
@@ -973,6 +997,16 @@ void vp9_temporal_filter_iterate_row_c(VP9_COMP *cpi, ThreadData *td,
           if (max_err < blk_bestsme[k]) max_err = blk_bestsme[k];
         }
 
+        if (motion_field != NULL) {
+          for (k = 0; k < 4; k++) {
+            MV mv;
+            mv.row = blk_mvs[k].row >> 3;
+            mv.col = blk_mvs[k].col >> 3;
+            vp9_motion_cache_set_mvs(motion_field, mi_row + (k >> 1) * 2,
+                                     mi_col + (k & 1) * 2, TF_SUB_BLOCK, &mv);
+          }
+        }
+
         if (((err * 15 < (err16 << 4)) && max_err - min_err < 10000) ||
             ((err * 14 < (err16 << 4)) && max_err - min_err < 5000)) {
           use_32x32 = 1;
@@ -1307,6 +1341,37 @@ static void adjust_arnr_filter(VP9_COMP *cpi, int distance, int group_boost,
   *arnr_strength = strength;
 }
 
+// Sets up the motion cache fields the temporal filter starts its searches
+// from and stores its motion in.
+static void setup_motion_cache(VP9_COMP *cpi,
+                               struct lookahead_entry *const *entries) {
+  ARNRFilterData *const arnr_filter_data = &cpi->arnr_filter_data;
+  const int alt_ref_index = arnr_filter_data->alt_ref_index;
+  const struct lookahead_entry *const arf = entries[alt_ref_index];
+  int frame;
+
+  for (frame = 0; frame < arnr_filter_data->frame_count; ++frame) {
+    arnr_filter_data->show_idx[frame] = -1;
+    arnr_filter_data->motion_fields[frame] = NULL;
+  }
+  // The frames scaled for spatial svc do not match the cached motion.
+  if (!cpi->sf.use_motion_cache || cpi->use_svc) return;
+
+  for (frame = 0; frame < arnr_filter_data->frame_count; ++frame) {
+    const struct lookahead_entry *const buf = entries[frame];
+    arnr_filter_data->show_idx[frame] = buf->show_idx;
+    if (frame == alt_ref_index) continue;
+    if (cpi->sf.use_motion_cache >= 2 &&
+        !vp9_motion_cache_has_motion(&cpi->motion_cache, arf->show_idx,
+                                     buf->show_idx)) {
+      vp9_motion_cache_build_field(&cpi->motion_cache, arf, buf);
+    }
+    arnr_filter_data->motion_fields[frame] = vp9_motion_cache_get_field(
+        &cpi->motion_cache, arf->show_idx, buf->show_idx,
+        buf->img.y_crop_width, buf->img.y_crop_height);
+  }
+}
+
 void vp9_temporal_filter(VP9_COMP *cpi, int distance) {
   VP9_COMMON *const cm = &cpi->common;
   RATE_CONTROL *const rc = &cpi->rc;
@@ -1320,6 +1385,7 @@ void vp9_temporal_filter(VP9_COMP *cpi, int distance) {
   int frames_to_blur_forward;
   struct scale_factors *sf = &arnr_filter_data->sf;
   YV12_BUFFER_CONFIG **frames = arnr_filter_data->frames;
+  struct lookahead_entry *entries[MAX_LAG_BUFFERS];
   int rdmult;
 
   // Apply context specific adjustments to the arnr filter parameters.
@@ -1339,6 +1405,7 @@ void vp9_temporal_filter(VP9_COMP *cpi, int distance) {
     struct lookahead_entry *buf =
         vp9_lookahead_peek(cpi->lookahead, which_buffer);
     frames[frames_to_blur - 1 - frame] = &buf->img;
+    entries[frames_to_blur - 1 - frame] = buf;
   }
 
   YV12_BUFFER_CONFIG *f = frames[arnr_filter_data->alt_ref_index];
@@ -1410,8 +1477,15 @@ void vp9_temporal_filter(VP9_COMP *cpi, int distance) {
   set_error_per_bit(&cpi->td.mb, rdmult);
   vp9_initialize_me_consts(cpi, &cpi->td.mb, ARNR_FILT_QINDEX);
 
+  setup_motion_cache(cpi, entries);
+
   if (!cpi->row_mt)
     temporal_filter_iterate_c(cpi);
   else
     vp9_temporal_filter_row_mt(cpi);
+
+  for (frame = 0; frame < frames_to_blur; ++frame) {
+    if (arnr_filter_data->motion_fields[frame] != NULL)
+      arnr_filter_data->motion_fields[frame]->complete = 1;
+  }
 }
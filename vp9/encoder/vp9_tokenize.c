@@ -70,6 +70,50 @@ const int *vp9_dct_cat_lt_10_value_cost =
     dct_cat_lt_10_value_cost +
     (sizeof(dct_cat_lt_10_value_cost) / sizeof(*dct_cat_lt_10_value_cost)) / 2;
 
+// The two tables above merged with vp9_pt_energy_class[] so that costing a
+// coefficient takes a single load.
+static const TOKENCOST dct_cat_lt_10_value_token_costs[] = {
+  { 3773, 9, 5 }, { 3750, 9, 5 }, { 3704, 9, 5 }, { 3681, 9, 5 },
+  { 3623, 9, 5 }, { 3600, 9, 5 }, { 3554, 9, 5 }, { 3531, 9, 5 },
+  { 3432, 9, 5 }, { 3409, 9, 5 }, { 3363, 9, 5 }, { 3340, 9, 5 },
+  { 3282, 9, 5 }, { 3259, 9, 5 }, { 3213, 9, 5 }, { 3190, 9, 5 },
+  { 3136, 9, 5 }, { 3113, 9, 5 }, { 3067, 9, 5 }, { 3044, 9, 5 },
+  { 2986, 9, 5 }, { 2963, 9, 5 }, { 2917, 9, 5 }, { 2894, 9, 5 },
+  { 2795, 9, 5 }, { 2772, 9, 5 }, { 2726, 9, 5 }, { 2703, 9, 5 },
+  { 2645, 9, 5 }, { 2622, 9, 5 }, { 2576, 9, 5 }, { 2553, 9, 5 },
+  { 3197, 8, 5 }, { 3116, 8, 5 }, { 3058, 8, 5 }, { 2977, 8, 5 },
+  { 2881, 8, 5 }, { 2800, 8, 5 }, { 2742, 8, 5 }, { 2661, 8, 5 },
+  { 2615, 8, 5 }, { 2534, 8, 5 }, { 2476, 8, 5 }, { 2395, 8, 5 },
+  { 2299, 8, 5 }, { 2218, 8, 5 }, { 2160, 8, 5 }, { 2079, 8, 5 },
+  { 2566, 7, 5 }, { 2427, 7, 5 }, { 2334, 7, 5 }, { 2195, 7, 5 },
+  { 2023, 7, 5 }, { 1884, 7, 5 }, { 1791, 7, 5 }, { 1652, 7, 5 },
+  { 1893, 6, 4 }, { 1696, 6, 4 }, { 1453, 6, 4 }, { 1256, 6, 4 },
+  { 1229, 5, 4 }, { 864, 5, 4 },  { 512, 4, 3 },  { 512, 3, 3 },
+  { 512, 2, 2 },  { 512, 1, 1 },  { 0, 0, 0 },    { 512, 1, 1 },
+  { 512, 2, 2 },  { 512, 3, 3 },  { 512, 4, 3 },  { 864, 5, 4 },
+  { 1229, 5, 4 }, { 1256, 6, 4 }, { 1453, 6, 4 }, { 1696, 6, 4 },
+  { 1893, 6, 4 }, { 1652, 7, 5 }, { 1791, 7, 5 }, { 1884, 7, 5 },
+  { 2023, 7, 5 }, { 2195, 7, 5 }, { 2334, 7, 5 }, { 2427, 7, 5 },
+  { 2566, 7, 5 }, { 2079, 8, 5 }, { 2160, 8, 5 }, { 2218, 8, 5 },
+  { 2299, 8, 5 }, { 2395, 8, 5 }, { 2476, 8, 5 }, { 2534, 8, 5 },
+  { 2615, 8, 5 }, { 2661, 8, 5 }, { 2742, 8, 5 }, { 2800, 8, 5 },
+  { 2881, 8, 5 }, { 2977, 8, 5 }, { 3058, 8, 5 }, { 3116, 8, 5 },
+  { 3197, 8, 5 }, { 2553, 9, 5 }, { 2576, 9, 5 }, { 2622, 9, 5 },
+  { 2645, 9, 5 }, { 2703, 9, 5 }, { 2726, 9, 5 }, { 2772, 9, 5 },
+  { 2795, 9, 5 }, { 2894, 9, 5 }, { 2917, 9, 5 }, { 2963, 9, 5 },
+  { 2986, 9, 5 }, { 3044, 9, 5 }, { 3067, 9, 5 }, { 3113, 9, 5 },
+  { 3136, 9, 5 }, { 3190, 9, 5 }, { 3213, 9, 5 }, { 3259, 9, 5 },
+  { 3282, 9, 5 }, { 3340, 9, 5 }, { 3363, 9, 5 }, { 3409, 9, 5 },
+  { 3432, 9, 5 }, { 3531, 9, 5 }, { 3554, 9, 5 }, { 3600, 9, 5 },
+  { 3623, 9, 5 }, { 3681, 9, 5 }, { 3704, 9, 5 }, { 3750, 9, 5 },
+  { 3773, 9, 5 }
+};
+const TOKENCOST *vp9_dct_cat_lt_10_value_token_costs =
+    dct_cat_lt_10_value_token_costs +
+    (sizeof(dct_cat_lt_10_value_token_costs) /
+     sizeof(*dct_cat_lt_10_value_token_costs)) /
+        2;
+
 // Array indices are identical to previously-existing CONTEXT_NODE indices
 /* clang-format off */
 const vpx_tree_index vp9_coef_tree[TREE_SIZE(ENTROPY_TOKENS)] = {
@@ -33,6 +33,12 @@ typedef struct {
   EXTRABIT extra;
 } TOKENVALUE;
 
+typedef struct {
+  uint16_t cost;
+  uint8_t token;
+  uint8_t energy_class;
+} TOKENCOST;
+
 typedef struct {
   const vpx_prob *context_tree;
   int16_t token;
@@ -75,6 +81,7 @@ extern const int16_t *vp9_dct_value_cost_ptr;
 extern const TOKENVALUE *vp9_dct_value_tokens_ptr;
 extern const TOKENVALUE *vp9_dct_cat_lt_10_value_tokens;
 extern const int *vp9_dct_cat_lt_10_value_cost;
+extern const TOKENCOST *vp9_dct_cat_lt_10_value_token_costs;
 extern const int16_t vp9_cat6_low_cost[256];
 extern const uint16_t vp9_cat6_high_cost[64];
 extern const uint16_t vp9_cat6_high10_high_cost[256];
@@ -123,6 +130,25 @@ static INLINE int vp9_get_token_cost(int v, int16_t *token,
   return vp9_dct_cat_lt_10_value_cost[v];
 }
 
+// Same as vp9_get_token_cost(), also returning the energy class of the token
+// used for the context of the following coefficients.
+static INLINE int vp9_get_token_cost_class(int v, int16_t *token,
+                                           uint8_t *energy_class,
+                                           const uint16_t *cat6_high_table) {
+  const TOKENCOST *tc;
+  if (v >= CAT6_MIN_VAL || v <= -CAT6_MIN_VAL) {
+    const int extrabits = abs(v) - CAT6_MIN_VAL;
+    *token = CATEGORY6_TOKEN;
+    *energy_class = vp9_pt_energy_class[CATEGORY6_TOKEN];
+    return vp9_cat6_low_cost[extrabits & 0xff] +
+           cat6_high_table[extrabits >> 8];
+  }
+  tc = &vp9_dct_cat_lt_10_value_token_costs[v];
+  *token = tc->token;
+  *energy_class = tc->energy_class;
+  return tc->cost;
+}
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -20,6 +20,7 @@
 #include "vp9/encoder/vp9_encoder.h"
 #include "vp9/encoder/vp9_ext_ratectrl.h"
 #include "vp9/encoder/vp9_firstpass.h"
+#include "vp9/encoder/vp9_motion_cache.h"
 #include "vp9/encoder/vp9_ratectrl.h"
 #include "vp9/encoder/vp9_tpl_model.h"
 #include "vpx/internal/vpx_codec_internal.h"
@@ -155,6 +156,7 @@ static int init_gop_frames_rc(VP9_COMP *cpi, GF_PICTURE *gf_picture,
     if (buf == NULL) break;
 
     gf_picture[frame_idx].frame = &buf->img;
+    gf_picture[frame_idx].show_idx = buf->show_idx;
     for (i = 0; i < 3; ++i) {
       gf_picture[frame_idx].ref_frame[i] = ref_table[i];
     }
@@ -199,6 +201,7 @@ static int init_gop_frames_rc(VP9_COMP *cpi, GF_PICTURE *gf_picture,
     cpi->tpl_stats[frame_idx].base_qindex = pframe_qindex;
 
     gf_picture[frame_idx].frame = &buf->img;
+    gf_picture[frame_idx].show_idx = buf->show_idx;
     gf_picture[frame_idx].ref_frame[0] = gf_picture[lst_index].ref_frame[0];
     gf_picture[frame_idx].ref_frame[1] = gf_picture[lst_index].ref_frame[1];
     gf_picture[frame_idx].ref_frame[2] = gf_picture[lst_index].ref_frame[2];
@@ -291,6 +294,8 @@ static int init_gop_frames(VP9_COMP *cpi, GF_PICTURE *gf_picture,
 
   // Initialize base layer ARF frame
   gf_picture[1].frame = cpi->Source;
+  if (gf_group->update_type[1] == ARF_UPDATE && cpi->alt_ref_source != NULL)
+    gf_picture[1].show_idx = cpi->alt_ref_source->show_idx;
   gf_picture[1].ref_frame[0] = gld_index;
   gf_picture[1].ref_frame[1] = lst_index;
   gf_picture[1].ref_frame[2] = alt_index;
@@ -307,6 +312,7 @@ static int init_gop_frames(VP9_COMP *cpi, GF_PICTURE *gf_picture,
     if (buf == NULL) break;
 
     gf_picture[frame_idx].frame = &buf->img;
+    gf_picture[frame_idx].show_idx = buf->show_idx;
     gf_picture[frame_idx].ref_frame[0] = gld_index;
     gf_picture[frame_idx].ref_frame[1] = lst_index;
     gf_picture[frame_idx].ref_frame[2] = alt_index;
@@ -354,6 +360,7 @@ static int init_gop_frames(VP9_COMP *cpi, GF_PICTURE *gf_picture,
     cpi->tpl_stats[frame_idx].base_qindex = pframe_qindex;
 
     gf_picture[frame_idx].frame = &buf->img;
+    gf_picture[frame_idx].show_idx = buf->show_idx;
     gf_picture[frame_idx].ref_frame[0] = gld_index;
     gf_picture[frame_idx].ref_frame[1] = lst_index;
     gf_picture[frame_idx].ref_frame[2] = alt_index;
@@ -490,11 +497,10 @@ static uint32_t sub_pixel_motion_search(VP9_COMP *cpi, ThreadData *td,
 }
 
 #else  // CONFIG_NON_GREEDY_MV
-static uint32_t motion_compensated_prediction(VP9_COMP *cpi, ThreadData *td,
-                                              uint8_t *cur_frame_buf,
-                                              uint8_t *ref_frame_buf,
-                                              int stride, BLOCK_SIZE bsize,
-                                              MV *mv) {
+static uint32_t motion_compensated_prediction(
+    VP9_COMP *cpi, ThreadData *td, uint8_t *cur_frame_buf,
+    uint8_t *ref_frame_buf, int stride, BLOCK_SIZE bsize,
+    const MV *cached_mvs, int num_cached_mvs, MV *mv) {
   MACROBLOCK *const x = &td->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   MV_SPEED_FEATURES *const mv_sf = &cpi->sf.mv;
@@ -524,6 +530,13 @@ static uint32_t motion_compensated_prediction(VP9_COMP *cpi, ThreadData *td,
 
   vp9_set_mv_search_range(&x->mv_limits, &best_ref_mv1);
 
+  if (num_cached_mvs > 0) {
+    vp9_motion_cache_pick_start_mv(x, &cpi->fn_ptr[bsize], cached_mvs,
+                                   num_cached_mvs, &best_ref_mv1_full);
+    step_param = VPXMIN(step_param + MOTION_CACHE_STEP_PARAM_OFFSET,
+                        MAX_MVSEARCH_STEPS - 2);
+  }
+
   vp9_full_pixel_search(cpi, x, bsize, &best_ref_mv1_full, step_param,
                         search_method, sadpb, cond_cost_list(cpi, cost_list),
                         &best_ref_mv1, mv, 0, 0);
@@ -884,9 +897,35 @@ static void mode_estimation(VP9_COMP *cpi, MACROBLOCK *x, MACROBLOCKD *xd,
         &cpi->motion_field_info, frame_idx, rf_idx, bsize);
     mv = vp9_motion_field_mi_get_mv(motion_field, mi_row, mi_col);
 #else
-    motion_compensated_prediction(cpi, td, xd->cur_buf->y_buffer + mb_y_offset,
-                                  ref_frame[rf_idx]->y_buffer + mb_y_offset,
-                                  xd->cur_buf->y_stride, bsize, &mv.as_mv);
+    {
+      const int cur_show_idx = gf_picture[frame_idx].show_idx;
+      const int ref_show_idx =
+          gf_picture[gf_picture[frame_idx].ref_frame[rf_idx]].show_idx;
+      MotionCacheField *motion_field = NULL;
+      MV cached_mvs[4];
+      int num_cached_mvs = 0;
+
+      if (cpi->sf.use_motion_cache) {
+        num_cached_mvs =
+            vp9_motion_cache_get_mvs(&cpi->motion_cache, cur_show_idx,
+                                     ref_show_idx, mi_row, mi_col, bsize,
+                                     cached_mvs);
+        motion_field = vp9_motion_cache_get_field(
+            &cpi->motion_cache, cur_show_idx, ref_show_idx,
+            xd->cur_buf->y_crop_width, xd->cur_buf->y_crop_height);
+      }
+      motion_compensated_prediction(
+          cpi, td, xd->cur_buf->y_buffer + mb_y_offset,
+          ref_frame[rf_idx]->y_buffer + mb_y_offset, xd->cur_buf->y_stride,
+          bsize, cached_mvs, num_cached_mvs, &mv.as_mv);
+      if (motion_field != NULL) {
+        MV full_mv;
+        full_mv.row = mv.as_mv.row >> 3;
+        full_mv.col = mv.as_mv.col >> 3;
+        vp9_motion_cache_set_mvs(motion_field, mi_row, mi_col, bsize,
+                                 &full_mv);
+      }
+    }
 #endif
 
 #if CONFIG_VP9_HIGHBITDEPTH
@@ -1476,6 +1515,21 @@ static void mc_flow_dispenser(VP9_COMP *cpi, GF_PICTURE *gf_picture,
                        bsize);
     }
   }
+
+#if !CONFIG_NON_GREEDY_MV
+  if (cpi->sf.use_motion_cache) {
+    for (idx = 0; idx < MAX_INTER_REF_FRAMES; ++idx) {
+      const int rf_idx = gf_picture[frame_idx].ref_frame[idx];
+      MotionCacheField *motion_field;
+      if (rf_idx == -REFS_PER_FRAME) continue;
+      motion_field = vp9_motion_cache_get_field(
+          &cpi->motion_cache, gf_picture[frame_idx].show_idx,
+          gf_picture[rf_idx].show_idx, this_frame->y_crop_width,
+          this_frame->y_crop_height);
+      if (motion_field != NULL) motion_field->complete = 1;
+    }
+  }
+#endif  // !CONFIG_NON_GREEDY_MV
 }
 
 static void trim_tpl_stats(struct vpx_internal_error_info *error_info,
@@ -1765,6 +1819,10 @@ void vp9_setup_tpl_stats(VP9_COMP *cpi) {
   cpi->tpl_bsize = BLOCK_32X32;
 
   memset(gf_picture_buf, 0, sizeof(gf_picture_buf));
+  for (frame_idx = 0; frame_idx < MAX_ARF_GOP_SIZE + REFS_PER_FRAME;
+       ++frame_idx) {
+    gf_picture_buf[frame_idx].show_idx = -1;
+  }
   extended_frame_count =
       init_gop_frames(cpi, gf_picture, gf_group, &tpl_group_frames);
 
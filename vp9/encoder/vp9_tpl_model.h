@@ -26,6 +26,8 @@ typedef struct GF_PICTURE {
   YV12_BUFFER_CONFIG *frame;
   int ref_frame[3];
   FRAME_UPDATE_TYPE update_type;
+  // Lookahead show_idx of the source frame, -1 for reconstructed frames.
+  int show_idx;
 } GF_PICTURE;
 
 void vp9_init_tpl_buffer(VP9_COMP *cpi);
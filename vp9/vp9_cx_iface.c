@@ -19,6 +19,7 @@
 #include "vpx_dsp/psnr.h"
 #include "vpx_ports/static_assert.h"
 #include "vpx_ports/system_state.h"
+#include "vpx_ports/vpx_timer.h"
 #include "vpx_util/vpx_timestamp.h"
 #include "vpx/internal/vpx_codec_internal.h"
 #include "./vpx_version.h"
@@ -45,6 +46,8 @@ typedef struct vp9_extracfg {
   unsigned int tile_rows;
   unsigned int enable_tpl_model;
   unsigned int enable_keyframe_filtering;
+  unsigned int enable_pyramid_search;
+  unsigned int enable_hash_search;
   unsigned int arnr_max_frames;
   unsigned int arnr_strength;
   unsigned int min_gf_interval;
@@ -85,6 +88,8 @@ static struct vp9_extracfg default_extra_cfg = {
   0,                     // tile_rows
   1,                     // enable_tpl_model
   0,                     // enable_keyframe_filtering
+  0,                     // enable_pyramid_search
+  0,                     // enable_hash_search
   7,                     // arnr_max_frames
   5,                     // arnr_strength
   0,                     // min_gf_interval; 0 -> default decision
@@ -193,6 +198,8 @@ static vpx_codec_err_t validate_config(vpx_codec_alg_priv_t *ctx,
   RANGE_CHECK_HI(cfg, rc_min_quantizer, cfg->rc_max_quantizer);
   RANGE_CHECK_BOOL(extra_cfg, lossless);
   RANGE_CHECK_BOOL(extra_cfg, frame_parallel_decoding_mode);
+  RANGE_CHECK_BOOL(extra_cfg, enable_pyramid_search);
+  RANGE_CHECK_BOOL(extra_cfg, enable_hash_search);
   RANGE_CHECK(extra_cfg, aq_mode, 0, AQ_MODE_COUNT - 2);
   RANGE_CHECK(extra_cfg, alt_ref_aq, 0, 1);
   RANGE_CHECK(extra_cfg, frame_periodic_boost, 0, 1);
@@ -618,6 +625,9 @@ static vpx_codec_err_t set_encoder_config(
 
   oxcf->enable_keyframe_filtering = extra_cfg->enable_keyframe_filtering;
 
+  oxcf->enable_pyramid_search = extra_cfg->enable_pyramid_search;
+  oxcf->enable_hash_search = extra_cfg->enable_hash_search;
+
   // TODO(yunqing): The dependencies between row tiles cause error in multi-
   // threaded encoding. For now, tile_rows is forced to be 0 in this case.
   // The further fix can be done by adding synchronizations after a tile row
@@ -977,6 +987,20 @@ static vpx_codec_err_t ctrl_set_keyframe_filtering(vpx_codec_alg_priv_t *ctx,
   return update_extra_cfg(ctx, &extra_cfg);
 }
 
+static vpx_codec_err_t ctrl_set_pyramid_motion_search(
+    vpx_codec_alg_priv_t *ctx, va_list args) {
+  struct vp9_extracfg extra_cfg = ctx->extra_cfg;
+  extra_cfg.enable_pyramid_search = CAST(VP9E_SET_PYRAMID_MOTION_SEARCH, args);
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
+static vpx_codec_err_t ctrl_set_hash_motion_search(vpx_codec_alg_priv_t *ctx,
+                                                   va_list args) {
+  struct vp9_extracfg extra_cfg = ctx->extra_cfg;
+  extra_cfg.enable_hash_search = CAST(VP9E_SET_HASH_MOTION_SEARCH, args);
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
 static vpx_codec_err_t ctrl_set_arnr_max_frames(vpx_codec_alg_priv_t *ctx,
                                                 va_list args) {
   struct vp9_extracfg extra_cfg = ctx->extra_cfg;
@@ -1343,10 +1367,13 @@ static vpx_codec_err_t encoder_encode(vpx_codec_alg_priv_t *ctx,
   const vpx_rational64_t *const timebase_in_ts = &ctx->oxcf.g_timebase_in_ts;
   size_t data_sz;
   vpx_codec_cx_pkt_t pkt;
+  struct vpx_usec_timer timer;
   memset(&pkt, 0, sizeof(pkt));
 
   if (cpi == NULL) return VPX_CODEC_INVALID_PARAM;
 
+  vpx_usec_timer_start(&timer);
+
   cpi->last_coded_width = ctx->oxcf.width;
   cpi->last_coded_height = ctx->oxcf.height;
 
@@ -1635,6 +1662,11 @@ static vpx_codec_err_t encoder_encode(vpx_codec_alg_priv_t *ctx,
     }
   }
 
+  if (img != NULL && res == VPX_CODEC_OK) {
+    vpx_usec_timer_mark(&timer);
+    vp9_update_encode_time_budget(cpi, vpx_usec_timer_elapsed(&timer));
+  }
+
   cpi->common.error.setjmp = 0;
   return res;
 }
@@ -2086,6 +2118,58 @@ static vpx_codec_err_t ctrl_set_external_rate_control(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_OK;
 }
 
+static vpx_codec_err_t ctrl_set_frame_time_budget(vpx_codec_alg_priv_t *ctx,
+                                                  va_list args) {
+  const unsigned int data = va_arg(args, unsigned int);
+  vp9_set_encode_time_budget(ctx->cpi, data);
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_first_pass_frame_size(
+    vpx_codec_alg_priv_t *ctx, va_list args) {
+  const vpx_first_pass_frame_size_t *const data =
+      va_arg(args, vpx_first_pass_frame_size_t *);
+#if !CONFIG_REALTIME_ONLY
+  if (data == NULL || data->width > INT_MAX || data->height > INT_MAX)
+    return VPX_CODEC_INVALID_PARAM;
+  if (vp9_set_first_pass_frame_size(ctx->cpi, (int)data->width,
+                                    (int)data->height))
+    return VPX_CODEC_INVALID_PARAM;
+  return VPX_CODEC_OK;
+#else
+  (void)ctx;
+  (void)data;
+  return VPX_CODEC_INCAPABLE;
+#endif  // !CONFIG_REALTIME_ONLY
+}
+
+static vpx_codec_err_t ctrl_set_two_pass_segment(vpx_codec_alg_priv_t *ctx,
+                                                 va_list args) {
+  const vpx_two_pass_segment_t *const data =
+      va_arg(args, vpx_two_pass_segment_t *);
+#if !CONFIG_REALTIME_ONLY
+  if (data == NULL || data->first_frame > INT_MAX ||
+      data->num_frames > INT_MAX)
+    return VPX_CODEC_INVALID_PARAM;
+  if (vp9_set_two_pass_segment(ctx->cpi, (int)data->first_frame,
+                               (int)data->num_frames))
+    return VPX_CODEC_INVALID_PARAM;
+  return VPX_CODEC_OK;
+#else
+  (void)ctx;
+  (void)data;
+  return VPX_CODEC_INCAPABLE;
+#endif  // !CONFIG_REALTIME_ONLY
+}
+
+static vpx_codec_err_t ctrl_set_mode_info_seed(vpx_codec_alg_priv_t *ctx,
+                                               va_list args) {
+  const VpxFrameModeInfo *const info = va_arg(args, VpxFrameModeInfo *);
+
+  if (vp9_set_mode_info_seed(ctx->cpi, info)) return VPX_CODEC_INVALID_PARAM;
+  return VPX_CODEC_OK;
+}
+
 static vpx_codec_err_t ctrl_set_quantizer_one_pass(vpx_codec_alg_priv_t *ctx,
                                                    va_list args) {
   VP9_COMP *const cpi = ctx->cpi;
@@ -2160,6 +2244,12 @@ static vpx_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { VP9E_SET_RTC_EXTERNAL_RATECTRL, ctrl_set_rtc_external_ratectrl },
   { VP9E_SET_EXTERNAL_RATE_CONTROL, ctrl_set_external_rate_control },
   { VP9E_SET_QUANTIZER_ONE_PASS, ctrl_set_quantizer_one_pass },
+  { VP9E_SET_FRAME_TIME_BUDGET, ctrl_set_frame_time_budget },
+  { VP9E_SET_FIRST_PASS_FRAME_SIZE, ctrl_set_first_pass_frame_size },
+  { VP9E_SET_MODE_INFO_SEED, ctrl_set_mode_info_seed },
+  { VP9E_SET_TWO_PASS_SEGMENT, ctrl_set_two_pass_segment },
+  { VP9E_SET_PYRAMID_MOTION_SEARCH, ctrl_set_pyramid_motion_search },
+  { VP9E_SET_HASH_MOTION_SEARCH, ctrl_set_hash_motion_search },
 
   // Getters
   { VP8E_GET_LAST_QUANTIZER, ctrl_get_quantizer },
@@ -2471,6 +2561,9 @@ void vp9_dump_encoder_config(const VP9EncoderConfig *oxcf, FILE *fp) {
 
   DUMP_STRUCT_VALUE(fp, oxcf, enable_keyframe_filtering);
 
+  DUMP_STRUCT_VALUE(fp, oxcf, enable_pyramid_search);
+  DUMP_STRUCT_VALUE(fp, oxcf, enable_hash_search);
+
   DUMP_STRUCT_VALUE(fp, oxcf, max_threads);
 
   DUMP_STRUCT_VALUE(fp, oxcf, target_level);
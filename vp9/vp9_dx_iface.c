@@ -19,6 +19,7 @@
 #include "vpx/vpx_decoder.h"
 #include "vpx_dsp/bitreader_buffer.h"
 #include "vpx_dsp/vpx_dsp_common.h"
+#include "vpx_ports/vpx_timer.h"
 
 #include "vp9/common/vp9_alloccommon.h"
 #include "vp9/common/vp9_frame_buffers.h"
@@ -200,13 +201,17 @@ static vpx_codec_err_t update_error_state(
   return error->error_code;
 }
 
+static int skip_loop_filter(const vpx_codec_alg_priv_t *ctx) {
+  return ctx->skip_loop_filter || ctx->load_shed_level >= 2;
+}
+
 static vpx_codec_err_t init_buffer_callbacks(vpx_codec_alg_priv_t *ctx) {
   VP9_COMMON *const cm = &ctx->pbi->common;
   BufferPool *const pool = cm->buffer_pool;
 
   cm->new_fb_idx = INVALID_IDX;
   cm->byte_alignment = ctx->byte_alignment;
-  cm->skip_loop_filter = ctx->skip_loop_filter;
+  cm->skip_loop_filter = skip_loop_filter(ctx);
 
   if (ctx->get_ext_fb_cb != NULL && ctx->release_ext_fb_cb != NULL) {
     pool->get_fb_cb = ctx->get_ext_fb_cb;
@@ -279,6 +284,11 @@ static vpx_codec_err_t init_decoder(vpx_codec_alg_priv_t *ctx) {
   RANGE_CHECK(ctx, lpf_opt, 0, 1);
   ctx->pbi->lpf_mt_opt = ctx->lpf_opt;
 
+  ctx->pbi->mode_info_export = ctx->mode_info_export;
+  ctx->pbi->region_x = ctx->region_x;
+  ctx->pbi->region_w = ctx->region_w;
+  ctx->pbi->load_shed_level = ctx->load_shed_level;
+
   // If postprocessing was enabled by the application and a
   // configuration has not been provided, default it.
   if (!ctx->postproc_cfg_set && (ctx->base.init_flags & VPX_CODEC_USE_POSTPROC))
@@ -337,6 +347,33 @@ static vpx_codec_err_t decode_one(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_OK;
 }
 
+static void update_skipped_work(vpx_codec_alg_priv_t *ctx) {
+  const VP9Decoder *const pbi = ctx->pbi;
+  if (pbi->parse_only) {
+    ctx->skipped_work |= VP9D_SKIPPED_FRAME;
+  } else if (pbi->load_shed_level >= 2 && pbi->common.lf.filter_level &&
+             !ctx->skip_loop_filter) {
+    ctx->skipped_work |= VP9D_SKIPPED_LOOP_FILTER;
+  }
+}
+
+// Tracks how far the decoder is behind the frame deadline and picks the work
+// to shed on the next decode call. Each deadline of delay sheds one more kind
+// of work, and the delay is capped so the decoder recovers quickly once it
+// keeps up again.
+static void update_load_shedding(vpx_codec_alg_priv_t *ctx) {
+  const int64_t deadline = ctx->frame_deadline;
+  vpx_usec_timer_mark(&ctx->timer);
+  ctx->deadline_debt += vpx_usec_timer_elapsed(&ctx->timer) - deadline;
+  ctx->deadline_debt = VPXMAX(ctx->deadline_debt, 0);
+  ctx->deadline_debt = VPXMIN(ctx->deadline_debt, 3 * deadline);
+  ctx->load_shed_level =
+      ctx->deadline_debt > 0 ? (int)(1 + ctx->deadline_debt / deadline) : 0;
+  ctx->load_shed_level = VPXMIN(ctx->load_shed_level, 3);
+  ctx->pbi->load_shed_level = ctx->load_shed_level;
+  ctx->pbi->common.skip_loop_filter = skip_loop_filter(ctx);
+}
+
 static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
                                       const uint8_t *data, unsigned int data_sz,
                                       void *user_priv) {
@@ -366,6 +403,9 @@ static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
   if (ctx->svc_decoding && ctx->svc_spatial_layer < frame_count - 1)
     frame_count = ctx->svc_spatial_layer + 1;
 
+  ctx->skipped_work = 0;
+  if (ctx->frame_deadline > 0) vpx_usec_timer_start(&ctx->timer);
+
   // Decode in serial mode.
   if (frame_count > 0) {
     const uint8_t *const data_end = data + data_sz;
@@ -381,6 +421,7 @@ static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
 
       res = decode_one(ctx, &data_start_copy, frame_size, user_priv);
       if (res != VPX_CODEC_OK) return res;
+      update_skipped_work(ctx);
 
       data_start += frame_size;
     }
@@ -390,6 +431,7 @@ static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
       const uint32_t frame_size = (uint32_t)(data_end - data_start);
       res = decode_one(ctx, &data_start, frame_size, user_priv);
       if (res != VPX_CODEC_OK) return res;
+      update_skipped_work(ctx);
 
       // Account for suboptimal termination by the encoder.
       while (data_start < data_end) {
@@ -401,6 +443,8 @@ static vpx_codec_err_t decoder_decode(vpx_codec_alg_priv_t *ctx,
     }
   }
 
+  if (ctx->frame_deadline > 0) update_load_shedding(ctx);
+
   return res;
 }
 
@@ -416,6 +460,10 @@ static vpx_image_t *decoder_get_frame(vpx_codec_alg_priv_t *ctx,
     YV12_BUFFER_CONFIG sd;
     vp9_ppflags_t flags = { 0, 0, 0 };
     if (ctx->base.init_flags & VPX_CODEC_USE_POSTPROC) set_ppflags(ctx, &flags);
+    if (ctx->load_shed_level >= 3 && flags.post_proc_flag) {
+      flags.post_proc_flag = 0;
+      ctx->skipped_work |= VP9D_SKIPPED_POSTPROC;
+    }
     if (vp9_get_raw_frame(ctx->pbi, &sd, &flags) == 0) {
       VP9_COMMON *const cm = &ctx->pbi->common;
       RefCntBuffer *const frame_bufs = cm->buffer_pool->frame_bufs;
@@ -650,7 +698,7 @@ static vpx_codec_err_t ctrl_set_skip_loop_filter(vpx_codec_alg_priv_t *ctx,
   ctx->skip_loop_filter = va_arg(args, int);
 
   if (ctx->pbi != NULL) {
-    ctx->pbi->common.skip_loop_filter = ctx->skip_loop_filter;
+    ctx->pbi->common.skip_loop_filter = skip_loop_filter(ctx);
   }
 
   return VPX_CODEC_OK;
@@ -680,6 +728,88 @@ static vpx_codec_err_t ctrl_enable_lpf_opt(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_OK;
 }
 
+static vpx_codec_err_t ctrl_set_mode_info_export(vpx_codec_alg_priv_t *ctx,
+                                                  va_list args) {
+  ctx->mode_info_export = va_arg(args, VpxFrameModeInfo *);
+
+  if (ctx->pbi != NULL) {
+    ctx->pbi->mode_info_export = ctx->mode_info_export;
+  }
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_set_decode_region(vpx_codec_alg_priv_t *ctx,
+                                              va_list args) {
+  const vpx_image_rect_t *const region = va_arg(args, vpx_image_rect_t *);
+
+  // VP9 frames are at most 65536 pixels wide.
+  if (region != NULL && (region->x > 65536 || region->w > 65536))
+    return VPX_CODEC_INVALID_PARAM;
+  ctx->region_x = region != NULL ? region->x : 0;
+  ctx->region_w = region != NULL ? region->w : 0;
+
+  if (ctx->pbi != NULL) {
+    ctx->pbi->region_x = ctx->region_x;
+    ctx->pbi->region_w = ctx->region_w;
+  }
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_get_decoded_region(vpx_codec_alg_priv_t *ctx,
+                                               va_list args) {
+  vpx_image_rect_t *const region = va_arg(args, vpx_image_rect_t *);
+
+  if (region) {
+    if (ctx->pbi != NULL) {
+      const VP9Decoder *const pbi = ctx->pbi;
+      const int fb_idx = pbi->common.new_fb_idx;
+      region->x = 0;
+      region->y = 0;
+      region->w = 0;
+      region->h = pbi->common.height;
+      if (fb_idx >= 0) {
+        region->x = pbi->region_x_start[fb_idx];
+        region->w = pbi->region_x_end[fb_idx] - pbi->region_x_start[fb_idx];
+      }
+      return VPX_CODEC_OK;
+    } else {
+      return VPX_CODEC_ERROR;
+    }
+  }
+
+  return VPX_CODEC_INVALID_PARAM;
+}
+
+static vpx_codec_err_t ctrl_set_frame_deadline(vpx_codec_alg_priv_t *ctx,
+                                               va_list args) {
+  const int frame_deadline = va_arg(args, int);
+
+  if (frame_deadline < 0) return VPX_CODEC_INVALID_PARAM;
+  ctx->frame_deadline = frame_deadline;
+  if (frame_deadline == 0) {
+    ctx->deadline_debt = 0;
+    ctx->load_shed_level = 0;
+  }
+
+  if (ctx->pbi != NULL) {
+    ctx->pbi->load_shed_level = ctx->load_shed_level;
+    ctx->pbi->common.skip_loop_filter = skip_loop_filter(ctx);
+  }
+  return VPX_CODEC_OK;
+}
+
+static vpx_codec_err_t ctrl_get_skipped_work(vpx_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  int *const skipped_work = va_arg(args, int *);
+
+  if (skipped_work) {
+    *skipped_work = ctx->skipped_work;
+    return VPX_CODEC_OK;
+  }
+
+  return VPX_CODEC_INVALID_PARAM;
+}
+
 static vpx_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { VP8_COPY_REFERENCE, ctrl_copy_reference },
 
@@ -693,6 +823,9 @@ static vpx_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { VP9_DECODE_SVC_SPATIAL_LAYER, ctrl_set_spatial_layer_svc },
   { VP9D_SET_ROW_MT, ctrl_set_row_mt },
   { VP9D_SET_LOOP_FILTER_OPT, ctrl_enable_lpf_opt },
+  { VP9D_SET_MODE_INFO_EXPORT, ctrl_set_mode_info_export },
+  { VP9D_SET_DECODE_REGION, ctrl_set_decode_region },
+  { VP9D_SET_FRAME_DEADLINE, ctrl_set_frame_deadline },
 
   // Getters
   { VPXD_GET_LAST_QUANTIZER, ctrl_get_quantizer },
@@ -702,6 +835,8 @@ static vpx_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { VP9D_GET_DISPLAY_SIZE, ctrl_get_render_size },
   { VP9D_GET_BIT_DEPTH, ctrl_get_bit_depth },
   { VP9D_GET_FRAME_SIZE, ctrl_get_frame_size },
+  { VP9D_GET_DECODED_REGION, ctrl_get_decoded_region },
+  { VP9D_GET_SKIPPED_WORK, ctrl_get_skipped_work },
 
   { -1, NULL },
 };
@@ -12,6 +12,7 @@
 #define VPX_VP9_VP9_DX_IFACE_H_
 
 #include "vp9/decoder/vp9_decoder.h"
+#include "vpx_ports/vpx_timer.h"
 
 typedef vpx_codec_stream_info_t vp9_stream_info_t;
 
@@ -47,6 +48,15 @@ struct vpx_codec_alg_priv {
   int svc_spatial_layer;
   int row_mt;
   int lpf_opt;
+  VpxFrameModeInfo *mode_info_export;
+  unsigned int region_x;
+  unsigned int region_w;
+  // Load shedding under a frame deadline in microseconds, 0 when disabled.
+  int frame_deadline;
+  int64_t deadline_debt;
+  int load_shed_level;
+  int skipped_work;
+  struct vpx_usec_timer timer;
 };
 
 #endif  // VPX_VP9_VP9_DX_IFACE_H_
@@ -18,6 +18,7 @@
 #include "./vp8.h"
 #include "./vpx_encoder.h"
 #include "./vpx_ext_ratectrl.h"
+#include "./vpx_mode_info.h"
 
 /*!\file
  * \brief Provides definitions for using VP8 or VP9 encoder algorithm within the
@@ -776,6 +777,101 @@ enum vp8e_enc_control_id {
    *
    */
   VP9E_SET_QUANTIZER_ONE_PASS,
+
+  /*!\brief Codec control to set the encode time budget per frame.
+   *
+   * The value is the wall-clock time in microseconds each input frame may
+   * take to encode. When set, the encoder measures the time taken by each
+   * call to vpx_codec_encode() and raises the speed above the configured
+   * VP8E_SET_CPUUSED value when frames exceed the budget, then lowers it
+   * back towards VP8E_SET_CPUUSED when there is headroom. The speed does not
+   * move between the rd (speed < 5) and non-rd (speed >= 5) realtime modes.
+   * Set to 0 (default) to disable.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_FRAME_TIME_BUDGET,
+
+  /*!\brief Codec control to set the frame size the two pass stats were
+   * collected at, pass a vpx_first_pass_frame_size_t pointer.
+   *
+   * This lets a single first pass drive the second pass of several
+   * renditions of the same source, e.g. the rungs of an adaptive bitrate
+   * ladder. The per macroblock stats are used as they are, while the motion
+   * vector and inactive region stats are rescaled to the encoded frame size.
+   * Must be called after vpx_codec_enc_init() and before the first frame is
+   * encoded, for a non-svc second pass with
+   * rc_2pass_vbr_corpus_complexity left at 0.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_FIRST_PASS_FRAME_SIZE,
+
+  /*!\brief Codec control to seed the encoder searches with the mode info of
+   * another encode of the source, pass a VpxFrameModeInfo pointer, or NULL
+   * to remove the seed.
+   *
+   * This is meant for transcoding, with the mode info exported by the decoder
+   * with VP9D_SET_MODE_INFO_EXPORT. At the speeds that limit the range of
+   * the partition search, the seed block sizes set that range. The seed
+   * motion vectors are the starting points of the motion searches for the
+   * same reference frame. Seeds from another frame size are rescaled to the
+   * encoded frame size. The seed is copied and applies to the frames encoded
+   * until it is replaced, so it is best set before each call to
+   * vpx_codec_encode() with g_lag_in_frames set to 0.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_MODE_INFO_SEED,
+
+  /*!\brief Codec control to encode a segment of the frames of the two pass
+   * stats, pass a vpx_two_pass_segment_t pointer.
+   *
+   * This lets several encoders run the second pass of one clip in parallel,
+   * each on a segment of it, with the stats of a single first pass over the
+   * whole clip. The segments should start at key frames and be encoded with
+   * the same configuration, so that their streams can be concatenated. Each
+   * segment gets the share of the bits of the whole clip its frames would get
+   * in a single second pass, so the concatenated stream still meets the
+   * target bitrate. The application passes only the source frames of the
+   * segment to vpx_codec_encode(). A num_frames of 0 encodes all of the
+   * frames. Must be called after vpx_codec_enc_init() and before the first
+   * frame is encoded, for a non-svc second pass with
+   * rc_2pass_vbr_corpus_complexity left at 0.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_TWO_PASS_SEGMENT,
+
+  /*!\brief Codec control function to enable the pyramid motion search,
+   * unsigned int parameter.
+   *
+   * The rd motion search of blocks of 32x32 and larger then also searches a
+   * wide range on a 1/4 resolution pyramid of the source and the references.
+   * This finds fast motion, e.g. in 2160p sports or game content, that the
+   * full resolution search misses, at the cost of more encode time.
+   *
+   * 0: off (default), 1: on. Only used in good quality mode.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_PYRAMID_MOTION_SEARCH,
+
+  /*!\brief Codec control function to enable the hash based motion search,
+   * unsigned int parameter.
+   *
+   * The non-rd motion search of blocks of 16x16 and larger on the LAST
+   * reference then first looks up exact matches of the block anywhere in the
+   * previous source. This finds the scrolling and moved windows of screen
+   * content, e.g. with VP9E_SET_TUNE_CONTENT set to VP9E_CONTENT_SCREEN, at
+   * the cost of indexing the changed areas of each source frame.
+   *
+   * 0: off (default), 1: on. Only used in real-time mode at speed 5 and
+   * above, without spatial or temporal layers.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9E_SET_HASH_MOTION_SEARCH,
 };
 
 /*!\brief vpx 1-D scaling mode
@@ -863,6 +959,26 @@ typedef struct vpx_scaling_mode {
   VPX_SCALING_MODE v_scaling_mode; /**< vertical scaling mode   */
 } vpx_scaling_mode_t;
 
+/*!\brief  vpx first pass frame size
+ *
+ * This defines the size of the frames the two pass stats were collected on
+ *
+ */
+typedef struct vpx_first_pass_frame_size {
+  unsigned int width;  /**< frame width in pixels */
+  unsigned int height; /**< frame height in pixels */
+} vpx_first_pass_frame_size_t;
+
+/*!\brief  vpx two pass segment
+ *
+ * This defines the range of the frames of the two pass stats to encode
+ *
+ */
+typedef struct vpx_two_pass_segment {
+  unsigned int first_frame; /**< index of the first frame of the segment */
+  unsigned int num_frames;  /**< number of frames in the segment */
+} vpx_two_pass_segment_t;
+
 /*!\brief VP8 token partition mode
  *
  * This defines VP8 partitioning mode for compressed data, i.e., the number of
@@ -1108,6 +1224,18 @@ VPX_CTRL_USE_TYPE(VP8E_SET_RTC_EXTERNAL_RATECTRL, int)
 #define VPX_CTRL_VP8E_SET_RTC_EXTERNAL_RATECTRL
 VPX_CTRL_USE_TYPE(VP9E_SET_QUANTIZER_ONE_PASS, int)
 #define VPX_CTRL_VP9E_SET_QUANTIZER_ONE_PASS
+VPX_CTRL_USE_TYPE(VP9E_SET_FRAME_TIME_BUDGET, unsigned int)
+#define VPX_CTRL_VP9E_SET_FRAME_TIME_BUDGET
+VPX_CTRL_USE_TYPE(VP9E_SET_FIRST_PASS_FRAME_SIZE, vpx_first_pass_frame_size_t *)
+#define VPX_CTRL_VP9E_SET_FIRST_PASS_FRAME_SIZE
+VPX_CTRL_USE_TYPE(VP9E_SET_MODE_INFO_SEED, VpxFrameModeInfo *)
+#define VPX_CTRL_VP9E_SET_MODE_INFO_SEED
+VPX_CTRL_USE_TYPE(VP9E_SET_TWO_PASS_SEGMENT, vpx_two_pass_segment_t *)
+#define VPX_CTRL_VP9E_SET_TWO_PASS_SEGMENT
+VPX_CTRL_USE_TYPE(VP9E_SET_PYRAMID_MOTION_SEARCH, unsigned int)
+#define VPX_CTRL_VP9E_SET_PYRAMID_MOTION_SEARCH
+VPX_CTRL_USE_TYPE(VP9E_SET_HASH_MOTION_SEARCH, unsigned int)
+#define VPX_CTRL_VP9E_SET_HASH_MOTION_SEARCH
 
 /*!\endcond */
 /*! @} - end defgroup vp8_encoder */
@@ -26,6 +26,7 @@ extern "C" {
 
 /* Include controls common to both the encoder and decoder */
 #include "./vp8.h"
+#include "./vpx_mode_info.h"
 
 /*!\name Algorithm interface for VP8
  *
@@ -158,9 +159,91 @@ enum vp8_dec_control_id {
    */
   VP9D_SET_LOOP_FILTER_OPT,
 
+  /*!\brief Codec control function to export the mode info of each decoded
+   * frame, pass a VpxFrameModeInfo pointer or NULL to stop the export.
+   *
+   * The decoder writes the motion vectors, reference frames, block size and
+   * skip flag of every 8x8 area into the blocks array as it parses them, and
+   * fills in the frame and mi dimensions. The structure must stay valid while
+   * frames are decoded. When num_blocks is smaller than mi_rows * mi_cols,
+   * nothing is written and mi_rows and mi_cols are set to 0. With superframes
+   * the array holds the last frame decoded.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SET_MODE_INFO_EXPORT,
+
+  /*!\brief Codec control function to decode only the tile columns that
+   * intersect a region of interest, e.g. the viewport of a 360 video. Pass a
+   * vpx_image_rect_t pointer with x and w in pixels, or NULL or a zero width
+   * to decode the whole frame.
+   *
+   * The y and h fields are ignored, since the tile rows of a frame depend on
+   * each other. The pixels of the skipped columns are left untouched. A
+   * column that was skipped is not decoded again until the next key frame,
+   * intra-only frame or error resilient frame, and frames that adapt the
+   * entropy probabilities are always decoded in full, so the region only
+   * takes effect for streams coded with frame parallel decoding mode or error
+   * resilience. The loop filter does not filter across the outer edges of the
+   * decoded columns, and inter prediction near those edges may read from
+   * skipped areas of the references, so the pixels near the edges differ
+   * from a full decode. #VP9D_GET_DECODED_REGION reports the columns that
+   * match it.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SET_DECODE_REGION,
+
+  /*!\brief Codec control function to get the columns of the last decoded
+   * frame whose pixels match a full decode, as a vpx_image_rect_t covering
+   * the full frame height. The width is 0 when no column matches.
+   *
+   * The columns exclude a margin of 16 pixels at the edges of the decoded
+   * columns for the loop filter. In inter frames whose references do not
+   * match a full decode everywhere, they also exclude the reach of the
+   * largest horizontal motion vector of the frame from the matching columns
+   * of the references, so the reported columns shrink from frame to frame
+   * until the next key frame or intra-only frame.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_GET_DECODED_REGION,
+
+  /*!\brief Codec control function to shed work when the decoder falls
+   * behind, with the time budget of each decode call in microseconds, or 0 to
+   * decode everything.
+   *
+   * The decoder tracks how far behind the budget it runs. The first deadline
+   * of delay makes it parse the frames that are not references without
+   * reconstructing or outputting them. The next one also skips the loop
+   * filter, which makes the references drift until the next key frame, and
+   * the last one also skips the postprocessing. The budget can change between
+   * decode calls.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_SET_FRAME_DEADLINE,
+
+  /*!\brief Codec control function to get the work skipped by the last decode
+   * call and the frames it output, a combination of vp9d_skipped_work flags.
+   *
+   * Supported in codecs: VP9
+   */
+  VP9D_GET_SKIPPED_WORK,
+
   VP8_DECODER_CTRL_ID_MAX
 };
 
+/*!\brief Work skipped under VP9D_SET_FRAME_DEADLINE
+ *
+ * Reported by VP9D_GET_SKIPPED_WORK.
+ */
+typedef enum vp9d_skipped_work {
+  VP9D_SKIPPED_FRAME = 1 << 0,       /**< A frame was parsed, not output */
+  VP9D_SKIPPED_LOOP_FILTER = 1 << 1, /**< The loop filter was skipped */
+  VP9D_SKIPPED_POSTPROC = 1 << 2     /**< The postprocessing was skipped */
+} vp9d_skipped_work;
+
 /** Decrypt n bytes of data from input -> output, using the decrypt_state
  *  passed in VPXD_SET_DECRYPTOR.
  */
@@ -217,6 +300,16 @@ VPX_CTRL_USE_TYPE(VP9D_SET_ROW_MT, int)
 #define VPX_CTRL_VP9_DECODE_SET_ROW_MT
 VPX_CTRL_USE_TYPE(VP9D_SET_LOOP_FILTER_OPT, int)
 #define VPX_CTRL_VP9_SET_LOOP_FILTER_OPT
+VPX_CTRL_USE_TYPE(VP9D_SET_MODE_INFO_EXPORT, VpxFrameModeInfo *)
+#define VPX_CTRL_VP9D_SET_MODE_INFO_EXPORT
+VPX_CTRL_USE_TYPE(VP9D_SET_DECODE_REGION, vpx_image_rect_t *)
+#define VPX_CTRL_VP9D_SET_DECODE_REGION
+VPX_CTRL_USE_TYPE(VP9D_GET_DECODED_REGION, vpx_image_rect_t *)
+#define VPX_CTRL_VP9D_GET_DECODED_REGION
+VPX_CTRL_USE_TYPE(VP9D_SET_FRAME_DEADLINE, int)
+#define VPX_CTRL_VP9D_SET_FRAME_DEADLINE
+VPX_CTRL_USE_TYPE(VP9D_GET_SKIPPED_WORK, int *)
+#define VPX_CTRL_VP9D_GET_SKIPPED_WORK
 
 /*!\endcond */
 /*! @} - end defgroup vp8_decoder */
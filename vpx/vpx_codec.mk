@@ -27,7 +27,10 @@ API_DOC_SRCS-yes += vpx_encoder.h
 API_DOC_SRCS-$(CONFIG_ENCODERS) += vpx_ext_ratectrl.h
 API_DOC_SRCS-yes += vpx_frame_buffer.h
 API_DOC_SRCS-yes += vpx_image.h
+API_DOC_SRCS-yes += vpx_mode_info.h
 API_DOC_SRCS-$(CONFIG_ENCODERS) += vpx_tpl.h
+API_DOC_SRCS-$(CONFIG_THREAD_TRACE) += vpx_trace.h
+API_DOC_SRCS-$(CONFIG_KERNEL_STATS) += vpx_kernel_stats.h
 
 API_SRCS-yes += src/vpx_decoder.c
 API_SRCS-yes += vpx_decoder.h
@@ -42,5 +45,8 @@ API_SRCS-yes += vpx_codec.mk
 API_SRCS-yes += vpx_frame_buffer.h
 API_SRCS-yes += vpx_image.h
 API_SRCS-yes += vpx_integer.h
+API_SRCS-yes += vpx_mode_info.h
 API_SRCS-yes += vpx_ext_ratectrl.h
 API_SRCS-yes += vpx_tpl.h
+API_SRCS-yes += vpx_trace.h
+API_SRCS-yes += vpx_kernel_stats.h
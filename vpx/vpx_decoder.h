@@ -31,6 +31,7 @@ extern "C" {
 
 #include "./vpx_codec.h"  // IWYU pragma: export
 #include "./vpx_frame_buffer.h"
+#include "./vpx_mode_info.h"
 
 /*!\brief Current ABI version number
  *
@@ -39,9 +40,15 @@ extern "C" {
  * must be bumped.  Examples include, but are not limited to, changing
  * types, removing or reassigning enums, adding/removing/rearranging
  * fields to structures
+ *
+ * \note
+ * VPX_DECODER_ABI_VERSION has a VPX_MODE_INFO_ABI_VERSION component
+ * because the VP9D_SET_MODE_INFO_EXPORT codec control uses
+ * VpxFrameModeInfo.
  */
 #define VPX_DECODER_ABI_VERSION \
-  (3 + VPX_CODEC_ABI_VERSION) /**<\hideinitializer*/
+  (3 + VPX_CODEC_ABI_VERSION +  \
+   VPX_MODE_INFO_ABI_VERSION) /**<\hideinitializer*/
 
 /*! \brief Decoder capabilities bitfield
  *
@@ -31,6 +31,7 @@ extern "C" {
 
 #include "./vpx_codec.h"  // IWYU pragma: export
 #include "./vpx_ext_ratectrl.h"
+#include "./vpx_mode_info.h"
 
 /*! Temporal Scalability: Maximum length of the sequence defining frame
  * layer membership
@@ -60,11 +61,12 @@ extern "C" {
  * \note
  * VPX_ENCODER_ABI_VERSION has a VPX_EXT_RATECTRL_ABI_VERSION component
  * because the VP9E_SET_EXTERNAL_RATE_CONTROL codec control uses
- * vpx_rc_funcs_t.
+ * vpx_rc_funcs_t, and a VPX_MODE_INFO_ABI_VERSION component because the
+ * VP9E_SET_MODE_INFO_SEED codec control uses VpxFrameModeInfo.
  */
-#define VPX_ENCODER_ABI_VERSION \
-  (18 + VPX_CODEC_ABI_VERSION + \
-   VPX_EXT_RATECTRL_ABI_VERSION) /**<\hideinitializer*/
+#define VPX_ENCODER_ABI_VERSION                                \
+  (18 + VPX_CODEC_ABI_VERSION + VPX_EXT_RATECTRL_ABI_VERSION + \
+   VPX_MODE_INFO_ABI_VERSION) /**<\hideinitializer*/
 
 /*! \brief Encoder capabilities bitfield
  *
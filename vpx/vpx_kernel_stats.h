@@ -0,0 +1,52 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*!\file
+ * \brief Reports the per kernel call counters of libraries configured with
+ * --enable-kernel-stats.
+ *
+ * Every call through an RTCD function pointer, e.g. vpx_sad16x16 or
+ * vpx_convolve8, counts one call and the ticks spent in the implementation
+ * selected at run time. Ticks are time stamp counter cycles on x86 and
+ * nanoseconds elsewhere.
+ *
+ * These functions are only present in libraries configured with
+ * --enable-kernel-stats.
+ */
+#ifndef VPX_VPX_VPX_KERNEL_STATS_H_
+#define VPX_VPX_VPX_KERNEL_STATS_H_
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!\brief Clears the counters of all the kernels
+ *
+ * Must not be called while codec threads are running.
+ */
+void vpx_kernel_stats_reset(void);
+
+/*!\brief Prints the counters of the kernels called so far
+ *
+ * The kernels that were called at least once are listed sorted by their
+ * total number of ticks, followed by the totals per block size as parsed
+ * from the kernel names.
+ *
+ * \param[in] file  Open file to print the counters to
+ */
+void vpx_kernel_stats_dump(FILE *file);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VPX_VPX_VPX_KERNEL_STATS_H_
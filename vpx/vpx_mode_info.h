@@ -0,0 +1,64 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*!\file
+ * \brief Describes the per block mode info exchanged between the VP9 decoder
+ * and encoder, e.g. to seed the encoder searches when transcoding.
+ *
+ */
+#ifndef VPX_VPX_VPX_MODE_INFO_H_
+#define VPX_VPX_VPX_MODE_INFO_H_
+
+#include "./vpx_integer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!\brief Current ABI version number
+ *
+ * \internal
+ * If this file is altered in any way that changes the ABI, this value
+ * must be bumped.  Examples include, but are not limited to, changing
+ * types, removing or reassigning enums, adding/removing/rearranging
+ * fields to structures
+ */
+#define VPX_MODE_INFO_ABI_VERSION 1 /**<\hideinitializer*/
+
+/*!\brief Mode info of the block covering one 8x8 area of a frame */
+typedef struct VpxBlockModeInfo {
+  int16_t mv_row[2];    /**< Motion vector rows in 1/8 pel */
+  int16_t mv_col[2];    /**< Motion vector cols in 1/8 pel */
+  int8_t ref_frame[2];  /**< 0 intra, 1 last, 2 golden, 3 altref, -1 none */
+  uint8_t block_width;  /**< Width of the coded block in pixels, 4 to 64 */
+  uint8_t block_height; /**< Height of the coded block in pixels, 4 to 64 */
+  uint8_t skip;         /**< Whether the block was coded without residual */
+} VpxBlockModeInfo;
+
+/*!\brief Mode info of a frame, one entry for each 8x8 area
+ *
+ * The entry of the 8x8 area at row r and col c is blocks[r * stride + c].
+ * The application owns the blocks array and sets num_blocks to its size.
+ */
+typedef struct VpxFrameModeInfo {
+  int frame_width;          /**< Frame width in pixels */
+  int frame_height;         /**< Frame height in pixels */
+  int mi_rows;              /**< Number of 8x8 rows */
+  int mi_cols;              /**< Number of 8x8 cols */
+  int stride;               /**< Distance between rows in blocks */
+  int num_blocks;           /**< Size of the blocks array */
+  VpxBlockModeInfo *blocks; /**< Mode info of each 8x8 area */
+} VpxFrameModeInfo;
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VPX_VPX_VPX_MODE_INFO_H_
@@ -0,0 +1,60 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*!\file
+ * \brief Controls the worker thread event tracing of libraries configured
+ * with --enable-thread-trace.
+ *
+ * The encoder and decoder record begin and end events of their worker
+ * threads, e.g. for each tile or superblock row, into one ring buffer per
+ * thread. The events can be written out in the Chrome trace event format,
+ * which is understood by chrome://tracing and https://ui.perfetto.dev.
+ *
+ * These functions are only present in libraries configured with
+ * --enable-thread-trace.
+ */
+#ifndef VPX_VPX_VPX_TRACE_H_
+#define VPX_VPX_VPX_TRACE_H_
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!\brief Starts or stops recording events
+ *
+ * Recording is off until this is called with a nonzero \p enable.
+ *
+ * \param[in] enable  Nonzero to record events, 0 to stop
+ */
+void vpx_trace_enable(int enable);
+
+/*!\brief Discards all the events recorded so far
+ *
+ * Must not be called while codec threads are running.
+ */
+void vpx_trace_reset(void);
+
+/*!\brief Writes all the recorded events as a JSON trace
+ *
+ * Must not be called while codec threads are recording.
+ *
+ * \param[in] file  Open file to write the trace to
+ *
+ * \retval 0 on success, nonzero on a write error
+ */
+int vpx_trace_write_json(FILE *file);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VPX_VPX_VPX_TRACE_H_
@@ -0,0 +1,215 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "./vpx_config.h"
+#include "vpx/vpx_integer.h"
+#if VPX_ARCH_X86 || VPX_ARCH_X86_64
+#include "vpx_ports/x86.h"
+#endif
+#if CONFIG_MULTITHREAD
+#include "vpx_ports/vpx_once.h"
+#include "vpx_util/vpx_pthread.h"
+#endif
+#include "vpx_util/vpx_kernel_stats.h"
+
+#if CONFIG_KERNEL_STATS
+
+// Room for one table per RTCD header (vp8, vp9, vpx_dsp and vpx_scale).
+#define MAX_KERNEL_STAT_TABLES 8
+#define MAX_BLOCK_SIZES 64
+
+typedef struct {
+  VpxKernelStat *stats;
+  int num_stats;
+} KernelStatTable;
+
+typedef struct {
+  int width;
+  int height;
+  uint64_t calls;
+  uint64_t ticks;
+} BlockSizeStat;
+
+static KernelStatTable kernel_stat_tables[MAX_KERNEL_STAT_TABLES];
+static int num_kernel_stat_tables;
+#if CONFIG_MULTITHREAD
+static pthread_mutex_t kernel_stats_mutex;
+
+static void kernel_stats_init(void) {
+  pthread_mutex_init(&kernel_stats_mutex, NULL);
+}
+#endif
+
+static void atomic_add_u64(uint64_t *value, uint64_t delta) {
+#if CONFIG_MULTITHREAD && (defined(__GNUC__) || defined(__clang__))
+  __atomic_fetch_add(value, delta, __ATOMIC_RELAXED);
+#elif CONFIG_MULTITHREAD && defined(_MSC_VER) && defined(_WIN64)
+  InterlockedExchangeAdd64((volatile LONG64 *)value, (LONG64)delta);
+#else
+  *value += delta;
+#endif
+}
+
+uint64_t vpx_kernel_stats_ticks(void) {
+#if VPX_ARCH_X86 || VPX_ARCH_X86_64
+  return x86_readtsc64();
+#elif defined(_WIN32)
+  LARGE_INTEGER counter;
+  QueryPerformanceCounter(&counter);
+  return (uint64_t)counter.QuadPart;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void vpx_kernel_stats_add(VpxKernelStat *stat, uint64_t start) {
+  const uint64_t ticks = vpx_kernel_stats_ticks() - start;
+  atomic_add_u64(&stat->calls, 1);
+  atomic_add_u64(&stat->ticks, ticks);
+}
+
+void vpx_kernel_stats_register(VpxKernelStat *stats, int num_stats) {
+#if CONFIG_MULTITHREAD
+  once(kernel_stats_init);
+  pthread_mutex_lock(&kernel_stats_mutex);
+#endif
+  if (num_kernel_stat_tables < MAX_KERNEL_STAT_TABLES) {
+    kernel_stat_tables[num_kernel_stat_tables].stats = stats;
+    kernel_stat_tables[num_kernel_stat_tables].num_stats = num_stats;
+    ++num_kernel_stat_tables;
+  }
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&kernel_stats_mutex);
+#endif
+}
+
+void vpx_kernel_stats_reset(void) {
+  int i, j;
+  for (i = 0; i < num_kernel_stat_tables; ++i) {
+    for (j = 0; j < kernel_stat_tables[i].num_stats; ++j) {
+      kernel_stat_tables[i].stats[j].calls = 0;
+      kernel_stat_tables[i].stats[j].ticks = 0;
+    }
+  }
+}
+
+static int compare_ticks(const void *a, const void *b) {
+  const VpxKernelStat *const sa = *(const VpxKernelStat *const *)a;
+  const VpxKernelStat *const sb = *(const VpxKernelStat *const *)b;
+  if (sa->ticks != sb->ticks) return sa->ticks < sb->ticks ? 1 : -1;
+  return sa->calls < sb->calls ? 1 : sa->calls > sb->calls ? -1 : 0;
+}
+
+static int compare_block_sizes(const void *a, const void *b) {
+  const BlockSizeStat *const sa = (const BlockSizeStat *)a;
+  const BlockSizeStat *const sb = (const BlockSizeStat *)b;
+  const int area_a = sa->width * sa->height;
+  const int area_b = sb->width * sb->height;
+  if (area_a != area_b) return area_a < area_b ? -1 : 1;
+  return sa->width - sb->width;
+}
+
+// Extracts the first <width>x<height> pair from a kernel name such as
+// vpx_sad16x8x4d. Returns 0 if the name has no block size.
+static int parse_block_size(const char *name, int *width, int *height) {
+  const char *p;
+  for (p = name; *p; ++p) {
+    if (isdigit((unsigned char)*p) && (p == name || !isdigit(p[-1]))) {
+      char *end;
+      const long w = strtol(p, &end, 10);
+      if (*end == 'x' && isdigit((unsigned char)end[1])) {
+        *width = (int)w;
+        *height = (int)strtol(end + 1, NULL, 10);
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+void vpx_kernel_stats_dump(FILE *file) {
+  BlockSizeStat block_sizes[MAX_BLOCK_SIZES];
+  int num_block_sizes = 0;
+  VpxKernelStat **sorted;
+  uint64_t total_ticks = 0;
+  int num_stats = 0;
+  int num_called = 0;
+  int i, j;
+
+  for (i = 0; i < num_kernel_stat_tables; ++i) {
+    num_stats += kernel_stat_tables[i].num_stats;
+  }
+  sorted = (VpxKernelStat **)malloc(num_stats * sizeof(*sorted));
+  if (sorted == NULL) return;
+
+  for (i = 0; i < num_kernel_stat_tables; ++i) {
+    for (j = 0; j < kernel_stat_tables[i].num_stats; ++j) {
+      VpxKernelStat *const stat = &kernel_stat_tables[i].stats[j];
+      int width, height, k;
+      if (!stat->calls) continue;
+      sorted[num_called++] = stat;
+      total_ticks += stat->ticks;
+      if (!parse_block_size(stat->name, &width, &height)) continue;
+      for (k = 0; k < num_block_sizes; ++k) {
+        if (block_sizes[k].width == width && block_sizes[k].height == height)
+          break;
+      }
+      if (k == num_block_sizes) {
+        if (num_block_sizes == MAX_BLOCK_SIZES) continue;
+        block_sizes[k].width = width;
+        block_sizes[k].height = height;
+        block_sizes[k].calls = 0;
+        block_sizes[k].ticks = 0;
+        ++num_block_sizes;
+      }
+      block_sizes[k].calls += stat->calls;
+      block_sizes[k].ticks += stat->ticks;
+    }
+  }
+  qsort(sorted, num_called, sizeof(*sorted), compare_ticks);
+  qsort(block_sizes, num_block_sizes, sizeof(*block_sizes),
+        compare_block_sizes);
+  if (total_ticks == 0) total_ticks = 1;
+
+  fprintf(file, "%-40s %-32s %14s %16s %12s %7s\n", "kernel", "impl", "calls",
+          "ticks", "ticks/call", "%");
+  for (i = 0; i < num_called; ++i) {
+    const VpxKernelStat *const stat = sorted[i];
+    fprintf(file, "%-40s %-32s %14" PRIu64 " %16" PRIu64 " %12.1f %7.2f\n",
+            stat->name, stat->impl, stat->calls, stat->ticks,
+            (double)stat->ticks / stat->calls,
+            100.0 * stat->ticks / total_ticks);
+  }
+
+  fprintf(file, "\n%-12s %14s %16s %7s\n", "block size", "calls", "ticks",
+          "%");
+  for (i = 0; i < num_block_sizes; ++i) {
+    char size[32];
+    snprintf(size, sizeof(size), "%dx%d", block_sizes[i].width,
+             block_sizes[i].height);
+    fprintf(file, "%-12s %14" PRIu64 " %16" PRIu64 " %7.2f\n", size,
+            block_sizes[i].calls, block_sizes[i].ticks,
+            100.0 * block_sizes[i].ticks / total_ticks);
+  }
+  free(sorted);
+}
+
+#endif  // CONFIG_KERNEL_STATS
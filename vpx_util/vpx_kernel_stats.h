@@ -0,0 +1,55 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VPX_VPX_UTIL_VPX_KERNEL_STATS_H_
+#define VPX_VPX_UTIL_VPX_KERNEL_STATS_H_
+
+#include "./vpx_config.h"
+#include "vpx/vpx_integer.h"
+#include "vpx/vpx_kernel_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_KERNEL_STATS
+/* Per kernel call counters for the RTCD functions. When configured with
+ * --enable-kernel-stats, rtcd.pl routes every RTCD function pointer through a
+ * wrapper which records the number of calls and the number of ticks spent in
+ * the implementation selected at run time. Ticks are time stamp counter
+ * cycles on x86 and nanoseconds elsewhere.
+ *
+ * Most kernels exist once per block size (vpx_sad16x8, vpx_variance32x32,
+ * ...), so the dump also aggregates the counters per block size as parsed
+ * from the kernel names.
+ *
+ * Applications reset and print the counters through the functions of
+ * vpx/vpx_kernel_stats.h. */
+typedef struct VpxKernelStat {
+  const char *name;
+  const char *impl;
+  uint64_t calls;
+  uint64_t ticks;
+} VpxKernelStat;
+
+uint64_t vpx_kernel_stats_ticks(void);
+
+/* Adds one call which started at |start| ticks to |stat|. */
+void vpx_kernel_stats_add(VpxKernelStat *stat, uint64_t start);
+
+/* Called once per RTCD table from the generated setup_rtcd_internal(). */
+void vpx_kernel_stats_register(VpxKernelStat *stats, int num_stats);
+#endif  // CONFIG_KERNEL_STATS
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VPX_VPX_UTIL_VPX_KERNEL_STATS_H_
@@ -24,6 +24,7 @@
 #include "./vpx_thread.h"
 #include "vpx_mem/vpx_mem.h"
 #include "vpx_util/vpx_pthread.h"
+#include "vpx_util/vpx_trace.h"
 
 #if CONFIG_MULTITHREAD
 
@@ -86,6 +87,7 @@ static THREADFN thread_loop(void *ptr) {
     }
   }
   pthread_mutex_unlock(&worker->impl_->mutex_);
+  VPX_TRACE_THREAD_EXIT();
   return THREAD_EXIT_SUCCESS;  // Thread is finished
 }
 
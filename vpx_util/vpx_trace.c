@@ -0,0 +1,193 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "./vpx_config.h"
+#include "vpx/vpx_integer.h"
+#include "vpx_ports/vpx_once.h"
+#include "vpx_ports/vpx_timer.h"
+#include "vpx_util/vpx_atomics.h"
+#if CONFIG_MULTITHREAD
+#include "vpx_util/vpx_pthread.h"
+#endif
+#include "vpx_util/vpx_trace.h"
+
+#if CONFIG_THREAD_TRACE
+
+#if defined(_MSC_VER)
+#define TRACE_TLS __declspec(thread)
+#else
+#define TRACE_TLS __thread
+#endif
+
+// Number of events kept per thread. Must be a power of 2.
+#define TRACE_BUFFER_SIZE (1 << 16)
+#define TRACE_MAX_THREADS 64
+
+typedef struct {
+  const char *name;
+  int64_t ts;
+  int arg;
+  char phase;
+} TraceEvent;
+
+typedef struct {
+  TraceEvent events[TRACE_BUFFER_SIZE];
+  // Total number of events recorded, including overwritten ones.
+  uint64_t count;
+  int tid;
+  // Set when the thread has exited. Its events are kept until the slot is
+  // needed by a new thread.
+  int retired;
+} TraceBuffer;
+
+static vpx_atomic_int trace_enabled = VPX_ATOMIC_INIT(0);
+// Incremented by vpx_trace_reset(), which frees the buffers, so that the
+// threads register again.
+static vpx_atomic_int trace_generation = VPX_ATOMIC_INIT(1);
+static TraceBuffer *trace_buffers[TRACE_MAX_THREADS];
+static int num_trace_buffers;
+static int last_tid;
+static struct vpx_usec_timer trace_origin;
+static TRACE_TLS TraceBuffer *thread_buffer;
+// Generation of thread_buffer, 0 when the thread has not registered.
+static TRACE_TLS int thread_generation;
+#if CONFIG_MULTITHREAD
+static pthread_mutex_t trace_mutex;
+#endif
+
+static void trace_init(void) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_init(&trace_mutex, NULL);
+#endif
+  vpx_usec_timer_start(&trace_origin);
+}
+
+// Gives the calling thread a buffer, reusing the one of an exited thread when
+// all the slots are taken. Returns NULL when no buffer is available.
+static TraceBuffer *register_thread(int generation) {
+  TraceBuffer *buffer = NULL;
+  int i;
+  once(trace_init);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&trace_mutex);
+#endif
+  if (num_trace_buffers < TRACE_MAX_THREADS) {
+    buffer = (TraceBuffer *)calloc(1, sizeof(*buffer));
+    if (buffer != NULL) trace_buffers[num_trace_buffers++] = buffer;
+  } else {
+    for (i = 0; i < num_trace_buffers; ++i) {
+      if (trace_buffers[i]->retired) {
+        buffer = trace_buffers[i];
+        buffer->count = 0;
+        buffer->retired = 0;
+        break;
+      }
+    }
+  }
+  if (buffer != NULL) buffer->tid = ++last_tid;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&trace_mutex);
+#endif
+  thread_buffer = buffer;
+  thread_generation = generation;
+  return buffer;
+}
+
+void vpx_trace_enable(int enable) {
+  once(trace_init);
+  vpx_atomic_store_release(&trace_enabled, enable);
+}
+
+void vpx_trace_event(const char *name, char phase, int arg) {
+  TraceBuffer *buffer = thread_buffer;
+  TraceEvent *event;
+  struct vpx_usec_timer now;
+  int generation;
+
+  if (!vpx_atomic_load_acquire(&trace_enabled)) return;
+  generation = vpx_atomic_load_acquire(&trace_generation);
+  if (thread_generation != generation) buffer = register_thread(generation);
+  if (buffer == NULL) return;
+
+  now = trace_origin;
+  vpx_usec_timer_mark(&now);
+  event = &buffer->events[buffer->count & (TRACE_BUFFER_SIZE - 1)];
+  event->name = name;
+  event->ts = vpx_usec_timer_elapsed(&now);
+  event->arg = arg;
+  event->phase = phase;
+  ++buffer->count;
+}
+
+void vpx_trace_thread_exit(void) {
+  if (thread_buffer == NULL ||
+      thread_generation != vpx_atomic_load_acquire(&trace_generation))
+    return;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&trace_mutex);
+#endif
+  thread_buffer->retired = 1;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&trace_mutex);
+#endif
+  thread_buffer = NULL;
+  thread_generation = 0;
+}
+
+void vpx_trace_reset(void) {
+  int i;
+  once(trace_init);
+  for (i = 0; i < num_trace_buffers; ++i) {
+    free(trace_buffers[i]);
+    trace_buffers[i] = NULL;
+  }
+  num_trace_buffers = 0;
+  last_tid = 0;
+  vpx_atomic_store_release(&trace_generation,
+                           vpx_atomic_load_acquire(&trace_generation) + 1);
+  vpx_usec_timer_start(&trace_origin);
+}
+
+int vpx_trace_write_json(FILE *file) {
+  int i;
+  int first = 1;
+
+  if (fprintf(file, "{\"traceEvents\":[") < 0) return -1;
+  for (i = 0; i < num_trace_buffers; ++i) {
+    const TraceBuffer *const buffer = trace_buffers[i];
+    const uint64_t end = buffer->count;
+    uint64_t j = end > TRACE_BUFFER_SIZE ? end - TRACE_BUFFER_SIZE : 0;
+
+    fprintf(file,
+            "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+            "\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+            first ? "" : ",", buffer->tid, buffer->tid);
+    first = 0;
+    for (; j < end; ++j) {
+      const TraceEvent *const event =
+          &buffer->events[j & (TRACE_BUFFER_SIZE - 1)];
+      fprintf(file,
+              ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%" PRId64
+              ",\"pid\":1,\"tid\":%d",
+              event->name, event->phase, event->ts, buffer->tid);
+      if (event->phase == 'B') {
+        fprintf(file, ",\"args\":{\"arg\":%d}", event->arg);
+      }
+      fputc('}', file);
+    }
+  }
+  if (fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n") < 0) return -1;
+  return ferror(file) ? -1 : 0;
+}
+
+#endif  // CONFIG_THREAD_TRACE
@@ -0,0 +1,51 @@
+/*
+ *  Copyright (c) 2024 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VPX_VPX_UTIL_VPX_TRACE_H_
+#define VPX_VPX_UTIL_VPX_TRACE_H_
+
+#include "./vpx_config.h"
+#include "vpx/vpx_trace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_THREAD_TRACE
+/* Lightweight begin/end event tracing for the encoder and decoder worker
+ * threads. Each thread records into its own fixed size ring buffer, so
+ * recording takes no locks once the thread has registered itself with its
+ * first event. When a ring buffer fills up the oldest events of that thread
+ * are overwritten.
+ *
+ * Applications enable, reset and write out the trace through the functions
+ * of vpx/vpx_trace.h. |name| must point to a string that outlives the trace,
+ * typically a string literal. */
+void vpx_trace_event(const char *name, char phase, int arg);
+
+/* Marks the buffer of the calling thread as free for reuse by a later thread
+ * once all the slots are taken. Its events are kept until then. Called by the
+ * worker threads when they exit. */
+void vpx_trace_thread_exit(void);
+
+#define VPX_TRACE_BEGIN(name, arg) vpx_trace_event((name), 'B', (arg))
+#define VPX_TRACE_END(name) vpx_trace_event((name), 'E', 0)
+#define VPX_TRACE_THREAD_EXIT() vpx_trace_thread_exit()
+#else
+#define VPX_TRACE_BEGIN(name, arg) ((void)0)
+#define VPX_TRACE_END(name) ((void)0)
+#define VPX_TRACE_THREAD_EXIT() ((void)0)
+#endif  // CONFIG_THREAD_TRACE
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // VPX_VPX_UTIL_VPX_TRACE_H_
@@ -19,3 +19,7 @@ UTIL_SRCS-yes += vpx_write_yuv_frame.c
 UTIL_SRCS-yes += vpx_timestamp.h
 UTIL_SRCS-$(or $(CONFIG_BITSTREAM_DEBUG),$(CONFIG_MISMATCH_DEBUG)) += vpx_debug_util.h
 UTIL_SRCS-$(or $(CONFIG_BITSTREAM_DEBUG),$(CONFIG_MISMATCH_DEBUG)) += vpx_debug_util.c
+UTIL_SRCS-yes += vpx_trace.h
+UTIL_SRCS-$(CONFIG_THREAD_TRACE) += vpx_trace.c
+UTIL_SRCS-yes += vpx_kernel_stats.h
+UTIL_SRCS-$(CONFIG_KERNEL_STATS) += vpx_kernel_stats.c
@@ -25,6 +25,7 @@
 #include "./ivfdec.h"
 
 #include "vpx/vpx_decoder.h"
+#include "vpx/vpx_trace.h"
 #include "vpx_ports/mem_ops.h"
 #include "vpx_ports/vpx_timer.h"
 
@@ -34,6 +35,7 @@
 
 #include "./md5_utils.h"
 
+#include "./tool_worker.h"
 #include "./tools_common.h"
 #if CONFIG_WEBM_IO
 #include "./webmdec.h"
@@ -45,6 +47,7 @@ static const char *exec_name;
 struct VpxDecInputContext {
   struct VpxInputContext *vpx_input_ctx;
   struct WebmInputContext *webm_ctx;
+  struct IvfMappedFile *ivf_map;
 };
 
 static const arg_def_t help =
@@ -103,6 +106,10 @@ static const arg_def_t rowmtarg =
 static const arg_def_t lpfoptarg =
     ARG_DEF(NULL, "lpf-opt", 1,
             "Do loopfilter without waiting for all threads to sync.");
+#if CONFIG_THREAD_TRACE
+static const arg_def_t tracefilearg = ARG_DEF(
+    NULL, "trace-file", 1, "Output thread events (chrome://tracing format)");
+#endif
 
 static const arg_def_t *all_args[] = { &help,
                                        &codecarg,
@@ -132,6 +139,9 @@ static const arg_def_t *all_args[] = { &help,
                                        &framestatsarg,
                                        &rowmtarg,
                                        &lpfoptarg,
+#if CONFIG_THREAD_TRACE
+                                       &tracefilearg,
+#endif
                                        NULL };
 
 #if CONFIG_VP8_DECODER
@@ -265,21 +275,32 @@ static int raw_read_frame(FILE *infile, uint8_t **buffer, size_t *bytes_read,
   return 1;
 }
 
+// Reads the next frame into |*buf|, or returns it in place when the input
+// is mapped. |*frame| is set to the frame data in either case.
 static int dec_read_frame(struct VpxDecInputContext *input, uint8_t **buf,
-                          size_t *bytes_in_buffer, size_t *buffer_size) {
+                          size_t *bytes_in_buffer, size_t *buffer_size,
+                          const uint8_t **frame) {
+  int ret;
   switch (input->vpx_input_ctx->file_type) {
 #if CONFIG_WEBM_IO
     case FILE_TYPE_WEBM:
-      return webm_read_frame(input->webm_ctx, buf, bytes_in_buffer);
+      return webm_read_frame_ref(input->webm_ctx, frame, bytes_in_buffer);
 #endif
     case FILE_TYPE_RAW:
-      return raw_read_frame(input->vpx_input_ctx->file, buf, bytes_in_buffer,
-                            buffer_size);
+      ret = raw_read_frame(input->vpx_input_ctx->file, buf, bytes_in_buffer,
+                           buffer_size);
+      break;
     case FILE_TYPE_IVF:
-      return ivf_read_frame(input->vpx_input_ctx->file, buf, bytes_in_buffer,
-                            buffer_size);
+      if (input->ivf_map) {
+        return ivf_map_read_frame(input->ivf_map, frame, bytes_in_buffer);
+      }
+      ret = ivf_read_frame(input->vpx_input_ctx->file, buf, bytes_in_buffer,
+                           buffer_size);
+      break;
     default: return 1;
   }
+  *frame = *buf;
+  return ret;
 }
 
 static void update_image_md5(const vpx_image_t *img, const int planes[3],
@@ -366,6 +387,7 @@ struct ExternalFrameBuffer {
   uint8_t *data;
   size_t size;
   int in_use;
+  int held;  // Still being output after the decoder released it.
 };
 
 struct ExternalFrameBufferList {
@@ -386,7 +408,9 @@ static int get_vp9_frame_buffer(void *cb_priv, size_t min_size,
 
   // Find a free frame buffer.
   for (i = 0; i < ext_fb_list->num_external_frame_buffers; ++i) {
-    if (!ext_fb_list->ext_fb[i].in_use) break;
+    if (!ext_fb_list->ext_fb[i].in_use && !ext_fb_list->ext_fb[i].held) {
+      break;
+    }
   }
 
   if (i == ext_fb_list->num_external_frame_buffers) return -1;
@@ -514,12 +538,224 @@ static int img_shifted_realloc_required(const vpx_image_t *img,
 }
 #endif
 
+// Scales, hashes and writes the decoded frames. The work runs on a worker
+// thread while the next frame is decoded, when the frame is in an external
+// frame buffer that can be held until the worker is done with it.
+struct OutputSink {
+  ToolWorker worker;
+  int hold_frames;
+  int flipuv;
+  int do_scale;
+  int do_md5;
+  int single_file;
+  int use_y4m;
+  int opt_i420;
+  int opt_yv12;
+#if CONFIG_VP9_HIGHBITDEPTH
+  unsigned int output_bit_depth;
+#endif
+  const char *outfile_pattern;
+  const struct VpxInputContext *vpx_input_ctx;
+
+  char outfile_name[PATH_MAX];
+  FILE *outfile;
+  MD5Context md5_ctx;
+  vpx_image_t *scaled_img;
+#if CONFIG_VP9_HIGHBITDEPTH
+  vpx_image_t *img_shifted;
+#endif
+
+  // The frame being output.
+  vpx_image_t img;
+  struct ExternalFrameBuffer *held_fb;
+  int frame_in;
+  int frame_out;
+  int corrupted;
+  int render_width;
+  int render_height;
+};
+
+static int output_frame(void *arg1, void *arg2) {
+  struct OutputSink *const sink = (struct OutputSink *)arg1;
+  vpx_image_t *img = &sink->img;
+  const int PLANES_YUV[] = { VPX_PLANE_Y, VPX_PLANE_U, VPX_PLANE_V };
+  const int PLANES_YVU[] = { VPX_PLANE_Y, VPX_PLANE_V, VPX_PLANE_U };
+  const int *planes = sink->flipuv ? PLANES_YVU : PLANES_YUV;
+  (void)arg2;
+
+  if (sink->do_scale) {
+    if (sink->frame_out == 1) {
+      sink->scaled_img = vpx_img_alloc(NULL, img->fmt, sink->render_width,
+                                       sink->render_height, 16);
+      if (!sink->scaled_img) {
+        fprintf(stderr, "Failed to allocate scaled image (%d x %d)\n",
+                sink->render_width, sink->render_height);
+        return 0;
+      }
+      sink->scaled_img->bit_depth = img->bit_depth;
+    }
+
+    if (img->d_w != sink->scaled_img->d_w ||
+        img->d_h != sink->scaled_img->d_h) {
+#if CONFIG_LIBYUV
+      libyuv_scale(img, sink->scaled_img, kFilterBox);
+      img = sink->scaled_img;
+#else
+      fprintf(stderr,
+              "Failed to scale output frame.\n"
+              "Scaling is disabled in this configuration. "
+              "To enable scaling, configure with --enable-libyuv\n");
+      return 0;
+#endif
+    }
+  }
+#if CONFIG_VP9_HIGHBITDEPTH
+  // Default to codec bit depth if output bit depth not set
+  if (!sink->output_bit_depth && sink->single_file && !sink->do_md5) {
+    sink->output_bit_depth = img->bit_depth;
+  }
+  // Shift up or down if necessary
+  if (sink->output_bit_depth != 0 &&
+      sink->output_bit_depth != img->bit_depth) {
+    const vpx_img_fmt_t shifted_fmt =
+        sink->output_bit_depth == 8
+            ? img->fmt ^ (img->fmt & VPX_IMG_FMT_HIGHBITDEPTH)
+            : img->fmt | VPX_IMG_FMT_HIGHBITDEPTH;
+    if (sink->img_shifted &&
+        img_shifted_realloc_required(img, sink->img_shifted, shifted_fmt)) {
+      vpx_img_free(sink->img_shifted);
+      sink->img_shifted = NULL;
+    }
+    if (!sink->img_shifted) {
+      sink->img_shifted =
+          vpx_img_alloc(NULL, shifted_fmt, img->d_w, img->d_h, 16);
+      if (!sink->img_shifted) {
+        fprintf(stderr, "Failed to allocate image\n");
+        return 0;
+      }
+      sink->img_shifted->bit_depth = sink->output_bit_depth;
+    }
+    if (sink->output_bit_depth > img->bit_depth) {
+      vpx_img_upshift(sink->img_shifted, img,
+                      sink->output_bit_depth - img->bit_depth);
+    } else {
+      vpx_img_downshift(sink->img_shifted, img,
+                        img->bit_depth - sink->output_bit_depth);
+    }
+    img = sink->img_shifted;
+  }
+#endif
+
+  if (sink->single_file) {
+    if (sink->use_y4m) {
+      char y4m_buf[Y4M_BUFFER_SIZE] = { 0 };
+      size_t len = 0;
+      if (img->fmt == VPX_IMG_FMT_I440 || img->fmt == VPX_IMG_FMT_I44016) {
+        fprintf(stderr, "Cannot produce y4m output for 440 sampling.\n");
+        return 0;
+      }
+      if (sink->frame_out == 1) {
+        // Y4M file header
+        len = y4m_write_file_header(
+            y4m_buf, sizeof(y4m_buf), sink->vpx_input_ctx->width,
+            sink->vpx_input_ctx->height, &sink->vpx_input_ctx->framerate,
+            img->fmt, img->bit_depth);
+        if (sink->do_md5) {
+          MD5Update(&sink->md5_ctx, (md5byte *)y4m_buf, (unsigned int)len);
+        } else {
+          fputs(y4m_buf, sink->outfile);
+        }
+      }
+
+      // Y4M frame header
+      len = y4m_write_frame_header(y4m_buf, sizeof(y4m_buf));
+      if (sink->do_md5) {
+        MD5Update(&sink->md5_ctx, (md5byte *)y4m_buf, (unsigned int)len);
+      } else {
+        fputs(y4m_buf, sink->outfile);
+      }
+    } else {
+      if (sink->frame_out == 1) {
+        // Check if --yv12 or --i420 options are consistent with the
+        // bit-stream decoded
+        if (sink->opt_i420) {
+          if (img->fmt != VPX_IMG_FMT_I420 && img->fmt != VPX_IMG_FMT_I42016) {
+            fprintf(stderr, "Cannot produce i420 output for bit-stream.\n");
+            return 0;
+          }
+        }
+        if (sink->opt_yv12) {
+          if ((img->fmt != VPX_IMG_FMT_I420 && img->fmt != VPX_IMG_FMT_YV12) ||
+              img->bit_depth != 8) {
+            fprintf(stderr, "Cannot produce yv12 output for bit-stream.\n");
+            return 0;
+          }
+        }
+      }
+    }
+
+    if (sink->do_md5) {
+      update_image_md5(img, planes, &sink->md5_ctx);
+    } else {
+      if (!sink->corrupted) write_image_file(img, planes, sink->outfile);
+    }
+  } else {
+    generate_filename(sink->outfile_pattern, sink->outfile_name, PATH_MAX,
+                      img->d_w, img->d_h, sink->frame_in);
+    if (sink->do_md5) {
+      unsigned char md5_digest[16];
+      MD5Init(&sink->md5_ctx);
+      update_image_md5(img, planes, &sink->md5_ctx);
+      MD5Final(md5_digest, &sink->md5_ctx);
+      print_md5(md5_digest, sink->outfile_name);
+    } else {
+      FILE *const outfile = open_outfile(sink->outfile_name);
+      write_image_file(img, planes, outfile);
+      fclose(outfile);
+    }
+  }
+  return 1;
+}
+
+// Waits for the previous frame to be output and lets the decoder reuse its
+// frame buffer. Returns 0 if the output failed.
+static int output_sink_sync(struct OutputSink *sink) {
+  const int ok = tool_worker_sync(&sink->worker);
+  if (sink->held_fb) {
+    sink->held_fb->held = 0;
+    sink->held_fb = NULL;
+  }
+  return ok;
+}
+
+// Starts outputting |img|. The frame is output right away unless it lies in
+// an external frame buffer that the decoder will not reuse while it is held.
+static void output_sink_launch(struct OutputSink *sink, const vpx_image_t *img,
+                               int frame_in, int frame_out, int corrupted) {
+  struct ExternalFrameBuffer *const ext_fb =
+      sink->hold_frames ? (struct ExternalFrameBuffer *)img->fb_priv : NULL;
+
+  sink->img = *img;
+  sink->frame_in = frame_in;
+  sink->frame_out = frame_out;
+  sink->corrupted = corrupted;
+  if (ext_fb && img->planes[VPX_PLANE_Y] >= ext_fb->data &&
+      img->planes[VPX_PLANE_Y] < ext_fb->data + ext_fb->size) {
+    ext_fb->held = 1;
+    sink->held_fb = ext_fb;
+    tool_worker_launch(&sink->worker);
+  } else {
+    tool_worker_execute(&sink->worker);
+  }
+}
+
 static int main_loop(int argc, const char **argv_) {
   vpx_codec_ctx_t decoder;
   char *fn = NULL;
   int i;
   int ret = EXIT_FAILURE;
   uint8_t *buf = NULL;
+  const uint8_t *frame = NULL;
   size_t bytes_in_buffer = 0, buffer_size = 0;
   FILE *infile;
   int frame_in = 0, frame_out = 0, flipuv = 0, noblit = 0;
@@ -552,25 +788,23 @@ static int main_loop(int argc, const char **argv_) {
   int frames_corrupted = 0;
   int dec_flags = 0;
   int do_scale = 0;
-  vpx_image_t *scaled_img = NULL;
-#if CONFIG_VP9_HIGHBITDEPTH
-  vpx_image_t *img_shifted = NULL;
-#endif
   int frame_avail, got_data, flush_decoder = 0;
   int num_external_frame_buffers = 0;
   struct ExternalFrameBufferList ext_fb_list = { 0, NULL };
 
   const char *outfile_pattern = NULL;
-  char outfile_name[PATH_MAX] = { 0 };
-  FILE *outfile = NULL;
+  struct OutputSink sink;
 
   FILE *framestats_file = NULL;
+#if CONFIG_THREAD_TRACE
+  FILE *trace_file = NULL;
+#endif
 
-  MD5Context md5_ctx;
   unsigned char md5_digest[16];
 
-  struct VpxDecInputContext input = { NULL, NULL };
+  struct VpxDecInputContext input = { NULL, NULL, NULL };
   struct VpxInputContext vpx_input_ctx;
+  struct IvfMappedFile ivf_map;
 #if CONFIG_WEBM_IO
   struct WebmInputContext webm_ctx;
   memset(&(webm_ctx), 0, sizeof(webm_ctx));
@@ -660,6 +894,17 @@ static int main_loop(int argc, const char **argv_) {
     } else if (arg_match(&arg, &lpfoptarg, argi)) {
       enable_lpf_opt = arg_parse_uint(&arg);
     }
+#if CONFIG_THREAD_TRACE
+    else if (arg_match(&arg, &tracefilearg, argi)) {
+      trace_file = fopen(arg.val, "w");
+      if (!trace_file) {
+        die("Error: Could not open --trace-file file (%s) for writing.\n",
+            arg.val);
+      }
+      vpx_trace_reset();
+      vpx_trace_enable(1);
+    }
+#endif
 #if CONFIG_VP8_DECODER
     else if (arg_match(&arg, &addnoise_level, argi)) {
       postproc = 1;
@@ -712,8 +957,10 @@ static int main_loop(int argc, const char **argv_) {
   }
 #endif
   input.vpx_input_ctx->file = infile;
-  if (file_is_ivf(input.vpx_input_ctx))
+  if (file_is_ivf(input.vpx_input_ctx)) {
     input.vpx_input_ctx->file_type = FILE_TYPE_IVF;
+    if (!ivf_map_file(&ivf_map, infile)) input.ivf_map = &ivf_map;
+  }
 #if CONFIG_WEBM_IO
   else if (file_is_webm(input.webm_ctx, input.vpx_input_ctx))
     input.vpx_input_ctx->file_type = FILE_TYPE_WEBM;
@@ -732,13 +979,30 @@ static int main_loop(int argc, const char **argv_) {
   outfile_pattern = outfile_pattern ? outfile_pattern : "-";
   single_file = is_single_file(outfile_pattern);
 
+  memset(&sink, 0, sizeof(sink));
+  sink.flipuv = flipuv;
+  sink.do_scale = do_scale;
+  sink.do_md5 = do_md5;
+  sink.single_file = single_file;
+  sink.use_y4m = use_y4m;
+  sink.opt_i420 = opt_i420;
+  sink.opt_yv12 = opt_yv12;
+#if CONFIG_VP9_HIGHBITDEPTH
+  sink.output_bit_depth = output_bit_depth;
+#endif
+  sink.outfile_pattern = outfile_pattern;
+  sink.vpx_input_ctx = &vpx_input_ctx;
+  tool_worker_init(&sink.worker);
+  sink.worker.hook = output_frame;
+  sink.worker.data1 = &sink;
+
   if (!noblit && single_file) {
-    generate_filename(outfile_pattern, outfile_name, PATH_MAX,
+    generate_filename(outfile_pattern, sink.outfile_name, PATH_MAX,
                       vpx_input_ctx.width, vpx_input_ctx.height, 0);
     if (do_md5)
-      MD5Init(&md5_ctx);
+      MD5Init(&sink.md5_ctx);
     else
-      outfile = open_outfile(outfile_name);
+      sink.outfile = open_outfile(sink.outfile_name);
   }
 
   if (use_y4m && !noblit) {
@@ -809,11 +1073,26 @@ static int main_loop(int argc, const char **argv_) {
 #endif
 
   if (arg_skip) fprintf(stderr, "Skipping first %d frames.\n", arg_skip);
+  if (input.ivf_map) {
+    ivf_map_seek(input.ivf_map, arg_skip);
+    arg_skip = 0;
+  }
   while (arg_skip) {
-    if (dec_read_frame(&input, &buf, &bytes_in_buffer, &buffer_size)) break;
+    if (dec_read_frame(&input, &buf, &bytes_in_buffer, &buffer_size, &frame))
+      break;
     arg_skip--;
   }
 
+  // Give the output sink its own frame buffers, so that it can hold on to a
+  // frame while the next one is decoded.
+  if (!noblit && !num_external_frame_buffers &&
+      interface->fourcc == VP9_FOURCC &&
+      tool_worker_start(&sink.worker)) {
+    sink.hold_frames = 1;
+    num_external_frame_buffers =
+        VP9_MAXIMUM_REF_BUFFERS + VPX_MAXIMUM_WORK_BUFFERS + 1;
+  }
+
   if (num_external_frame_buffers > 0) {
     ext_fb_list.num_external_frame_buffers = num_external_frame_buffers;
     ext_fb_list.ext_fb = (struct ExternalFrameBuffer *)calloc(
@@ -845,14 +1124,15 @@ static int main_loop(int argc, const char **argv_) {
 
     frame_avail = 0;
     if (!stop_after || frame_in < stop_after) {
-      if (!dec_read_frame(&input, &buf, &bytes_in_buffer, &buffer_size)) {
+      if (!dec_read_frame(&input, &buf, &bytes_in_buffer, &buffer_size,
+                          &frame)) {
         frame_avail = 1;
         frame_in++;
 
         vpx_usec_timer_start(&timer);
 
-        if (vpx_codec_decode(&decoder, buf, (unsigned int)bytes_in_buffer, NULL,
-                             0)) {
+        if (vpx_codec_decode(&decoder, frame, (unsigned int)bytes_in_buffer,
+                             NULL, 0)) {
           const char *detail = vpx_codec_error_detail(&decoder);
           warn("Failed to decode frame %d: %s", frame_in,
                vpx_codec_error(&decoder));
@@ -910,162 +1190,34 @@ static int main_loop(int argc, const char **argv_) {
     if (progress) show_progress(frame_in, frame_out, dx_time);
 
     if (!noblit && img) {
-      const int PLANES_YUV[] = { VPX_PLANE_Y, VPX_PLANE_U, VPX_PLANE_V };
-      const int PLANES_YVU[] = { VPX_PLANE_Y, VPX_PLANE_V, VPX_PLANE_U };
-      const int *planes = flipuv ? PLANES_YVU : PLANES_YUV;
-
-      if (do_scale) {
-        if (frame_out == 1) {
-          // If the output frames are to be scaled to a fixed display size then
-          // use the width and height specified in the container. If either of
-          // these is set to 0, use the display size set in the first frame
-          // header. If that is unavailable, use the raw decoded size of the
-          // first decoded frame.
-          int render_width = vpx_input_ctx.width;
-          int render_height = vpx_input_ctx.height;
-          if (!render_width || !render_height) {
-            int render_size[2];
-            if (vpx_codec_control(&decoder, VP9D_GET_DISPLAY_SIZE,
-                                  render_size)) {
-              // As last resort use size of first frame as display size.
-              render_width = img->d_w;
-              render_height = img->d_h;
-            } else {
-              render_width = render_size[0];
-              render_height = render_size[1];
-            }
-          }
-          scaled_img =
-              vpx_img_alloc(NULL, img->fmt, render_width, render_height, 16);
-          if (!scaled_img) {
-            fprintf(stderr, "Failed to allocate scaled image (%d x %d)\n",
-                    render_width, render_height);
-            goto fail;
-          }
-          scaled_img->bit_depth = img->bit_depth;
-        }
-
-        if (img->d_w != scaled_img->d_w || img->d_h != scaled_img->d_h) {
-#if CONFIG_LIBYUV
-          libyuv_scale(img, scaled_img, kFilterBox);
-          img = scaled_img;
-#else
-          fprintf(stderr,
-                  "Failed  to scale output frame: %s.\n"
-                  "Scaling is disabled in this configuration. "
-                  "To enable scaling, configure with --enable-libyuv\n",
-                  vpx_codec_error(&decoder));
-          goto fail;
-#endif
-        }
-      }
-#if CONFIG_VP9_HIGHBITDEPTH
-      // Default to codec bit depth if output bit depth not set
-      if (!output_bit_depth && single_file && !do_md5) {
-        output_bit_depth = img->bit_depth;
-      }
-      // Shift up or down if necessary
-      if (output_bit_depth != 0 && output_bit_depth != img->bit_depth) {
-        const vpx_img_fmt_t shifted_fmt =
-            output_bit_depth == 8
-                ? img->fmt ^ (img->fmt & VPX_IMG_FMT_HIGHBITDEPTH)
-                : img->fmt | VPX_IMG_FMT_HIGHBITDEPTH;
-        if (img_shifted &&
-            img_shifted_realloc_required(img, img_shifted, shifted_fmt)) {
-          vpx_img_free(img_shifted);
-          img_shifted = NULL;
-        }
-        if (!img_shifted) {
-          img_shifted =
-              vpx_img_alloc(NULL, shifted_fmt, img->d_w, img->d_h, 16);
-          if (!img_shifted) {
-            fprintf(stderr, "Failed to allocate image\n");
-            goto fail;
-          }
-          img_shifted->bit_depth = output_bit_depth;
-        }
-        if (output_bit_depth > img->bit_depth) {
-          vpx_img_upshift(img_shifted, img, output_bit_depth - img->bit_depth);
-        } else {
-          vpx_img_downshift(img_shifted, img,
-                            img->bit_depth - output_bit_depth);
-        }
-        img = img_shifted;
-      }
-#endif
-
-      if (single_file) {
-        if (use_y4m) {
-          char y4m_buf[Y4M_BUFFER_SIZE] = { 0 };
-          size_t len = 0;
-          if (img->fmt == VPX_IMG_FMT_I440 || img->fmt == VPX_IMG_FMT_I44016) {
-            fprintf(stderr, "Cannot produce y4m output for 440 sampling.\n");
-            goto fail;
-          }
-          if (frame_out == 1) {
-            // Y4M file header
-            len = y4m_write_file_header(
-                y4m_buf, sizeof(y4m_buf), vpx_input_ctx.width,
-                vpx_input_ctx.height, &vpx_input_ctx.framerate, img->fmt,
-                img->bit_depth);
-            if (do_md5) {
-              MD5Update(&md5_ctx, (md5byte *)y4m_buf, (unsigned int)len);
-            } else {
-              fputs(y4m_buf, outfile);
-            }
-          }
-
-          // Y4M frame header
-          len = y4m_write_frame_header(y4m_buf, sizeof(y4m_buf));
-          if (do_md5) {
-            MD5Update(&md5_ctx, (md5byte *)y4m_buf, (unsigned int)len);
+      if (!output_sink_sync(&sink)) goto fail;
+      if (do_scale && frame_out == 1) {
+        // If the output frames are to be scaled to a fixed display size then
+        // use the width and height specified in the container. If either of
+        // these is set to 0, use the display size set in the first frame
+        // header. If that is unavailable, use the raw decoded size of the
+        // first decoded frame.
+        sink.render_width = vpx_input_ctx.width;
+        sink.render_height = vpx_input_ctx.height;
+        if (!sink.render_width || !sink.render_height) {
+          int render_size[2];
+          if (vpx_codec_control(&decoder, VP9D_GET_DISPLAY_SIZE,
+                                render_size)) {
+            // As last resort use size of first frame as display size.
+            sink.render_width = img->d_w;
+            sink.render_height = img->d_h;
           } else {
-            fputs(y4m_buf, outfile);
-          }
-        } else {
-          if (frame_out == 1) {
-            // Check if --yv12 or --i420 options are consistent with the
-            // bit-stream decoded
-            if (opt_i420) {
-              if (img->fmt != VPX_IMG_FMT_I420 &&
-                  img->fmt != VPX_IMG_FMT_I42016) {
-                fprintf(stderr, "Cannot produce i420 output for bit-stream.\n");
-                goto fail;
-              }
-            }
-            if (opt_yv12) {
-              if ((img->fmt != VPX_IMG_FMT_I420 &&
-                   img->fmt != VPX_IMG_FMT_YV12) ||
-                  img->bit_depth != 8) {
-                fprintf(stderr, "Cannot produce yv12 output for bit-stream.\n");
-                goto fail;
-              }
-            }
+            sink.render_width = render_size[0];
+            sink.render_height = render_size[1];
           }
         }
-
-        if (do_md5) {
-          update_image_md5(img, planes, &md5_ctx);
-        } else {
-          if (!corrupted) write_image_file(img, planes, outfile);
-        }
-      } else {
-        generate_filename(outfile_pattern, outfile_name, PATH_MAX, img->d_w,
-                          img->d_h, frame_in);
-        if (do_md5) {
-          MD5Init(&md5_ctx);
-          update_image_md5(img, planes, &md5_ctx);
-          MD5Final(md5_digest, &md5_ctx);
-          print_md5(md5_digest, outfile_name);
-        } else {
-          outfile = open_outfile(outfile_name);
-          write_image_file(img, planes, outfile);
-          fclose(outfile);
-        }
       }
+      output_sink_launch(&sink, img, frame_in, frame_out, corrupted);
     }
   }
 
+  if (!output_sink_sync(&sink)) goto fail;
+
   if (summary || progress) {
     show_progress(frame_in, frame_out, dx_time);
     fprintf(stderr, "\n");
@@ -1079,6 +1231,7 @@ static int main_loop(int argc, const char **argv_) {
 
 fail:
 
+  output_sink_sync(&sink);
   if (vpx_codec_destroy(&decoder)) {
     fprintf(stderr, "Failed to destroy decoder: %s\n",
             vpx_codec_error(&decoder));
@@ -1086,12 +1239,13 @@ fail:
 
 fail2:
 
+  tool_worker_end(&sink.worker);
   if (!noblit && single_file) {
     if (do_md5) {
-      MD5Final(md5_digest, &md5_ctx);
-      print_md5(md5_digest, outfile_name);
+      MD5Final(md5_digest, &sink.md5_ctx);
+      print_md5(md5_digest, sink.outfile_name);
     } else {
-      fclose(outfile);
+      fclose(sink.outfile);
     }
   }
 
@@ -1101,10 +1255,11 @@ fail2:
 #endif
 
   if (input.vpx_input_ctx->file_type != FILE_TYPE_WEBM) free(buf);
+  if (input.ivf_map) ivf_unmap_file(input.ivf_map);
 
-  if (scaled_img) vpx_img_free(scaled_img);
+  if (sink.scaled_img) vpx_img_free(sink.scaled_img);
 #if CONFIG_VP9_HIGHBITDEPTH
-  if (img_shifted) vpx_img_free(img_shifted);
+  if (sink.img_shifted) vpx_img_free(sink.img_shifted);
 #endif
 
   for (i = 0; i < ext_fb_list.num_external_frame_buffers; ++i) {
@@ -1114,6 +1269,14 @@ fail2:
 
   fclose(infile);
   if (framestats_file) fclose(framestats_file);
+#if CONFIG_THREAD_TRACE
+  if (trace_file) {
+    vpx_trace_enable(0);
+    if (vpx_trace_write_json(trace_file))
+      warn("Failed to write --trace-file output.\n");
+    fclose(trace_file);
+  }
+#endif
 
   free(argv);
 
@@ -40,9 +40,12 @@
 #endif
 
 #include "vpx/vpx_integer.h"
+#include "vpx/vpx_kernel_stats.h"
+#include "vpx/vpx_trace.h"
 #include "vpx_ports/mem_ops.h"
 #include "vpx_ports/vpx_timer.h"
 #include "./rate_hist.h"
+#include "./tool_worker.h"
 #include "./vpxstats.h"
 #include "./warnings.h"
 #if CONFIG_WEBM_IO
@@ -161,6 +164,14 @@ static const arg_def_t disable_warnings =
 static const arg_def_t disable_warning_prompt =
     ARG_DEF("y", "disable-warning-prompt", 0,
             "Display warnings, but do not prompt user to continue.");
+#if CONFIG_THREAD_TRACE
+static const arg_def_t tracefilearg = ARG_DEF(
+    NULL, "trace-file", 1, "Output thread events (chrome://tracing format)");
+#endif
+#if CONFIG_KERNEL_STATS
+static const arg_def_t kernelstatsarg =
+    ARG_DEF(NULL, "kernel-stats", 0, "Show calls and ticks per DSP kernel");
+#endif
 
 #if CONFIG_VP9_HIGHBITDEPTH
 static const arg_def_t test16bitinternalarg = ARG_DEF(
@@ -191,6 +202,12 @@ static const arg_def_t *main_args[] = { &help,
                                         &disable_warnings,
                                         &disable_warning_prompt,
                                         &recontest,
+#if CONFIG_THREAD_TRACE
+                                        &tracefilearg,
+#endif
+#if CONFIG_KERNEL_STATS
+                                        &kernelstatsarg,
+#endif
                                         NULL };
 
 static const arg_def_t usage =
@@ -534,6 +551,21 @@ static const arg_def_t disable_loopfilter =
             "1: Loopfilter off for non reference frames\n"
             "                                          "
             "2: Loopfilter off for all frames");
+
+static const arg_def_t frame_time_budget =
+    ARG_DEF(NULL, "frame-time-budget", 1,
+            "Encode time budget per frame in usec, raises the speed above "
+            "cpu-used as needed (0: off)");
+
+static const arg_def_t pyramid_motion_search =
+    ARG_DEF(NULL, "pyramid-motion-search", 1,
+            "Search fast motion on a 1/4 resolution pyramid in good quality "
+            "mode (0: off (default), 1: on)");
+
+static const arg_def_t hash_motion_search =
+    ARG_DEF(NULL, "hash-motion-search", 1,
+            "Look up exact matches of blocks in the previous source in "
+            "real-time mode, for screen content (0: off (default), 1: on)");
 #endif
 
 #if CONFIG_VP9_ENCODER
@@ -566,6 +598,9 @@ static const arg_def_t *vp9_args[] = { &cpu_used_vp9,
                                        &target_level,
                                        &row_mt,
                                        &disable_loopfilter,
+                                       &frame_time_budget,
+                                       &pyramid_motion_search,
+                                       &hash_motion_search,
 // NOTE: The entries above have a corresponding entry in vp9_arg_ctrl_map. The
 // entries below do not have a corresponding entry in vp9_arg_ctrl_map. They
 // must be listed at the end of vp9_args.
@@ -603,6 +638,9 @@ static const int vp9_arg_ctrl_map[] = { VP8E_SET_CPUUSED,
                                         VP9E_SET_TARGET_LEVEL,
                                         VP9E_SET_ROW_MT,
                                         VP9E_SET_DISABLE_LOOPFILTER,
+                                        VP9E_SET_FRAME_TIME_BUDGET,
+                                        VP9E_SET_PYRAMID_MOTION_SEARCH,
+                                        VP9E_SET_HASH_MOTION_SEARCH,
                                         0 };
 #endif
 
@@ -690,6 +728,16 @@ struct stream_config {
 #endif
 };
 
+/* Copies of the frame packets of one encode call, waiting to be written */
+struct output_packets {
+  vpx_codec_cx_pkt_t *pkts;
+  int count;
+  int capacity;
+  uint8_t *data;
+  size_t data_sz;
+  size_t data_capacity;
+};
+
 struct stream_state {
   int index;
   struct stream_state *next;
@@ -710,6 +758,11 @@ struct stream_state {
   struct vpx_image *img;
   vpx_codec_ctx_t decoder;
   int mismatch_seen;
+  ToolWorker writer;
+  struct output_packets output[2];
+  int output_index;
+  FileOffset ivf_header_pos;
+  size_t ivf_frame_size;
 };
 
 static void validate_positive_rational(const char *msg,
@@ -809,6 +862,14 @@ static void parse_global_config(struct VpxEncoderConfig *global, char **argv) {
       global->disable_warnings = 1;
     else if (arg_match(&arg, &disable_warning_prompt, argi))
       global->disable_warning_prompt = 1;
+#if CONFIG_THREAD_TRACE
+    else if (arg_match(&arg, &tracefilearg, argi))
+      global->trace_file = arg.val;
+#endif
+#if CONFIG_KERNEL_STATS
+    else if (arg_match(&arg, &kernelstatsarg, argi))
+      global->show_kernel_stats = 1;
+#endif
     else
       argj++;
   }
@@ -1290,14 +1351,27 @@ static void open_output_file(struct stream_state *stream,
   if (!stream->config.write_webm) {
     ivf_write_file_header(stream->file, cfg, global->codec->fourcc, 0);
   }
+
+  tool_worker_init(&stream->writer);
+  if (!tool_worker_start(&stream->writer))
+    fatal("Failed to create the output thread");
 }
 
 static void close_output_file(struct stream_state *stream,
                               unsigned int fourcc) {
   const struct vpx_codec_enc_cfg *const cfg = &stream->config.cfg;
+  int i;
 
   if (cfg->g_pass == VPX_RC_FIRST_PASS) return;
 
+  tool_worker_sync(&stream->writer);
+  tool_worker_end(&stream->writer);
+  for (i = 0; i < 2; ++i) {
+    free(stream->output[i].pkts);
+    free(stream->output[i].data);
+  }
+  memset(stream->output, 0, sizeof(stream->output));
+
 #if CONFIG_WEBM_IO
   if (stream->config.write_webm) {
     write_webm_file_footer(&stream->webm_ctx);
@@ -1471,6 +1545,94 @@ static void update_quantizer_histogram(struct stream_state *stream) {
   }
 }
 
+static int write_output_packets(void *arg1, void *arg2) {
+  struct stream_state *const stream = (struct stream_state *)arg1;
+  const struct output_packets *const output =
+      (const struct output_packets *)arg2;
+  int i;
+
+  for (i = 0; i < output->count; ++i) {
+    const vpx_codec_cx_pkt_t *const pkt = &output->pkts[i];
+#if CONFIG_WEBM_IO
+    if (stream->config.write_webm) {
+      write_webm_block(&stream->webm_ctx, &stream->config.cfg, pkt);
+    }
+#endif
+    if (!stream->config.write_webm) {
+      if (pkt->data.frame.partition_id <= 0) {
+        stream->ivf_header_pos = ftello(stream->file);
+        stream->ivf_frame_size = pkt->data.frame.sz;
+
+        ivf_write_frame_header(stream->file, pkt->data.frame.pts,
+                               stream->ivf_frame_size);
+      } else {
+        stream->ivf_frame_size += pkt->data.frame.sz;
+
+        if (!(pkt->data.frame.flags & VPX_FRAME_IS_FRAGMENT)) {
+          const FileOffset currpos = ftello(stream->file);
+          fseeko(stream->file, stream->ivf_header_pos, SEEK_SET);
+          ivf_write_frame_size(stream->file, stream->ivf_frame_size);
+          fseeko(stream->file, currpos, SEEK_SET);
+        }
+      }
+
+      (void)fwrite(pkt->data.frame.buf, 1, pkt->data.frame.sz, stream->file);
+    }
+  }
+  return 1;
+}
+
+/* Copies a frame packet, which is only valid until the next encode call, so
+ * that the writer thread can write it while the next frame is encoded.
+ */
+static void queue_output_packet(struct stream_state *stream,
+                                const vpx_codec_cx_pkt_t *pkt) {
+  struct output_packets *const output = &stream->output[stream->output_index];
+
+  if (output->count == output->capacity) {
+    const int capacity = output->capacity ? 2 * output->capacity : 8;
+    vpx_codec_cx_pkt_t *const pkts = (vpx_codec_cx_pkt_t *)realloc(
+        output->pkts, capacity * sizeof(*pkts));
+    if (!pkts) fatal("Failed to allocate output packets");
+    output->pkts = pkts;
+    output->capacity = capacity;
+  }
+  if (output->data_sz + pkt->data.frame.sz > output->data_capacity) {
+    const size_t capacity = 2 * (output->data_sz + pkt->data.frame.sz);
+    uint8_t *const data = (uint8_t *)realloc(output->data, capacity);
+    if (!data) fatal("Failed to allocate output buffer");
+    output->data = data;
+    output->data_capacity = capacity;
+  }
+  memcpy(output->data + output->data_sz, pkt->data.frame.buf,
+         pkt->data.frame.sz);
+  output->data_sz += pkt->data.frame.sz;
+  output->pkts[output->count++] = *pkt;
+}
+
+/* Waits for the previous packets to be written, then starts writing the
+ * queued ones on the writer thread.
+ */
+static void write_queued_packets(struct stream_state *stream) {
+  struct output_packets *const output = &stream->output[stream->output_index];
+  uint8_t *data = output->data;
+  int i;
+
+  tool_worker_sync(&stream->writer);
+  for (i = 0; i < output->count; ++i) {
+    output->pkts[i].data.frame.buf = data;
+    data += output->pkts[i].data.frame.sz;
+  }
+  stream->writer.hook = write_output_packets;
+  stream->writer.data1 = stream;
+  stream->writer.data2 = output;
+  tool_worker_launch(&stream->writer);
+
+  stream->output_index ^= 1;
+  stream->output[stream->output_index].count = 0;
+  stream->output[stream->output_index].data_sz = 0;
+}
+
 static void get_cx_data(struct stream_state *stream,
                         struct VpxEncoderConfig *global, int *got_data) {
   const vpx_codec_cx_pkt_t *pkt;
@@ -1479,9 +1641,6 @@ static void get_cx_data(struct stream_state *stream,
 
   *got_data = 0;
   while ((pkt = vpx_codec_get_cx_data(&stream->encoder, &iter))) {
-    static size_t fsize = 0;
-    static FileOffset ivf_header_pos = 0;
-
     switch (pkt->kind) {
       case VPX_CODEC_CX_FRAME_PKT:
         if (!(pkt->data.frame.flags & VPX_FRAME_IS_FRAGMENT)) {
@@ -1491,31 +1650,7 @@ static void get_cx_data(struct stream_state *stream,
           fprintf(stderr, " %6luF", (unsigned long)pkt->data.frame.sz);
 
         update_rate_histogram(stream->rate_hist, cfg, pkt);
-#if CONFIG_WEBM_IO
-        if (stream->config.write_webm) {
-          write_webm_block(&stream->webm_ctx, cfg, pkt);
-        }
-#endif
-        if (!stream->config.write_webm) {
-          if (pkt->data.frame.partition_id <= 0) {
-            ivf_header_pos = ftello(stream->file);
-            fsize = pkt->data.frame.sz;
-
-            ivf_write_frame_header(stream->file, pkt->data.frame.pts, fsize);
-          } else {
-            fsize += pkt->data.frame.sz;
-
-            if (!(pkt->data.frame.flags & VPX_FRAME_IS_FRAGMENT)) {
-              const FileOffset currpos = ftello(stream->file);
-              fseeko(stream->file, ivf_header_pos, SEEK_SET);
-              ivf_write_frame_size(stream->file, fsize);
-              fseeko(stream->file, currpos, SEEK_SET);
-            }
-          }
-
-          (void)fwrite(pkt->data.frame.buf, 1, pkt->data.frame.sz,
-                       stream->file);
-        }
+        queue_output_packet(stream, pkt);
         stream->nbytes += pkt->data.raw.sz;
 
         *got_data = 1;
@@ -1558,6 +1693,10 @@ static void get_cx_data(struct stream_state *stream,
       default: break;
     }
   }
+
+  if (stream->output[stream->output_index].count) {
+    write_queued_packets(stream);
+  }
 }
 
 static void show_psnr(struct stream_state *stream, double peak) {
@@ -1678,9 +1817,100 @@ static void print_time(const char *label, int64_t etl) {
   }
 }
 
+/* Reads the next input frame on a worker thread while the current one is
+ * encoded. Frames alternate between two images. The worker owns the input
+ * file, so it also records the file position after each frame for the
+ * progress estimate.
+ */
+struct input_reader {
+  ToolWorker worker;
+  struct VpxInputContext *input;
+  vpx_image_t img[2];
+  unsigned char *y4m_buf[2];
+  int frame_avail[2];
+  int64_t file_pos[2];
+  int64_t bytes_read;
+  int slot;
+};
+
+static int read_frame_hook(void *arg1, void *arg2) {
+  struct input_reader *const reader = (struct input_reader *)arg1;
+  const int slot = reader->slot;
+  (void)arg2;
+
+  if (reader->input->file_type == FILE_TYPE_Y4M)
+    reader->input->y4m.dst_buf = reader->y4m_buf[slot];
+  reader->frame_avail[slot] = read_frame(reader->input, &reader->img[slot]);
+  reader->file_pos[slot] = ftello(reader->input->file);
+  return 1;
+}
+
+static void input_reader_start(struct input_reader *reader,
+                               struct VpxInputContext *input) {
+  memset(reader, 0, sizeof(*reader));
+  reader->input = input;
+  if (input->file_type == FILE_TYPE_Y4M) {
+    // The Y4M reader does its own allocation. Give it a second frame buffer
+    // to fill while the frame in the first one is encoded.
+    const size_t frame_buf_sz = input->y4m.bit_depth == 8
+                                    ? input->y4m.dst_buf_sz
+                                    : 2 * input->y4m.dst_buf_sz;
+    reader->y4m_buf[0] = input->y4m.dst_buf;
+    reader->y4m_buf[1] = (unsigned char *)malloc(frame_buf_sz);
+    if (!reader->y4m_buf[1]) fatal("Failed to allocate frame buffer");
+  } else {
+    if (!vpx_img_alloc(&reader->img[0], input->fmt, input->width,
+                       input->height, 32) ||
+        !vpx_img_alloc(&reader->img[1], input->fmt, input->width,
+                       input->height, 32)) {
+      fatal("Failed to allocate image");
+    }
+  }
+
+  tool_worker_init(&reader->worker);
+  if (!tool_worker_start(&reader->worker))
+    fatal("Failed to create the input thread");
+  reader->worker.hook = read_frame_hook;
+  reader->worker.data1 = reader;
+  tool_worker_launch(&reader->worker);
+}
+
+/* Returns the frame read ahead, or NULL at the end of the input. The next
+ * frame is read while this one is encoded if |read_ahead| is set. The input
+ * bytes consumed up to and including the returned frame are left in
+ * |bytes_read|.
+ */
+static vpx_image_t *input_reader_next(struct input_reader *reader,
+                                      int read_ahead) {
+  const int slot = reader->slot;
+
+  tool_worker_sync(&reader->worker);
+  if (!reader->frame_avail[slot]) return NULL;
+  reader->bytes_read = reader->file_pos[slot];
+  reader->slot ^= 1;
+  if (read_ahead)
+    tool_worker_launch(&reader->worker);
+  else
+    reader->frame_avail[reader->slot] = 0;
+  return &reader->img[slot];
+}
+
+static void input_reader_stop(struct input_reader *reader) {
+  tool_worker_sync(&reader->worker);
+  tool_worker_end(&reader->worker);
+  if (reader->input->file_type == FILE_TYPE_Y4M) {
+    reader->input->y4m.dst_buf = reader->y4m_buf[0];
+    free(reader->y4m_buf[1]);
+  } else {
+    vpx_img_free(&reader->img[0]);
+    vpx_img_free(&reader->img[1]);
+  }
+}
+
 int main(int argc, const char **argv_) {
   int pass;
-  vpx_image_t raw;
+  struct input_reader reader;
+  vpx_image_t *raw = NULL;
 #if CONFIG_VP9_HIGHBITDEPTH
   vpx_image_t raw_shift;
   int allocated_raw_shift = 0;
@@ -1698,7 +1928,6 @@ int main(int argc, const char **argv_) {
   int res = 0;
 
   memset(&input, 0, sizeof(input));
-  memset(&raw, 0, sizeof(raw));
   exec_name = argv_[0];
 
   /* Setup default input stream settings */
@@ -1720,6 +1949,13 @@ int main(int argc, const char **argv_) {
 
   if (argc < 3) usage_exit();
 
+#if CONFIG_THREAD_TRACE
+  if (global.trace_file) {
+    vpx_trace_reset();
+    vpx_trace_enable(1);
+  }
+#endif
+
   switch (global.color_type) {
     case I420: input.fmt = VPX_IMG_FMT_I420; break;
     case I422: input.fmt = VPX_IMG_FMT_I422; break;
@@ -1848,10 +2084,6 @@ int main(int argc, const char **argv_) {
       FOREACH_STREAM(show_stream_config(stream, &global, &input));
 
     if (pass == (global.pass ? global.pass - 1 : 0)) {
-      // The Y4M reader does its own allocation.
-      if (input.file_type != FILE_TYPE_Y4M) {
-        vpx_img_alloc(&raw, input.fmt, input.width, input.height, 32);
-      }
       FOREACH_STREAM(stream->rate_hist = init_rate_histogram(
                          &stream->config.cfg, &global.framerate));
     }
@@ -1880,6 +2112,7 @@ int main(int argc, const char **argv_) {
     }
 #endif
 
+    input_reader_start(&reader, &input);
     frame_avail = 1;
     got_data = 0;
 
@@ -1887,7 +2120,9 @@ int main(int argc, const char **argv_) {
       struct vpx_usec_timer timer;
 
       if (!global.limit || frames_in < global.limit) {
-        frame_avail = read_frame(&input, &raw);
+        raw = input_reader_next(&reader,
+                                !global.limit || frames_in + 1 < global.limit);
+        frame_avail = raw != NULL;
 
         if (frame_avail) frames_in++;
         seen_frames =
@@ -1916,39 +2151,40 @@ int main(int argc, const char **argv_) {
       if (frames_in > global.skip_frames) {
 #if CONFIG_VP9_HIGHBITDEPTH
         vpx_image_t *frame_to_encode;
-        if (input_shift || (use_16bit_internal && input.bit_depth == 8)) {
+        if (frame_avail &&
+            (input_shift || (use_16bit_internal && input.bit_depth == 8))) {
           assert(use_16bit_internal);
           // Input bit depth and stream bit depth do not match, so up
           // shift frame to stream bit depth
           if (!allocated_raw_shift) {
-            vpx_img_alloc(&raw_shift, raw.fmt | VPX_IMG_FMT_HIGHBITDEPTH,
+            vpx_img_alloc(&raw_shift, raw->fmt | VPX_IMG_FMT_HIGHBITDEPTH,
                           input.width, input.height, 32);
             allocated_raw_shift = 1;
           }
-          vpx_img_upshift(&raw_shift, &raw, input_shift);
+          vpx_img_upshift(&raw_shift, raw, input_shift);
           frame_to_encode = &raw_shift;
         } else {
-          frame_to_encode = &raw;
+          frame_to_encode = frame_avail ? raw : NULL;
         }
         vpx_usec_timer_start(&timer);
         if (use_16bit_internal) {
-          assert(frame_to_encode->fmt & VPX_IMG_FMT_HIGHBITDEPTH);
+          assert(!frame_to_encode ||
+                 (frame_to_encode->fmt & VPX_IMG_FMT_HIGHBITDEPTH));
           FOREACH_STREAM({
             if (stream->config.use_16bit_internal)
-              encode_frame(stream, &global,
-                           frame_avail ? frame_to_encode : NULL, frames_in);
+              encode_frame(stream, &global, frame_to_encode, frames_in);
             else
               assert(0);
           });
         } else {
-          assert((frame_to_encode->fmt & VPX_IMG_FMT_HIGHBITDEPTH) == 0);
-          FOREACH_STREAM(encode_frame(stream, &global,
-                                      frame_avail ? frame_to_encode : NULL,
-                                      frames_in));
+          assert(!frame_to_encode ||
+                 (frame_to_encode->fmt & VPX_IMG_FMT_HIGHBITDEPTH) == 0);
+          FOREACH_STREAM(
+              encode_frame(stream, &global, frame_to_encode, frames_in));
         }
 #else
         vpx_usec_timer_start(&timer);
-        FOREACH_STREAM(encode_frame(stream, &global, frame_avail ? &raw : NULL,
+        FOREACH_STREAM(encode_frame(stream, &global, frame_avail ? raw : NULL,
                                     frames_in));
 #endif
         vpx_usec_timer_mark(&timer);
@@ -1961,7 +2197,7 @@ int main(int argc, const char **argv_) {
 
         if (!got_data && input.length && streams != NULL &&
             !streams->frames_out) {
-          lagged_count = global.limit ? seen_frames : ftello(input.file);
+          lagged_count = global.limit ? seen_frames : reader.bytes_read;
         } else if (input.length) {
           int64_t remaining;
           int64_t rate;
@@ -1973,7 +2209,7 @@ int main(int argc, const char **argv_) {
             remaining = 1000 * (global.limit - global.skip_frames -
                                 seen_frames + lagged_count);
           } else {
-            const int64_t input_pos = ftello(input.file);
+            const int64_t input_pos = reader.bytes_read;
             const int64_t input_pos_lagged = input_pos - lagged_count;
 
             rate = cx_time ? input_pos_lagged * (int64_t)1000000 / cx_time : 0;
@@ -2027,6 +2263,7 @@ int main(int argc, const char **argv_) {
       FOREACH_STREAM(vpx_codec_destroy(&stream->decoder));
     }
 
+    input_reader_stop(&reader);
     close_input_file(&input);
 
     if (global.test_decode == TEST_DECODE_FATAL) {
@@ -2068,7 +2305,20 @@ int main(int argc, const char **argv_) {
 #if CONFIG_VP9_HIGHBITDEPTH
   if (allocated_raw_shift) vpx_img_free(&raw_shift);
 #endif
-  vpx_img_free(&raw);
+#if CONFIG_KERNEL_STATS
+  if (global.show_kernel_stats) vpx_kernel_stats_dump(stderr);
+#endif
+
+#if CONFIG_THREAD_TRACE
+  if (global.trace_file) {
+    FILE *const f = fopen(global.trace_file, "w");
+    vpx_trace_enable(0);
+    if (!f || vpx_trace_write_json(f))
+      warn("Failed to write --trace-file %s\n", global.trace_file);
+    if (f) fclose(f);
+  }
+#endif
+
   free(argv);
   free(streams);
   return res ? EXIT_FAILURE : EXIT_SUCCESS;
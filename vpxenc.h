@@ -56,6 +56,8 @@ struct VpxEncoderConfig {
   int disable_warnings;
   int disable_warning_prompt;
   int experimental_bitstream;
+  const char *trace_file;
+  int show_kernel_stats;
 };
 
 #ifdef __cplusplus
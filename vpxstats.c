@@ -13,12 +13,16 @@
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#endif
 
 #include "./tools_common.h"
 
 int stats_open_file(stats_io_t *stats, const char *fpf, int pass) {
   int res;
   stats->pass = pass;
+  stats->buf_mapped = 0;
 
   if (pass == 0) {
     stats->file = fopen(fpf, "wb");
@@ -38,6 +42,22 @@ int stats_open_file(stats_io_t *stats, const char *fpf, int pass) {
     stats->buf.sz = stats->buf_alloc_sz = ftell(stats->file);
     rewind(stats->file);
 
+#if !defined(_WIN32)
+    // Map the stats rather than reading them into the heap. The encoder reads
+    // them in place, so only the pages it touches become resident and, being
+    // backed by the file, the kernel can drop them again. This keeps the
+    // memory use of long two-pass encodes bounded.
+    if (stats->buf.sz > 0) {
+      void *const data = mmap(NULL, stats->buf.sz, PROT_READ, MAP_PRIVATE,
+                              fileno(stats->file), 0);
+      if (data != MAP_FAILED) {
+        stats->buf.buf = data;
+        stats->buf_mapped = 1;
+        return 1;
+      }
+    }
+#endif
+
     stats->buf.buf = malloc(stats->buf_alloc_sz);
 
     if (!stats->buf.buf)
@@ -54,6 +74,7 @@ int stats_open_file(stats_io_t *stats, const char *fpf, int pass) {
 int stats_open_mem(stats_io_t *stats, int pass) {
   int res;
   stats->pass = pass;
+  stats->buf_mapped = 0;
 
   if (!pass) {
     stats->buf.sz = 0;
@@ -69,7 +90,13 @@ int stats_open_mem(stats_io_t *stats, int pass) {
 void stats_close(stats_io_t *stats, int last_pass) {
   if (stats->file) {
     if (stats->pass == last_pass) {
-      free(stats->buf.buf);
+      if (stats->buf_mapped) {
+#if !defined(_WIN32)
+        munmap(stats->buf.buf, stats->buf.sz);
+#endif
+      } else {
+        free(stats->buf.buf);
+      }
     }
 
     fclose(stats->file);
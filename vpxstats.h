@@ -28,6 +28,7 @@ typedef struct {
   FILE *file;
   char *buf_ptr;
   size_t buf_alloc_sz;
+  int buf_mapped;
 } stats_io_t;
 
 int stats_open_file(stats_io_t *stats, const char *fpf, int pass);
@@ -12,12 +12,62 @@
 
 #include <cstring>
 #include <cstdio>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 #include "third_party/libwebm/mkvparser/mkvparser.h"
 #include "third_party/libwebm/mkvparser/mkvreader.h"
 
 namespace {
 
+#if !defined(_WIN32)
+// Serves the parser from a read only mapping of the input file, so that
+// frames can be returned without reading them into a buffer.
+class MappedMkvReader : public mkvparser::MkvReader {
+ public:
+  MappedMkvReader(FILE *file, const uint8_t *data, long long size)
+      : mkvparser::MkvReader(file), data_(data), size_(size) {}
+
+  ~MappedMkvReader() override {
+    munmap(const_cast<uint8_t *>(data_), static_cast<size_t>(size_));
+  }
+
+  int Read(long long pos, long len, unsigned char *buf) override {
+    if (pos < 0 || len < 0) return -1;
+    if (len == 0) return 0;
+    if (pos >= size_ || len > size_ - pos) return -1;
+    memcpy(buf, data_ + pos, static_cast<size_t>(len));
+    return 0;
+  }
+
+ private:
+  const uint8_t *const data_;
+  const long long size_;
+};
+#endif
+
+// Maps |file| when it is a regular file and falls back to reading it.
+mkvparser::MkvReader *create_reader(FILE *file,
+                                    struct WebmInputContext *const webm_ctx) {
+#if !defined(_WIN32)
+  struct stat st;
+  if (!fstat(fileno(file), &st) && S_ISREG(st.st_mode) && st.st_size > 0 &&
+      static_cast<unsigned long long>(st.st_size) <= SIZE_MAX) {
+    void *const data = mmap(nullptr, static_cast<size_t>(st.st_size),
+                            PROT_READ, MAP_PRIVATE, fileno(file), 0);
+    if (data != MAP_FAILED) {
+      webm_ctx->mapped_data = static_cast<const uint8_t *>(data);
+      webm_ctx->mapped_size = static_cast<int64_t>(st.st_size);
+      return new MappedMkvReader(file, webm_ctx->mapped_data,
+                                 webm_ctx->mapped_size);
+    }
+  }
+#endif
+  return new mkvparser::MkvReader(file);
+}
+
 void reset(struct WebmInputContext *const webm_ctx) {
   if (webm_ctx->reader != nullptr) {
     mkvparser::MkvReader *const reader =
@@ -35,6 +85,9 @@ void reset(struct WebmInputContext *const webm_ctx) {
   webm_ctx->reader = nullptr;
   webm_ctx->segment = nullptr;
   webm_ctx->buffer = nullptr;
+  webm_ctx->buffer_size = 0;
+  webm_ctx->mapped_data = nullptr;
+  webm_ctx->mapped_size = 0;
   webm_ctx->cluster = nullptr;
   webm_ctx->block_entry = nullptr;
   webm_ctx->block = nullptr;
@@ -61,7 +114,7 @@ void rewind_and_reset(struct WebmInputContext *const webm_ctx,
 
 int file_is_webm(struct WebmInputContext *webm_ctx,
                  struct VpxInputContext *vpx_ctx) {
-  mkvparser::MkvReader *const reader = new mkvparser::MkvReader(vpx_ctx->file);
+  mkvparser::MkvReader *const reader = create_reader(vpx_ctx->file, webm_ctx);
   webm_ctx->reader = reader;
   webm_ctx->reached_eos = 0;
 
@@ -118,8 +171,12 @@ int file_is_webm(struct WebmInputContext *webm_ctx,
   return 1;
 }
 
-int webm_read_frame(struct WebmInputContext *webm_ctx, uint8_t **buffer,
-                    size_t *buffer_size) {
+namespace {
+
+// Advances to the next frame of the video track. Returns 0 and sets |*frame|
+// on success, 1 at the end of the stream and -1 on error.
+int next_frame(struct WebmInputContext *webm_ctx,
+               const mkvparser::Block::Frame **frame) {
   // This check is needed for frame parallel decoding, in which case this
   // function could be called even after it has reached end of input stream.
   if (webm_ctx->reached_eos) {
@@ -143,7 +200,6 @@ int webm_read_frame(struct WebmInputContext *webm_ctx, uint8_t **buffer,
     } else if (block_entry_eos || block_entry->EOS()) {
       cluster = segment->GetNext(cluster);
       if (cluster == nullptr || cluster->EOS()) {
-        *buffer_size = 0;
         webm_ctx->reached_eos = 1;
         return 1;
       }
@@ -175,9 +231,24 @@ int webm_read_frame(struct WebmInputContext *webm_ctx, uint8_t **buffer,
   webm_ctx->block_entry = block_entry;
   webm_ctx->block = block;
 
-  const mkvparser::Block::Frame &frame =
-      block->GetFrame(webm_ctx->block_frame_index);
+  *frame = &block->GetFrame(webm_ctx->block_frame_index);
   ++webm_ctx->block_frame_index;
+  webm_ctx->timestamp_ns = block->GetTime(cluster);
+  webm_ctx->is_key_frame = block->IsKey();
+  return 0;
+}
+
+}  // namespace
+
+int webm_read_frame(struct WebmInputContext *webm_ctx, uint8_t **buffer,
+                    size_t *buffer_size) {
+  const mkvparser::Block::Frame *frame_ptr;
+  const int status = next_frame(webm_ctx, &frame_ptr);
+  if (status) {
+    if (status == 1) *buffer_size = 0;
+    return status;
+  }
+  const mkvparser::Block::Frame &frame = *frame_ptr;
   if (frame.len > static_cast<long>(*buffer_size)) {
     delete[] * buffer;
     *buffer = new uint8_t[frame.len];
@@ -187,21 +258,48 @@ int webm_read_frame(struct WebmInputContext *webm_ctx, uint8_t **buffer,
     webm_ctx->buffer = *buffer;
   }
   *buffer_size = frame.len;
-  webm_ctx->timestamp_ns = block->GetTime(cluster);
-  webm_ctx->is_key_frame = block->IsKey();
 
   mkvparser::MkvReader *const reader =
       reinterpret_cast<mkvparser::MkvReader *>(webm_ctx->reader);
   return frame.Read(reader, *buffer) ? -1 : 0;
 }
 
+int webm_read_frame_ref(struct WebmInputContext *webm_ctx,
+                        const uint8_t **buffer, size_t *bytes_read) {
+  const mkvparser::Block::Frame *frame;
+  const int status = next_frame(webm_ctx, &frame);
+  if (status) {
+    if (status == 1) *bytes_read = 0;
+    return status;
+  }
+  if (webm_ctx->mapped_data != nullptr) {
+    if (frame->pos < 0 || frame->len < 0 ||
+        frame->pos > webm_ctx->mapped_size - frame->len) {
+      return -1;
+    }
+    *buffer = webm_ctx->mapped_data + frame->pos;
+    *bytes_read = frame->len;
+    return 0;
+  }
+  if (static_cast<size_t>(frame->len) > webm_ctx->buffer_size) {
+    delete[] webm_ctx->buffer;
+    webm_ctx->buffer = new uint8_t[frame->len];
+    webm_ctx->buffer_size = frame->len;
+  }
+  *buffer = webm_ctx->buffer;
+  *bytes_read = frame->len;
+
+  mkvparser::MkvReader *const reader =
+      reinterpret_cast<mkvparser::MkvReader *>(webm_ctx->reader);
+  return frame->Read(reader, webm_ctx->buffer) ? -1 : 0;
+}
+
 int webm_guess_framerate(struct WebmInputContext *webm_ctx,
                          struct VpxInputContext *vpx_ctx) {
   uint32_t i = 0;
-  uint8_t *buffer = nullptr;
-  size_t buffer_size = 0;
+  const mkvparser::Block::Frame *frame;
   while (webm_ctx->timestamp_ns < 1000000000 && i < 50) {
-    if (webm_read_frame(webm_ctx, &buffer, &buffer_size)) {
+    if (next_frame(webm_ctx, &frame)) {
       break;
     }
     ++i;
@@ -209,9 +307,6 @@ int webm_guess_framerate(struct WebmInputContext *webm_ctx,
   vpx_ctx->framerate.numerator = (i - 1) * 1000000;
   vpx_ctx->framerate.denominator =
       static_cast<int>(webm_ctx->timestamp_ns / 1000);
-  delete[] buffer;
-  // webm_ctx->buffer is assigned to the buffer pointer in webm_read_frame().
-  webm_ctx->buffer = nullptr;
 
   get_first_cluster(webm_ctx);
   webm_ctx->block = nullptr;
@@ -22,6 +22,9 @@ struct WebmInputContext {
   void *reader;
   void *segment;
   uint8_t *buffer;
+  size_t buffer_size;
+  const uint8_t *mapped_data;
+  int64_t mapped_size;
   const void *cluster;
   const void *block_entry;
   const void *block;
@@ -55,6 +58,12 @@ int file_is_webm(struct WebmInputContext *webm_ctx,
 int webm_read_frame(struct WebmInputContext *webm_ctx, uint8_t **buffer,
                     size_t *buffer_size);
 
+// Like webm_read_frame() but returns the frame in place when the input file
+// is mapped, and in a buffer owned by |webm_ctx| otherwise. |*buffer| stays
+// valid until the next call or webm_free().
+int webm_read_frame_ref(struct WebmInputContext *webm_ctx,
+                        const uint8_t **buffer, size_t *bytes_read);
+
 // Guesses the frame rate of the input file based on the container timestamps.
 int webm_guess_framerate(struct WebmInputContext *webm_ctx,
                          struct VpxInputContext *vpx_ctx);
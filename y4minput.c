@@ -15,6 +15,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "vpx/vpx_integer.h"
 #include "y4minput.h"
@@ -206,6 +209,86 @@ static int parse_tags(y4m_input *y4m_ctx, FILE *file) {
 #define OC_MAXI(_a, _b) ((_a) < (_b) ? (_b) : (_a))
 #define OC_CLAMPI(_a, _b, _c) (OC_MAXI(_a, OC_MINI(_b, _c)))
 
+/*The filters below work on whole rows at a time, so the inner loops walk
+   memory sequentially and can be vectorized.
+  This file is built into the tools without the run-time CPU detection of the
+   codec libraries, so SSE2 is used only when the compiler targets it anyway
+   (e.g., all x86-64 builds).*/
+
+/*Applies the 6-tap filter _taps, which sums to 128, to the pixels at the same
+   position in the rows _src[0] through _src[5] to produce a row of _w
+   pixels.*/
+static void y4m_filter_rows(unsigned char *_dst,
+                            const unsigned char *const _src[6],
+                            const int _taps[6], int _w) {
+  int x = 0;
+  int k;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i round = _mm_set1_epi32(64);
+  __m128i taps[3];
+  for (k = 0; k < 3; k++) {
+    taps[k] = _mm_set_epi16(_taps[2 * k + 1], _taps[2 * k], _taps[2 * k + 1],
+                            _taps[2 * k], _taps[2 * k + 1], _taps[2 * k],
+                            _taps[2 * k + 1], _taps[2 * k]);
+  }
+  for (; x + 8 <= _w; x += 8) {
+    __m128i lo = round;
+    __m128i hi = round;
+    for (k = 0; k < 3; k++) {
+      const __m128i a = _mm_unpacklo_epi8(
+          _mm_loadl_epi64((const __m128i *)(_src[2 * k] + x)), zero);
+      const __m128i b = _mm_unpacklo_epi8(
+          _mm_loadl_epi64((const __m128i *)(_src[2 * k + 1] + x)), zero);
+      lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), taps[k]));
+      hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), taps[k]));
+    }
+    lo = _mm_packs_epi32(_mm_srai_epi32(lo, 7), _mm_srai_epi32(hi, 7));
+    _mm_storel_epi64((__m128i *)(_dst + x), _mm_packus_epi16(lo, lo));
+  }
+#endif
+  for (; x < _w; x++) {
+    int sum = 64;
+    for (k = 0; k < 6; k++) sum += _taps[k] * _src[k][x];
+    _dst[x] = (unsigned char)OC_CLAMPI(0, sum >> 7, 255);
+  }
+}
+
+/*Applies the 6-tap filter _taps, whose first tap sits _offset pixels to the
+   left, to the pixels _x0 through _x1 - 1 of a row of _w pixels, replicating
+   the pixels at the edges of the row.*/
+static void y4m_filter_edges(unsigned char *_dst, const unsigned char *_src,
+                             const int _taps[6], int _offset, int _x0,
+                             int _x1, int _w) {
+  int x;
+  int k;
+  for (x = _x0; x < _x1; x++) {
+    int sum = 64;
+    for (k = 0; k < 6; k++) {
+      sum += _taps[k] * _src[OC_CLAMPI(0, x + k - _offset, _w - 1)];
+    }
+    _dst[x] = (unsigned char)OC_CLAMPI(0, sum >> 7, 255);
+  }
+}
+
+/*Filters the rows of the _w by _h plane _src with the 6-tap filter _taps,
+   whose first tap sits _offset rows above, keeping every _step'th row,
+   replicating the rows at the edges of the plane.*/
+static void y4m_filter_plane_v(unsigned char *_dst, const unsigned char *_src,
+                               const int _taps[6], int _offset, int _step,
+                               int _w, int _h) {
+  const unsigned char *rows[6];
+  int y;
+  int k;
+  for (y = 0; y < _h; y += _step) {
+    for (k = 0; k < 6; k++) {
+      rows[k] = _src + OC_CLAMPI(0, y + k - _offset, _h - 1) * _w;
+    }
+    y4m_filter_rows(_dst, rows, _taps, _w);
+    _dst += _w;
+  }
+}
+
 /*420jpeg chroma samples are sited like:
   Y-------Y-------Y-------Y-------
   |       |       |       |
@@ -250,38 +333,23 @@ static int parse_tags(y4m_input *y4m_ctx, FILE *file) {
 static void y4m_42xmpeg2_42xjpeg_helper(unsigned char *_dst,
                                         const unsigned char *_src, int _c_w,
                                         int _c_h) {
+  /*Filter: [4 -17 114 35 -9 1]/128, derived from a 6-tap Lanczos window.*/
+  static const int TAPS[6] = { 4, -17, 114, 35, -9, 1 };
+  const unsigned char *taps_src[6];
+  int x0;
+  int x1;
   int y;
-  int x;
+  int k;
+  /*Pixels [x0, x1) have all of their taps inside the row.*/
+  x0 = OC_MINI(_c_w, 2);
+  x1 = OC_MAXI(x0, _c_w - 3);
   for (y = 0; y < _c_h; y++) {
-    /*Filter: [4 -17 114 35 -9 1]/128, derived from a 6-tap Lanczos
-       window.*/
-    for (x = 0; x < OC_MINI(_c_w, 2); x++) {
-      _dst[x] = (unsigned char)OC_CLAMPI(
-          0,
-          (4 * _src[0] - 17 * _src[OC_MAXI(x - 1, 0)] + 114 * _src[x] +
-           35 * _src[OC_MINI(x + 1, _c_w - 1)] -
-           9 * _src[OC_MINI(x + 2, _c_w - 1)] + _src[OC_MINI(x + 3, _c_w - 1)] +
-           64) >>
-              7,
-          255);
-    }
-    for (; x < _c_w - 3; x++) {
-      _dst[x] = (unsigned char)OC_CLAMPI(
-          0,
-          (4 * _src[x - 2] - 17 * _src[x - 1] + 114 * _src[x] +
-           35 * _src[x + 1] - 9 * _src[x + 2] + _src[x + 3] + 64) >>
-              7,
-          255);
-    }
-    for (; x < _c_w; x++) {
-      _dst[x] = (unsigned char)OC_CLAMPI(
-          0,
-          (4 * _src[x - 2] - 17 * _src[x - 1] + 114 * _src[x] +
-           35 * _src[OC_MINI(x + 1, _c_w - 1)] -
-           9 * _src[OC_MINI(x + 2, _c_w - 1)] + _src[_c_w - 1] + 64) >>
-              7,
-          255);
+    y4m_filter_edges(_dst, _src, TAPS, 2, 0, x0, _c_w);
+    if (x1 > x0) {
+      for (k = 0; k < 6; k++) taps_src[k] = _src + x0 - 2 + k;
+      y4m_filter_rows(_dst + x0, taps_src, TAPS, x1 - x0);
     }
+    y4m_filter_edges(_dst, _src, TAPS, 2, x1, _c_w, _c_w);
     _dst += _c_w;
     _src += _c_w;
   }
@@ -337,8 +405,6 @@ static void y4m_convert_42xpaldv_42xjpeg(y4m_input *_y4m, unsigned char *_dst,
   int c_h;
   int c_sz;
   int pli;
-  int y;
-  int x;
   /*Skip past the luma data.*/
   _dst += _y4m->pic_w * _y4m->pic_h;
   /*Compute the size of each chroma plane.*/
@@ -356,79 +422,16 @@ static void y4m_convert_42xpaldv_42xjpeg(y4m_input *_y4m, unsigned char *_dst,
       case 1: {
         /*Slide C_b up a quarter-pel.
           This is the same filter used above, but in the other order.*/
-        for (x = 0; x < c_w; x++) {
-          for (y = 0; y < OC_MINI(c_h, 3); y++) {
-            _dst[y * c_w] = (unsigned char)OC_CLAMPI(
-                0,
-                (tmp[0] - 9 * tmp[OC_MAXI(y - 2, 0) * c_w] +
-                 35 * tmp[OC_MAXI(y - 1, 0) * c_w] + 114 * tmp[y * c_w] -
-                 17 * tmp[OC_MINI(y + 1, c_h - 1) * c_w] +
-                 4 * tmp[OC_MINI(y + 2, c_h - 1) * c_w] + 64) >>
-                    7,
-                255);
-          }
-          for (; y < c_h - 2; y++) {
-            _dst[y * c_w] = (unsigned char)OC_CLAMPI(
-                0,
-                (tmp[(y - 3) * c_w] - 9 * tmp[(y - 2) * c_w] +
-                 35 * tmp[(y - 1) * c_w] + 114 * tmp[y * c_w] -
-                 17 * tmp[(y + 1) * c_w] + 4 * tmp[(y + 2) * c_w] + 64) >>
-                    7,
-                255);
-          }
-          for (; y < c_h; y++) {
-            _dst[y * c_w] = (unsigned char)OC_CLAMPI(
-                0,
-                (tmp[(y - 3) * c_w] - 9 * tmp[(y - 2) * c_w] +
-                 35 * tmp[(y - 1) * c_w] + 114 * tmp[y * c_w] -
-                 17 * tmp[OC_MINI(y + 1, c_h - 1) * c_w] +
-                 4 * tmp[(c_h - 1) * c_w] + 64) >>
-                    7,
-                255);
-          }
-          _dst++;
-          tmp++;
-        }
-        _dst += c_sz - c_w;
-        tmp -= c_w;
+        static const int TAPS_UP[6] = { 1, -9, 35, 114, -17, 4 };
+        y4m_filter_plane_v(_dst, tmp, TAPS_UP, 3, 1, c_w, c_h);
+        _dst += c_sz;
         break;
       }
       case 2: {
         /*Slide C_r down a quarter-pel.
           This is the same as the horizontal filter.*/
-        for (x = 0; x < c_w; x++) {
-          for (y = 0; y < OC_MINI(c_h, 2); y++) {
-            _dst[y * c_w] = (unsigned char)OC_CLAMPI(
-                0,
-                (4 * tmp[0] - 17 * tmp[OC_MAXI(y - 1, 0) * c_w] +
-                 114 * tmp[y * c_w] + 35 * tmp[OC_MINI(y + 1, c_h - 1) * c_w] -
-                 9 * tmp[OC_MINI(y + 2, c_h - 1) * c_w] +
-                 tmp[OC_MINI(y + 3, c_h - 1) * c_w] + 64) >>
-                    7,
-                255);
-          }
-          for (; y < c_h - 3; y++) {
-            _dst[y * c_w] = (unsigned char)OC_CLAMPI(
-                0,
-                (4 * tmp[(y - 2) * c_w] - 17 * tmp[(y - 1) * c_w] +
-                 114 * tmp[y * c_w] + 35 * tmp[(y + 1) * c_w] -
-                 9 * tmp[(y + 2) * c_w] + tmp[(y + 3) * c_w] + 64) >>
-                    7,
-                255);
-          }
-          for (; y < c_h; y++) {
-            _dst[y * c_w] = (unsigned char)OC_CLAMPI(
-                0,
-                (4 * tmp[(y - 2) * c_w] - 17 * tmp[(y - 1) * c_w] +
-                 114 * tmp[y * c_w] + 35 * tmp[OC_MINI(y + 1, c_h - 1) * c_w] -
-                 9 * tmp[OC_MINI(y + 2, c_h - 1) * c_w] + tmp[(c_h - 1) * c_w] +
-                 64) >>
-                    7,
-                255);
-          }
-          _dst++;
-          tmp++;
-        }
+        static const int TAPS_DOWN[6] = { 4, -17, 114, 35, -9, 1 };
+        y4m_filter_plane_v(_dst, tmp, TAPS_DOWN, 2, 1, c_w, c_h);
         break;
       }
     }
@@ -447,41 +450,9 @@ static void y4m_convert_42xpaldv_42xjpeg(y4m_input *_y4m, unsigned char *_dst,
 static void y4m_422jpeg_420jpeg_helper(unsigned char *_dst,
                                        const unsigned char *_src, int _c_w,
                                        int _c_h) {
-  int y;
-  int x;
   /*Filter: [3 -17 78 78 -17 3]/128, derived from a 6-tap Lanczos window.*/
-  for (x = 0; x < _c_w; x++) {
-    for (y = 0; y < OC_MINI(_c_h, 2); y += 2) {
-      _dst[(y >> 1) * _c_w] =
-          OC_CLAMPI(0,
-                    (64 * _src[0] + 78 * _src[OC_MINI(1, _c_h - 1) * _c_w] -
-                     17 * _src[OC_MINI(2, _c_h - 1) * _c_w] +
-                     3 * _src[OC_MINI(3, _c_h - 1) * _c_w] + 64) >>
-                        7,
-                    255);
-    }
-    for (; y < _c_h - 3; y += 2) {
-      _dst[(y >> 1) * _c_w] =
-          OC_CLAMPI(0,
-                    (3 * (_src[(y - 2) * _c_w] + _src[(y + 3) * _c_w]) -
-                     17 * (_src[(y - 1) * _c_w] + _src[(y + 2) * _c_w]) +
-                     78 * (_src[y * _c_w] + _src[(y + 1) * _c_w]) + 64) >>
-                        7,
-                    255);
-    }
-    for (; y < _c_h; y += 2) {
-      _dst[(y >> 1) * _c_w] = OC_CLAMPI(
-          0,
-          (3 * (_src[(y - 2) * _c_w] + _src[(_c_h - 1) * _c_w]) -
-           17 * (_src[(y - 1) * _c_w] + _src[OC_MINI(y + 2, _c_h - 1) * _c_w]) +
-           78 * (_src[y * _c_w] + _src[OC_MINI(y + 1, _c_h - 1) * _c_w]) +
-           64) >>
-              7,
-          255);
-    }
-    _src++;
-    _dst++;
-  }
+  static const int TAPS[6] = { 3, -17, 78, 78, -17, 3 };
+  y4m_filter_plane_v(_dst, _src, TAPS, 2, 2, _c_w, _c_h);
 }
 
 /*420jpeg chroma samples are sited like:
@@ -745,6 +716,42 @@ static void y4m_convert_411_420jpeg(y4m_input *_y4m, unsigned char *_dst,
   }
 }
 
+#if defined(__SSE2__)
+/*Decimates the row _src of _w pixels horizontally by two with the filter
+   [3 -17 78 78 -17 3]/128, starting at the even pixel _x, for as long as all
+   of the taps are inside the row.
+  Returns the pixel at which to continue.*/
+static int y4m_444_420_row_sse2(unsigned char *_dst, const unsigned char *_src,
+                                int _x, int _w) {
+  const __m128i even = _mm_set1_epi16(0xff);
+  const __m128i round = _mm_set1_epi16(64);
+  const __m128i taps_a = _mm_set_epi16(-17, 78, -17, 78, -17, 78, -17, 78);
+  const __m128i taps_b = _mm_set_epi16(1, 3, 1, 3, 1, 3, 1, 3);
+  /*Each iteration reads pixels _x - 2 through _x + 17.*/
+  for (; _x >= 2 && _x + 18 <= _w; _x += 16) {
+    const __m128i l = _mm_loadu_si128((const __m128i *)(_src + _x - 2));
+    const __m128i c = _mm_loadu_si128((const __m128i *)(_src + _x));
+    const __m128i r = _mm_loadu_si128((const __m128i *)(_src + _x + 2));
+    /*The sums of the pixels that share a tap.*/
+    const __m128i s1 = _mm_add_epi16(_mm_and_si128(l, even),
+                                     _mm_srli_epi16(r, 8));
+    const __m128i s2 = _mm_add_epi16(_mm_srli_epi16(l, 8),
+                                     _mm_and_si128(r, even));
+    const __m128i s3 = _mm_add_epi16(_mm_and_si128(c, even),
+                                     _mm_srli_epi16(c, 8));
+    __m128i lo = _mm_add_epi32(
+        _mm_madd_epi16(_mm_unpacklo_epi16(s3, s2), taps_a),
+        _mm_madd_epi16(_mm_unpacklo_epi16(s1, round), taps_b));
+    __m128i hi = _mm_add_epi32(
+        _mm_madd_epi16(_mm_unpackhi_epi16(s3, s2), taps_a),
+        _mm_madd_epi16(_mm_unpackhi_epi16(s1, round), taps_b));
+    lo = _mm_packs_epi32(_mm_srai_epi32(lo, 7), _mm_srai_epi32(hi, 7));
+    _mm_storel_epi64((__m128i *)(_dst + (_x >> 1)), _mm_packus_epi16(lo, lo));
+  }
+  return _x;
+}
+#endif
+
 /*Convert 444 to 420jpeg.*/
 static void y4m_convert_444_420jpeg(y4m_input *_y4m, unsigned char *_dst,
                                     unsigned char *_aux) {
@@ -781,6 +788,9 @@ static void y4m_convert_444_420jpeg(y4m_input *_y4m, unsigned char *_dst,
                                     7,
                                 255);
       }
+#if defined(__SSE2__)
+      x = y4m_444_420_row_sse2(tmp, _aux, x, c_w);
+#endif
       for (; x < c_w - 3; x += 2) {
         tmp[x >> 1] = OC_CLAMPI(0,
                                 (3 * (_aux[x - 2] + _aux[x + 3]) -